@@ -188,9 +188,10 @@ public:
 protected:
     /**
      * Casts the string value \p s into the type <code>T</code>. If the conversion fails,
-     * an CommandException is thrown. The conversion is done via an
-     * <code>std::stringstream</code> so it can only cast those types supported by the
-     * stream.
+     * an CommandException is thrown. Numbers are converted with ghoul::from_chars and
+     * have to consume the entire string, all other types, including characters and
+     * booleans, are converted via an <code>std::stringstream</code> so it can only cast
+     * those types supported by the stream.
      *
      * \tparam T The type of the value which should be converted
      * \param s The <code>std::string</code> representation of the value
@@ -203,8 +204,9 @@ protected:
 
     /**
      * Checks if the string value \p s can be cast into the type <code>T</code>. It only
-     * returns <code>true</code> for those values that can be converted using an
-     * <code>std::stringstream</code>.
+     * returns <code>true</code> for numbers that can be converted using
+     * ghoul::from_chars and for other values, including characters and booleans, that
+     * can be converted using an <code>std::stringstream</code>.
      *
      * \tparam T The type of the value which should be converted
      * \param s The <code>std::string</code> representation of the value
@@ -24,27 +24,62 @@
  ****************************************************************************************/
 
 #include <ghoul/misc/assert.h>
+#include <ghoul/misc/stringconversion.h>
+#include <type_traits>
 
 namespace ghoul::cmdparser {
 
+namespace internal {
+
+// Characters and booleans keep the stream conversion, which reads a single character or
+// the values 0 and 1, respectively, rather than a number
+template <typename T>
+constexpr bool IsParsedAsNumber = std::is_arithmetic_v<T> && !std::is_same_v<T, bool> &&
+    !std::is_same_v<T, char> && !std::is_same_v<T, signed char> &&
+    !std::is_same_v<T, unsigned char>;
+
+template <typename T>
+bool parseArithmetic(const std::string& s, T& value) {
+    const char* last = s.data() + s.size();
+    const std::from_chars_result res = ghoul::from_chars(s.data(), last, value);
+    return res.ec == std::errc() && res.ptr == last;
+}
+
+} // namespace internal
+
 template <class T>
 T CommandlineCommand::cast(const std::string& s) const {
     ghoul_assert(!s.empty(), "s must not be empty");
-    std::istringstream iss(s);
-    T t;
-    iss >> std::dec >> t;
-    if (iss.fail()) {
-        throw CommandExecutionException("Illegal conversion");
+    if constexpr (internal::IsParsedAsNumber<T>) {
+        T t = T();
+        if (!internal::parseArithmetic(s, t)) {
+            throw CommandExecutionException("Illegal conversion");
+        }
+        return t;
+    }
+    else {
+        std::istringstream iss(s);
+        T t;
+        iss >> std::dec >> t;
+        if (iss.fail()) {
+            throw CommandExecutionException("Illegal conversion");
+        }
+        return t;
     }
-    return t;
 }
 
 template <class T>
 [[nodiscard]] bool CommandlineCommand::is(const std::string& s) const {
-    std::istringstream iss(s);
-    T t;
-    iss >> std::dec >> t;
-    return !iss.fail();
+    if constexpr (internal::IsParsedAsNumber<T>) {
+        T t = T();
+        return internal::parseArithmetic(s, t);
+    }
+    else {
+        std::istringstream iss(s);
+        T t;
+        iss >> std::dec >> t;
+        return !iss.fail();
+    }
 }
 
 }  // namespace ghoul::cmdparser
@@ -29,12 +29,23 @@
 #include <ghoul/filesystem/directory.h>
 #include <ghoul/misc/boolean.h>
 #include <ghoul/misc/exception.h>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
+
+namespace ghoul { class ThreadPool; }
 
 namespace ghoul::filesystem {
 
 class File;
+struct CacheFileHandle;
 
 /**
  * The CacheManager allows users to request a storage location for an, optionally
@@ -51,13 +62,44 @@ class File;
  * <code>isPersistent</code> flag set to <code>false</code>. Non-persistent files will
  * automatically be deleted when the program ends.<br>
  * The persistent files are stored in a <code>cache</code> file so that they can be
- * retained between application runs. If two CacheManagers are pointing at the same
- * directory, the result is undefined.
+ * retained between application runs. This file is an append-only journal to which every
+ * change to a persistent entry is written immediately. Each record is protected by a
+ * checksum, so that a crash of the application loses at most the record that was being
+ * written, rather than the entire cache. The journal is compacted by writing its live
+ * entries into a new file that atomically replaces the old journal.<br>
+ * All methods of the CacheManager are thread-safe. The entries are split into shards
+ * that are locked independently, so that concurrent requests for different files rarely
+ * block each other. Multiple processes can use the same cache directory at the same
+ * time. Changes to the journal are serialized between the processes with a lock file,
+ * while lookups read the records that were written by the other processes without
+ * taking the lock. This way, a persistent file that was cached by one process is found
+ * by all other processes using the same directory. Only the last process that is using
+ * the cache directory removes files that are left over from a crash.<br>
+ * Cached files that are requested for a File are identified by a hash of the file's
+ * contents, so identical files share a cache entry regardless of their location. The
+ * hash of a file is remembered and only computed again once the size or modification
+ * time of the file changes. Each cached file is stored in a directory named after its
+ * hash value. These directories are spread over two levels of directories named after
+ * the two most significant bytes of the hash, so that no single directory grows too
+ * large.<br>
+ * The total size of the persistent files can be limited using #setSizeLimit, in which
+ * case the least recently or least frequently used entries are evicted by a background
+ * thread whenever the cache grows beyond the limit. The time and number of accesses for
+ * each entry are stored alongside the persistent entries in the <code>cache</code> file,
+ * so that they carry over between application runs. Unlike the other changes, they are
+ * collected in memory and written in batches, so a crash might lose the most recent
+ * accesses.
  */
 class CacheManager {
 public:
     BooleanType(Persistent);
 
+    /// Determines which persistent files are removed first if the size limit is exceeded
+    enum class EvictionPolicy {
+        LeastRecentlyUsed = 0, ///< The files that were not requested the longest
+        LeastFrequentlyUsed ///< The files that were requested the fewest times
+    };
+
     /// Superclass for all cache-related exceptions
     struct CacheException : public RuntimeError {
         explicit CacheException(std::string msg);
@@ -85,10 +127,11 @@ public:
 
     /**
      * The constructor will automatically register all persistent cache entries from
-     * previous application runs and clean the directory of non-persistent entries that
-     * might have been left intact if the previous run crashed. After the constructor
-     * returns, the CacheManager will leave a cleaned cache directory and the persistent
-     * files are correctly registered and available.
+     * previous application runs by replaying the journal in the <code>cache</code> file
+     * and clean the directory of non-persistent entries that might have been left intact
+     * if the previous run crashed. Persistent entries survive a crash of a previous run.
+     * After the constructor returns, the CacheManager will leave a cleaned cache
+     * directory and the persistent files are correctly registered and available.
      *
      * \param directory The directory that is used for the CacheManager
      * \param version The version of the cache. If a major change happens that shouldn't
@@ -96,15 +139,16 @@ public:
      *
      * \throw MalformedCacheException If the cache file could is malformed
      * \throw ErrorLoadingCacheException If the previous cache could not be loaded
+     * \throw CacheException If the journal could not be written
      * \pre \p directory must not be empty
      */
     CacheManager(std::string directory, int version = -1);
 
     /**
-     * The destructor will save all information on persistent files in a
+     * The destructor will compact the journal of persistent files in the
      * <code>cache</code> file in the cache directory that was passed in the constructor
-     * so that they can be retrieved when the application is started up again. All
-     * non-persistent files are automatically deleted in the destructor.
+     * so that they can be retrieved quickly when the application is started up again.
+     * All non-persistent files are automatically deleted in the destructor.
      */
     ~CacheManager();
 
@@ -117,11 +161,11 @@ public:
      * Returns the path to a storage location for the cached file. Depending on the
      * persistence (\p isPersistent), the directory and files will automatically be
      * cleaned on application end or be made available automatically on the next
-     * application run. The method will use the date of last modification as a unique
+     * application run. The method will use a hash of the file's contents as a unique
      * identifier for the file. Subsequent calls (in the same run or different) with the
-     * same \p file will consistently produce the same file path until the last-modified
-     * date changes. If the cached file was created before, the \p isPersistent parameter
-     * is silently ignored.
+     * same \p file will consistently produce the same file path until the contents of
+     * the file change. If the cached file was created before, the \p isPersistent
+     * parameter is silently ignored.
      *
      * \param file The file name of the file for which the cached entry is to be retrieved
      * \param isPersistent This parameter will only be used if the cached file is used for
@@ -136,6 +180,7 @@ public:
      *        <code>\\</code>, <code>?</code>, <code>%</code>, <code>*</code>,
      *        <code>:</code>, <code>|</code>, <code>"</code>, <code>\<</code>,
      *        <code>\></code>, or <code>.</code>) in the \p file
+     * \throw CacheException If the contents of the \p file could not be read
      */
     std::string cachedFilename(const File& file,
         Persistent isPersistent = Persistent::No);
@@ -180,8 +225,8 @@ public:
      * combination of \p baseName and \p information is the unique key for the returned
      * cached file. If the cached file was created before, the \p isPersistent parameter
      * is silently ignored.<br>
-     * As the \p baseName will be used as a name for a directory in the file system, the
-     * usual restrictions apply. The \p baseName is automatically converted into
+     * As the \p baseName will be used as the name of the cached file, the usual
+     * restrictions apply. The \p baseName is automatically converted into
      * lower case, so that the \p baseName of <code>base</code>, <code>bAsE</code>, and
      * <code>BASE</code> all refer to the same file. Furthermore, the \p baseName cannot
      * contain any of the following characters:
@@ -216,7 +261,7 @@ public:
      * application run (persistent and non-persistent files) or in a previous run
      * (persistent cache files only). Note that this only checks if a file has been
      * requested before, not if the cached file has actually been used. The method will
-     * use the date of last modification as a unique identifier for the file.
+     * use a hash of the file's contents as a unique identifier for the file.
      *
      * \param file The file for which the cached file should be searched
      * \return <code>true</code> if a cached file was requested before; <code>false</code>
@@ -226,6 +271,7 @@ public:
      *        <code>\\</code>, <code>?</code>, <code>%</code>, <code>*</code>,
      *        <code>:</code>, <code>|</code>, <code>"</code>, <code>\<</code>,
      *        <code>\></code>, or <code>.</code>) in the \p file
+     * \throw CacheException If the contents of the \p file could not be read
      */
     bool hasCachedFile(const File& file) const;
 
@@ -270,7 +316,7 @@ public:
     /**
      * Removes the cached file and deleted the entry from the CacheManager. If the
      * \p file has not previously been used to request a cache entry, no error
-     * will be signaled. The method will use the date of last modification as a unique
+     * will be signaled. The method will use a hash of the file's contents as a unique
      * identifier for the file.
      *
      * \param file The file for which the cache file should be deleted
@@ -279,6 +325,7 @@ public:
      *        <code>\\</code>, <code>?</code>, <code>%</code>, <code>*</code>,
      *        <code>:</code>, <code>|</code>, <code>"</code>, <code>\<</code>,
      *        <code>\></code>, or <code>.</code>) in the \p file
+     * \throw CacheException If the contents of the \p file could not be read
      */
     void removeCacheFile(const File& file);
 
@@ -315,14 +362,165 @@ public:
      */
     void removeCacheFile(const std::string& baseName, const std::string& information);
 
+    /**
+     * Limits the total size of all persistent cached files to \p bytes. Whenever the
+     * cached files grow beyond this limit, a background thread removes persistent entries
+     * in the order determined by the \p policy until the limit is met again. As the size
+     * of a cached file is only known after the caller has written it, the sizes are
+     * checked periodically and after each new entry. Non-persistent files do not count
+     * towards the limit and are never evicted. Passing a limit of 0 disables the limit.
+     *
+     * \param bytes The maximum number of bytes all persistent cached files may use, or 0
+     *        if the size should not be limited
+     * \param policy The policy that determines which entries are evicted first
+     */
+    void setSizeLimit(uint64_t bytes,
+        EvictionPolicy policy = EvictionPolicy::LeastRecentlyUsed);
+
+    /**
+     * Returns the size limit that was set with #setSizeLimit or 0 if the size of the
+     * cache is not limited.
+     *
+     * \return The size limit in bytes or 0 if the size is not limited
+     */
+    uint64_t sizeLimit() const;
+
+    /**
+     * Immediately evicts persistent entries on the calling thread until the total size
+     * of the persistent cached files is within the limit set with #setSizeLimit. This
+     * happens automatically in the background, so calling this is only necessary if the
+     * limit has to be met at a specific point in time.
+     */
+    void enforceSizeLimit();
+
 protected:
     /// This struct stores the cache information for a specific hash value.
     struct CacheInformation {
         std::string file; ///< The path to the cached file
         bool isPersistent = false; ///< if the cached file should be automatically deleted
+        int64_t lastAccess = 0; ///< Microseconds since epoch when last requested
+        uint64_t nAccesses = 0; ///< The number of times the file was requested
+    };
+
+    /// A part of the cache entries that is protected by its own mutex
+    struct Shard {
+        mutable std::mutex mutex;
+        std::map<uint64_t, CacheInformation> files;
     };
 
-    using LoadedCacheInfo = std::pair<unsigned int, std::string>;
+    /// The number of shards the cache entries are split into
+    static constexpr const size_t NShards = 16;
+
+    /// The hash of a file's contents and the state of the file it was computed for
+    struct ContentHash {
+        uint64_t size = 0; ///< The size of the file in bytes
+        int64_t lastWriteTime = 0; ///< The time of the last change to the file
+        std::string hash; ///< The hash of the contents as a hexadecimal number
+    };
+
+    /// Returns the shard that is responsible for the entry with the \p hash
+    Shard& shard(uint64_t hash) const;
+
+    /**
+     * Returns the hash of the contents of the \p file as a hexadecimal number. The hash
+     * is remembered for the path of the \p file and is only computed again if the size
+     * or the time of the last change of the file are different.
+     *
+     * \throw CacheException If the contents of the \p file could not be read
+     */
+    std::string contentInformation(const File& file) const;
+
+    /// Updates the access time and the number of accesses of the \p info
+    void touch(CacheInformation& info);
+
+    /// The function that is run by the background thread evicting entries
+    void evictionThread();
+
+    /**
+     * Loads the journal when the CacheManager is created. Expects the lock for the
+     * journal to be held by the caller.
+     *
+     * \param isOnlyUser <code>true</code> if no other process is using the cache
+     *        directory, in which case the cache is cleaned of left over files
+     *
+     * \throw ErrorLoadingCacheException If the journal has a different version while
+     *        other processes are using the cache
+     */
+    void loadJournal(bool isOnlyUser);
+
+    /// Returns the path to the journal file in the cache directory
+    std::string journalPath() const;
+
+    /**
+     * Applies all records in the \p data to the cache entries, except for the records
+     * that were written by this CacheManager. The \p data must only contain complete
+     * and valid records.
+     *
+     * \param data The records that should be applied
+     * \param size The number of bytes in \p data
+     * \param shardsLocked Whether all shards are already locked by the caller
+     * \param isSnapshot If <code>true</code>, the \p data is an entire journal that
+     *        replaces all persistent entries, including the ones written by this
+     *        CacheManager. This requires all shards to be locked by the caller
+     */
+    void applyJournal(const char* data, size_t size, bool shardsLocked,
+        bool isSnapshot) const;
+
+    /**
+     * Reads all records that other processes have appended to the journal since the
+     * last time and stores them in #_pendingRecords. If the journal was replaced by
+     * another process, it is reopened and read from the beginning, which is signaled by
+     * #_pendingIsSnapshot. Expects the #_journalMutex to be held by the caller.
+     *
+     * \param isLocked Whether the caller holds the lock for the journal. Only then are
+     *        incomplete records left by a crash removed and a missing journal recreated
+     */
+    void readJournalTail(bool isLocked) const;
+
+    /**
+     * Applies all records that other processes have written to the journal. This does
+     * not take the lock for the journal, which is only needed to change the journal.
+     */
+    void syncJournal() const;
+
+    /// Writes a record for the newly added persistent entry to the journal
+    void journalAdd(uint64_t hash, const CacheInformation& info);
+
+    /**
+     * Writes the access information of all persistent entries that were requested since
+     * the last time to the journal with a single write.
+     */
+    void flushAccesses();
+
+    /// Writes a record for the removal of a persistent entry to the journal
+    void journalRemove(uint64_t hash);
+
+    /// Appends the record with the \p payload to the journal
+    void writeToJournal(const std::vector<char>& payload);
+
+    /// Appends the \p nRecords complete \p records to the journal
+    void writeRecordsToJournal(const std::vector<char>& records, size_t nRecords);
+
+    /// Compacts the journal if it contains too many outdated records
+    void compactJournalIfNecessary();
+
+    /**
+     * Writes all persistent entries into a new journal that atomically replaces the
+     * current journal.
+     *
+     * \throw CacheException If the new journal could not be written
+     */
+    void compactJournal();
+
+    /**
+     * Writes the new journal for #compactJournal. Expects all shards, the #_journalMutex,
+     * and the lock for the journal to be held by the caller.
+     *
+     * \throw CacheException If the new journal could not be written
+     */
+    void writeCompactedJournal();
+
+    using LoadedCacheInfo = std::pair<uint64_t, std::string>;
 
     /**
      * Cleans a directory from files not flagged as persistent and removes
@@ -343,8 +541,81 @@ protected:
     /// The cache version
     const int _version;
 
-    /// A map containing file hashes and file information
-    std::map<unsigned long, CacheInformation> _files;
+    /// The cache entries, split into shards by their hash
+    mutable std::array<Shard, NShards> _shards;
+
+    /// A random identifier for the records written by this CacheManager
+    uint64_t _instanceId;
+
+    /// The last access time that was handed out to make access times unique
+    mutable std::atomic<int64_t> _lastAccess = 0;
+
+    /// Protects the journal and the state associated with it within this process
+    mutable std::mutex _journalMutex;
+
+    /// Serializes applying the records of other processes so that they keep their order
+    mutable std::mutex _syncMutex;
+
+    /// The journal that all changes to persistent files are appended to
+    mutable std::unique_ptr<CacheFileHandle> _journal;
+
+    /// The lock file that serializes changes to the journal between processes
+    std::unique_ptr<CacheFileHandle> _journalLock;
+
+    /// Every process using the cache directory holds a shared lock on this file
+    std::unique_ptr<CacheFileHandle> _usersLock;
+
+    /// The position in the journal up to which all records have been read
+    mutable uint64_t _journalOffset = 0;
+
+    /// Records that were written by other processes but have not been applied yet
+    mutable std::vector<char> _pendingRecords;
+
+    /// Set if the #_pendingRecords contain an entire journal written by another process
+    mutable bool _pendingIsSnapshot = false;
+
+    /// The persistent entries that were requested since their access information was
+    /// last written to the journal
+    std::vector<uint64_t> _pendingAccesses;
+
+    /// Protects the #_pendingAccesses
+    std::mutex _accessMutex;
+
+    /// The number of records in the journal, used to determine when to compact it
+    mutable std::atomic<size_t> _nJournalRecords = 0;
+
+    /// The maximum size of all persistent files in bytes, or 0 if it is not limited
+    uint64_t _sizeLimit = 0;
+
+    /// The policy that is used to determine which files are evicted first
+    EvictionPolicy _evictionPolicy = EvictionPolicy::LeastRecentlyUsed;
+
+    /// The hashes of the contents of files that have been requested, keyed by path
+    mutable std::map<std::string, ContentHash> _contentHashes;
+
+    /// Protects the #_contentHashes
+    mutable std::mutex _contentHashMutex;
+
+    /// The ThreadPool that hashes the chunks of large files, created on first use
+    mutable std::unique_ptr<ThreadPool> _hashPool;
+
+    /// Guards the creation of the #_hashPool
+    mutable std::once_flag _hashPoolCreated;
+
+    /// The thread that evicts entries if the size limit is exceeded
+    std::thread _evictionThread;
+
+    /// Protects the state that is shared with the eviction thread
+    mutable std::mutex _evictionMutex;
+
+    /// Used to wake up the eviction thread before its next periodic check
+    std::condition_variable _evictionCondition;
+
+    /// Set if the eviction thread should check the size before its next periodic check
+    bool _evictionRequested = false;
+
+    /// Set if the eviction thread should terminate
+    bool _stopEviction = false;
 };
 
 } // namespace ghoul::filesystem
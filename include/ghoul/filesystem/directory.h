@@ -27,9 +27,12 @@
 #define __GHOUL___DIRECTORY___H__
 
 #include <ghoul/misc/boolean.h>
+#include <functional>
 #include <string>
 #include <vector>
 
+namespace ghoul { class ThreadPool; }
+
 namespace ghoul::filesystem {
 
 /**
@@ -39,7 +42,8 @@ namespace ghoul::filesystem {
  * create and absolute path or use the provided path as-is.
  * The Directory has the possibility to list all files (#read), or selectively only
  * read files (#readFiles), read directories (#readDirectories), or get the parent
- * (#parentDirectory).
+ * (#parentDirectory). For large directory trees, the #walk function traverses the tree
+ * in a single pass, optionally in parallel, and streams the results to a callback.
  */
 class Directory {
 public:
@@ -48,6 +52,43 @@ public:
     BooleanType(Recursive);
     BooleanType(Sort);
 
+    /**
+     * The callback that is called by #walk for each entry that passes the filters. The
+     * first parameter is the path of the entry, which is created by appending the name
+     * of the entry to the path of its parent directory, the second parameter is
+     * <code>true</code> if the entry is a directory. The referenced string is only valid
+     * for the duration of the call.
+     */
+    using WalkCallback = std::function<void(const std::string& path, bool isDirectory)>;
+
+    /// The options that determine which entries are reported by #walk
+    struct WalkOptions {
+        /// If <code>true</code> all subdirectories are traversed as well
+        Recursive recursive = Recursive::Yes;
+
+        /// If <code>true</code> files are reported to the callback
+        bool includeFiles = true;
+
+        /// If <code>true</code> directories are reported to the callback
+        bool includeDirectories = true;
+
+        /**
+         * If this list is not empty, only files whose extension (without the leading
+         * <code>.</code>) is in this list are reported. The extensions do not apply to
+         * directories
+         */
+        std::vector<std::string> extensions;
+
+        /**
+         * If this is not empty, only entries whose name matches this glob pattern are
+         * reported. The pattern supports <code>*</code> for any number of characters and
+         * <code>?</code> for a single character. The pattern is only matched against the
+         * name of the entry, not against its full path and does not restrict which
+         * directories are traversed
+         */
+        std::string pattern;
+    };
+
     /**
      * This constructor creates a Directory object pointing to the absolute path of the
      * current working directory.
@@ -167,36 +208,31 @@ public:
     std::vector<std::string> readDirectories(Recursive recursiveSearch = Recursive::No,
         Sort sort = Sort::No) const;
 
-private:
     /**
-     * Internal function that does the directory marching of all files that are in the
-     * directory point to by \p path. It will combine all results in the \p result
-     * parameter and will, if \p recursiveSearch is <code>true</code> recursively call
-     * itself; thus reusing the \p result parameter.
+     * Traverses this directory and, depending on the \p options, all of its
+     * subdirectories in a single pass and calls the \p callback for each entry that
+     * passes the filters specified in the \p options. The type of each entry is taken
+     * from the directory listing itself wherever the operating system provides it, so no
+     * additional <code>stat</code> call is necessary. If a \p threadPool is provided,
+     * subdirectories are distributed among its workers and the calling thread, in which
+     * case the \p callback is called concurrently from multiple threads and has to be
+     * thread-safe. The order in which the entries are reported is unspecified. This
+     * function returns once all entries have been reported.
      *
-     * \param result The result vector that will contain all files in the directory
-     * \param path The path of the directory whose files should be listed
-     * \param recursiveSearch If <code>true</code>, this method will be called recursively
-     *        for each directory in the current directory, combining all results in the
-     *        \p result> vector
-     */
-    void internalReadFiles(std::vector<std::string>& result, const std::string& path,
-        Recursive recursiveSearch = Recursive::No) const;
-
-    /**
-     * Internal function that does the directory marching of all subdirectories that are
-     * in the directory point to by \p path. It will combine all results in the \p result
-     * parameter and will, if \p recursiveSearch is <code>true</code> recursively call
-     * itself; thus reusing the \p result parameter.
+     * \param callback The callback that is called for each entry passing the filters
+     * \param options The options that determine which entries are reported
+     * \param threadPool The ThreadPool whose workers help with the traversal. If this is
+     *        <code>nullptr</code>, the traversal happens on the calling thread only
      *
-     * \param result The result vector that will contain all files in the directory
-     * \param path The path of the directory whose files should be listed
-     * \param recursiveSearch If <code>true</code>, this method will be called recursively
-     *        for each directory in the current directory, combining all results in the
-     *        \p result vector.
+     * \throw Any exception thrown by the \p callback or while listing a directory. The
+     *        walk is aborted and the first exception is rethrown on the calling thread
+     *        after all participating threads have stopped
+     * \pre \p callback must not be empty
      */
-    void internalReadDirectories(std::vector<std::string>& result,
-        const std::string& path, Recursive recursiveSearch = Recursive::No) const;
+    void walk(const WalkCallback& callback, const WalkOptions& options,
+        ThreadPool* threadPool = nullptr) const;
+
+private:
 
     /// The path in the filesystem to this Directory object. May be absolute or relative
     std::string _directoryPath;
@@ -0,0 +1,184 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2020                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __GHOUL___FILESOURCE___H__
+#define __GHOUL___FILESOURCE___H__
+
+#include <ghoul/misc/exception.h>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ghoul::filesystem {
+
+/**
+ * The contents of a file that was read through a FileSource or FileSystem::readFile.
+ * Depending on where the file came from, the contents are either owned by this object or
+ * they point directly into a memory mapping, in which case this object keeps the mapping
+ * alive. In both cases, copying a FileContents object does not copy the contents.
+ */
+class FileContents {
+public:
+    /// Creates empty contents
+    FileContents() = default;
+
+    /**
+     * Creates contents that point to \p size bytes at \p data. The memory has to stay
+     * valid for as long as the \p owner is alive.
+     *
+     * \param owner The object that owns the memory pointed to by \p data
+     * \param data A pointer to the beginning of the contents
+     * \param size The size of the contents in bytes
+     *
+     * \pre \p data must not be <code>nullptr</code> if \p size is not 0
+     */
+    FileContents(std::shared_ptr<const void> owner, const char* data, size_t size);
+
+    /**
+     * Creates contents that take ownership of the passed \p contents.
+     *
+     * \param contents The contents of the file
+     */
+    explicit FileContents(std::string contents);
+
+    /**
+     * Returns a pointer to the beginning of the contents.
+     *
+     * \return A pointer to the beginning of the contents
+     */
+    const char* data() const;
+
+    /**
+     * Returns the size of the contents in bytes.
+     *
+     * \return The size of the contents in bytes
+     */
+    size_t size() const;
+
+    /**
+     * Returns whether the contents are empty.
+     *
+     * \return <code>true</code> if the contents are empty
+     */
+    bool empty() const;
+
+    /**
+     * Returns the contents as a <code>std::string_view</code>.
+     *
+     * \return The contents
+     */
+    std::string_view view() const;
+
+private:
+    std::shared_ptr<const void> _owner;
+    const char* _data = nullptr;
+    size_t _size = 0;
+};
+
+/**
+ * A FileSource provides the files that are mounted at a mount point of the FileSystem
+ * (see FileSystem::mount). All paths that are passed to a FileSource are relative to the
+ * mount point and use <code>/</code> as the path separator, regardless of the operating
+ * system. Implementations of this class have to be safe to use from multiple threads.
+ */
+class FileSource {
+public:
+    /// Exception that is thrown if a file could not be read from a FileSource
+    struct FileSourceException : public RuntimeError {
+        explicit FileSourceException(std::string f, std::string msg);
+
+        /// The file that could not be read
+        const std::string file;
+    };
+
+    virtual ~FileSource() = default;
+
+    /**
+     * Returns whether this source contains a file at the relative \p path.
+     *
+     * \param path The path of the file relative to the root of this source
+     * \return <code>true</code> if this source contains the file
+     */
+    virtual bool hasFile(std::string_view path) const = 0;
+
+    /**
+     * Returns whether this source contains a directory at the relative \p path, that is
+     * if any of its files are located in or below that directory.
+     *
+     * \param path The path of the directory relative to the root of this source
+     * \return <code>true</code> if this source contains the directory
+     */
+    virtual bool hasDirectory(std::string_view path) const = 0;
+
+    /**
+     * Returns the contents of the file at the relative \p path.
+     *
+     * \param path The path of the file relative to the root of this source
+     * \return The contents of the file
+     *
+     * \throw FileSourceException If the file does not exist or could not be read
+     */
+    virtual FileContents read(std::string_view path) const = 0;
+
+    /**
+     * Returns the relative paths of all files in this source, sorted by name.
+     *
+     * \return The relative paths of all files in this source
+     */
+    virtual std::vector<std::string> files() const = 0;
+};
+
+/**
+ * A FileSource that provides the files of a directory in the file system of the
+ * operating system. This makes it possible to mount a directory at a different location.
+ */
+class DirectorySource : public FileSource {
+public:
+    /**
+     * Creates a source that provides the files in the \p directory.
+     *
+     * \param directory The path to the directory whose files are provided. Relative
+     *        paths and path tokens are resolved when the source is created
+     *
+     * \pre \p directory must be an existing directory
+     */
+    explicit DirectorySource(std::string directory);
+
+    bool hasFile(std::string_view path) const override;
+    bool hasDirectory(std::string_view path) const override;
+    FileContents read(std::string_view path) const override;
+    std::vector<std::string> files() const override;
+
+private:
+    /// Returns the path in the file system for the relative \p path
+    std::string fullPath(std::string_view path) const;
+
+    std::string _directory;
+};
+
+} // namespace ghoul::filesystem
+
+#endif // __GHOUL___FILESOURCE___H__
@@ -27,14 +27,21 @@
 #define __GHOUL___FILESYSTEM___H__
 
 #include <ghoul/filesystem/directory.h>
+#include <ghoul/filesystem/filesource.h>
 #include <ghoul/misc/boolean.h>
 #include <ghoul/misc/exception.h>
+#include <atomic>
 #include <map>
 #include <memory>
+#include <shared_mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #if !defined(WIN32) && !defined(__APPLE__)
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
 #include <thread>
 #endif
 
@@ -117,7 +124,11 @@ public:
      * Returns the absolute path to the passed \p path, resolving any tokens (if present)
      * in the process. The current working directory (#currentDirectory) is used as a base
      * path for this. All tokens contained in the \p ignoredTokens are ignored from the
-     * token resolving
+     * token resolving. Resolved paths are cached, so repeatedly resolving the same path
+     * only costs a hash lookup. The cache is invalidated whenever a path token is
+     * registered or the current directory is changed through #setCurrentDirectory; the
+     * cache is not aware of changes to the working directory that bypass the FileSystem.
+     * This method is thread-safe with regard to other calls of this method.
      *
      * \param path The path that should be converted into an absolute path
      * \param ignoredTokens All tokens contained in this list are ignored during the
@@ -188,7 +199,8 @@ public:
     /**
      * Checks if the file at the \p path exists or not. This method will also return
      * <code>false</code> if \p path points to a directory. This method will not expand
-     * any tokens that are passed to it.
+     * any tokens that are passed to it. Files provided by a mounted FileSource (see
+     * #mount) exist as well.
      *
      * \param path The path that should be tested for existence
      * \return <code>true</code> if \p path points to an existing file, <code>false</code>
@@ -201,7 +213,8 @@ public:
 
     /**
      * Checks if the directory at the \p path exists or not. This method will return
-     * <code>false</code> if \p path points to a file.
+     * <code>false</code> if \p path points to a file. Mount points and the directories
+     * provided by a mounted FileSource (see #mount) exist as well.
      *
      * \param path The path that should be tested for existence
      * \return <code>true</code> if \p path points to an existing directory,
@@ -324,6 +337,65 @@ public:
      */
     bool containsToken(const std::string& path) const;
 
+    /**
+     * Mounts the \p source at the \p mountPoint. Afterwards, the files provided by the
+     * \p source appear to be located in the directory \p mountPoint for #fileExists,
+     * #directoryExists, and #readFile. As the \p mountPoint is resolved into an absolute
+     * path, path tokens that point into the \p mountPoint transparently resolve to the
+     * files of the \p source. The \p mountPoint does not have to exist on disk. If it
+     * does, the files of the \p source take precedence over the files on disk, while
+     * the files that the \p source does not provide are still taken from the disk. If
+     * mount points are nested, the innermost mount point is used. This method is
+     * thread-safe.
+     *
+     * \param mountPoint The path at which the \p source is mounted
+     * \param source The FileSource that provides the files
+     *
+     * \pre \p mountPoint must not be empty
+     * \pre \p source must not be <code>nullptr</code>
+     * \pre \p mountPoint must not have been used for another source
+     */
+    void mount(std::string mountPoint, std::unique_ptr<FileSource> source);
+
+    /**
+     * Removes the FileSource that was mounted at the \p mountPoint. The contents that
+     * have been read from the source with #readFile remain valid. This method is
+     * thread-safe.
+     *
+     * \param mountPoint The path at which the source was mounted
+     *
+     * \pre \p mountPoint must have been used in a call to #mount before
+     */
+    void unmount(std::string mountPoint);
+
+    /**
+     * Reads the contents of the file at the \p path, resolving any tokens (if present)
+     * in the process. If the \p path is located in a mount point (see #mount) whose
+     * FileSource provides the file, the contents are read from that source. Otherwise,
+     * the file is memory-mapped from the disk. This method is thread-safe.
+     *
+     * \param path The path to the file that should be read
+     * \return The contents of the file
+     *
+     * \throw FileSystemException If the file could not be read from the disk
+     * \throw FileSource::FileSourceException If the file could not be read from a
+     *        mounted FileSource
+     * \pre \p path must not be empty
+     */
+    FileContents readFile(const std::string& path) const;
+
+    /**
+     * Returns whether the file at the \p path is provided by a mounted FileSource (see
+     * #mount) instead of being read from the disk. Such a file cannot be watched for
+     * changes. This method is thread-safe.
+     *
+     * \param path The path to the file that is checked
+     * \return <code>true</code> if #readFile reads the file from a mounted FileSource
+     *
+     * \pre \p path must not be empty
+     */
+    bool isMountedFile(const std::string& path) const;
+
     /**
      * Creates a CacheManager for this FileSystem. If a CacheManager already exists, this
      * method will fail and log an error. The passed \p cacheDirectory has to be a valid
@@ -378,13 +450,21 @@ public:
      * Removes the file object from tracking lists. The file on the filesystem may still
      * be tracked and other File objects may still have callbacks registered.
      *
+     * On Linux, if the callback of the \p file is currently executed by
+     * #triggerFilesystemEvents on a different thread, this function waits until the
+     * callback has returned.
+     *
      * \pre \p file must not be a <code>nullptr</code>
      * \pre \p file must have been added before (addFileListener)
      */
     void removeFileListener(File* file);
 
     /**
-     * Triggers callbacks on filesystem. May not be needed depending on environment.
+     * Triggers callbacks on filesystem. May not be needed depending on environment. On
+     * Linux, the watcher thread only collects changes and all File callbacks are invoked
+     * from this function on the calling thread. Multiple changes to the same file are
+     * coalesced into a single callback that is only delivered once the file has not been
+     * changed for at least FileChangeDebounceInterval.
      */
     void triggerFilesystemEvents();
 
@@ -448,9 +528,70 @@ private:
      */
     std::string resolveToken(const std::string& token) const;
 
+    /**
+     * Returns the length of the registered token that starts at position \p begin in
+     * the \p path and stores its replacement in \p replacement. If no registered token
+     * starts at \p begin, 0 is returned.
+     *
+     * \param path The path that is searched for a registered token
+     * \param begin The position in the \p path at which the token has to start
+     * \param replacement Receives the path the found token points to
+     * \return The length of the found token, or 0 if no token was found
+     */
+    size_t matchToken(const std::string& path, size_t begin,
+        const std::string*& replacement) const;
+
+    /// Rebuilds the #_tokenTrie from the #_tokenMap
+    void buildTokenTrie();
+
     /// This map stores all the tokens that are used in the FileSystem.
     std::map<std::string, std::string> _tokenMap;
 
+    /// A node in the prefix tree of all registered tokens
+    struct TokenTrieNode {
+        /// The character and node index of all children, sorted by character
+        std::vector<std::pair<char, int>> children;
+        /// The replacement if a token ends at this node, or <code>nullptr</code>
+        const std::string* replacement = nullptr;
+    };
+    /// All tokens of the #_tokenMap in a prefix tree, the root node is at index 0
+    std::vector<TokenTrieNode> _tokenTrie = std::vector<TokenTrieNode>(1);
+
+    /// A single entry in the cache of resolved absolute paths
+    struct CachedPath {
+        uint64_t generation;
+        std::string path;
+    };
+    /// The cache of resolved absolute paths indexed by the unresolved paths
+    mutable std::unordered_map<std::string, CachedPath> _absolutePathCache;
+    /// Protects the #_absolutePathCache
+    mutable std::shared_mutex _absolutePathCacheMutex;
+    /// Incremented whenever the cached absolute paths might have become invalid
+    mutable std::atomic<uint64_t> _pathGeneration = 0;
+
+    /**
+     * Returns the FileSource that is mounted at the innermost mount point containing the
+     * \p path and stores the \p path relative to that mount point in \p relativePath.
+     *
+     * \param path The absolute path that is looked up
+     * \param relativePath Receives the \p path relative to the mount point, using
+     *        <code>/</code> as the path separator
+     * \return The mounted source or <code>nullptr</code> if the \p path is not located
+     *         in any mount point
+     */
+    std::shared_ptr<const FileSource> findMount(const std::string& path,
+        std::string& relativePath) const;
+
+    /// A FileSource that is mounted at an absolute path
+    struct Mount {
+        std::string mountPoint;
+        std::shared_ptr<const FileSource> source;
+    };
+    /// All mounted sources, sorted by the descending length of their mount point
+    std::vector<Mount> _mounts;
+    /// Protects the #_mounts
+    mutable std::shared_mutex _mountsMutex;
+
     /// The cache manager object, only allocated if createCacheManager is called
     std::unique_ptr<CacheManager> _cacheManager;
 
@@ -498,21 +639,96 @@ private:
     std::map<std::string, DirectoryHandle*> _directories;
 
 #else // Linux
+    /// The time a file has to be left untouched before its change callbacks are fired
+    static constexpr std::chrono::milliseconds FileChangeDebounceInterval =
+        std::chrono::milliseconds(50);
+
     /// Linux specific initialize function
     void initializeInternalLinux();
 
     /// Linux specific deinitialize function
     void deinitializeInternalLinux();
 
+    /// Linux specific trigger function that invokes the callbacks of changed files
+    void triggerFilesystemEventsInternalLinux();
+
     /// Function that run by the watcher thread
-    static void inotifyWatcher();
+    void inotifyWatcher();
+
+    /// Marks the \p file in the directory \p wd as changed; must hold the mutex
+    void markChanged(int wd, const std::string& file);
+
+    /// Handles a single inotify event; must hold the mutex
+    void handleInotifyEvent(int wd, uint32_t mask, const std::string& file);
+
+    /**
+     * Returns the watch descriptor for the normalized \p directory and creates the watch
+     * if the directory is not watched yet. Returns -1 if the directory cannot be
+     * watched, for example because it does not exist. The caller must hold the mutex.
+     */
+    int watchDirectory(const std::string& directory);
 
-    int _inotifyHandle;
-    bool _keepGoing;
+    /**
+     * Tracks the \p files in the \p directory again after the directory has been replaced
+     * and marks them as changed. If the directory does not exist, the files are kept in
+     * #_removedDirectories until the directory reappears in its parent directory. The
+     * caller must hold the mutex.
+     */
+    void restoreDirectory(const std::string& directory,
+        std::multimap<std::string, File*> files);
+
+    /// Removes the watch \p wd if it neither has files nor waits for a removed
+    /// subdirectory to reappear; must hold the mutex
+    void releaseDirectory(int wd);
+
+    /// Forgets the removed \p directory if it neither has files nor waits for a removed
+    /// subdirectory to reappear and releases its parent; must hold the mutex
+    void releaseRemovedDirectory(const std::string& directory);
+
+    /// Returns whether a removed subdirectory of \p directory waits to reappear; must
+    /// hold the mutex
+    bool hasRemovedSubdirectory(const std::string& directory) const;
+
+    /// All files in a single directory that are tracked by one inotify watch
+    struct WatchedDirectory {
+        /// The normalized paths in #_directoryWatches that refer to this watch
+        std::vector<std::string> paths;
+        std::multimap<std::string, File*> files;
+    };
+
+    int _inotifyHandle = -1;
+    int _epollHandle = -1;
+    int _wakeupHandle = -1;
+    std::atomic_bool _keepGoing = false;
     std::thread _t;
 
-    /// The list of tracked files
-    std::multimap<int, File*> _trackedFiles;
+    /// Protects the watched directories and the pending changes
+    std::mutex _trackedFilesMutex;
+
+    /// The watched directories, indexed by their inotify watch descriptor
+    std::map<int, WatchedDirectory> _watchedDirectories;
+
+    /// Maps the normalized absolute path of every watched directory to its watch
+    std::map<std::string, int> _directoryWatches;
+
+    /// Maps every tracked File to the watch descriptor of its directory, or to -1 while
+    /// its directory is in #_removedDirectories
+    std::map<const File*, int> _fileWatches;
+
+    /// The tracked files of watched directories that were removed or renamed, indexed by
+    /// the normalized path of the directory. The parent directory is watched instead, so
+    /// that the files are tracked again once the directory reappears
+    std::map<std::string, std::multimap<std::string, File*>> _removedDirectories;
+
+    /// The Files whose callback is currently executed and the executing threads
+    std::multimap<const File*, std::thread::id> _filesInCallback;
+
+    /// Signalled whenever a callback has returned
+    std::condition_variable _callbackFinished;
+
+    /// The changed files (directory and filename) and the time of their last change
+    std::map<std::pair<int, std::string>, std::chrono::steady_clock::time_point>
+        _pendingChanges;
 #endif
 
     static FileSystem* _instance;
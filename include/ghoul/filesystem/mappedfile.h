@@ -0,0 +1,159 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2020                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __GHOUL___MAPPEDFILE___H__
+#define __GHOUL___MAPPEDFILE___H__
+
+#include <ghoul/misc/boolean.h>
+#include <ghoul/misc/exception.h>
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace ghoul::filesystem {
+
+/**
+ * This class maps the contents of a file into the address space of the process for
+ * reading. The memory is provided directly by the page cache of the operating system, so
+ * reading a file through a MappedFile does not require a separate buffer or a copy of
+ * its contents. The mapping is owned by the MappedFile object and is released in its
+ * destructor, so the pointer returned by #data must not be used after that. A
+ * MappedFile can be moved but not copied.
+ *
+ * The access pattern that is passed as an Advice lets the operating system schedule its
+ * read-ahead accordingly, for example by prefetching the entire file if it is read
+ * sequentially. On systems that support it, the mapping can be backed by huge pages,
+ * which reduces the number of page faults and TLB misses for large files. All of these
+ * are hints that are silently ignored where they are not supported.
+ *
+ * The mapped memory is read-only and writing to it is undefined behavior. If the file is
+ * changed by another process while it is mapped, the changes might be visible through
+ * the mapping. A file that is truncated while it is mapped can cause a crash when the
+ * removed part is accessed.
+ */
+class MappedFile {
+public:
+    BooleanType(UseHugePages);
+
+    /// Exception that is thrown if a file could not be mapped
+    struct MappedFileException : public RuntimeError {
+        explicit MappedFileException(std::string f, std::string msg);
+
+        /// The file that could not be mapped
+        const std::string file;
+    };
+
+    /// The expected access pattern for the mapped file
+    enum class Advice {
+        Normal = 0, ///< No specific access pattern
+        Sequential, ///< The file is read from the beginning to the end
+        Random, ///< The file is accessed at random offsets, read-ahead is not useful
+        WillNeed ///< The entire file is needed soon and should be read in ahead of time
+    };
+
+    /**
+     * Maps the contents of the file at \p path into memory.
+     *
+     * \param path The path to the file that should be mapped
+     * \param advice The expected access pattern for the file
+     * \param useHugePages If <code>true</code>, the mapping will use huge pages, if the
+     *        system supports it for file mappings
+     *
+     * \throw MappedFileException If the file could not be opened or mapped
+     * \pre \p path must not be empty
+     */
+    explicit MappedFile(std::string path, Advice advice = Advice::Normal,
+        UseHugePages useHugePages = UseHugePages::No);
+
+    /// Releases the mapping of the file
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * Returns the path of the file that was passed to the constructor.
+     *
+     * \return The path of the file that was passed to the constructor
+     */
+    const std::string& path() const;
+
+    /**
+     * Returns a pointer to the beginning of the mapped contents of the file. The pointer
+     * is <code>nullptr</code> if the file is empty.
+     *
+     * \return A pointer to the beginning of the mapped contents of the file
+     */
+    const char* data() const;
+
+    /**
+     * Returns the size of the mapped file in bytes.
+     *
+     * \return The size of the mapped file in bytes
+     */
+    size_t size() const;
+
+    /**
+     * Returns whether the mapped file is empty.
+     *
+     * \return <code>true</code> if the mapped file is empty
+     */
+    bool empty() const;
+
+    /**
+     * Returns the contents of the mapped file as a <code>std::string_view</code>.
+     *
+     * \return The contents of the mapped file
+     */
+    std::string_view view() const;
+
+    /**
+     * Changes the expected access pattern for a part of the file.
+     *
+     * \param advice The expected access pattern for the part of the file
+     * \param offset The offset in bytes of the part of the file that the \p advice
+     *        applies to
+     * \param size The size in bytes of the part of the file that the \p advice applies
+     *        to. If the part extends beyond the end of the file, it is clamped to the
+     *        end of the file
+     */
+    void advise(Advice advice, size_t offset = 0,
+        size_t size = std::string_view::npos) const;
+
+private:
+    /// Releases the mapping, if there is one
+    void unmap();
+
+    std::string _path;
+    const char* _data = nullptr;
+    size_t _size = 0;
+};
+
+} // namespace ghoul::filesystem
+
+#endif // __GHOUL___MAPPEDFILE___H__
@@ -0,0 +1,139 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2020                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __GHOUL___PACKARCHIVE___H__
+#define __GHOUL___PACKARCHIVE___H__
+
+#include <ghoul/filesystem/filesource.h>
+
+#include <ghoul/misc/boolean.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ghoul::filesystem {
+
+class MappedFile;
+
+/**
+ * A FileSource that provides the files stored in a single packed archive. The archive is
+ * memory-mapped when it is opened and an index of all files is kept in memory, so
+ * mounting an archive (see FileSystem::mount) replaces the opening of every individual
+ * file with a single mapping. Archives are created from a directory with #create.
+ *
+ * Each file in the archive can be compressed with LZ4 individually. Files that are
+ * stored uncompressed are read without copying, the returned FileContents point directly
+ * into the mapping; compressed files are decompressed into a new buffer on every read.
+ *
+ * The archive consists of a header, followed by the contents of all files and the index:
+ * <pre>
+ * header:  char[8] magic ("GHLPACK\0"), uint32 version, uint32 number of files,
+ *          uint64 offset of the index
+ * index:   per file, sorted by path: uint64 offset, uint64 stored size, uint64 size,
+ *          uint32 flags, uint32 path length, char[] path
+ * </pre>
+ * All integers are stored in little-endian byte order. The paths are relative to the
+ * root of the archive and use <code>/</code> as the path separator.
+ */
+class PackArchive : public FileSource {
+public:
+    BooleanType(Compress);
+
+    /// Exception that is thrown if an archive could not be opened or created
+    struct PackArchiveException : public RuntimeError {
+        explicit PackArchiveException(std::string f, std::string msg);
+
+        /// The archive that caused the error
+        const std::string file;
+    };
+
+    /**
+     * Opens the archive at \p path and reads its index.
+     *
+     * \param path The path to the archive
+     *
+     * \throw PackArchiveException If the file could not be mapped or is not a valid
+     *        archive
+     * \pre \p path must not be empty
+     */
+    explicit PackArchive(std::string path);
+
+    ~PackArchive() override;
+
+    /**
+     * Creates a new archive at \p path that contains all files in the \p directory and
+     * its subdirectories. If \p compress is <code>true</code>, every file is compressed
+     * with LZ4, unless the compression would not reduce its size or the file is larger
+     * than LZ4 can compress in a single block (about 2 GB).
+     *
+     * \param path The path at which the archive is created. An existing file at this
+     *        location is overwritten
+     * \param directory The directory whose files are stored in the archive
+     * \param compress Whether the files in the archive should be compressed
+     *
+     * \throw PackArchiveException If the archive could not be written
+     * \throw FileSourceException If one of the files could not be read
+     * \pre \p path must not be empty
+     * \pre \p directory must be an existing directory
+     */
+    static void create(const std::string& path, const std::string& directory,
+        Compress compress = Compress::Yes);
+
+    bool hasFile(std::string_view path) const override;
+    bool hasDirectory(std::string_view path) const override;
+    FileContents read(std::string_view path) const override;
+    std::vector<std::string> files() const override;
+
+    /**
+     * Returns the path to the archive that was passed to the constructor.
+     *
+     * \return The path to the archive
+     */
+    const std::string& path() const;
+
+private:
+    /// A single file in the archive, the path points into the mapped index
+    struct Entry {
+        std::string_view path;
+        uint64_t offset;
+        uint64_t storedSize;
+        uint64_t size;
+        uint32_t flags;
+    };
+
+    /// Returns the entry for the relative \p path or <code>nullptr</code>
+    const Entry* findEntry(std::string_view path) const;
+
+    std::string _path;
+    std::shared_ptr<const MappedFile> _file;
+    /// All files in the archive, sorted by path
+    std::vector<Entry> _entries;
+};
+
+} // namespace ghoul::filesystem
+
+#endif // __GHOUL___PACKARCHIVE___H__
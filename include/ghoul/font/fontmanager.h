@@ -30,6 +30,7 @@
 #include <ghoul/opengl/textureatlas.h>
 #include <ghoul/misc/boolean.h>
 #include <ghoul/misc/exception.h>
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <string>
@@ -99,7 +100,7 @@ public:
      * \pre \p fontName must not be empty
      * \pre \p filePath must not be empty
      */
-    unsigned int registerFontPath(const std::string& fontName,
+    uint64_t registerFontPath(const std::string& fontName,
         const std::string& filePath);
 
     /**
@@ -146,7 +147,7 @@ public:
      * \return Returns a usable and initialized Font object, or <code>nullptr</code> if an
      *         error occurred
      */
-    std::shared_ptr<Font> font(unsigned int hashName, float fontSize,
+    std::shared_ptr<Font> font(uint64_t hashName, float fontSize,
         Outline withOutline = Outline::Yes, LoadGlyphs loadGlyphs = LoadGlyphs::Yes);
 
 private:
@@ -159,10 +160,10 @@ private:
     ghoul::opengl::TextureAtlas _textureAtlas;
 
     /// The map that is used to retrieve previously created Font objects.
-    std::multimap<unsigned int, std::shared_ptr<Font>> _fonts;
+    std::multimap<uint64_t, std::shared_ptr<Font>> _fonts;
 
     /// The map that correlates the hashed names with the file paths for the fonts
-    std::map<unsigned int, std::string> _fontPaths;
+    std::map<uint64_t, std::string> _fontPaths;
 };
 
 } // namespace ghoul::fontrendering
@@ -67,6 +67,8 @@
 #include <glm/ext/matrix_common.hpp>
 #include <glm/gtx/component_wise.hpp>
 
+#include <charconv>
+#include <stdexcept>
 #include <string>
 
 namespace glm {
@@ -160,349 +162,434 @@ struct glm_cols<glm::tmat4x3<T, P>> : public std::integral_constant<glm::length_
 template <typename T, glm::precision P>
 struct glm_cols<glm::tmat4x4<T, P>> : public std::integral_constant<glm::length_t, 4> {};
 
-inline std::string to_string(const glm::bvec2& _Val) {
-    return "{" + std::to_string(_Val.x) + "," + std::to_string(_Val.y) + "}";
+/**
+ * Writes the vector \p value as <code>{x,y,z}</code> into the caller-provided buffer
+ * <code>[first, last)</code> using the arithmetic #to_chars for each component.
+ *
+ * \param first The beginning of the buffer that receives the characters
+ * \param last The end of the buffer that receives the characters
+ * \param value The vector that is converted
+ * \return The pointer one past the last character that was written and
+ *         <code>std::errc()</code> on success, or <code>std::errc::value_too_large</code>
+ *         if the buffer was too small
+ */
+template <glm::length_t L, typename T, glm::precision P>
+std::to_chars_result to_chars(char* first, char* last, const glm::vec<L, T, P>& value) {
+    for (glm::length_t i = 0; i < L; ++i) {
+        if (first == last) {
+            return { last, std::errc::value_too_large };
+        }
+        *first++ = (i == 0) ? '{' : ',';
+        const std::to_chars_result res = to_chars(first, last, value[i]);
+        if (res.ec != std::errc()) {
+            return res;
+        }
+        first = res.ptr;
+    }
+    if (first == last) {
+        return { last, std::errc::value_too_large };
+    }
+    *first++ = '}';
+    return { first, std::errc() };
+}
+
+/**
+ * Parses a vector written as <code>{x,y,z}</code> from the character range
+ * <code>[first, last)</code> using the arithmetic #from_chars for each component.
+ * Whitespace is allowed between the components and the punctuation.
+ *
+ * \param first The beginning of the range that is parsed
+ * \param last The end of the range that is parsed
+ * \param value The vector that receives the result. It is only modified on success
+ * \return The pointer one past the closing brace and <code>std::errc()</code> on success,
+ *         <code>std::errc::invalid_argument</code> if the range does not contain a
+ *         vector with the correct number of components, or
+ *         <code>std::errc::result_out_of_range</code> if a component does not fit
+ */
+template <glm::length_t L, typename T, glm::precision P>
+std::from_chars_result from_chars(const char* first, const char* last,
+                                  glm::vec<L, T, P>& value)
+{
+    auto skipWhitespace = [last](const char* p) {
+        while (p != last && (*p == ' ' || *p == '\t')) {
+            ++p;
+        }
+        return p;
+    };
+
+    glm::vec<L, T, P> result;
+    const char* p = first;
+    for (glm::length_t i = 0; i < L; ++i) {
+        p = skipWhitespace(p);
+        if (p == last || *p != ((i == 0) ? '{' : ',')) {
+            return { first, std::errc::invalid_argument };
+        }
+        p = skipWhitespace(p + 1);
+        const std::from_chars_result res = from_chars(p, last, result[i]);
+        if (res.ec != std::errc()) {
+            return res.ec == std::errc::invalid_argument ?
+                std::from_chars_result{ first, res.ec } :
+                res;
+        }
+        p = res.ptr;
+    }
+    p = skipWhitespace(p);
+    if (p == last || *p != '}') {
+        return { first, std::errc::invalid_argument };
+    }
+    value = result;
+    return { p + 1, std::errc() };
+}
+
+template <glm::length_t L, typename T, glm::precision P>
+std::string to_string(const glm::vec<L, T, P>& value) {
+    // Braces, separators and the largest possible representation of every component
+    char buffer[1 + L * (MaxCharsLength<T> + 1)];
+    const std::to_chars_result res = to_chars(buffer, buffer + sizeof(buffer), value);
+    return std::string(buffer, res.ptr);
+}
+
+namespace internal {
+
+template <typename T>
+T vectorFromString(const std::string& string) {
+    const char* last = string.data() + string.size();
+    T value;
+    const std::from_chars_result res = from_chars(string.data(), last, value);
+    if (res.ec == std::errc::result_out_of_range) {
+        throw std::out_of_range("Value '" + string + "' is out of range");
+    }
+    if (res.ec != std::errc() || res.ptr != last) {
+        throw std::invalid_argument("Value '" + string + "' is not a vector");
+    }
+    return value;
 }
 
-inline std::string to_string(const glm::bvec3& _Val) {
-    return "{" +
-        std::to_string(_Val.x) + "," +
-        std::to_string(_Val.y) + "," +
-        std::to_string(_Val.z) + "}";
+} // namespace internal
+
+template <>
+inline glm::bvec2 from_string(const std::string& string) {
+    return internal::vectorFromString<glm::bvec2>(string);
 }
 
-inline std::string to_string(const glm::bvec4& _Val) {
-    return "{" +
-        std::to_string(_Val.x) + "," +
-        std::to_string(_Val.y) + "," +
-        std::to_string(_Val.z) + "," +
-        std::to_string(_Val.w) + "}";
+template <>
+inline glm::bvec3 from_string(const std::string& string) {
+    return internal::vectorFromString<glm::bvec3>(string);
 }
 
-inline std::string to_string(const glm::vec2& _Val) {
-    return "{" + std::to_string(_Val.x) + "," + std::to_string(_Val.y) + "}";
+template <>
+inline glm::bvec4 from_string(const std::string& string) {
+    return internal::vectorFromString<glm::bvec4>(string);
 }
 
-inline std::string to_string(const glm::vec3& _Val) {
-    return "{" +
-        std::to_string(_Val.x) + "," +
-        std::to_string(_Val.y) + "," +
-        std::to_string(_Val.z) + "}";
+template <>
+inline glm::vec2 from_string(const std::string& string) {
+    return internal::vectorFromString<glm::vec2>(string);
 }
 
-inline std::string to_string(const glm::vec4& _Val) {
-    return "{" +
-        std::to_string(_Val.x) + "," +
-        std::to_string(_Val.y) + "," +
-        std::to_string(_Val.z) + "," +
-        std::to_string(_Val.w) + "}";
+template <>
+inline glm::vec3 from_string(const std::string& string) {
+    return internal::vectorFromString<glm::vec3>(string);
 }
 
-inline std::string to_string(const glm::quat& _Val) {
-    return "{" +
-        std::to_string(_Val.x) + "," +
-        std::to_string(_Val.y) + "," +
-        std::to_string(_Val.z) + "," +
-        std::to_string(_Val.w) + "}";
+template <>
+inline glm::vec4 from_string(const std::string& string) {
+    return internal::vectorFromString<glm::vec4>(string);
 }
 
-inline std::string to_string(const glm::dvec2& _Val) {
-    return "{" + std::to_string(_Val.x) + "," + std::to_string(_Val.y) + "}";
+template <>
+inline glm::dvec2 from_string(const std::string& string) {
+    return internal::vectorFromString<glm::dvec2>(string);
 }
 
-inline std::string to_string(const glm::dvec3& _Val) {
-    return "{" +
-        std::to_string(_Val.x) + "," +
-        std::to_string(_Val.y) + "," +
-        std::to_string(_Val.z) + "}";
+template <>
+inline glm::dvec3 from_string(const std::string& string) {
+    return internal::vectorFromString<glm::dvec3>(string);
 }
 
-inline std::string to_string(const glm::dvec4& _Val) {
-    return "{" +
-        std::to_string(_Val.x) + "," +
-        std::to_string(_Val.y) + "," +
-        std::to_string(_Val.z) + "," +
-        std::to_string(_Val.w) + "}";
+template <>
+inline glm::dvec4 from_string(const std::string& string) {
+    return internal::vectorFromString<glm::dvec4>(string);
 }
 
-inline std::string to_string(const glm::dquat& _Val) {
-    return "{" +
-        std::to_string(_Val.x) + "," +
-        std::to_string(_Val.y) + "," +
-        std::to_string(_Val.z) + "," +
-        std::to_string(_Val.w) + "}";
+template <>
+inline glm::ivec2 from_string(const std::string& string) {
+    return internal::vectorFromString<glm::ivec2>(string);
 }
 
-inline std::string to_string(const glm::ivec2& _Val) {
-    return "{" + std::to_string(_Val.x) + "," + std::to_string(_Val.y) + "}";
+template <>
+inline glm::ivec3 from_string(const std::string& string) {
+    return internal::vectorFromString<glm::ivec3>(string);
 }
 
-inline std::string to_string(const glm::ivec3& _Val) {
-    return "{" +
-        std::to_string(_Val.x) + "," +
-        std::to_string(_Val.y) + "," +
-        std::to_string(_Val.z) + "}";
+template <>
+inline glm::ivec4 from_string(const std::string& string) {
+    return internal::vectorFromString<glm::ivec4>(string);
 }
 
-inline std::string to_string(const glm::ivec4& _Val) {
-    return "{" +
-        std::to_string(_Val.x) + "," +
-        std::to_string(_Val.y) + "," +
-        std::to_string(_Val.z) + "," +
-        std::to_string(_Val.w) + "}";
+template <>
+inline glm::uvec2 from_string(const std::string& string) {
+    return internal::vectorFromString<glm::uvec2>(string);
 }
 
-inline std::string to_string(const glm::uvec2& _Val) {
-    return "{" + std::to_string(_Val.x) + "," + std::to_string(_Val.y) + "}";
+template <>
+inline glm::uvec3 from_string(const std::string& string) {
+    return internal::vectorFromString<glm::uvec3>(string);
 }
 
-inline std::string to_string(const glm::uvec3& _Val) {
+template <>
+inline glm::uvec4 from_string(const std::string& string) {
+    return internal::vectorFromString<glm::uvec4>(string);
+}
+
+inline std::string to_string(const glm::quat& _Val) {
     return "{" +
-        std::to_string(_Val.x) + "," +
-        std::to_string(_Val.y) + "," +
-        std::to_string(_Val.z) + "}";
+        ghoul::to_string(_Val.x) + "," +
+        ghoul::to_string(_Val.y) + "," +
+        ghoul::to_string(_Val.z) + "," +
+        ghoul::to_string(_Val.w) + "}";
 }
 
-inline std::string to_string(const glm::uvec4& _Val) {
+inline std::string to_string(const glm::dquat& _Val) {
     return "{" +
-        std::to_string(_Val.x) + "," +
-        std::to_string(_Val.y) + "," +
-        std::to_string(_Val.z) + "," +
-        std::to_string(_Val.w) + "}";
+        ghoul::to_string(_Val.x) + "," +
+        ghoul::to_string(_Val.y) + "," +
+        ghoul::to_string(_Val.z) + "," +
+        ghoul::to_string(_Val.w) + "}";
 }
 
 inline std::string to_string(const glm::mat2& _Val) {
     return "{" +
-        std::to_string(_Val[0].x) + "," +
-        std::to_string(_Val[0].y) + "," +
-        std::to_string(_Val[1].x) + "," +
-        std::to_string(_Val[1].y) + "}";
+        ghoul::to_string(_Val[0].x) + "," +
+        ghoul::to_string(_Val[0].y) + "," +
+        ghoul::to_string(_Val[1].x) + "," +
+        ghoul::to_string(_Val[1].y) + "}";
 }
 
 inline std::string to_string(const glm::mat2x3& _Val) {
     return "{" +
-        std::to_string(_Val[0].x) + "," +
-        std::to_string(_Val[0].y) + "," +
-        std::to_string(_Val[0].z) + "," +
-        std::to_string(_Val[1].x) + "," +
-        std::to_string(_Val[1].y) + "," +
-        std::to_string(_Val[1].z) + "}";
+        ghoul::to_string(_Val[0].x) + "," +
+        ghoul::to_string(_Val[0].y) + "," +
+        ghoul::to_string(_Val[0].z) + "," +
+        ghoul::to_string(_Val[1].x) + "," +
+        ghoul::to_string(_Val[1].y) + "," +
+        ghoul::to_string(_Val[1].z) + "}";
 }
 
 inline std::string to_string(const glm::mat2x4& _Val) {
     return "{" +
-        std::to_string(_Val[0].x) + "," +
-        std::to_string(_Val[0].y) + "," +
-        std::to_string(_Val[0].z) + "," +
-        std::to_string(_Val[0].w) + "," +
-        std::to_string(_Val[1].x) + "," +
-        std::to_string(_Val[1].y) + "," +
-        std::to_string(_Val[1].z) + "," +
-        std::to_string(_Val[1].w) + "}";
+        ghoul::to_string(_Val[0].x) + "," +
+        ghoul::to_string(_Val[0].y) + "," +
+        ghoul::to_string(_Val[0].z) + "," +
+        ghoul::to_string(_Val[0].w) + "," +
+        ghoul::to_string(_Val[1].x) + "," +
+        ghoul::to_string(_Val[1].y) + "," +
+        ghoul::to_string(_Val[1].z) + "," +
+        ghoul::to_string(_Val[1].w) + "}";
 }
 
 inline std::string to_string(const glm::mat3x2& _Val) {
     return "{" +
-        std::to_string(_Val[0].x) + "," +
-        std::to_string(_Val[0].y) + "," +
-        std::to_string(_Val[1].x) + "," +
-        std::to_string(_Val[1].y) + "," +
-        std::to_string(_Val[2].x) + "," +
-        std::to_string(_Val[2].y) + "}";
+        ghoul::to_string(_Val[0].x) + "," +
+        ghoul::to_string(_Val[0].y) + "," +
+        ghoul::to_string(_Val[1].x) + "," +
+        ghoul::to_string(_Val[1].y) + "," +
+        ghoul::to_string(_Val[2].x) + "," +
+        ghoul::to_string(_Val[2].y) + "}";
 }
 
 inline std::string to_string(const glm::mat3& _Val) {
     return "{" +
-        std::to_string(_Val[0].x) + "," +
-        std::to_string(_Val[0].y) + "," +
-        std::to_string(_Val[0].z) + "," +
-        std::to_string(_Val[1].x) + "," +
-        std::to_string(_Val[1].y) + "," +
-        std::to_string(_Val[1].z) + "," +
-        std::to_string(_Val[2].x) + "," +
-        std::to_string(_Val[2].y) + "," +
-        std::to_string(_Val[2].z) + "}";
+        ghoul::to_string(_Val[0].x) + "," +
+        ghoul::to_string(_Val[0].y) + "," +
+        ghoul::to_string(_Val[0].z) + "," +
+        ghoul::to_string(_Val[1].x) + "," +
+        ghoul::to_string(_Val[1].y) + "," +
+        ghoul::to_string(_Val[1].z) + "," +
+        ghoul::to_string(_Val[2].x) + "," +
+        ghoul::to_string(_Val[2].y) + "," +
+        ghoul::to_string(_Val[2].z) + "}";
 }
 
 inline std::string to_string(const glm::mat3x4& _Val) {
     return "{" +
-        std::to_string(_Val[0].x) + "," +
-        std::to_string(_Val[0].y) + "," +
-        std::to_string(_Val[0].z) + "," +
-        std::to_string(_Val[0].w) + "," +
-        std::to_string(_Val[1].x) + "," +
-        std::to_string(_Val[1].y) + "," +
-        std::to_string(_Val[1].z) + "," +
-        std::to_string(_Val[1].w) + "," +
-        std::to_string(_Val[2].x) + "," +
-        std::to_string(_Val[2].y) + "," +
-        std::to_string(_Val[2].z) + "," +
-        std::to_string(_Val[2].w) + "}";
+        ghoul::to_string(_Val[0].x) + "," +
+        ghoul::to_string(_Val[0].y) + "," +
+        ghoul::to_string(_Val[0].z) + "," +
+        ghoul::to_string(_Val[0].w) + "," +
+        ghoul::to_string(_Val[1].x) + "," +
+        ghoul::to_string(_Val[1].y) + "," +
+        ghoul::to_string(_Val[1].z) + "," +
+        ghoul::to_string(_Val[1].w) + "," +
+        ghoul::to_string(_Val[2].x) + "," +
+        ghoul::to_string(_Val[2].y) + "," +
+        ghoul::to_string(_Val[2].z) + "," +
+        ghoul::to_string(_Val[2].w) + "}";
 }
 
 inline std::string to_string(const glm::mat4x2& _Val) {
     return "{" +
-        std::to_string(_Val[0].x) + "," +
-        std::to_string(_Val[0].y) + "," +
-        std::to_string(_Val[1].x) + "," +
-        std::to_string(_Val[1].y) + "," +
-        std::to_string(_Val[2].x) + "," +
-        std::to_string(_Val[2].y) + "," +
-        std::to_string(_Val[3].x) + "," +
-        std::to_string(_Val[3].y) + "}";
+        ghoul::to_string(_Val[0].x) + "," +
+        ghoul::to_string(_Val[0].y) + "," +
+        ghoul::to_string(_Val[1].x) + "," +
+        ghoul::to_string(_Val[1].y) + "," +
+        ghoul::to_string(_Val[2].x) + "," +
+        ghoul::to_string(_Val[2].y) + "," +
+        ghoul::to_string(_Val[3].x) + "," +
+        ghoul::to_string(_Val[3].y) + "}";
 }
 
 inline std::string to_string(const glm::mat4x3& _Val) {
     return "{" +
-        std::to_string(_Val[0].x) + "," +
-        std::to_string(_Val[0].y) + "," +
-        std::to_string(_Val[0].z) + "," +
-        std::to_string(_Val[1].x) + "," +
-        std::to_string(_Val[1].y) + "," +
-        std::to_string(_Val[1].z) + "," +
-        std::to_string(_Val[2].x) + "," +
-        std::to_string(_Val[2].y) + "," +
-        std::to_string(_Val[2].z) + "," +
-        std::to_string(_Val[3].x) + "," +
-        std::to_string(_Val[3].y) + "," +
-        std::to_string(_Val[3].z) + "}";
+        ghoul::to_string(_Val[0].x) + "," +
+        ghoul::to_string(_Val[0].y) + "," +
+        ghoul::to_string(_Val[0].z) + "," +
+        ghoul::to_string(_Val[1].x) + "," +
+        ghoul::to_string(_Val[1].y) + "," +
+        ghoul::to_string(_Val[1].z) + "," +
+        ghoul::to_string(_Val[2].x) + "," +
+        ghoul::to_string(_Val[2].y) + "," +
+        ghoul::to_string(_Val[2].z) + "," +
+        ghoul::to_string(_Val[3].x) + "," +
+        ghoul::to_string(_Val[3].y) + "," +
+        ghoul::to_string(_Val[3].z) + "}";
 }
 
 inline std::string to_string(const glm::mat4& _Val) {
     return "{" +
-        std::to_string(_Val[0].x) + "," +
-        std::to_string(_Val[0].y) + "," +
-        std::to_string(_Val[0].z) + "," +
-        std::to_string(_Val[0].w) + "," +
-        std::to_string(_Val[1].x) + "," +
-        std::to_string(_Val[1].y) + "," +
-        std::to_string(_Val[1].z) + "," +
-        std::to_string(_Val[1].w) + "," +
-        std::to_string(_Val[2].x) + "," +
-        std::to_string(_Val[2].y) + "," +
-        std::to_string(_Val[2].z) + "," +
-        std::to_string(_Val[2].w) + "," +
-        std::to_string(_Val[3].x) + "," +
-        std::to_string(_Val[3].y) + "," +
-        std::to_string(_Val[3].z) + "," +
-        std::to_string(_Val[3].w) + "}";
+        ghoul::to_string(_Val[0].x) + "," +
+        ghoul::to_string(_Val[0].y) + "," +
+        ghoul::to_string(_Val[0].z) + "," +
+        ghoul::to_string(_Val[0].w) + "," +
+        ghoul::to_string(_Val[1].x) + "," +
+        ghoul::to_string(_Val[1].y) + "," +
+        ghoul::to_string(_Val[1].z) + "," +
+        ghoul::to_string(_Val[1].w) + "," +
+        ghoul::to_string(_Val[2].x) + "," +
+        ghoul::to_string(_Val[2].y) + "," +
+        ghoul::to_string(_Val[2].z) + "," +
+        ghoul::to_string(_Val[2].w) + "," +
+        ghoul::to_string(_Val[3].x) + "," +
+        ghoul::to_string(_Val[3].y) + "," +
+        ghoul::to_string(_Val[3].z) + "," +
+        ghoul::to_string(_Val[3].w) + "}";
 }
 
 inline std::string to_string(const glm::dmat2& _Val) {
     return "{" +
-        std::to_string(_Val[0].x) + "," +
-        std::to_string(_Val[0].y) + "," +
-        std::to_string(_Val[1].x) + "," +
-        std::to_string(_Val[1].y) + "}";
+        ghoul::to_string(_Val[0].x) + "," +
+        ghoul::to_string(_Val[0].y) + "," +
+        ghoul::to_string(_Val[1].x) + "," +
+        ghoul::to_string(_Val[1].y) + "}";
 }
 
 inline std::string to_string(const glm::dmat2x3& _Val) {
     return "{" +
-        std::to_string(_Val[0].x) + "," +
-        std::to_string(_Val[0].y) + "," +
-        std::to_string(_Val[0].z) + "," +
-        std::to_string(_Val[1].x) + "," +
-        std::to_string(_Val[1].y) + "," +
-        std::to_string(_Val[1].z) + "}";
+        ghoul::to_string(_Val[0].x) + "," +
+        ghoul::to_string(_Val[0].y) + "," +
+        ghoul::to_string(_Val[0].z) + "," +
+        ghoul::to_string(_Val[1].x) + "," +
+        ghoul::to_string(_Val[1].y) + "," +
+        ghoul::to_string(_Val[1].z) + "}";
 }
 
 inline std::string to_string(const glm::dmat2x4& _Val) {
     return "{" +
-        std::to_string(_Val[0].x) + "," +
-        std::to_string(_Val[0].y) + "," +
-        std::to_string(_Val[0].z) + "," +
-        std::to_string(_Val[0].w) + "," +
-        std::to_string(_Val[1].x) + "," +
-        std::to_string(_Val[1].y) + "," +
-        std::to_string(_Val[1].z) + "," +
-        std::to_string(_Val[1].w) + "}";
+        ghoul::to_string(_Val[0].x) + "," +
+        ghoul::to_string(_Val[0].y) + "," +
+        ghoul::to_string(_Val[0].z) + "," +
+        ghoul::to_string(_Val[0].w) + "," +
+        ghoul::to_string(_Val[1].x) + "," +
+        ghoul::to_string(_Val[1].y) + "," +
+        ghoul::to_string(_Val[1].z) + "," +
+        ghoul::to_string(_Val[1].w) + "}";
 }
 
 inline std::string to_string(const glm::dmat3x2& _Val) {
     return "{" +
-        std::to_string(_Val[0].x) + "," +
-        std::to_string(_Val[0].y) + "," +
-        std::to_string(_Val[1].x) + "," +
-        std::to_string(_Val[1].y) + "," +
-        std::to_string(_Val[2].x) + "," +
-        std::to_string(_Val[2].y) + "}";
+        ghoul::to_string(_Val[0].x) + "," +
+        ghoul::to_string(_Val[0].y) + "," +
+        ghoul::to_string(_Val[1].x) + "," +
+        ghoul::to_string(_Val[1].y) + "," +
+        ghoul::to_string(_Val[2].x) + "," +
+        ghoul::to_string(_Val[2].y) + "}";
 }
 
 inline std::string to_string(const glm::dmat3& _Val) {
     return "{" +
-        std::to_string(_Val[0].x) + "," +
-        std::to_string(_Val[0].y) + "," +
-        std::to_string(_Val[0].z) + "," +
-        std::to_string(_Val[1].x) + "," +
-        std::to_string(_Val[1].y) + "," +
-        std::to_string(_Val[1].z) + "," +
-        std::to_string(_Val[2].x) + "," +
-        std::to_string(_Val[2].y) + "," +
-        std::to_string(_Val[2].z) + "}";
+        ghoul::to_string(_Val[0].x) + "," +
+        ghoul::to_string(_Val[0].y) + "," +
+        ghoul::to_string(_Val[0].z) + "," +
+        ghoul::to_string(_Val[1].x) + "," +
+        ghoul::to_string(_Val[1].y) + "," +
+        ghoul::to_string(_Val[1].z) + "," +
+        ghoul::to_string(_Val[2].x) + "," +
+        ghoul::to_string(_Val[2].y) + "," +
+        ghoul::to_string(_Val[2].z) + "}";
 }
 
 inline std::string to_string(const glm::dmat3x4& _Val) {
     return "{" +
-        std::to_string(_Val[0].x) + "," +
-        std::to_string(_Val[0].y) + "," +
-        std::to_string(_Val[0].z) + "," +
-        std::to_string(_Val[0].w) + "," +
-        std::to_string(_Val[1].x) + "," +
-        std::to_string(_Val[1].y) + "," +
-        std::to_string(_Val[1].z) + "," +
-        std::to_string(_Val[1].w) + "," +
-        std::to_string(_Val[2].x) + "," +
-        std::to_string(_Val[2].y) + "," +
-        std::to_string(_Val[2].z) + "," +
-        std::to_string(_Val[2].w) + "}";
+        ghoul::to_string(_Val[0].x) + "," +
+        ghoul::to_string(_Val[0].y) + "," +
+        ghoul::to_string(_Val[0].z) + "," +
+        ghoul::to_string(_Val[0].w) + "," +
+        ghoul::to_string(_Val[1].x) + "," +
+        ghoul::to_string(_Val[1].y) + "," +
+        ghoul::to_string(_Val[1].z) + "," +
+        ghoul::to_string(_Val[1].w) + "," +
+        ghoul::to_string(_Val[2].x) + "," +
+        ghoul::to_string(_Val[2].y) + "," +
+        ghoul::to_string(_Val[2].z) + "," +
+        ghoul::to_string(_Val[2].w) + "}";
 }
 
 inline std::string to_string(const glm::dmat4x2& _Val) {
     return "{" +
-        std::to_string(_Val[0].x) + "," +
-        std::to_string(_Val[0].y) + "," +
-        std::to_string(_Val[1].x) + "," +
-        std::to_string(_Val[1].y) + "," +
-        std::to_string(_Val[2].x) + "," +
-        std::to_string(_Val[2].y) + "," +
-        std::to_string(_Val[3].x) + "," +
-        std::to_string(_Val[3].y) + "}";
+        ghoul::to_string(_Val[0].x) + "," +
+        ghoul::to_string(_Val[0].y) + "," +
+        ghoul::to_string(_Val[1].x) + "," +
+        ghoul::to_string(_Val[1].y) + "," +
+        ghoul::to_string(_Val[2].x) + "," +
+        ghoul::to_string(_Val[2].y) + "," +
+        ghoul::to_string(_Val[3].x) + "," +
+        ghoul::to_string(_Val[3].y) + "}";
 }
 
 inline std::string to_string(const glm::dmat4x3& _Val) {
     return "{" +
-        std::to_string(_Val[0].x) + "," +
-        std::to_string(_Val[0].y) + "," +
-        std::to_string(_Val[0].z) + "," +
-        std::to_string(_Val[1].x) + "," +
-        std::to_string(_Val[1].y) + "," +
-        std::to_string(_Val[1].z) + "," +
-        std::to_string(_Val[2].x) + "," +
-        std::to_string(_Val[2].y) + "," +
-        std::to_string(_Val[2].z) + "," +
-        std::to_string(_Val[3].x) + "," +
-        std::to_string(_Val[3].y) + "," +
-        std::to_string(_Val[3].z) + "}";
+        ghoul::to_string(_Val[0].x) + "," +
+        ghoul::to_string(_Val[0].y) + "," +
+        ghoul::to_string(_Val[0].z) + "," +
+        ghoul::to_string(_Val[1].x) + "," +
+        ghoul::to_string(_Val[1].y) + "," +
+        ghoul::to_string(_Val[1].z) + "," +
+        ghoul::to_string(_Val[2].x) + "," +
+        ghoul::to_string(_Val[2].y) + "," +
+        ghoul::to_string(_Val[2].z) + "," +
+        ghoul::to_string(_Val[3].x) + "," +
+        ghoul::to_string(_Val[3].y) + "," +
+        ghoul::to_string(_Val[3].z) + "}";
 }
 
 inline std::string to_string(const glm::dmat4& _Val) {
     return "{" +
-        std::to_string(_Val[0].x) + "," +
-        std::to_string(_Val[0].y) + "," +
-        std::to_string(_Val[0].z) + "," +
-        std::to_string(_Val[0].w) + "," +
-        std::to_string(_Val[1].x) + "," +
-        std::to_string(_Val[1].y) + "," +
-        std::to_string(_Val[1].z) + "," +
-        std::to_string(_Val[1].w) + "," +
-        std::to_string(_Val[2].x) + "," +
-        std::to_string(_Val[2].y) + "," +
-        std::to_string(_Val[2].z) + "," +
-        std::to_string(_Val[2].w) + "," +
-        std::to_string(_Val[3].x) + "," +
-        std::to_string(_Val[3].y) + "," +
-        std::to_string(_Val[3].z) + "," +
-        std::to_string(_Val[3].w) + "}";
+        ghoul::to_string(_Val[0].x) + "," +
+        ghoul::to_string(_Val[0].y) + "," +
+        ghoul::to_string(_Val[0].z) + "," +
+        ghoul::to_string(_Val[0].w) + "," +
+        ghoul::to_string(_Val[1].x) + "," +
+        ghoul::to_string(_Val[1].y) + "," +
+        ghoul::to_string(_Val[1].z) + "," +
+        ghoul::to_string(_Val[1].w) + "," +
+        ghoul::to_string(_Val[2].x) + "," +
+        ghoul::to_string(_Val[2].y) + "," +
+        ghoul::to_string(_Val[2].z) + "," +
+        ghoul::to_string(_Val[2].w) + "," +
+        ghoul::to_string(_Val[3].x) + "," +
+        ghoul::to_string(_Val[3].y) + "," +
+        ghoul::to_string(_Val[3].z) + "," +
+        ghoul::to_string(_Val[3].w) + "}";
 }
 
 } // namespace ghoul
@@ -0,0 +1,182 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2020                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __GHOUL___ASYNCFILE___H__
+#define __GHOUL___ASYNCFILE___H__
+
+#include <ghoul/misc/exception.h>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ghoul::io {
+
+/**
+ * This class provides asynchronous read access to a file. All reads return immediately
+ * and the data is delivered either through a <code>std::future</code> or a callback, so
+ * that a caller can issue the reads for many files or many parts of a file at once and
+ * let the operating system overlap their latencies, instead of waiting for each read in
+ * turn.
+ *
+ * On Linux, the reads are submitted to the kernel through an <code>io_uring</code>, if
+ * it is available, and are completed by a single background thread. On all other
+ * platforms, or if the <code>io_uring</code> cannot be created, the reads are performed
+ * by a ghoul::ThreadPool with blocking reads. The backend is shared by all AsyncFile
+ * objects and is created on first use.
+ *
+ * An AsyncFile can be destroyed while reads are still in flight; the underlying file is
+ * kept open until the last of them has completed.
+ */
+class AsyncFile {
+public:
+    /// Exception that is thrown if a file could not be opened or read
+    struct AsyncFileException : public RuntimeError {
+        explicit AsyncFileException(std::string f, std::string msg);
+
+        /// The file that caused the exception
+        const std::string file;
+    };
+
+    /// A contiguous part of a file that is read by a vectored read
+    struct Range {
+        /// The offset in bytes from the beginning of the file
+        uint64_t offset = 0;
+        /// The number of bytes that should be read
+        size_t size = 0;
+    };
+
+    /**
+     * The signature of the callback that receives the result of a read. If the read
+     * failed, the \p data is empty and the \p error contains the AsyncFileException.
+     * The callback is called on a thread owned by the backend and should return quickly
+     */
+    using Callback = std::function<
+        void (std::vector<char> data, std::exception_ptr error)
+    >;
+
+    /**
+     * Opens the file at the provided \p path for reading.
+     *
+     * \param path The path to the file that should be read
+     *
+     * \throw AsyncFileException If the file could not be opened
+     * \pre \p path must not be empty
+     */
+    explicit AsyncFile(std::string path);
+    ~AsyncFile();
+
+    AsyncFile(const AsyncFile&) = delete;
+    AsyncFile& operator=(const AsyncFile&) = delete;
+
+    /**
+     * Returns the path of the file that was passed to the constructor.
+     *
+     * \return The path of the file that was passed to the constructor
+     */
+    const std::string& path() const;
+
+    /**
+     * Returns the size of the file at the time it was opened.
+     *
+     * \return The size of the file in bytes at the time it was opened
+     */
+    uint64_t size() const;
+
+    /**
+     * Reads \p size bytes starting at the \p offset. If the file ends before, the
+     * returned data only contains the bytes up to the end of the file.
+     *
+     * \param offset The offset in bytes at which the read starts
+     * \param size The number of bytes that should be read
+     * \return A future that contains the read bytes or an AsyncFileException
+     */
+    std::future<std::vector<char>> read(uint64_t offset, size_t size) const;
+
+    /**
+     * Reads \p size bytes starting at the \p offset and passes them to the
+     * \p callback. If the file ends before, the data only contains the bytes up to the
+     * end of the file.
+     *
+     * \param offset The offset in bytes at which the read starts
+     * \param size The number of bytes that should be read
+     * \param callback The callback that receives the read bytes or the error
+     * \pre \p callback must not be empty
+     */
+    void read(uint64_t offset, size_t size, Callback callback) const;
+
+    /**
+     * Reads all of the \p ranges of the file with a single request. The reads of the
+     * individual ranges are issued at the same time and the returned future becomes
+     * ready once all of them have completed.
+     *
+     * \param ranges The parts of the file that should be read
+     * \return A future that contains the read bytes of each of the \p ranges in the same
+     *         order, or an AsyncFileException if any of the reads failed
+     */
+    std::future<std::vector<std::vector<char>>> read(std::vector<Range> ranges) const;
+
+    /**
+     * Reads the entire file.
+     *
+     * \return A future that contains the contents of the file or an AsyncFileException
+     */
+    std::future<std::vector<char>> readAll() const;
+
+    /**
+     * Reads the entire contents of all files at the \p paths. All reads are issued
+     * before this function returns. If a file cannot be opened, its future contains the
+     * AsyncFileException instead of throwing it from this function.
+     *
+     * \param paths The paths of the files that should be read
+     * \return The futures containing the contents of each file in the same order as the
+     *         \p paths
+     */
+    static std::vector<std::future<std::vector<char>>> readFiles(
+        const std::vector<std::string>& paths);
+
+    /**
+     * Returns whether the reads are performed by an <code>io_uring</code> or by the
+     * fallback ThreadPool.
+     *
+     * \return <code>true</code> if the reads are performed by an <code>io_uring</code>
+     */
+    static bool isUsingIoUring();
+
+    /// The operating system handle of an opened file, shared with all pending reads
+    struct Handle;
+
+private:
+    std::string _path;
+    std::shared_ptr<Handle> _handle;
+    uint64_t _size = 0;
+};
+
+} // namespace ghoul::io
+
+#endif // __GHOUL___ASYNCFILE___H__
@@ -0,0 +1,210 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2020                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __GHOUL___SOCKETREACTOR___H__
+#define __GHOUL___SOCKETREACTOR___H__
+
+#ifdef __linux__
+
+#include <ghoul/io/socket/sockettype.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace ghoul::io {
+
+/**
+ * The SocketReactor multiplexes the I/O of many sockets onto a small, fixed set of
+ * threads, each of which runs an epoll event loop. Every registered socket is assigned to
+ * one of these loops for its whole lifetime, so the callback of a single socket is never
+ * called concurrently with itself. The TcpSocket and TcpSocketServer use the shared
+ * reactor returned by #ref instead of starting dedicated threads for each connection.
+ *
+ * The callbacks are called on the thread of the event loop and thus must not block, as
+ * this would stall all other sockets served by the same loop. The sockets are level
+ * triggered, so a callback does not have to drain all available data at once.
+ */
+class SocketReactor {
+public:
+    /// The events that a socket can be interested in or that can occur for a socket
+    enum Event {
+        None = 0,
+        Readable = 1,
+        Writable = 2,
+        /// The connection was closed or an error occurred. This event is always reported
+        /// for a socket that is interested in any other event
+        Closed = 4
+    };
+
+    /// The callback that is called with a bitmask of the Event%s that have occurred
+    using Callback = std::function<void(int events)>;
+
+    /**
+     * Creates a new SocketReactor and starts \p nThreads event loops.
+     *
+     * \param nThreads The number of threads that serve the registered sockets
+     * \throw RuntimeError If the epoll instances could not be created
+     * \pre \p nThreads must be bigger than 0
+     */
+    explicit SocketReactor(int nThreads = 1);
+
+    /**
+     * Stops all event loops and waits for their threads to finish. All sockets should
+     * be unregistered before the SocketReactor is destroyed.
+     */
+    ~SocketReactor();
+
+    /**
+     * Returns the SocketReactor that is shared by all TcpSocket%s and TcpSocketServer%s.
+     * It is created on first use with a small number of threads and is never destroyed,
+     * so it remains usable while static objects are destroyed at the end of the program.
+     *
+     * \return The shared SocketReactor
+     */
+    static SocketReactor& ref();
+
+    /**
+     * Starts monitoring the \p socket for the provided \p events. The \p socket should be
+     * in non-blocking mode, as the \p callback must not block.
+     *
+     * \param socket The socket that is monitored
+     * \param events A bitmask of Event%s that the socket is interested in
+     * \param callback The function that is called whenever one of the \p events occurs
+     * \return The identifier of the registration that is used in #setEvents and
+     *         #unregisterSocket
+     * \throw RuntimeError If the socket could not be added to the event loop
+     * \pre \p socket must not be INVALID_SOCKET
+     * \pre \p callback must not be empty
+     */
+    uint64_t registerSocket(_SOCKET socket, int events, Callback callback);
+
+    /**
+     * Changes the Event%s that the socket with the identifier \p id is interested in. If
+     * \p events is Event::None, the socket does not receive any events, including the
+     * Event::Closed, until this function is called again. Calling this function with an
+     * identifier that has already been unregistered does nothing. This function can be
+     * called from any thread, including from the socket's callback.
+     *
+     * \param id The identifier that was returned by #registerSocket
+     * \param events A bitmask of Event%s that the socket is interested in
+     */
+    void setEvents(uint64_t id, int events);
+
+    /**
+     * Adds the \p events to the Event%s that the socket with the identifier \p id is
+     * interested in, without changing the other Event%s. This makes it possible for
+     * different threads to control different Event%s of the same socket. Otherwise, this
+     * function behaves like #setEvents.
+     *
+     * \param id The identifier that was returned by #registerSocket
+     * \param events A bitmask of Event%s that are added
+     */
+    void addEvents(uint64_t id, int events);
+
+    /**
+     * Removes the \p events from the Event%s that the socket with the identifier \p id is
+     * interested in, without changing the other Event%s. Otherwise, this function behaves
+     * like #setEvents.
+     *
+     * \param id The identifier that was returned by #registerSocket
+     * \param events A bitmask of Event%s that are removed
+     */
+    void removeEvents(uint64_t id, int events);
+
+    /**
+     * Stops monitoring the socket with the identifier \p id. After this function returns,
+     * the socket's callback is not called anymore. This function also waits for a
+     * running callback to finish, which makes it safe to close the socket and to destroy
+     * the objects that are used by the callback. It does not wait if it is called from
+     * the socket's own callback, which may close the socket, but must not access it
+     * afterwards. If the callbacks of two sockets unregister each other at the same
+     * time, the second one does not wait either, as they would otherwise wait for each
+     * other forever. Calling this function with an identifier that has already been
+     * unregistered does nothing.
+     *
+     * \param id The identifier that was returned by #registerSocket
+     */
+    void unregisterSocket(uint64_t id);
+
+    /**
+     * Returns the number of threads that serve the registered sockets.
+     *
+     * \return The number of threads that serve the registered sockets
+     */
+    int nThreads() const;
+
+private:
+    struct Registration {
+        _SOCKET socket;
+        int events;
+        Callback callback;
+
+        // Both are protected by the registrationMutex of the Loop
+        bool isRunning = false;
+        // Set if the socket was unregistered while its callback was running, in which
+        // case the Loop removes the registration once the callback returns
+        bool isUnregistered = false;
+
+        // The registration whose callback the running callback is waiting for in
+        // #unregisterSocket. Protected by a mutex shared by all SocketReactors
+        const Registration* waitingFor = nullptr;
+    };
+
+    struct Loop {
+        int epollHandle = -1;
+        int wakeupHandle = -1;
+        std::thread thread;
+
+        std::mutex registrationMutex;
+        std::unordered_map<uint64_t, std::shared_ptr<Registration>> registrations;
+        // Notified whenever a callback has returned so #unregisterSocket can wait for it
+        std::condition_variable callbackFinished;
+    };
+
+    // Replaces the bits of the \p mask in the socket's events with those in \p events
+    void updateEvents(uint64_t id, int events, int mask);
+    void runLoop(Loop& loop);
+    void stopLoops();
+    Loop& loopFor(uint64_t id);
+
+    // The registration whose callback is running on the current thread
+    static thread_local Registration* _runningRegistration;
+
+    std::vector<std::unique_ptr<Loop>> _loops;
+    std::atomic<uint64_t> _nextId = 1;
+    std::atomic_bool _keepGoing = true;
+};
+
+} // namespace ghoul::io
+
+#endif // __linux__
+
+#endif // __GHOUL___SOCKETREACTOR___H__
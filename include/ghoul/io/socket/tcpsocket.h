@@ -30,14 +30,16 @@
 
 #include <ghoul/io/socket/sockettype.h>
 #include <ghoul/misc/exception.h>
+#include <ghoul/misc/ringbuffer.h>
 #include <array>
 #include <atomic>
 #include <condition_variable>
-#include <deque>
 #include <mutex>
+#include <string_view>
 #include <thread>
 #include <unordered_map>
 #include <functional>
+#include <vector>
 
 struct addrinfo;
 
@@ -53,8 +55,37 @@ public:
         explicit TcpSocketError(std::string msg, std::string comp = "");
     };
 
-    TcpSocket(std::string address, int port);
-    TcpSocket(std::string address, int port, _SOCKET socket);
+    /**
+     * The capacity of the input and output queues in bytes. This is a separate type, as
+     * a plain integer could not be told apart from a socket handle.
+     */
+    struct QueueCapacity {
+        size_t bytes;
+    };
+    static constexpr const QueueCapacity DefaultQueueCapacity = { 64 * 1024 };
+
+    /**
+     * Creates a TcpSocket that connects to the \p address and \p port in #connect.
+     *
+     * \param address The address of the remote host
+     * \param port The port of the remote host
+     * \param queueCapacity The capacity of the input and output queues in bytes. Longer
+     *        messages are still supported, but have to be copied in parts
+     */
+    TcpSocket(std::string address, int port,
+        QueueCapacity queueCapacity = DefaultQueueCapacity);
+
+    /**
+     * Creates a TcpSocket for the already connected \p socket.
+     *
+     * \param address The address of the remote host
+     * \param port The port of the remote host
+     * \param socket The connected socket, whose ownership is taken over
+     * \param queueCapacity The capacity of the input and output queues in bytes. Longer
+     *        messages are still supported, but have to be copied in parts
+     */
+    TcpSocket(std::string address, int port, _SOCKET socket,
+        QueueCapacity queueCapacity = DefaultQueueCapacity);
     virtual ~TcpSocket();
     void connect();
     void startStreams() override;
@@ -67,12 +98,36 @@ public:
 
     bool getMessage(std::string& message) override;
     bool putMessage(const std::string& message) override;
+
+    /**
+     * Waits for the next message and provides a view of it without copying it out of
+     * the input queue. The \p message remains valid until the next message or bytes are
+     * read from this TcpSocket, as only then the bytes are removed from the queue.
+     *
+     * \param message The view that is set to the received message
+     * \return \c true if a message was received, \c false if the socket disconnected
+     */
+    bool getMessage(std::string_view& message);
     void setDelimiter(char delimiter);
 
     static void initializeNetworkApi();
     static bool initializedNetworkApi();
 
+    /**
+     * Passes all bytes that are received from now on to the \p interceptor instead of
+     * adding them to the input queue. On Linux, the \p interceptor is called on the
+     * thread of the shared SocketReactor that serves this socket. As that thread also
+     * serves many other sockets, a slow \p interceptor delays all of them, so any
+     * expensive processing should be handed off to another thread.
+     *
+     * \param interceptor The function that is called with each block of received bytes
+     */
     void interceptInput(InputInterceptor interceptor);
+
+    /**
+     * Stops passing the received bytes to the interceptor set in #interceptInput, so that
+     * they are added to the input queue again.
+     */
     void uninterceptInput();
 
     /**
@@ -102,7 +157,7 @@ private:
     * Read size bytes from the socket, store them in buffer.
     * Do NOT dequeue them from input.
     * Block until size bytes have been read.
-    * Return false if this fails. Use error() to get the socket error code.
+    * Return false if this fails or if size is bigger than the input queue.
     */
     bool peekBytes(char* buffer, size_t nItems);
 
@@ -121,11 +176,29 @@ private:
 
     void closeSocket();
     void establishConnection(addrinfo* info);
+#ifdef __linux__
+    // Called by the SocketReactor whenever the socket becomes readable or writable
+    void handleEvents(int events);
+    bool receiveInput();
+    bool sendOutput();
+    void registerWithReactor(int events);
+    void unregisterFromReactor();
+    void requestWritable();
+#else // ^^^^ __linux__ // !__linux__ vvvv
     void streamInput();
     void streamOutput();
-    int waitForDelimiter();
-    void waitForInput(size_t nBytes);
     void waitForOutput(size_t nBytes);
+#endif // __linux__
+    // The consumer side of the input queue; requires the _inputQueueMutex to be held
+    bool nextMessage(std::string_view& message);
+    void releaseMessage();
+    bool waitForInput(size_t nBytes);
+    void resumeInput();
+    // The producer side of the input queue
+    void notifyInput();
+
+    bool hasPendingOutput() const;
+    bool moveOutputOverflow();
 
     const std::string _address;
     const int _port;
@@ -135,20 +208,41 @@ private:
     std::atomic<bool> _shouldCloseSocket = false;
 
     _SOCKET _socket;
+#ifdef __linux__
+    // On Linux all sockets are served by the shared SocketReactor instead of threads
+    std::atomic<uint64_t> _reactorId = 0;
+    std::atomic_bool _isWaitingForWritable = false;
+#else // ^^^^ __linux__ // !__linux__ vvvv
     std::thread _inputThread;
     std::thread _outputThread;
+    std::atomic_int _nWaitingForOutput = 0;
+#endif // __linux__
 
+    // The I/O thread is the only producer of the input queue and the threads reading
+    // from the socket are serialized by the _inputQueueMutex, which the I/O thread never
+    // takes. The _inputBufferMutex is only used to wait for the I/O thread
     std::mutex _inputBufferMutex;
     std::mutex _inputQueueMutex;
     std::condition_variable _inputNotifier;
-    std::deque<char> _inputQueue;
+    std::atomic_int _nWaitingForInput = 0;
+    std::atomic_bool _isInputPaused = false;
+    RingBuffer _inputQueue;
+    // The number of bytes of the last message view that are still in the input queue
+    size_t _nMessageBytes = 0;
+    // Messages that wrap around the end of the input queue or don't fit into it at all
+    std::string _messageBuffer;
     std::array<char, 4096> _inputBuffer = { 0 };
 
+    // The threads writing to the socket are serialized by the _outputQueueMutex and the
+    // I/O thread is the only consumer. Bytes that don't fit into the output queue are
+    // stored in the overflow, which is the only time the I/O thread takes the mutex
     std::mutex _outputBufferMutex;
     std::mutex _outputQueueMutex;
     std::condition_variable _outputNotifier;
-    std::deque<char> _outputQueue;
-    std::array<char, 4096> _outputBuffer = { 0 };
+    RingBuffer _outputQueue;
+    std::vector<char> _outputOverflow;
+    size_t _outputOverflowOffset = 0;
+    std::atomic_bool _hasOutputOverflow = false;
 
     std::atomic<char> _delimiter;
 
@@ -36,6 +36,8 @@
 #include <mutex>
 #include <thread>
 
+struct sockaddr_in;
+
 namespace ghoul::io {
 
 class TcpSocket;
@@ -58,7 +60,13 @@ public:
     std::unique_ptr<Socket> awaitPendingSocket() override;
 
 private:
+#ifdef __linux__
+    // Called by the SocketReactor whenever there are connections waiting to be accepted
+    void acceptConnections();
+#else // ^^^^ __linux__ // !__linux__ vvvv
     void waitForConnections();
+#endif // __linux__
+    void addPendingConnection(_SOCKET socketHandle, const sockaddr_in& clientInfo);
 
     mutable std::mutex _settingsMutex;
     int _port = 0;
@@ -70,7 +78,11 @@ private:
     std::mutex _connectionNotificationMutex;
     std::condition_variable _connectionNotifier;
 
+#ifdef __linux__
+    uint64_t _reactorId = 0;
+#else // ^^^^ __linux__ // !__linux__ vvvv
     std::unique_ptr<std::thread> _serverThread;
+#endif // __linux__
     _SOCKET _serverSocket = _SOCKET(0);
 };
 
@@ -31,6 +31,7 @@
 #include <string>
 #include <vector>
 
+namespace ghoul::filesystem { class MappedFile; }
 namespace ghoul::opengl { class Texture; }
 
 namespace ghoul::io {
@@ -98,6 +99,24 @@ public:
     std::unique_ptr<opengl::Texture> loadTexture(void* memory, size_t size,
         const std::string& format = "");
 
+    /**
+     * Loads a Texture from the memory-mapped \p file. The mapped contents are passed to
+     * the actual implementation of the texture reader without copying them. The
+     * TextureReaderBase is chosen based on the \p format or, if it is empty, by the
+     * extension of the mapped file.
+     *
+     * \param file The mapped file that contains the bytes of the Texture to be loaded
+     * \param format The format of the image in the \p file, which is used in the same
+     *        way as the file extension for the #loadTexture method. If it is empty, the
+     *        extension of the \p file is used instead
+     *
+     * \throw TextureLoadException If there was an error reading the \p file
+     * \throw MissingReaderException If there was no reader for the format of the \p file
+     * \pre \p file must not be empty
+     */
+    std::unique_ptr<opengl::Texture> loadTexture(const filesystem::MappedFile& file,
+        const std::string& format = "");
+
     /**
      * Returns a list of all the extensions that are supported by registered readers. If
      * a file with an extension included in this list is passed to the loadTexture file
@@ -28,8 +28,11 @@
 
 #include <ghoul/misc/exception.h>
 
+#include <atomic>
 #include <functional>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace ghoul::logging {
 
@@ -38,13 +41,24 @@ namespace ghoul::logging {
  * automatically reserves a part of the block for use as a header in which the version,
  * possible attributes and the amount of stored data is located. The version is always
  * located in the first byte of the buffer and determines the size and the structure of
- * the rest of the header. Each log entry stores an 8 byte timestamp followed by a
- * <code>\0</code> terminated ASCII char array containing the message. Each logging will
- * test if there is enough memory left in the buffer. For memory exhaustion management, a
- * custom callback can be specified (#setCallback) that will have to reset the buffer
- * (#resetBuffer) or a warning will be logged. The buffer can be written to disk
- * (#writeToDisk), or access directly (#buffer). Most of the methods are thread-safe and
- * are marked as such.
+ * the rest of the header. Each logging will test if there is enough memory left in the
+ * buffer. For memory exhaustion management, a custom callback can be specified
+ * (#setCallback) that will have to reset the buffer (#resetBuffer) or a warning will be
+ * logged. The buffer can be written to disk (#writeToDisk), or access directly
+ * (#buffer). Most of the methods are thread-safe and are marked as such.
+ *
+ * In version 1 of the layout, each log entry stores an 8 byte timestamp followed by a
+ * <code>\0</code> terminated ASCII char array containing the message and all writers
+ * were serialized by a spin lock in the header. Version 2, which is the layout that is
+ * written by this class, allows multiple producers to write concurrently. Each producer
+ * reserves space for its record with a single atomic addition on the first empty byte
+ * and then commits the record by writing a ready flag into the record's header. The
+ * record header consists of a 4 byte commit word and a 4 byte record size, followed by
+ * the 8 byte timestamp and the <code>\0</code> terminated message, padded to a multiple
+ * of 8 bytes. A record is only valid if its commit word is equal to the generation
+ * stored in the buffer header plus one; the generation is increased every time the
+ * buffer is reset, which invalidates stale records from previous uses. A reader (for
+ * example in a different process) can decode either version using #entries.
  */
 class BufferLog {
 public:
@@ -66,10 +80,18 @@ public:
      * reset the buffer (#resetBuffer) or supply a new buffer that will be used instead
      * (#setBuffer). The passed parameters are the BufferLog that is exhausted and the
      * timestamp that will be used in the message after the callback has been resolved.
+     * The callback must not throw; an exception that escapes the callback terminates the
+     * application.
      */
     using MemoryExhaustedCallback =
         std::function<void(BufferLog&, unsigned long long int&)>;
 
+    /// A single decoded entry of a BufferLog, as returned by the #entries function
+    struct Entry {
+        unsigned long long timestamp;
+        std::string message;
+    };
+
     /**
      * Constructor that registers a MemoryExhausedCallback that will be used. The
      * constructor will take a small piece of the provided buffer to store a necessary
@@ -119,9 +141,11 @@ public:
     /**
      * Logs a \p message with a particular \p timestamp. The unit of the timestamp is
      * undefined and depends on the specific use case. The \p timestamp and the \p message
-     * will be copied into the buffer. This method will acquire a lock before calling the
-     * callback function (if provided). Calling this function from the callback results in
-     * undefined behavior. This method is thread-safe.
+     * will be copied into the buffer. Concurrent calls to this method do not block each
+     * other unless the buffer is exhausted, in which case exactly one caller waits for
+     * the pending writes to finish and calls the callback function (if provided) while
+     * all other callers wait for it to return. Calling this function from the callback
+     * results in undefined behavior. This method is thread-safe.
      *
      * \param timestamp The timestamp of the message
      * \param message The message to store in the buffer
@@ -195,18 +219,49 @@ public:
      */
     void writeToDisk(const std::string& filename);
 
+    /**
+     * Decodes all committed entries that are stored in the provided \p buffer, which has
+     * to be the contents of a BufferLog, for example obtained through #buffer or read
+     * from a file created by #writeToDisk. Both version 1 and version 2 layouts are
+     * supported. Records that have been reserved but not committed yet terminate the
+     * list of returned entries.
+     *
+     * \param buffer The contents of a BufferLog that should be decoded
+     * \param bufferSize The number of valid bytes in the \p buffer
+     * \return The list of entries stored in the \p buffer in the order they were stored
+     *
+     * \throw RuntimeError If the version of the buffer is not supported
+     * \pre \p buffer must not be <code>nullptr</code>
+     */
+    static std::vector<Entry> entries(const void* buffer, size_t bufferSize);
+
 protected:
     /**
-     * This method will initialize the individual members of the header fields and make
-     * the buffer usable.
+     * This method will initialize the individual members of the header fields of the
+     * \p buffer and make the buffer usable.
      */
-    void initializeBuffer();
+    static void initializeBuffer(void* buffer, size_t bufferSize);
+
+    /**
+     * Waits until no other thread is writing to the buffer and prevents new writers
+     * from entering until #releaseExclusiveAccess is called. If the calling thread is
+     * currently executing the MemoryExhaustedCallback, it already owns the buffer and
+     * this function returns immediately.
+     *
+     * \return The buffer for which the access was acquired by this call and which has to
+     *         be passed to #releaseExclusiveAccess, or <code>nullptr</code> if the
+     *         access was already owned
+     */
+    void* acquireExclusiveAccess();
+
+    /// Releases the exclusive access acquired by #acquireExclusiveAccess for \p buffer
+    static void releaseExclusiveAccess(void* buffer);
 
     /**
      * This block of memory will store all log messages that are added to this BufferLog
      * it has to be as big as the value provided in <code>_totalSize</code>
      */
-    void* _buffer;
+    std::atomic<void*> _buffer;
     size_t _totalSize; ///< The total size of the buffer used by this BufferLog
 
     /**
@@ -217,11 +272,12 @@ protected:
      */
     MemoryExhaustedCallback _callback;
 
-    /** This variable is <code>true</code> if this BufferLog has had its callback trigged
-     * in the current callstack. It forces some methods to ignore the
-     * <code>atomic_lock</code> to ensure that no deadlock can happen.
+    /**
+     * The id of the thread which is currently executing the callback. It forces some
+     * methods called from within the callback to skip acquiring the exclusive access to
+     * ensure that no deadlock can happen.
      */
-    bool _inCallbackStack = false;
+    std::atomic<std::thread::id> _callbackThread = std::thread::id();
 };
 
 } // namespace ghoul::logging
@@ -29,15 +29,55 @@
 #include <ghoul/logging/loglevel.h>
 #include <ghoul/misc/boolean.h>
 #include <array>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <set>
+#include <shared_mutex>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace ghoul::logging {
 
 class Log;
 
+/**
+ * A LogCallSite stores the state that the LogManager keeps for each location in the code
+ * that logs messages. It remembers the interned index of the category that was last used
+ * at the call site, so that the level check for that category does not need to look up
+ * the category name again, and it contains the state for rate limiting the call site.
+ * The logging macros create one static instance per call site; it is not meant to be
+ * used directly otherwise.
+ */
+struct LogCallSite {
+    /// The file and line of the call site, used when reporting suppressed messages
+    const char* file = nullptr;
+    int line = 0;
+
+    /// The interned index of the category that was last logged from this call site
+    std::atomic<int> index = -1;
+
+    /// The interned alias of the category that was last logged from this call site if
+    /// the category was passed as a character pointer
+    std::atomic<int> alias = -1;
+
+    /// The earliest time (in ns) at which the next message is allowed without a burst
+    std::atomic<int64_t> nextAllowed = 0;
+
+    /// The number of messages that were suppressed since the last one was logged
+    std::atomic<uint32_t> nSuppressed = 0;
+
+    /// The level of the last suppressed message
+    std::atomic<LogLevel> suppressedLevel = LogLevel::NoLogging;
+
+    /// The LogManager that will report the suppressed messages if no message follows
+    std::atomic<const void*> owner = nullptr;
+};
+
 /**
  * The central singleton class that is responsible for handling Log%s and logging methods.
  * This singleton class provides methods to add new Log%s, remove Log%s, and relay
@@ -53,18 +93,49 @@ class Log;
  * LogLevel::Info, LogLevel::Warning, LogLevel::Error,
  * LogLevel::Fatal.
  * If a LogManager was created with a LogLevel x, all messages with
- * LogLevel y <= x will be passed to Log handler.
+ * LogLevel y <= x will be passed to Log handler. The level can be overwritten for
+ * individual categories (#setCategoryLogLevel), which makes it possible to, for example,
+ * enable tracing for a single category without enabling it for all others. Each category
+ * is interned into a fixed-size table the first time it is used, so that checking a
+ * category's level only requires a single array access. Categories that are passed to
+ * the logging macros as character pointers, such as <code>_loggerCat</code>, are
+ * additionally interned by their address, so a call site only compares the address
+ * rather than the name. These strings must therefore not change while the LogManager is
+ * in use.
+ *
+ * To prevent a single repeating error from flooding all Log%s, the messages that are
+ * logged through the logging macros can be rate limited, both for each call site
+ * (#setCallSiteRateLimit) and for each category (#setCategoryRateLimit). Rate limits are
+ * implemented as token buckets that allow a number of messages per second with an
+ * additional burst. Messages that exceed the limit are dropped without being formatted
+ * and are only counted; the next message from the same call site that is logged
+ * afterwards carries the suffix "(repeated N times)". Counts for which no message
+ * followed are reported with the next message that is checked against the rate limits
+ * once the call site could log again, when the Log%s are flushed (#flushLogs), and when
+ * the LogManager is destroyed.
  *
  * Macros are defined to make logging messages easier. These macros are: #LDEBUG,
  * #LDEBUGC, #LINFO, #LINFOC, #LWARNING, #LWARNINGC, #LERROR, #LERRORC, #LFATAL, #LFATALC.
  * The *C versions of the macros requires the category and the message as a parameter. The
  * versions without the C require an <code>std::string</code> variable named
- * <code>_loggerCat</code> to be defined in the scope of the macro "call".
+ * <code>_loggerCat</code> to be defined in the scope of the macro "call". The macros
+ * check whether the message would be accepted before the message expression is
+ * evaluated, so filtered messages do not incur the cost of formatting. As they expand to
+ * statements, the macros cannot be used as expressions. Each *C macro has a function of
+ * the same name that can be used instead where an expression or a function is needed,
+ * for example <code>(LINFOC)(category, message)</code> or <code>&LINFOC</code>; these
+ * functions always evaluate the message and do not support call site rate limits.
  */
 class LogManager {
 public:
     BooleanType(ImmediateFlush);
 
+    /// The maximum number of categories that can be interned by the LogManager
+    static constexpr const int MaxCategories = 1024;
+
+    /// The maximum number of category strings that can be interned by their address
+    static constexpr const int MaxCategoryAliases = 4 * MaxCategories;
+
     static void initialize(LogLevel level = LogLevel::Info,
         ImmediateFlush immediateFlush = ImmediateFlush::No);
     static void deinitialize();
@@ -122,6 +193,124 @@ public:
      */
     LogLevel logLevel() const;
 
+    /**
+     * Overwrites the LogLevel for all messages of the provided \p category. Messages of
+     * this category will be passed to the Log%s if they have a level >= \p level,
+     * regardless of the LogLevel that this LogManager was created with. The level of
+     * each Log is still respected. This method is thread-safe.
+     *
+     * \param category The category whose level should be overwritten
+     * \param level The new LogLevel for the \p category
+     *
+     * \throw RuntimeError If the maximum number of categories has been exceeded
+     */
+    void setCategoryLogLevel(std::string_view category, LogLevel level);
+
+    /**
+     * Removes a LogLevel override that was previously set for the \p category using
+     * #setCategoryLogLevel. Afterwards, the messages of the category are filtered using
+     * the LogLevel of this LogManager again. Removing a non-existing override has no
+     * effect. This method is thread-safe.
+     *
+     * \param category The category whose level override should be removed
+     */
+    void removeCategoryLogLevel(std::string_view category);
+
+    /**
+     * Returns the LogLevel that is used to filter the messages of the \p category. This
+     * is either the level that was set through #setCategoryLogLevel or the LogLevel this
+     * LogManager has been initialized with.
+     *
+     * \param category The category for which to return the level
+     * \return The LogLevel that is used to filter messages of the \p category
+     */
+    LogLevel categoryLogLevel(std::string_view category);
+
+    /**
+     * Limits the number of messages that are logged from each call site. Each call site
+     * can log \p messagesPerSecond messages per second on average and up to \p burst
+     * messages in quick succession. This method is thread-safe.
+     *
+     * \param messagesPerSecond The average number of messages per second per call site
+     * \param burst The number of messages that can be logged in quick succession
+     *
+     * \pre \p messagesPerSecond must be positive
+     * \pre \p burst must be positive
+     */
+    void setCallSiteRateLimit(double messagesPerSecond, int burst = 1);
+
+    /**
+     * Removes the limit set by #setCallSiteRateLimit. This method is thread-safe.
+     */
+    void removeCallSiteRateLimit();
+
+    /**
+     * Limits the number of messages that are logged for the \p category across all call
+     * sites. The \p category can log \p messagesPerSecond messages per second on average
+     * and up to \p burst messages in quick succession. This method is thread-safe.
+     *
+     * \param category The category that should be limited
+     * \param messagesPerSecond The average number of messages per second
+     * \param burst The number of messages that can be logged in quick succession
+     *
+     * \throw RuntimeError If the maximum number of categories has been exceeded
+     * \pre \p messagesPerSecond must be positive
+     * \pre \p burst must be positive
+     */
+    void setCategoryRateLimit(std::string_view category, double messagesPerSecond,
+        int burst = 1);
+
+    /**
+     * Removes a limit that was previously set for the \p category using
+     * #setCategoryRateLimit. Removing a non-existing limit has no effect. This method is
+     * thread-safe.
+     *
+     * \param category The category whose rate limit should be removed
+     */
+    void removeCategoryRateLimit(std::string_view category);
+
+    /**
+     * Returns whether a message with the provided \p level and \p category would be
+     * passed on to the Log%s from the call \p site. The \p site is used to store the
+     * interned index of the \p category so that subsequent calls with the same
+     * category only require a single array access. If the message is accepted, it
+     * counts against the rate limits of the call site and category; if a rate limit is
+     * exceeded, the message is counted as suppressed in the \p site. This method is
+     * thread-safe.
+     *
+     * \param level The level of the message that would be logged
+     * \param category The category of the message that would be logged
+     * \param site The call site from which the message is logged
+     * \return <code>true</code> if the message should be logged
+     */
+    bool isEnabled(LogLevel level, std::string_view category, LogCallSite& site);
+
+    /**
+     * Returns whether a message with the provided \p level and \p category would be
+     * passed on to the Log%s from the call \p site. The \p category has to point to a
+     * string that does not change, such as a string literal, as the category is only
+     * compared by its address after it was seen at the call site for the first time.
+     * Otherwise, this method behaves like the overload that takes an
+     * <code>std::string_view</code>. This method is thread-safe.
+     *
+     * \param level The level of the message that would be logged
+     * \param category The category of the message that would be logged
+     * \param site The call site from which the message is logged
+     * \return <code>true</code> if the message should be logged
+     */
+    bool isEnabled(LogLevel level, const char* category, LogCallSite& site);
+
+    /**
+     * Returns whether a message with the provided \p level and \p category would be
+     * passed on to the Log%s. Rate limits are not considered by this method. This
+     * method is thread-safe.
+     *
+     * \param level The level of the message that would be logged
+     * \param category The category of the message that would be logged
+     * \return <code>true</code> if the message would be logged
+     */
+    bool isEnabled(LogLevel level, std::string_view category);
+
     /**
      * Returns the message counter status for the passed LogLevel \p level.
      *
@@ -159,7 +348,67 @@ public:
      */
     void flushLogs();
 
+    /// Reports the messages that are still suppressed and flushes all Log%s
+    ~LogManager();
+
 private:
+    /**
+     * Returns the interned index for the \p category, adding it to the table of
+     * categories if it has not been seen before. Returns -1 if the category was not
+     * interned already and the table is full.
+     */
+    int categoryIndex(std::string_view category);
+
+    /**
+     * Returns the alias for the address of the \p category string, adding it to the
+     * table of aliases if it has not been seen before. Returns -1 if the address was not
+     * interned already and either table is full.
+     */
+    int aliasIndex(const char* category);
+
+    /**
+     * Returns whether a message with the \p level would be passed on for the category
+     * with the interned \p index and consumes the rate limits if \p hasRateLimits is
+     * <code>true</code>.
+     */
+    bool isEnabledForIndex(LogLevel level, int index, bool hasRateLimits,
+        LogCallSite& site);
+
+    /// Recomputes the #_minimumLevel from the current category overrides
+    void updateMinimumLevel();
+
+    /// Updates the number of active rate limits
+    void updateRateLimitCount();
+
+    /**
+     * Passes the \p message to all Log%s without checking the LogLevel of the
+     * \p category, which has to be done by the caller beforehand.
+     */
+    void dispatchMessage(LogLevel level, const std::string& category,
+        const std::string& message);
+
+    friend void logFromCallSite(LogLevel level, const std::string& category,
+        const std::string& message, LogCallSite& site);
+
+    /**
+     * Consumes a token from the call \p site's and the category's rate limit. Returns
+     * <code>false</code> and increases the suppression counter of the \p site if either
+     * limit is exceeded.
+     */
+    bool consumeRateLimits(LogLevel level, int categoryIndex, LogCallSite& site);
+
+    /**
+     * Logs the number of messages that were suppressed at each call site without
+     * another message being logged from that call site afterwards. Only the call sites
+     * whose rate limits would allow a message at the time \p now (in ns) are reported,
+     * the others are reported once their limits allow a message again.
+     */
+    void reportSuppressedMessages(int64_t now = std::numeric_limits<int64_t>::max());
+
+    /// Returns the time (in ns) at which the rate limits allow the next message from the
+    /// call \p site
+    int64_t suppressionEnd(const LogCallSite& site) const;
+
     static LogManager* _instance;
 
     /// The mutex that is protecting the #logMessage calls
@@ -176,7 +425,93 @@ private:
 
     /// Stores the number of messages for each log level (7)
     std::array<int, 7> _logCounters = { 0, 0, 0, 0, 0, 0, 0 };
+
+    /// Protects the interning of new categories and the changes of category levels
+    std::shared_mutex _categoryMutex;
+
+    /// Maps from the category names to their index in the category tables
+    std::map<std::string, int, std::less<>> _categoryIndices;
+
+    /// The effective level for each interned category
+    std::array<std::atomic<LogLevel>, MaxCategories> _categoryLevels;
+
+    /// The name for each interned category; entries are never changed once written
+    std::array<std::string, MaxCategories> _categoryNames;
+
+    /// The number of categories that have been interned so far
+    std::atomic<int> _nCategories = 0;
+
+    /// Maps from the addresses of category strings to their alias index
+    std::map<const char*, int> _aliasIndices;
+
+    /// The address of the category string for each alias; entries are never changed
+    /// once written
+    std::array<const char*, MaxCategoryAliases> _aliasNames;
+
+    /// The interned category index of each alias
+    std::array<int, MaxCategoryAliases> _aliasCategories;
+
+    /// The number of aliases that have been interned so far
+    std::atomic<int> _nAliases = 0;
+
+    /// The levels that have been set explicitly through #setCategoryLogLevel
+    std::map<int, LogLevel> _categoryOverrides;
+
+    /// The number of entries in #_categoryOverrides
+    std::atomic<int> _nCategoryOverrides = 0;
+
+    /// The lowest level of any category and this LogManager's level
+    std::atomic<LogLevel> _minimumLevel;
+
+    /**
+     * The interval (in ns) between two messages for each interned category, or 0 if the
+     * category is not rate limited
+     */
+    std::array<std::atomic<int64_t>, MaxCategories> _categoryRateIntervals;
+
+    /// The additional time (in ns) that each category can borrow for bursts
+    std::array<std::atomic<int64_t>, MaxCategories> _categoryRateTolerances;
+
+    /// The earliest time (in ns) at which the next message of each category is allowed
+    std::array<std::atomic<int64_t>, MaxCategories> _categoryNextAllowed;
+
+    /// The indices of all categories that have a rate limit
+    std::set<int> _rateLimitedCategories;
+
+    /// The interval (in ns) between two messages of a call site, or 0 if not limited
+    std::atomic<int64_t> _callSiteRateInterval = 0;
+
+    /// The additional time (in ns) that each call site can borrow for bursts
+    std::atomic<int64_t> _callSiteRateTolerance = 0;
+
+    /// The number of rate limits (per category or per call site) that are active
+    std::atomic<int> _nRateLimits = 0;
+
+    /// Protects the #_suppressingSites
+    std::mutex _suppressingSitesMutex;
+
+    /// All call sites that had messages suppressed since they were last reported
+    std::vector<LogCallSite*> _suppressingSites;
+
+    /// The earliest time (in ns) at which one of the #_suppressingSites can be reported
+    std::atomic<int64_t> _nextSuppressionReport = std::numeric_limits<int64_t>::max();
 };
+
+/**
+ * Returns whether a message of the provided \p level and \p category would be logged.
+ * If no LogManager has been initialized, this function always returns
+ * <code>true</code> as the message will be printed to the console instead.
+ */
+inline bool isLogEnabled(LogLevel level, std::string_view category, LogCallSite& site);
+inline bool isLogEnabled(LogLevel level, const char* category, LogCallSite& site);
+
+/**
+ * Logs the \p message that passed #isLogEnabled for the call \p site. If messages of the
+ * call site have been suppressed by a rate limit since the last message, the number of
+ * suppressed messages is appended to the \p message.
+ */
+inline void logFromCallSite(LogLevel level, const std::string& category,
+    const std::string& message, LogCallSite& site);
 } // namespace ghoul::logging
 
 #define LogMgr (ghoul::logging::LogManager::ref())
@@ -184,23 +519,48 @@ private:
 inline void log(ghoul::logging::LogLevel level, const std::string& category,
     const std::string& message);
 
+// The message is only evaluated if the category, level, and rate limits would lead to it
+// being logged
+#define GHOUL_LOG_CATEGORY(__level__, __cat__, __msg__)                                  \
+    do {                                                                                \
+        static ghoul::logging::LogCallSite __ghoulLogSite = { __FILE__, __LINE__ };     \
+        const auto& __ghoulLogCat = (__cat__);                                          \
+        if (ghoul::logging::isLogEnabled(__level__, __ghoulLogCat, __ghoulLogSite)) {   \
+            ghoul::logging::logFromCallSite(                                            \
+                __level__, __ghoulLogCat, (__msg__), __ghoulLogSite                     \
+            );                                                                          \
+        }                                                                               \
+    } while (false)
+
 #define LTRACE(__msg__) LTRACEC(_loggerCat, __msg__)
-inline void LTRACEC(const std::string& category, const std::string& message);
+inline void (LTRACEC)(const std::string& category, const std::string& message);
+#define LTRACEC(__cat__, __msg__)                                                        \
+    GHOUL_LOG_CATEGORY(ghoul::logging::LogLevel::Trace, __cat__, __msg__)
 
 #define LDEBUG(__msg__) LDEBUGC(_loggerCat, __msg__)
-inline void LDEBUGC(const std::string& category, const std::string& message);
+inline void (LDEBUGC)(const std::string& category, const std::string& message);
+#define LDEBUGC(__cat__, __msg__)                                                        \
+    GHOUL_LOG_CATEGORY(ghoul::logging::LogLevel::Debug, __cat__, __msg__)
 
 #define LINFO(__msg__) LINFOC(_loggerCat, __msg__)
-inline void LINFOC(const std::string& category, const std::string& message);
+inline void (LINFOC)(const std::string& category, const std::string& message);
+#define LINFOC(__cat__, __msg__)                                                         \
+    GHOUL_LOG_CATEGORY(ghoul::logging::LogLevel::Info, __cat__, __msg__)
 
 #define LWARNING(__msg__) LWARNINGC(_loggerCat, __msg__)
-inline void LWARNINGC(const std::string& category, const std::string& message);
+inline void (LWARNINGC)(const std::string& category, const std::string& message);
+#define LWARNINGC(__cat__, __msg__)                                                      \
+    GHOUL_LOG_CATEGORY(ghoul::logging::LogLevel::Warning, __cat__, __msg__)
 
 #define LERROR(__msg__) LERRORC(_loggerCat, __msg__)
-inline void LERRORC(const std::string& category, const std::string& message);
+inline void (LERRORC)(const std::string& category, const std::string& message);
+#define LERRORC(__cat__, __msg__)                                                        \
+    GHOUL_LOG_CATEGORY(ghoul::logging::LogLevel::Error, __cat__, __msg__)
 
 #define LFATAL(__msg__) LFATALC(_loggerCat, __msg__)
-inline void LFATALC(const std::string& category, const std::string& message);
+inline void (LFATALC)(const std::string& category, const std::string& message);
+#define LFATALC(__cat__, __msg__)                                                        \
+    GHOUL_LOG_CATEGORY(ghoul::logging::LogLevel::Fatal, __cat__, __msg__)
 
 #include "logmanager.inl"
 
@@ -26,6 +26,83 @@
 #include <iostream>
 #include <sstream>
 
+namespace ghoul::logging {
+
+inline bool LogManager::isEnabled(LogLevel level, std::string_view category,
+                                  LogCallSite& site)
+{
+    if (level < _minimumLevel.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    const bool hasRateLimits = _nRateLimits.load(std::memory_order_relaxed) > 0;
+    if (!hasRateLimits && _nCategoryOverrides.load(std::memory_order_relaxed) == 0) {
+        return level >= _level;
+    }
+
+    int index = site.index.load(std::memory_order_relaxed);
+    if (index < 0 || index >= _nCategories.load(std::memory_order_acquire) ||
+        _categoryNames[index] != category)
+    {
+        index = categoryIndex(category);
+        site.index.store(index, std::memory_order_relaxed);
+    }
+    return isEnabledForIndex(level, index, hasRateLimits, site);
+}
+
+inline bool LogManager::isEnabled(LogLevel level, const char* category,
+                                  LogCallSite& site)
+{
+    if (level < _minimumLevel.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    const bool hasRateLimits = _nRateLimits.load(std::memory_order_relaxed) > 0;
+    if (!hasRateLimits && _nCategoryOverrides.load(std::memory_order_relaxed) == 0) {
+        return level >= _level;
+    }
+
+    // The name of the category is only compared when its address is interned
+    int alias = site.alias.load(std::memory_order_relaxed);
+    if (alias < 0 || alias >= _nAliases.load(std::memory_order_acquire) ||
+        _aliasNames[alias] != category)
+    {
+        alias = aliasIndex(category);
+        site.alias.store(alias, std::memory_order_relaxed);
+        site.index.store(
+            alias < 0 ? categoryIndex(category) : _aliasCategories[alias],
+            std::memory_order_relaxed
+        );
+    }
+    const int index = alias < 0 ? categoryIndex(category) : _aliasCategories[alias];
+    return isEnabledForIndex(level, index, hasRateLimits, site);
+}
+
+inline bool LogManager::isEnabledForIndex(LogLevel level, int index, bool hasRateLimits,
+                                          LogCallSite& site)
+{
+    const LogLevel threshold =
+        index < 0 ? _level : _categoryLevels[index].load(std::memory_order_relaxed);
+    if (level < threshold) {
+        return false;
+    }
+    return hasRateLimits ? consumeRateLimits(level, index, site) : true;
+}
+
+inline bool isLogEnabled(LogLevel level, std::string_view category, LogCallSite& site) {
+    if (!LogManager::isInitialized()) {
+        return true;
+    }
+    return LogMgr.isEnabled(level, category, site);
+}
+
+inline bool isLogEnabled(LogLevel level, const char* category, LogCallSite& site) {
+    if (!LogManager::isInitialized()) {
+        return true;
+    }
+    return LogMgr.isEnabled(level, category, site);
+}
+
+} // namespace ghoul::logging
+
 inline void log(ghoul::logging::LogLevel level, const std::string& category,
                 const std::string& message)
 {
@@ -38,26 +115,57 @@ inline void log(ghoul::logging::LogLevel level, const std::string& category,
     }
 }
 
-inline void LTRACEC(const std::string& category, const std::string& message) {
+inline void (LTRACEC)(const std::string& category, const std::string& message) {
     log(ghoul::logging::LogLevel::Trace, category, message);
 }
 
-inline void LDEBUGC(const std::string& category, const std::string& message) {
+inline void (LDEBUGC)(const std::string& category, const std::string& message) {
     log(ghoul::logging::LogLevel::Debug, category, message);
 }
 
-inline void LINFOC(const std::string& category, const std::string& message) {
+inline void (LINFOC)(const std::string& category, const std::string& message) {
     log(ghoul::logging::LogLevel::Info, category, message);
 }
 
-inline void LWARNINGC(const std::string& category, const std::string& message) {
+inline void (LWARNINGC)(const std::string& category, const std::string& message) {
     log(ghoul::logging::LogLevel::Warning, category, message);
 }
 
-inline void LERRORC(const std::string& category, const std::string& message) {
+inline void (LERRORC)(const std::string& category, const std::string& message) {
     log(ghoul::logging::LogLevel::Error, category, message);
 }
 
-inline void LFATALC(const std::string& category, const std::string& message) {
+inline void (LFATALC)(const std::string& category, const std::string& message) {
     log(ghoul::logging::LogLevel::Fatal, category, message);
 }
+
+namespace ghoul::logging {
+
+inline void logFromCallSite(LogLevel level, const std::string& category,
+                            const std::string& message, LogCallSite& site)
+{
+    if (!LogManager::isInitialized()) {
+        // Without a LogManager, there are no rate limits that could suppress messages
+        ::log(level, category, message);
+        return;
+    }
+
+    // Only pay for the read-modify-write if something was actually suppressed
+    const uint32_t nSuppressed = site.nSuppressed.load(std::memory_order_relaxed) > 0 ?
+        site.nSuppressed.exchange(0, std::memory_order_relaxed) :
+        0;
+
+    // The level was already checked by isLogEnabled using the cached category index
+    if (nSuppressed == 0) {
+        LogMgr.dispatchMessage(level, category, message);
+    }
+    else {
+        LogMgr.dispatchMessage(
+            level,
+            category,
+            message + " (repeated " + std::to_string(nSuppressed) + " times)"
+        );
+    }
+}
+
+} // namespace ghoul::logging
@@ -121,6 +121,10 @@ BooleanType(PopValue);
  * restriction on the script is that it can only contain a pure array-style table (= only
  * indexed by numbers) or a pure dictionary-style table (= no numbering indices).
  *
+ * If the FileSystem has a CacheManager, the compiled bytecode of the script is stored
+ * in it and reused on later loads as long as the contents of the file and the Lua
+ * version are unchanged.
+ *
  * \param filename The filename pointing to the script that is executed.
  * \param dictionary The #ghoul::Dictionary into which the values from the script are
  *        added
@@ -148,6 +152,10 @@ void loadDictionaryFromFile(const std::string& filename, ghoul::Dictionary& dict
  * pure array-style table (= only indexed by numbers) or a pure dictionary-style table
  * (= no numbering indices).
  *
+ * If the FileSystem has a CacheManager, the compiled bytecode of the script is stored
+ * in it and reused on later loads as long as the contents of the file and the Lua
+ * version are unchanged.
+ *
  * \param filename The filename pointing to the script that is executed.
  * \param dictionary The #ghoul::Dictionary into which the values from the script are
  *        added
@@ -338,7 +346,9 @@ void destroyLuaState(lua_State* state);
 
 /**
  * This function executes the Lua script pointed to by \p filename using the passed
- * <code>lua_State</code> \p state.
+ * <code>lua_State</code> \p state. If the FileSystem has a CacheManager, the compiled
+ * bytecode of the script is stored in it and reused on later calls as long as the
+ * contents of the file and the Lua version are unchanged.
  *
  * \param state The Lua state that is used to execute the script
  * \param filename The file path that contains the Lua script that is executed
@@ -0,0 +1,150 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2020                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __GHOUL___LUASTATEPOOL___H__
+#define __GHOUL___LUASTATEPOOL___H__
+
+#include <ghoul/lua/luastate.h>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+struct lua_State;
+
+namespace ghoul::lua {
+
+/**
+ * This class manages a set of LuaState objects that can be borrowed by multiple threads
+ * concurrently, for example by the workers of a ghoul::ThreadPool, to evaluate scripts in
+ * parallel. A state is borrowed through the #acquire function, which returns a Handle
+ * that gives the state back to the pool when it is destroyed. If no idle state is
+ * available, a new state is created, so the number of states grows to the highest
+ * number of concurrent users.
+ *
+ * Each state is initialized once with the optional initializer function, which can be
+ * used to preload an environment, for example by registering functions or running common
+ * scripts. Afterwards, the global variables of the state are recorded as a snapshot. When
+ * a state is returned, its stack is cleared and all global variables that were added,
+ * overwritten, or removed are restored to the snapshot. This is much cheaper than
+ * creating a new state with its standard libraries, but it only covers the global table
+ * itself; changes to the contents of tables, such as <code>string.foo = 1</code>,
+ * persist.
+ *
+ * Example:
+ * \verbatim
+ghoul::lua::LuaStatePool pool;
+std::vector<std::future<ghoul::Dictionary>> results;
+for (const std::string& file : files) {
+    results.push_back(threadPool.queue([&pool, file]() {
+        return ghoul::lua::loadDictionaryFromFile(file, pool.acquire());
+    }));
+}
+\endverbatim
+ */
+class LuaStatePool {
+public:
+    /**
+     * This RAII object provides access to a single LuaState that is borrowed from a
+     * LuaStatePool and gives it back to the pool when it is destroyed.
+     */
+    class Handle {
+    public:
+        Handle(Handle&& other) noexcept;
+        Handle& operator=(Handle&& other) = delete;
+
+        /**
+         * Resets the borrowed state and returns it to the LuaStatePool. If a Lua error
+         * occurs while resetting the state, for example because memory runs out, the
+         * state is destroyed instead.
+         */
+        ~Handle();
+
+        /**
+         * Converts this Handle into the \c lua_State pointer of the borrowed state.
+         *
+         * \return The contained \c lua_State pointer
+         */
+        operator lua_State*() const;
+
+    private:
+        friend class LuaStatePool;
+        Handle(LuaStatePool& pool, LuaState state);
+
+        LuaStatePool* _pool;
+        LuaState _state;
+    };
+
+    /**
+     * Creates a new LuaStatePool that creates \p nStates states up front.
+     *
+     * \param nStates The number of states that are created immediately
+     * \param include If \c Yes, the Lua standard libraries are loaded into each state
+     * \param initializer A function that is called once for each newly created state
+     *        before its global variables are recorded. This function might be called
+     *        concurrently for different states
+     *
+     * \throw LuaRuntimeException If an error occurred while creating a state
+     * \pre \p nStates must be non-negative
+     */
+    explicit LuaStatePool(int nStates = 0,
+        LuaState::IncludeStandardLibrary include = LuaState::IncludeStandardLibrary::Yes,
+        std::function<void(lua_State*)> initializer = nullptr);
+
+    /**
+     * Borrows a state from this pool, creating a new one if all states are in use. This
+     * function is thread-safe. The stack of the returned state is empty.
+     *
+     * \return The Handle to the borrowed state
+     *
+     * \throw LuaRuntimeException If an error occurred while creating a new state
+     * \pre The returned Handle must not outlive the LuaStatePool
+     */
+    Handle acquire();
+
+    /**
+     * Returns the number of states that are currently not borrowed.
+     *
+     * \return The number of idle states
+     */
+    int nIdleStates() const;
+
+private:
+    /// Creates a new state, calls the initializer and records the global variables
+    LuaState createState() const;
+
+    /// Resets the \p state to the recorded global variables and makes it available again,
+    /// or destroys it if the reset fails
+    void release(LuaState state);
+
+    const LuaState::IncludeStandardLibrary _includeStandardLibrary;
+    const std::function<void(lua_State*)> _initializer;
+
+    mutable std::mutex _mutex;
+    std::vector<LuaState> _idleStates;
+};
+
+}  // namespace ghoul::lua
+
+#endif // __GHOUL___LUASTATEPOOL___H__
@@ -32,6 +32,8 @@
 #ifndef __GHOUL___CRC32___H__
 #define __GHOUL___CRC32___H__
 
+#include <cstddef>
+#include <iosfwd>
 #include <string>
 
 namespace ghoul {
@@ -54,6 +56,52 @@ constexpr unsigned int hashCRC32(const char* s);
  */
 constexpr unsigned int hashCRC32(const char* buffer, unsigned int size);
 
+/**
+ * Continues the CRC-32 hash \p crc with the contents of the provided \p buffer of size
+ * \p size. Hashing a buffer in multiple parts this way results in the same value as
+ * hashing it at once, if the first part starts with a \p crc of 0. Contrary to the
+ * <code>constexpr</code> versions, this function uses the fastest implementation that
+ * is available on the CPU, which is folding with the PCLMULQDQ instruction on x86, the
+ * CRC32 instructions on ARMv8, or a slicing-by-8 table lookup otherwise.
+ *
+ * \param crc The hash of the previous parts, or 0 for the first part
+ * \param buffer The buffer whose contents are to be hashed
+ * \param size The size of the buffer
+ * \return The hash value of the previous parts followed by the \p buffer
+ */
+unsigned int updateCRC32(unsigned int crc, const char* buffer, size_t size);
+
+/// The implementations of the CRC-32 hash that #updateCRC32 chooses from
+enum class CRC32Implementation {
+    SlicingBy8 = 0, ///< Table lookup, available everywhere
+    Pclmul,         ///< Folding with the PCLMULQDQ instruction on x86
+    ArmV8           ///< The CRC32 instructions of ARMv8
+};
+
+/**
+ * Returns whether the \p implementation is supported by the compiler and the CPU.
+ *
+ * \param implementation The implementation that is checked
+ * \return \c true if the \p implementation can be passed to #updateCRC32
+ */
+bool hasCRC32Implementation(CRC32Implementation implementation);
+
+/**
+ * Continues the CRC-32 hash \p crc with the contents of the provided \p buffer of size
+ * \p size using the provided \p implementation instead of the fastest available one.
+ * All implementations return the same value.
+ *
+ * \param crc The hash of the previous parts, or 0 for the first part
+ * \param buffer The buffer whose contents are to be hashed
+ * \param size The size of the buffer
+ * \param implementation The implementation that is used
+ * \return The hash value of the previous parts followed by the \p buffer
+ *
+ * \pre \p implementation must be available according to #hasCRC32Implementation
+ */
+unsigned int updateCRC32(unsigned int crc, const char* buffer, size_t size,
+        CRC32Implementation implementation);
+
 /**
  * Computes the CRC-32 hash of the string \p s.
  *
@@ -67,9 +115,22 @@ unsigned int hashCRC32(const std::string& s);
  *
  * \param file The file whose content will be hashed
  * \return The hash value for the contents of the \p file
+ *
+ * \throw ghoul::RuntimeError If the \p file could not be read
  */
 unsigned int hashCRC32File(const std::string& file);
 
+/**
+ * Computes the CRC-32 hash of the remaining contents of the \p stream. The contents are
+ * read and hashed in blocks, so they never have to be in memory at the same time.
+ *
+ * \param stream The stream whose content will be hashed
+ * \return The hash value for the remaining contents of the \p stream
+ *
+ * \throw ghoul::RuntimeError If there was an error reading from the \p stream
+ */
+unsigned int hashCRC32(std::istream& stream);
+
 /**
  * A postfix operator that will convert a string into a crc32 at compile time. This is
  * functionally equivalent to calling #hashCRC32 with the string \p s.
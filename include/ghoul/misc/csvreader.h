@@ -26,11 +26,114 @@
 #ifndef __GHOUL___CSVREADER___H__
 #define __GHOUL___CSVREADER___H__
 
+#include <ghoul/filesystem/mappedfile.h>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <tuple>
 #include <vector>
 
 namespace ghoul {
 
+class ThreadPool;
+
+/**
+ * This class reads the rows of a comma-separated value (CSV) file one at a time. The
+ * format follows RFC 4180 with a configurable delimiter: Rows are separated by
+ * <code>\\n</code> or <code>\\r\\n</code> and cells by the delimiter. Cells can be
+ * enclosed in double quotes, in which case they can contain delimiters, line breaks, and
+ * double quotes that are escaped by doubling them (<code>""</code>). Double quotes in
+ * cells that do not start with a double quote are regular characters, and characters
+ * between the closing double quote and the next delimiter are appended to the cell.
+ *
+ * The cells of each row are returned as <code>std::string_view</code>s that point
+ * directly into the contents, so reading a file does not allocate memory for the
+ * individual cells. Only quoted cells that contain escaped double quotes have to be
+ * unescaped into a buffer of the reader; these cells are only valid until the next row is
+ * read. If the reader is constructed from a MappedFile, the reader takes ownership of the
+ * mapping and all other cells are valid for as long as the reader exists.
+ */
+class CSVReader {
+public:
+    /**
+     * Creates a reader for the contents of the memory-mapped \p file.
+     *
+     * \param file The mapped CSV file that is to be read
+     * \param delimiter The character that separates the cells of a row
+     *
+     * \pre \p delimiter must not be <code>"</code>, <code>\\r</code>, or
+     *      <code>\\n</code>
+     */
+    explicit CSVReader(filesystem::MappedFile file, char delimiter = ',');
+
+    /**
+     * Creates a reader for the CSV \p contents. The \p contents are not copied and have
+     * to remain valid for as long as the reader and the returned cells are used.
+     *
+     * \param contents The contents in the CSV format
+     * \param delimiter The character that separates the cells of a row
+     *
+     * \pre \p delimiter must not be <code>"</code>, <code>\\r</code>, or
+     *      <code>\\n</code>
+     */
+    explicit CSVReader(std::string_view contents, char delimiter = ',');
+
+    /**
+     * Reads the next row and stores its cells in \p cells, replacing the previous
+     * contents of the vector. Reusing the same vector for all rows avoids allocations.
+     *
+     * \param cells Receives the cells of the next row
+     * \return <code>true</code> if a row was read, <code>false</code> if the end of the
+     *         contents has been reached
+     */
+    bool readRow(std::vector<std::string_view>& cells);
+
+    /**
+     * Skips the next row.
+     *
+     * \return <code>true</code> if a row was skipped, <code>false</code> if the end of
+     *         the contents has been reached
+     */
+    bool skipRow();
+
+    /**
+     * Returns the 1-based number of the line on which the last row that was read or
+     * skipped starts, or 0 if no row has been read yet. As quoted cells can contain line
+     * breaks, this can be different from the number of rows that have been read.
+     *
+     * \return The line number of the last row that was read
+     */
+    size_t lineNumber() const;
+
+    /**
+     * Returns the offset in bytes of the beginning of the next row in the contents.
+     *
+     * \return The offset of the next row in the contents
+     */
+    size_t position() const;
+
+private:
+    /**
+     * Reads the quoted cell that starts at \p position, stores it in \p cells, and
+     * returns the position of the delimiter or line break that follows the cell.
+     */
+    size_t readQuotedCell(size_t position, std::vector<std::string_view>& cells);
+
+    std::optional<filesystem::MappedFile> _file;
+    std::string_view _contents;
+    char _delimiter;
+    size_t _position = 0;
+    size_t _lineNumber = 0;
+    size_t _nextLineNumber = 1;
+
+    /// The unescaped contents of the quoted cells in the current row that need it
+    std::string _buffer;
+    /// The index, offset in the #_buffer, and length of the cells that are unescaped
+    std::vector<std::tuple<size_t, size_t, size_t>> _bufferedCells;
+    /// The cells of the rows that are skipped
+    std::vector<std::string_view> _skippedCells;
+};
+
 /**
  * Loads a comma-separated value (CSV) file from the provided \p fileName and returns all
  * the specified columns. In the return value, each element of the outer vector is a data
@@ -42,12 +145,14 @@ namespace ghoul {
  * \param fileName The location of the CSV file that is to be loaded
  * \param includeFirstLine If \c true, the first line of the CSV file is included;
  *        otherwise it is ignored
+ * \param delimiter The character that separates the cells of a row
  * \return A list of set of data values extracted from the CSV file
  *
+ * \throw ghoul::RuntimeError If the file could not be opened
  * \pre fileName must not be empty
  */
 std::vector<std::vector<std::string>> loadCSVFile(const std::string& fileName,
-    bool includeFirstLine = false);
+    bool includeFirstLine = false, char delimiter = ',');
 
 /**
  * Loads a comma-separated value (CSV) file from the provided \p fileName and returns all
@@ -63,15 +168,18 @@ std::vector<std::vector<std::string>> loadCSVFile(const std::string& fileName,
  *        values of the first line are used as the names for the columns
  * \param includeFirstLine If \c true, the first line of the CSV file is included;
  *        otherwise it is ignored
+ * \param delimiter The character that separates the cells of a row
  * \return A list of set of data values extracted from the CSV file
 
- * \throw ghoul::RuntimeError if one of the \p columns does not exist in the provided CSV
+ * \throw ghoul::RuntimeError If the file could not be opened or if one of the \p columns
+ *        does not exist in the provided CSV
  * \pre fileName must not be empty
  * \pre columns must not be empty
  * \post <code>return.size() == columns.size()</code>
  */
 std::vector<std::vector<std::string>> loadCSVFile(const std::string& fileName,
-    const std::vector<std::string>& columns, bool includeFirstLine = false);
+    const std::vector<std::string>& columns, bool includeFirstLine = false,
+    char delimiter = ',');
 
 /**
  * Loads a comma-separated value (CSV) file from the provided \p fileName and returns all
@@ -84,16 +192,81 @@ std::vector<std::vector<std::string>> loadCSVFile(const std::string& fileName,
  * \param columns The indices of the columns that should be extracted from the CSV file
  * \param includeFirstLine If \c true, the first line of the CSV file is included;
  *        otherwise it is ignored
+ * \param delimiter The character that separates the cells of a row
  * \return A list of set of data values extracted from the CSV file
 
- * \throw ghoul::RuntimeError if one of the indices is larger than the number of columns
- *        in the CSV file
+ * \throw ghoul::RuntimeError If the file could not be opened or if one of the indices is
+ *        larger than the number of columns in the CSV file
  * \pre fileName must not be empty
  * \pre columns must not be empty
  * \post <code>return.size() == columns.size()</code>
  */
 std::vector<std::vector<std::string>> loadCSVFile(const std::string& fileName,
-    const std::vector<int>& columns, bool includeFirstLine = false);
+    const std::vector<int>& columns, bool includeFirstLine = false,
+    char delimiter = ',');
+
+/**
+ * Loads the specified \p columns (as a 0-based index) from the comma-separated value
+ * (CSV) file at \p fileName and converts their values into numbers of type \p T. In
+ * contrast to #loadCSVFile, each element of the outer vector of the return value is a
+ * column that contains the values of all rows in the file. Empty cells are converted to
+ * NaN for floating point types. This function is available for <code>float</code>,
+ * <code>double</code>, <code>int</code>, and <code>int64_t</code>. If a \p threadPool is
+ * passed, large files are split into chunks at line boundaries that are parsed by the
+ * workers of the ThreadPool and the calling thread in parallel. Finding the line
+ * boundaries relies on the double quotes in the file being balanced as in RFC 4180.
+ *
+ * \param fileName The location of the CSV file that is to be loaded
+ * \param columns The indices of the columns that should be extracted from the CSV file
+ * \param includeFirstLine If \c true, the first line of the CSV file is included;
+ *        otherwise it is ignored
+ * \param threadPool The ThreadPool whose workers help with parsing the file. If this is
+ *        <code>nullptr</code>, the file is parsed on the calling thread only
+ * \param delimiter The character that separates the cells of a row
+ * \return The values of each of the \p columns
+ *
+ * \throw ghoul::RuntimeError If the file could not be opened, if one of the indices is
+ *        larger than the number of columns in the CSV file, or if a value could not be
+ *        converted into \p T
+ * \pre fileName must not be empty
+ * \pre columns must not be empty
+ * \post <code>return.size() == columns.size()</code>
+ */
+template <typename T>
+std::vector<std::vector<T>> loadCSVColumns(const std::string& fileName,
+    const std::vector<int>& columns, bool includeFirstLine = false,
+    ThreadPool* threadPool = nullptr, char delimiter = ',');
+
+/**
+ * Loads the specified \p columns from the comma-separated value (CSV) file at
+ * \p fileName and converts their values into numbers of type \p T. The data values of
+ * the first line in the CSV are used as names for the columns and the first line is not
+ * included in the return value. Each element of the outer vector of the return value is
+ * a column that contains the values of all rows in the file. Empty cells are converted
+ * to NaN for floating point types. This function is available for <code>float</code>,
+ * <code>double</code>, <code>int</code>, and <code>int64_t</code>. If a \p threadPool is
+ * passed, large files are split into chunks at line boundaries that are parsed by the
+ * workers of the ThreadPool and the calling thread in parallel. Finding the line
+ * boundaries relies on the double quotes in the file being balanced as in RFC 4180.
+ *
+ * \param fileName The location of the CSV file that is to be loaded
+ * \param columns The name of the columns that should be extracted from the CSV file
+ * \param threadPool The ThreadPool whose workers help with parsing the file. If this is
+ *        <code>nullptr</code>, the file is parsed on the calling thread only
+ * \param delimiter The character that separates the cells of a row
+ * \return The values of each of the \p columns
+ *
+ * \throw ghoul::RuntimeError If the file could not be opened, if one of the \p columns
+ *        does not exist in the provided CSV, or if a value could not be converted into
+ *        \p T
+ * \pre fileName must not be empty
+ * \pre columns must not be empty
+ * \post <code>return.size() == columns.size()</code>
+ */
+template <typename T>
+std::vector<std::vector<T>> loadCSVColumns(const std::string& fileName,
+    const std::vector<std::string>& columns, ThreadPool* threadPool = nullptr,
+    char delimiter = ',');
 
 } // namespace ghoul
 
@@ -0,0 +1,129 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2020                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ *****************************************************************************************
+ * The hash function is xxHash64 by Yann Collet, https://github.com/Cyan4973/xxHash      *
+ * Licensed under the BSD 2-Clause license.                                              *
+ ****************************************************************************************/
+
+#ifndef __GHOUL___HASH___H__
+#define __GHOUL___HASH___H__
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace ghoul {
+
+/**
+ * Computes the 64 bit xxHash64 of the provided \p buffer of size \p size. If the passed
+ * values are compile constants, the hash will also be computed at compile time. The hash
+ * is not cryptographically secure, but it is much faster than #hashCRC32 and its 64 bit
+ * result makes accidental collisions negligible even for very large numbers of keys.
+ *
+ * \param buffer The buffer whose contents are to be hashed
+ * \param size The size of the buffer
+ * \param seed The seed that results in a different family of hash values
+ * \return The hash value for the passed buffer
+ */
+constexpr uint64_t hash64(const char* buffer, size_t size, uint64_t seed = 0);
+
+/**
+ * Computes the 64 bit xxHash64 of the string \p s. If the passed value \p s is a compile
+ * constant, the hash will also be computed at compile time.
+ *
+ * \param s The string for which to compute the hash
+ * \param seed The seed that results in a different family of hash values
+ * \return The hash value for the passed string
+ */
+constexpr uint64_t hash64(std::string_view s, uint64_t seed = 0);
+
+/**
+ * A postfix operator that will convert a string into a 64 bit hash at compile time. This
+ * is functionally equivalent to calling #hash64 with the string \p s.
+ *
+ * \param s The character array that is converted
+ * \param len The length of the character array
+ * \return The 64 bit hash of \p s
+ */
+constexpr uint64_t operator "" _hash64(const char* s, size_t len);
+
+/**
+ * This class computes the same 64 bit hash as #hash64 for data that is not available
+ * all at once, for example because it is read from a file or a network connection in
+ * blocks. The data is passed in any number of parts to #update and the hash of all parts
+ * combined can be retrieved with #value at any time.
+ */
+class StreamingHash64 {
+public:
+    /**
+     * Creates a new hash without any data.
+     *
+     * \param seed The seed that results in a different family of hash values
+     */
+    explicit StreamingHash64(uint64_t seed = 0);
+
+    /**
+     * Appends the contents of the \p buffer of size \p size to the hashed data.
+     *
+     * \param buffer The buffer whose contents are appended
+     * \param size The size of the buffer
+     *
+     * \pre \p buffer must not be <code>nullptr</code> if \p size is bigger than 0
+     */
+    void update(const char* buffer, size_t size);
+
+    /**
+     * Appends the string \p s to the hashed data.
+     *
+     * \param s The string that is appended
+     */
+    void update(std::string_view s);
+
+    /**
+     * Returns the hash value of all data that has been passed to #update so far, which
+     * is equal to the result of #hash64 for the concatenation of the data. More data can
+     * be added afterwards.
+     *
+     * \return The hash value of all data
+     */
+    uint64_t value() const;
+
+private:
+    /// The four accumulators of the 32 byte stripes that have been processed
+    uint64_t _lanes[4];
+    /// The data that does not yet fill a complete stripe
+    char _buffer[32];
+    /// The number of bytes in the #_buffer
+    size_t _bufferSize = 0;
+    /// The total number of bytes that were passed to #update
+    uint64_t _totalSize = 0;
+    /// The seed that was passed in the constructor
+    uint64_t _seed;
+};
+
+} // namespace ghoul
+
+#include "hash.inl"
+
+#endif // __GHOUL___HASH___H__
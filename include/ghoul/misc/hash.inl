@@ -0,0 +1,141 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2020                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ *****************************************************************************************
+ * The hash function is xxHash64 by Yann Collet, https://github.com/Cyan4973/xxHash      *
+ * Licensed under the BSD 2-Clause license.                                              *
+ ****************************************************************************************/
+
+namespace ghoul {
+
+namespace internal {
+
+constexpr const uint64_t Hash64Prime1 = 0x9E3779B185EBCA87ULL;
+constexpr const uint64_t Hash64Prime2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr const uint64_t Hash64Prime3 = 0x165667B19E3779F9ULL;
+constexpr const uint64_t Hash64Prime4 = 0x85EBCA77C2B2AE63ULL;
+constexpr const uint64_t Hash64Prime5 = 0x27D4EB2F165667C5ULL;
+
+constexpr uint64_t rotateLeft(uint64_t value, int r) {
+    return (value << r) | (value >> (64 - r));
+}
+
+// Reads the little-endian value byte by byte, which works in constant expressions and
+// is turned into a single load by the compilers on little-endian platforms
+constexpr uint64_t readHash64Block(const char* data, int size) {
+    uint64_t res = 0;
+    for (int i = 0; i < size; ++i) {
+        res |= static_cast<uint64_t>(static_cast<unsigned char>(data[i])) << (8 * i);
+    }
+    return res;
+}
+
+constexpr uint64_t hash64Round(uint64_t acc, uint64_t input) {
+    acc += input * Hash64Prime2;
+    acc = rotateLeft(acc, 31);
+    return acc * Hash64Prime1;
+}
+
+constexpr uint64_t hash64MergeRound(uint64_t acc, uint64_t lane) {
+    acc ^= hash64Round(0, lane);
+    return acc * Hash64Prime1 + Hash64Prime4;
+}
+
+// Processes the 32 byte stripe starting at data into the four lanes
+constexpr void hash64Stripe(uint64_t (&lanes)[4], const char* data) {
+    for (int i = 0; i < 4; ++i) {
+        lanes[i] = hash64Round(lanes[i], readHash64Block(data + i * 8, 8));
+    }
+}
+
+constexpr uint64_t hash64MergeLanes(const uint64_t (&lanes)[4]) {
+    uint64_t h = rotateLeft(lanes[0], 1) + rotateLeft(lanes[1], 7) +
+                 rotateLeft(lanes[2], 12) + rotateLeft(lanes[3], 18);
+    for (int i = 0; i < 4; ++i) {
+        h = hash64MergeRound(h, lanes[i]);
+    }
+    return h;
+}
+
+// Mixes the remaining less than 32 bytes into the hash and avalanches the result
+constexpr uint64_t hash64Finalize(uint64_t h, const char* data, size_t size) {
+    while (size >= 8) {
+        h ^= hash64Round(0, readHash64Block(data, 8));
+        h = rotateLeft(h, 27) * Hash64Prime1 + Hash64Prime4;
+        data += 8;
+        size -= 8;
+    }
+    if (size >= 4) {
+        h ^= readHash64Block(data, 4) * Hash64Prime1;
+        h = rotateLeft(h, 23) * Hash64Prime2 + Hash64Prime3;
+        data += 4;
+        size -= 4;
+    }
+    while (size > 0) {
+        h ^= static_cast<unsigned char>(*data) * Hash64Prime5;
+        h = rotateLeft(h, 11) * Hash64Prime1;
+        ++data;
+        --size;
+    }
+
+    h ^= h >> 33;
+    h *= Hash64Prime2;
+    h ^= h >> 29;
+    h *= Hash64Prime3;
+    h ^= h >> 32;
+    return h;
+}
+
+} // namespace internal
+
+constexpr uint64_t hash64(const char* buffer, size_t size, uint64_t seed) {
+    using namespace internal;
+
+    const uint64_t totalSize = size;
+    uint64_t h = seed + Hash64Prime5;
+    if (size >= 32) {
+        uint64_t lanes[4] = {
+            seed + Hash64Prime1 + Hash64Prime2,
+            seed + Hash64Prime2,
+            seed,
+            seed - Hash64Prime1
+        };
+        while (size >= 32) {
+            hash64Stripe(lanes, buffer);
+            buffer += 32;
+            size -= 32;
+        }
+        h = hash64MergeLanes(lanes);
+    }
+    return hash64Finalize(h + totalSize, buffer, size);
+}
+
+constexpr uint64_t hash64(std::string_view s, uint64_t seed) {
+    return hash64(s.data(), s.size(), seed);
+}
+
+constexpr uint64_t operator "" _hash64(const char* s, size_t len) {
+    return hash64(s, len);
+}
+
+} // namespace ghoul
@@ -26,7 +26,10 @@
 #ifndef __GHOUL___MISC___H__
 #define __GHOUL___MISC___H__
 
+#include <cstddef>
+#include <iterator>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace ghoul {
@@ -45,6 +48,78 @@ namespace ghoul {
  */
 std::vector<std::string> tokenizeString(const std::string& input, char separator = '.');
 
+/**
+ * A range over the parts of a string that are separated by a separator character, which
+ * is returned by #splitString. The parts are found lazily while iterating and are views
+ * into the original string, so no memory is allocated. The parts are the same as the
+ * ones returned by #tokenizeString.
+ */
+class StringSplitRange {
+public:
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const std::string_view*;
+        using reference = const std::string_view&;
+
+        /// Creates the iterator that points past the last part
+        Iterator() = default;
+
+        /// Creates the iterator that points to the first part of the \p input
+        Iterator(std::string_view input, char separator);
+
+        reference operator*() const;
+        pointer operator->() const;
+
+        Iterator& operator++();
+        Iterator operator++(int);
+
+        bool operator==(const Iterator& rhs) const;
+        bool operator!=(const Iterator& rhs) const;
+
+    private:
+        /// Moves #_current to the next part of #_rest
+        void advance();
+
+        std::string_view _current;
+        std::string_view _rest;
+        char _separator = '.';
+        bool _hasRest = false;
+        bool _isEnd = true;
+    };
+
+    /**
+     * Creates the range over the parts of the \p input.
+     *
+     * \param input The string that is split, which has to stay valid while the range is
+     *        used
+     * \param separator The character that separates the parts
+     */
+    StringSplitRange(std::string_view input, char separator);
+
+    Iterator begin() const;
+    Iterator end() const;
+
+private:
+    std::string_view _input;
+    char _separator;
+};
+
+/**
+ * Splits the \p input into the parts that are separated by the \p separator without
+ * allocating any memory. If \p input is <code>a.b..c</code>, the returned range will
+ * contain <code>a</code>, <code>b</code>, an empty part, and <code>c</code>. In contrast
+ * to #tokenizeString, the parts are views into the \p input, which therefore has to
+ * outlive the returned range.
+ *
+ * \param input The string that is to be split
+ * \param separator The separator between the parts
+ * \return A range over the parts of the \p input
+ */
+StringSplitRange splitString(std::string_view input, char separator = '.');
+
 /**
  * Joins the strings located in the \p input using the provided \p separator and returns
  * the joined list.
@@ -52,7 +127,7 @@ std::vector<std::string> tokenizeString(const std::string& input, char separator
  * \param input The list of strings that will be joined
  * \param separator The separator that will be used in the joined string
  */
-std::string join(std::vector<std::string> input, const std::string& separator = ".");
+std::string join(const std::vector<std::string>& input, std::string_view separator = ".");
 
 /**
  * Removes whitespace at the beginning and the end of the string.
@@ -61,6 +136,14 @@ std::string join(std::vector<std::string> input, const std::string& separator =
  */
 void trimWhitespace(std::string& value);
 
+/**
+ * Removes whitespace at the beginning and the end of the view by shrinking it. The
+ * characters the view refers to are not modified.
+ *
+ * \param value The view from which to remove the whitespace
+ */
+void trimWhitespace(std::string_view& value);
+
 } // namespace ghoul
 
 #endif // __GHOUL___MISC___H__
@@ -0,0 +1,206 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2020                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __GHOUL___RINGBUFFER___H__
+#define __GHOUL___RINGBUFFER___H__
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace ghoul {
+
+/**
+ * A fixed-size ring buffer of bytes that is shared between exactly one producer thread
+ * and one consumer thread without any locking. The producer appends bytes with #write or
+ * by receiving them directly into the #writeRegion and #commit%ting them; the consumer
+ * inspects the bytes with #readRegion, #contiguousData, #peek, or #find and removes them
+ * with #read or #consume. All other methods can be called from either thread, but the
+ * values they return might be outdated by the time they are used.
+ *
+ * The indices are only ever increased and are masked with the capacity, which therefore
+ * is always a power of two, so that the full capacity can be used.
+ */
+class RingBuffer {
+public:
+    /// The value returned by #find if the searched byte does not exist
+    static constexpr const size_t npos = static_cast<size_t>(-1);
+
+    /**
+     * Creates a RingBuffer that can hold at least \p capacity bytes.
+     *
+     * \param capacity The minimum number of bytes the RingBuffer can hold. The actual
+     *        capacity is rounded up to the next power of two
+     * \pre \p capacity must be bigger than 0
+     */
+    explicit RingBuffer(size_t capacity);
+
+    /**
+     * Returns the maximum number of bytes that the RingBuffer can hold.
+     *
+     * \return The maximum number of bytes that the RingBuffer can hold
+     */
+    size_t capacity() const;
+
+    /**
+     * Returns the number of bytes that have been written but not yet consumed.
+     *
+     * \return The number of bytes that have been written but not yet consumed
+     */
+    size_t size() const;
+
+    /**
+     * Returns whether there are no bytes that can be consumed.
+     *
+     * \return Whether there are no bytes that can be consumed
+     */
+    bool empty() const;
+
+    /**
+     * Returns the number of bytes that can be written before the RingBuffer is full.
+     *
+     * \return The number of bytes that can be written before the RingBuffer is full
+     */
+    size_t freeSpace() const;
+
+    /**
+     * Appends as many of the \p nBytes bytes from \p data as fit into the RingBuffer.
+     * This method must only be called from the producer thread.
+     *
+     * \param data The bytes that are appended
+     * \param nBytes The number of bytes in \p data
+     * \return The number of bytes that were appended
+     */
+    size_t write(const char* data, size_t nBytes);
+
+    /**
+     * Returns the largest contiguous region that the producer can write into, which
+     * might be smaller than the #freeSpace if it wraps around the end of the storage. The
+     * written bytes become visible to the consumer with #commit. This method must only
+     * be called from the producer thread.
+     *
+     * \return The beginning and the size of the writable region
+     */
+    std::pair<char*, size_t> writeRegion();
+
+    /**
+     * Makes the first \p nBytes bytes of the #writeRegion visible to the consumer. This
+     * method must only be called from the producer thread.
+     *
+     * \param nBytes The number of bytes that were written into the #writeRegion
+     * \pre \p nBytes must not be bigger than the size of the last #writeRegion
+     */
+    void commit(size_t nBytes);
+
+    /**
+     * Returns the largest contiguous region of bytes that can be consumed, which might be
+     * smaller than the #size if it wraps around the end of the storage. This method must
+     * only be called from the consumer thread.
+     *
+     * \return The beginning and the size of the readable region
+     */
+    std::pair<const char*, size_t> readRegion() const;
+
+    /**
+     * Returns a pointer to the first \p nBytes bytes if they are stored contiguously, or
+     * <code>nullptr</code> if they wrap around the end of the storage. This method must
+     * only be called from the consumer thread.
+     *
+     * \param nBytes The number of bytes that have to be contiguous
+     * \return The pointer to the first \p nBytes bytes or <code>nullptr</code>
+     * \pre \p nBytes must not be bigger than the #size
+     */
+    const char* contiguousData(size_t nBytes) const;
+
+    /**
+     * Copies up to \p nBytes bytes into the \p buffer without consuming them. This method
+     * must only be called from the consumer thread.
+     *
+     * \param buffer The destination of the copied bytes
+     * \param nBytes The maximum number of bytes that are copied
+     * \return The number of bytes that were copied
+     */
+    size_t peek(char* buffer, size_t nBytes) const;
+
+    /**
+     * Copies up to \p nBytes bytes into the \p buffer and consumes them. This method
+     * must only be called from the consumer thread.
+     *
+     * \param buffer The destination of the copied bytes
+     * \param nBytes The maximum number of bytes that are copied
+     * \return The number of bytes that were copied and consumed
+     */
+    size_t read(char* buffer, size_t nBytes);
+
+    /**
+     * Removes the first \p nBytes bytes, which makes room for the producer. This method
+     * must only be called from the consumer thread.
+     *
+     * \param nBytes The number of bytes that are removed
+     * \pre \p nBytes must not be bigger than the #size
+     */
+    void consume(size_t nBytes);
+
+    /**
+     * Searches for the first occurrence of the byte \p value, starting \p offset bytes
+     * after the first byte that can be consumed. This method must only be called from
+     * the consumer thread.
+     *
+     * \param value The byte that is searched
+     * \param offset The number of bytes at the beginning that are skipped
+     * \return The position of the byte relative to the first byte that can be consumed,
+     *         or #npos if it does not exist
+     */
+    size_t find(char value, size_t offset = 0) const;
+
+    /**
+     * Searches for the first occurrence of the byte \p value in the bytes from \p offset
+     * up to \p limit, relative to the first byte that can be consumed. As the producer
+     * might commit more bytes at any time, this makes it possible to know exactly which
+     * bytes were searched. This method must only be called from the consumer thread.
+     *
+     * \param value The byte that is searched
+     * \param offset The number of bytes at the beginning that are skipped
+     * \param limit The number of bytes from the beginning after which the search stops.
+     *        Only the bytes that are available are searched if this is bigger
+     * \return The position of the byte relative to the first byte that can be consumed,
+     *         or #npos if it does not exist
+     */
+    size_t find(char value, size_t offset, size_t limit) const;
+
+private:
+    const size_t _capacity;
+    const size_t _mask;
+    std::unique_ptr<char[]> _data;
+
+    // The indices are on separate cache lines as they are written by different threads
+    alignas(64) std::atomic<size_t> _writeIndex = 0;
+    alignas(64) std::atomic<size_t> _readIndex = 0;
+};
+
+} // namespace ghoul
+
+#endif // __GHOUL___RINGBUFFER___H__
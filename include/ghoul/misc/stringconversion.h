@@ -26,10 +26,243 @@
 #ifndef __GHOUL___STRINGCONVERSION___H__
 #define __GHOUL___STRINGCONVERSION___H__
 
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <clocale>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
 
 namespace ghoul {
 
+/**
+ * The maximum number of characters that #to_chars writes for a value of the arithmetic
+ * type \c T. A buffer of this size is always large enough to hold the shortest
+ * round-trip representation of any value of that type, including the sign and exponent.
+ */
+template <typename T>
+constexpr size_t MaxCharsLength = std::is_floating_point_v<T> ?
+    (sizeof(T) <= 4 ? 16 : (sizeof(T) <= 8 ? 24 : 48)) :
+    std::numeric_limits<T>::digits10 + 3;
+
+namespace internal {
+
+// Only standard libraries that implement the floating point overloads of std::to_chars
+// and std::from_chars define __cpp_lib_to_chars. GCC before 11 and libc++ (including
+// Apple's) only provide the integral overloads, so the floating point conversions fall
+// back to the C functions. These are always compiled so that they can be tested
+// everywhere
+
+// The C functions use the decimal point of the current locale
+inline char localeDecimalPoint() {
+    const char* point = std::localeconv()->decimal_point;
+    return (point && *point != '\0') ? *point : '.';
+}
+
+template <typename T>
+std::from_chars_result floatFromChars(const char* first, const char* last, T& value) {
+    // Unlike std::from_chars, strtod skips whitespace and accepts a leading '+' and
+    // hexadecimal numbers, so only the characters of a decimal number are passed on
+    constexpr std::string_view NumberCharacters = "0123456789.+-eEinfatyINFATY";
+    const char* end = first;
+    while (end != last && NumberCharacters.find(*end) != std::string_view::npos) {
+        ++end;
+    }
+    if (first == end || *first == '+') {
+        return { first, std::errc::invalid_argument };
+    }
+
+    std::string number(first, end);
+    std::replace(number.begin(), number.end(), '.', localeDecimalPoint());
+    char* numberEnd = nullptr;
+    errno = 0;
+    T result;
+    if constexpr (std::is_same_v<T, float>) {
+        result = std::strtof(number.c_str(), &numberEnd);
+    }
+    else if constexpr (std::is_same_v<T, double>) {
+        result = std::strtod(number.c_str(), &numberEnd);
+    }
+    else {
+        result = std::strtold(number.c_str(), &numberEnd);
+    }
+    const char* ptr = first + (numberEnd - number.c_str());
+    if (ptr == first) {
+        return { first, std::errc::invalid_argument };
+    }
+    // Subnormal values are reported as ERANGE as well, but std::from_chars accepts them
+    const int category = std::fpclassify(result);
+    if (errno == ERANGE && (category == FP_INFINITE || category == FP_ZERO)) {
+        return { ptr, std::errc::result_out_of_range };
+    }
+    value = result;
+    return { ptr, std::errc() };
+}
+
+template <typename T>
+std::to_chars_result floatToChars(char* first, char* last, T value) {
+    // Like std::to_chars, the shortest representation that reads back to the same value
+    // is used, so the precision is increased until the value survives a round trip
+    char buffer[MaxCharsLength<T> + 1];
+    int length = 0;
+    for (int p = 1; p <= std::numeric_limits<T>::max_digits10; ++p) {
+        length = std::snprintf(
+            buffer,
+            sizeof(buffer),
+            "%.*Lg",
+            p,
+            static_cast<long double>(value)
+        );
+        std::replace(buffer, buffer + length, localeDecimalPoint(), '.');
+
+        T check = T(0);
+        const std::from_chars_result res = floatFromChars(buffer, buffer + length, check);
+        if (res.ec == std::errc() && !(check < value) && !(value < check)) {
+            break;
+        }
+    }
+    if (length > last - first) {
+        return { last, std::errc::value_too_large };
+    }
+    return { std::copy(buffer, buffer + length, first), std::errc() };
+}
+
+template <typename T>
+std::to_chars_result fixedToChars(char* first, char* last, T value, int precision) {
+    const long double v = static_cast<long double>(value);
+    const int length = std::snprintf(nullptr, 0, "%.*Lf", precision, v);
+    if (length > last - first) {
+        return { last, std::errc::value_too_large };
+    }
+    std::string buffer(length, '\0');
+    std::snprintf(buffer.data(), length + 1, "%.*Lf", precision, v);
+    std::replace(buffer.begin(), buffer.end(), localeDecimalPoint(), '.');
+    return { std::copy(buffer.begin(), buffer.end(), first), std::errc() };
+}
+
+} // namespace internal
+
+/**
+ * Writes the string representation of the arithmetic \p value into the caller-provided
+ * buffer <code>[first, last)</code> without allocating memory or consulting the current
+ * locale. Integral values are written in base 10, floating point values use the shortest
+ * representation that reads back to exactly the same value, and \c bool values are
+ * written as <code>0</code> or <code>1</code>. No null terminator is written.
+ *
+ * \param first The beginning of the buffer that receives the characters
+ * \param last The end of the buffer that receives the characters
+ * \param value The value that is converted
+ * \return The pointer one past the last character that was written and
+ *         <code>std::errc()</code> on success, or \p last and
+ *         <code>std::errc::value_too_large</code> if the buffer was too small
+ */
+template <typename T, std::enable_if_t<std::is_arithmetic_v<T>, int> = 0>
+std::to_chars_result to_chars(char* first, char* last, T value) {
+    if constexpr (std::is_same_v<T, bool>) {
+        if (first == last) {
+            return { last, std::errc::value_too_large };
+        }
+        *first = value ? '1' : '0';
+        return { first + 1, std::errc() };
+    }
+    else if constexpr (std::is_floating_point_v<T>) {
+#ifdef __cpp_lib_to_chars
+        return std::to_chars(first, last, value);
+#else // ^^^^ __cpp_lib_to_chars // !__cpp_lib_to_chars vvvv
+        return internal::floatToChars(first, last, value);
+#endif // __cpp_lib_to_chars
+    }
+    else {
+        return std::to_chars(first, last, value);
+    }
+}
+
+/**
+ * Writes the floating point \p value in fixed notation with exactly \p precision digits
+ * after the decimal point into the caller-provided buffer <code>[first, last)</code>.
+ * This is the equivalent of <code>std::to_chars</code> with
+ * <code>std::chars_format::fixed</code> and does not consult the current locale either.
+ * No null terminator is written.
+ *
+ * \param first The beginning of the buffer that receives the characters
+ * \param last The end of the buffer that receives the characters
+ * \param value The value that is converted
+ * \param precision The number of digits after the decimal point
+ * \return The pointer one past the last character that was written and
+ *         <code>std::errc()</code> on success, or \p last and
+ *         <code>std::errc::value_too_large</code> if the buffer was too small
+ */
+template <typename T, std::enable_if_t<std::is_floating_point_v<T>, int> = 0>
+std::to_chars_result to_chars(char* first, char* last, T value, int precision) {
+#ifdef __cpp_lib_to_chars
+    return std::to_chars(first, last, value, std::chars_format::fixed, precision);
+#else // ^^^^ __cpp_lib_to_chars // !__cpp_lib_to_chars vvvv
+    return internal::fixedToChars(first, last, value, precision);
+#endif // __cpp_lib_to_chars
+}
+
+/**
+ * Parses an arithmetic value from the character range <code>[first, last)</code> without
+ * allocating memory or consulting the current locale. In addition to what
+ * <code>std::from_chars</code> accepts, a leading <code>+</code> is skipped and \c bool
+ * values can be written as <code>0</code>, <code>1</code>, <code>true</code>, or
+ * <code>false</code>. Parsing stops at the first character that is not part of the
+ * number, which is reported back through the returned pointer.
+ *
+ * \param first The beginning of the range that is parsed
+ * \param last The end of the range that is parsed
+ * \param value The value that receives the result. It is only modified on success
+ * \return The pointer one past the last character that was consumed and
+ *         <code>std::errc()</code> on success, <code>std::errc::invalid_argument</code>
+ *         if no number could be parsed, or <code>std::errc::result_out_of_range</code>
+ *         if the number does not fit into \c T
+ */
+template <typename T, std::enable_if_t<std::is_arithmetic_v<T>, int> = 0>
+std::from_chars_result from_chars(const char* first, const char* last, T& value) {
+    if constexpr (std::is_same_v<T, bool>) {
+        const std::string_view s(first, last - first);
+        for (std::string_view v : { "true", "false", "1", "0" }) {
+            if (s.substr(0, v.size()) == v) {
+                value = (v == "true" || v == "1");
+                return { first + v.size(), std::errc() };
+            }
+        }
+        return { first, std::errc::invalid_argument };
+    }
+    else {
+        const char* begin = first;
+        if (begin != last && *begin == '+') {
+            ++begin;
+            if (begin != last && *begin == '-') {
+                // std::from_chars would otherwise accept "+-1" as negative
+                return { first, std::errc::invalid_argument };
+            }
+        }
+#ifdef __cpp_lib_to_chars
+        const std::from_chars_result res = std::from_chars(begin, last, value);
+#else // ^^^^ __cpp_lib_to_chars // !__cpp_lib_to_chars vvvv
+        std::from_chars_result res;
+        if constexpr (std::is_floating_point_v<T>) {
+            res = internal::floatFromChars(begin, last, value);
+        }
+        else {
+            res = std::from_chars(begin, last, value);
+        }
+#endif // __cpp_lib_to_chars
+        if (res.ec == std::errc::invalid_argument) {
+            return { first, res.ec };
+        }
+        return res;
+    }
+}
+
 /**
  * Converts the passed \p string into a \c T value and returns it. For each valid
  * conversion, a template specialization has to be created. This function is meant to be
@@ -38,18 +271,39 @@ namespace ghoul {
  * <code>ghoul::to_string(ghoul::from_string(s)) == s</code>
  *
  * <code>ghoul::from_string(ghoul::to_string(v)) == v</code>
+ *
+ * Arithmetic types are supported out of the box through #from_chars and require the
+ * entire \p string to be a valid number.
+ *
+ * \throw std::invalid_argument If \c T is arithmetic and \p string is not a number
+ * \throw std::out_of_range If \c T is arithmetic and the number does not fit into \c T
  */
 template <typename T>
 T from_string(const std::string& string) {
-    // Unfortunately, we can't write 'false' here, as the compiler is a bit too eager to
-    // evaluate that
-    static_assert(sizeof(T) == -1, "Missing from_string implementation");
+    if constexpr (std::is_arithmetic_v<T>) {
+        const char* last = string.data() + string.size();
+        T value = T();
+        const std::from_chars_result res = from_chars(string.data(), last, value);
+        if (res.ec == std::errc::result_out_of_range) {
+            throw std::out_of_range("Value '" + string + "' is out of range");
+        }
+        if (res.ec != std::errc() || res.ptr != last) {
+            throw std::invalid_argument("Value '" + string + "' is not a number");
+        }
+        return value;
+    }
+    else {
+        // Unfortunately, we can't write 'false' here, as the compiler is a bit too eager
+        // to evaluate that
+        static_assert(sizeof(T) == -1, "Missing from_string implementation");
+    }
 }
 
 /**
- * Converts the passed \p value to its string representation. The default implementation
- * calls the <code>std::to_string</code> function. User-defined types are supported by
- * creating a specialization of this function.
+ * Converts the passed \p value to its string representation. Arithmetic types are
+ * converted through #to_chars, the default implementation for all other types calls the
+ * <code>std::to_string</code> function. User-defined types are supported by creating a
+ * specialization of this function.
  */
 template <typename T>
 std::string to_string(const T& value) {
@@ -57,6 +311,11 @@ std::string to_string(const T& value) {
     if constexpr (std::is_same_v<T, std::string>) {
         return value;
     }
+    else if constexpr (std::is_arithmetic_v<T>) {
+        char buffer[MaxCharsLength<T>];
+        const std::to_chars_result res = to_chars(buffer, buffer + sizeof(buffer), value);
+        return std::string(buffer, res.ptr);
+    }
     else {
         return std::to_string(value);
     }
@@ -27,6 +27,7 @@
 #define __GHOUL___SHADERMANAGER___H__
 
 #include <ghoul/misc/exception.h>
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <string>
@@ -70,7 +71,7 @@ public:
      *
      * \throw ShaderManagerError if the ShaderObject for \p hashedName did not exist
      */
-    ShaderObject* shaderObject(unsigned int hashedName);
+    ShaderObject* shaderObject(uint64_t hashedName);
 
     /**
      * This method will return the ShaderObject that was registered with the passed name.
@@ -98,7 +99,7 @@ public:
      *        \p name
      * \pre \p shader must not be nullptr
      */
-    unsigned int registerShaderObject(const std::string& name,
+    uint64_t registerShaderObject(const std::string& name,
         std::unique_ptr<ShaderObject> shader);
 
     /**
@@ -123,7 +124,7 @@ public:
      * \return The registered ShaderObject or <code>nullptr</code> if the \p name was not
      *         a valid ShaderObject
      */
-    std::unique_ptr<ShaderObject> unregisterShaderObject(unsigned int hashedName);
+    std::unique_ptr<ShaderObject> unregisterShaderObject(uint64_t hashedName);
 
     /**
      * This method returns the hash value for a given \p name. The hash function is
@@ -133,11 +134,11 @@ public:
      * \param name The name which should be converted into a hash value
      * \return The hash value for the passed name
      */
-    unsigned int hashedNameForName(const std::string& name) const;
+    uint64_t hashedNameForName(const std::string& name) const;
 
 private:
     /// Map containing all the registered ShaderObject%s
-    std::map<unsigned int, std::unique_ptr<ShaderObject>> _objects;
+    std::map<uint64_t, std::unique_ptr<ShaderObject>> _objects;
 };
 
 #define ShdrMgr (ghoul::opengl::ShaderManager::ref())
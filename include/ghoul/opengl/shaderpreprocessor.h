@@ -27,6 +27,7 @@
 #define __GHOUL___SHADERPREPROCESSOR___H__
 
 #include <ghoul/filesystem/file.h>
+#include <ghoul/filesystem/filesource.h>
 #include <ghoul/misc/boolean.h>
 #include <ghoul/misc/dictionary.h>
 #include <ghoul/misc/exception.h>
@@ -89,9 +90,12 @@ public:
 
 private:
     struct Input {
-        Input(std::ifstream& str, ghoul::filesystem::File& f, std::string indent);
+        Input(filesystem::FileContents c, ghoul::filesystem::File& f,
+            std::string indent);
 
-        std::ifstream& stream;
+        // The lines are parsed directly from the contents as read by the FileSystem
+        const filesystem::FileContents contents;
+        size_t position = 0;
         ghoul::filesystem::File& file;
         const std::string indentation;
         unsigned int lineNumber = 1;
@@ -100,7 +104,7 @@ private:
     struct ForStatement {
         unsigned int inputIndex;
         unsigned int lineNumber;
-        unsigned int streamPos;
+        unsigned int position;
 
         std::string keyName;
         std::string valueName;
@@ -31,8 +31,32 @@
 #include <ghoul/logging/logmanager.h>
 #include <ghoul/misc/assert.h>
 #include <ghoul/misc/crc32.h>
+#include <ghoul/misc/hash.h>
+#include <ghoul/misc/threadpool.h>
 #include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
+#include <future>
+#include <iterator>
+#include <random>
+#include <thread>
+#include <vector>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#ifdef WIN32
+#include <io.h>
+#include <fcntl.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#endif
 
 namespace {
     constexpr const char* _loggerCat = "CacheManager";
@@ -41,15 +65,584 @@ namespace {
     // something that cannot occur in the filesystem
     constexpr const char _hashDelimiter = '|';
 
-    unsigned int generateHash(const std::string& file, const std::string& information) {
-        std::string hashString = file + _hashDelimiter + information;
-        unsigned int hash = ghoul::hashCRC32(hashString);
-        return hash;
+    // Files are hashed in chunks of this size, larger files are hashed in parallel
+    constexpr const size_t HashChunkSize = 4 * 1024 * 1024;
+
+    // The interval in which the eviction thread checks the size of the cache. As the
+    // cached files are written after they have been requested, their sizes have to be
+    // checked again after a while
+    constexpr const std::chrono::seconds EvictionInterval = std::chrono::seconds(10);
+
+    uint64_t fileSize(const std::string& path) {
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0) {
+            return 0;
+        }
+        return static_cast<uint64_t>(info.st_size);
+    }
+
+    uint64_t generateHash(const std::string& file, const std::string& information) {
+        ghoul::StreamingHash64 hash;
+        hash.update(file);
+        hash.update(std::string_view(&_hashDelimiter, 1));
+        hash.update(information);
+        return hash.value();
+    }
+
+    // Computes a 64 bit hash of the contents of the file at the provided path that has
+    // the provided size. The file is split into chunks that are hashed independently,
+    // which allows larger files to be read and hashed by the workers of the ThreadPool at
+    // the same time. The chunk hashes are combined in order, so the result does not
+    // depend on the number of threads
+    uint64_t contentHash(const std::string& path, size_t size, ghoul::ThreadPool& pool) {
+        const size_t nChunks = std::max<size_t>(
+            (size + HashChunkSize - 1) / HashChunkSize,
+            1
+        );
+        std::vector<uint64_t> chunkHashes(nChunks);
+        std::atomic<size_t> nextChunk = 0;
+        std::atomic_bool success = true;
+        auto worker = [&]() {
+            std::ifstream f(path, std::ifstream::binary);
+            std::vector<char> buffer(std::min(size, HashChunkSize));
+            for (size_t c = nextChunk++; c < nChunks; c = nextChunk++) {
+                const size_t offset = c * HashChunkSize;
+                const size_t length = std::min(HashChunkSize, size - offset);
+                f.seekg(offset);
+                f.read(buffer.data(), length);
+                success = success && f.good();
+                chunkHashes[c] = ghoul::hash64(buffer.data(), length, c);
+            }
+        };
+
+        // The calling thread hashes chunks as well, so this finishes even if all
+        // workers are busy with other files
+        const size_t nTasks = std::min(static_cast<size_t>(pool.size()), nChunks - 1);
+        std::vector<std::future<void>> tasks;
+        for (size_t i = 0; i < nTasks; ++i) {
+            tasks.push_back(pool.queue(worker));
+        }
+        worker();
+        for (std::future<void>& t : tasks) {
+            t.wait();
+        }
+        if (!success) {
+            throw ghoul::filesystem::CacheManager::CacheException(fmt::format(
+                "Could not read file '{}' for hashing", path
+            ));
+        }
+
+        return ghoul::hash64(
+            reinterpret_cast<const char*>(chunkHashes.data()),
+            chunkHashes.size() * sizeof(uint64_t),
+            size
+        );
+    }
+
+    // The cache file is a journal that starts with a Header and is followed by records
+    // that each consist of the size of the payload, the CRC32 checksum of the payload,
+    // and the payload. The payload starts with the RecordType, the identifier of the
+    // CacheManager that wrote the record, and the hash of the entry. Depending on the
+    // type, this is followed by the access information and the path of the cached file
+    // relative to the cache directory
+    constexpr const char JournalMagic[8] = { 'G', 'H', 'L', 'C', 'A', 'C', 'H', 'E' };
+    constexpr const uint32_t JournalVersion = 3;
+
+    // The lock files next to the journal. The journal lock serializes all access to the
+    // journal, while every process holds a shared lock on the users lock file as long as
+    // it is using the cache directory
+    constexpr const char* _journalLockFile = "cache.lock";
+    constexpr const char* _usersLockFile = "cache.users";
+
+    struct Header {
+        char magic[8];
+        uint32_t formatVersion;
+        int32_t version;
+    };
+
+    enum class RecordType : uint8_t {
+        Add = 1,
+        Access = 2,
+        Remove = 3
+    };
+
+    // The journal is compacted if it contains more than CompactionFactor times as many
+    // records as there are entries, but at least MinCompactionRecords records
+    constexpr const size_t CompactionFactor = 4;
+    constexpr const size_t MinCompactionRecords = 1024;
+
+    // The number of requests for persistent entries whose access information is
+    // collected before it is written to the journal
+    constexpr const size_t AccessFlushThreshold = 256;
+
+    template <typename T>
+    void append(std::vector<char>& buffer, T value) {
+        const size_t size = buffer.size();
+        buffer.resize(size + sizeof(T));
+        std::memcpy(buffer.data() + size, &value, sizeof(T));
+    }
+
+    template <typename T>
+    bool extract(const char*& data, const char* end, T& value) {
+        if (static_cast<size_t>(end - data) < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, data, sizeof(T));
+        data += sizeof(T);
+        return true;
+    }
+
+    std::vector<char> headerData(int version) {
+        Header header;
+        std::copy(std::begin(JournalMagic), std::end(JournalMagic), header.magic);
+        header.formatVersion = JournalVersion;
+        header.version = version;
+
+        std::vector<char> data(sizeof(Header));
+        std::memcpy(data.data(), &header, sizeof(Header));
+        return data;
+    }
+
+    std::vector<char> addRecord(uint64_t writer, uint64_t hash, int64_t lastAccess,
+                                uint64_t nAccesses, const std::string& path)
+    {
+        std::vector<char> payload;
+        append(payload, RecordType::Add);
+        append(payload, writer);
+        append(payload, hash);
+        append(payload, lastAccess);
+        append(payload, nAccesses);
+        append(payload, static_cast<uint32_t>(path.size()));
+        payload.insert(payload.end(), path.begin(), path.end());
+        return payload;
+    }
+
+    std::vector<char> accessRecord(uint64_t writer, uint64_t hash, int64_t lastAccess,
+                                   uint64_t nAccesses)
+    {
+        std::vector<char> payload;
+        append(payload, RecordType::Access);
+        append(payload, writer);
+        append(payload, hash);
+        append(payload, lastAccess);
+        append(payload, nAccesses);
+        return payload;
+    }
+
+    std::vector<char> removeRecord(uint64_t writer, uint64_t hash) {
+        std::vector<char> payload;
+        append(payload, RecordType::Remove);
+        append(payload, writer);
+        append(payload, hash);
+        return payload;
+    }
+
+    void appendRecord(std::vector<char>& buffer, const std::vector<char>& payload) {
+        const uint32_t checksum = ghoul::hashCRC32(
+            payload.data(),
+            static_cast<unsigned int>(payload.size())
+        );
+        append(buffer, static_cast<uint32_t>(payload.size()));
+        append(buffer, checksum);
+        buffer.insert(buffer.end(), payload.begin(), payload.end());
+    }
+
+    // Returns the number of bytes at the beginning of the data that consist of complete
+    // records with a valid checksum and stores the number of these records in nRecords.
+    // Anything after that was left by a crash while the record was being written
+    size_t validRecordsSize(const char* data, size_t size, size_t& nRecords) {
+        const char* begin = data;
+        const char* end = data + size;
+        nRecords = 0;
+        while (data != end) {
+            const char* record = data;
+            uint32_t payloadSize;
+            uint32_t checksum;
+            if (!extract(data, end, payloadSize) || !extract(data, end, checksum) ||
+                static_cast<size_t>(end - data) < payloadSize ||
+                ghoul::hashCRC32(data, payloadSize) != checksum)
+            {
+                return static_cast<size_t>(record - begin);
+            }
+            data += payloadSize;
+            ++nRecords;
+        }
+        return size;
+    }
+
+    void raiseTo(std::atomic<int64_t>& value, int64_t minimum) {
+        int64_t current = value;
+        while (current < minimum && !value.compare_exchange_weak(current, minimum)) {}
+    }
+
+    // Writes the data into the file at the provided path and only returns once the
+    // contents have reached the disk
+    void writeFileDurably(const std::string& path, const std::vector<char>& data) {
+        using CacheException = ghoul::filesystem::CacheManager::CacheException;
+#ifdef WIN32
+        const int fd = _open(
+            path.c_str(),
+            _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY,
+            _S_IREAD | _S_IWRITE
+        );
+#else
+        const int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+#endif
+        if (fd == -1) {
+            throw CacheException(fmt::format(
+                "Could not open '{}' for writing: {}", path, strerror(errno)
+            ));
+        }
+
+        size_t written = 0;
+        bool success = true;
+        while (success && written < data.size()) {
+#ifdef WIN32
+            const int res = _write(
+                fd,
+                data.data() + written,
+                static_cast<unsigned int>(data.size() - written)
+            );
+#else
+            const ssize_t res = write(fd, data.data() + written, data.size() - written);
+#endif
+            success = res > 0;
+            written += success ? static_cast<size_t>(res) : 0;
+        }
+#ifdef WIN32
+        success &= (_commit(fd) == 0);
+        _close(fd);
+#else
+        success &= (fsync(fd) == 0);
+        close(fd);
+#endif
+        if (!success) {
+            throw CacheException(fmt::format(
+                "Error writing '{}': {}", path, strerror(errno)
+            ));
+        }
+    }
+
+    // Atomically replaces the file at the destination with the source file
+    void replaceFile(const std::string& source, const std::string& destination) {
+#ifdef WIN32
+        const BOOL success = MoveFileEx(
+            source.c_str(),
+            destination.c_str(),
+            MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH
+        );
+        if (!success) {
+            throw ghoul::filesystem::CacheManager::CacheException(fmt::format(
+                "Error replacing '{}' with '{}'", destination, source
+            ));
+        }
+#else
+        if (rename(source.c_str(), destination.c_str()) != 0) {
+            throw ghoul::filesystem::CacheManager::CacheException(fmt::format(
+                "Error replacing '{}' with '{}': {}",
+                destination, source, strerror(errno)
+            ));
+        }
+#endif
     }
 } // namespace
 
 namespace ghoul::filesystem {
 
+/**
+ * A file in the cache directory that can be appended to from multiple processes and that
+ * can be locked across processes. The locks are advisory and only exclude other
+ * processes, so threads within the same process have to be synchronized separately.
+ */
+struct CacheFileHandle {
+    /// Opens or creates the file at the \p path
+    explicit CacheFileHandle(const std::string& path);
+    ~CacheFileHandle();
+
+    /// Appends the \p data at the end of the file
+    void append(const std::vector<char>& data);
+
+    /// Returns the contents of the file from the \p offset to the end of the file
+    std::vector<char> read(uint64_t offset) const;
+
+    /// Returns the current size of the file
+    uint64_t size() const;
+
+    /// Shortens the file to the \p size
+    void truncate(uint64_t size);
+
+    /// Returns a value that uniquely identifies the opened file on the filesystem
+    std::pair<uint64_t, uint64_t> identity() const;
+
+    /// Returns the identity of the file at the \p path, or {0, 0} if it does not exist
+    static std::pair<uint64_t, uint64_t> identity(const std::string& path);
+
+    void lockExclusive();
+    bool tryLockExclusive();
+    void lockShared();
+    void unlock();
+
+#ifdef WIN32
+    HANDLE handle = INVALID_HANDLE_VALUE;
+#else
+    int fd = -1;
+#endif
+};
+
+#ifdef WIN32
+
+CacheFileHandle::CacheFileHandle(const std::string& path) {
+    // Sharing the delete access is necessary to atomically replace the journal while
+    // other processes have it opened
+    handle = CreateFile(
+        path.c_str(),
+        GENERIC_READ | GENERIC_WRITE,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        nullptr,
+        OPEN_ALWAYS,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr
+    );
+    if (handle == INVALID_HANDLE_VALUE) {
+        throw CacheManager::CacheException(fmt::format("Could not open '{}'", path));
+    }
+}
+
+CacheFileHandle::~CacheFileHandle() {
+    CloseHandle(handle);
+}
+
+void CacheFileHandle::append(const std::vector<char>& data) {
+    // Writing to an offset of 0xFFFFFFFFFFFFFFFF appends to the end of the file
+    OVERLAPPED overlapped = {};
+    overlapped.Offset = 0xFFFFFFFF;
+    overlapped.OffsetHigh = 0xFFFFFFFF;
+    DWORD written = 0;
+    const BOOL success = WriteFile(
+        handle,
+        data.data(),
+        static_cast<DWORD>(data.size()),
+        &written,
+        &overlapped
+    );
+    if (!success || written != data.size()) {
+        throw CacheManager::CacheException("Error writing to the cache journal");
+    }
+}
+
+std::vector<char> CacheFileHandle::read(uint64_t offset) const {
+    const uint64_t s = size();
+    std::vector<char> result(s > offset ? s - offset : 0);
+    size_t position = 0;
+    while (position < result.size()) {
+        OVERLAPPED overlapped = {};
+        overlapped.Offset = static_cast<DWORD>((offset + position) & 0xFFFFFFFF);
+        overlapped.OffsetHigh = static_cast<DWORD>((offset + position) >> 32);
+        DWORD nRead = 0;
+        const BOOL success = ReadFile(
+            handle,
+            result.data() + position,
+            static_cast<DWORD>(result.size() - position),
+            &nRead,
+            &overlapped
+        );
+        if (!success || nRead == 0) {
+            break;
+        }
+        position += nRead;
+    }
+    result.resize(position);
+    return result;
+}
+
+uint64_t CacheFileHandle::size() const {
+    LARGE_INTEGER s;
+    return GetFileSizeEx(handle, &s) ? static_cast<uint64_t>(s.QuadPart) : 0;
+}
+
+void CacheFileHandle::truncate(uint64_t size) {
+    FILE_END_OF_FILE_INFO info;
+    info.EndOfFile.QuadPart = static_cast<LONGLONG>(size);
+    SetFileInformationByHandle(handle, FileEndOfFileInfo, &info, sizeof(info));
+}
+
+std::pair<uint64_t, uint64_t> CacheFileHandle::identity() const {
+    BY_HANDLE_FILE_INFORMATION info;
+    if (!GetFileInformationByHandle(handle, &info)) {
+        return { 0, 0 };
+    }
+    return {
+        info.dwVolumeSerialNumber,
+        (static_cast<uint64_t>(info.nFileIndexHigh) << 32) | info.nFileIndexLow
+    };
+}
+
+std::pair<uint64_t, uint64_t> CacheFileHandle::identity(const std::string& path) {
+    HANDLE h = CreateFile(
+        path.c_str(),
+        0,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr
+    );
+    if (h == INVALID_HANDLE_VALUE) {
+        return { 0, 0 };
+    }
+    BY_HANDLE_FILE_INFORMATION info;
+    const BOOL success = GetFileInformationByHandle(h, &info);
+    CloseHandle(h);
+    if (!success) {
+        return { 0, 0 };
+    }
+    return {
+        info.dwVolumeSerialNumber,
+        (static_cast<uint64_t>(info.nFileIndexHigh) << 32) | info.nFileIndexLow
+    };
+}
+
+void CacheFileHandle::lockExclusive() {
+    OVERLAPPED overlapped = {};
+    LockFileEx(handle, LOCKFILE_EXCLUSIVE_LOCK, 0, MAXDWORD, MAXDWORD, &overlapped);
+}
+
+bool CacheFileHandle::tryLockExclusive() {
+    OVERLAPPED overlapped = {};
+    return LockFileEx(
+        handle,
+        LOCKFILE_EXCLUSIVE_LOCK | LOCKFILE_FAIL_IMMEDIATELY,
+        0,
+        MAXDWORD,
+        MAXDWORD,
+        &overlapped
+    );
+}
+
+void CacheFileHandle::lockShared() {
+    OVERLAPPED overlapped = {};
+    LockFileEx(handle, 0, 0, MAXDWORD, MAXDWORD, &overlapped);
+}
+
+void CacheFileHandle::unlock() {
+    OVERLAPPED overlapped = {};
+    UnlockFileEx(handle, 0, MAXDWORD, MAXDWORD, &overlapped);
+}
+
+#else // ^^^^ WIN32 // !WIN32 vvvv
+
+CacheFileHandle::CacheFileHandle(const std::string& path) {
+    fd = open(path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd == -1) {
+        throw CacheManager::CacheException(fmt::format(
+            "Could not open '{}': {}", path, strerror(errno)
+        ));
+    }
+}
+
+CacheFileHandle::~CacheFileHandle() {
+    close(fd);
+}
+
+void CacheFileHandle::append(const std::vector<char>& data) {
+    // The file was opened with O_APPEND, so every write goes to the end of the file
+    size_t written = 0;
+    while (written < data.size()) {
+        const ssize_t res = write(fd, data.data() + written, data.size() - written);
+        if (res <= 0) {
+            if (res == -1 && errno == EINTR) {
+                continue;
+            }
+            throw CacheManager::CacheException(fmt::format(
+                "Error writing to the cache journal: {}", strerror(errno)
+            ));
+        }
+        written += static_cast<size_t>(res);
+    }
+}
+
+std::vector<char> CacheFileHandle::read(uint64_t offset) const {
+    const uint64_t s = size();
+    std::vector<char> result(s > offset ? s - offset : 0);
+    size_t position = 0;
+    while (position < result.size()) {
+        const ssize_t res = pread(
+            fd,
+            result.data() + position,
+            result.size() - position,
+            static_cast<off_t>(offset + position)
+        );
+        if (res <= 0) {
+            if (res == -1 && errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        position += static_cast<size_t>(res);
+    }
+    result.resize(position);
+    return result;
+}
+
+uint64_t CacheFileHandle::size() const {
+    struct stat info;
+    return fstat(fd, &info) == 0 ? static_cast<uint64_t>(info.st_size) : 0;
+}
+
+void CacheFileHandle::truncate(uint64_t size) {
+    [[maybe_unused]] int res = ftruncate(fd, static_cast<off_t>(size));
+}
+
+std::pair<uint64_t, uint64_t> CacheFileHandle::identity() const {
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        return { 0, 0 };
+    }
+    // The width and signedness of dev_t and ino_t differ between platforms
+    return std::pair<uint64_t, uint64_t>(info.st_dev, info.st_ino);
+}
+
+std::pair<uint64_t, uint64_t> CacheFileHandle::identity(const std::string& path) {
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) {
+        return { 0, 0 };
+    }
+    // The width and signedness of dev_t and ino_t differ between platforms
+    return std::pair<uint64_t, uint64_t>(info.st_dev, info.st_ino);
+}
+
+void CacheFileHandle::lockExclusive() {
+    while (flock(fd, LOCK_EX) == -1 && errno == EINTR) {}
+}
+
+bool CacheFileHandle::tryLockExclusive() {
+    return flock(fd, LOCK_EX | LOCK_NB) == 0;
+}
+
+void CacheFileHandle::lockShared() {
+    while (flock(fd, LOCK_SH) == -1 && errno == EINTR) {}
+}
+
+void CacheFileHandle::unlock() {
+    flock(fd, LOCK_UN);
+}
+
+#endif // WIN32
+
+namespace {
+    // Holds the exclusive lock of a lock file for the duration of a scope
+    struct FileLock {
+        explicit FileLock(ghoul::filesystem::CacheFileHandle& handle) : _handle(handle) {
+            _handle.lockExclusive();
+        }
+        ~FileLock() {
+            _handle.unlock();
+        }
+
+        ghoul::filesystem::CacheFileHandle& _handle;
+    };
+} // namespace
+
 CacheManager::CacheException::CacheException(std::string msg)
     : RuntimeError(std::move(msg), "Cache")
 {}
@@ -76,121 +669,109 @@ CacheManager::CacheManager(std::string directory, int version)
     ghoul_assert(!directory.empty(), "Directory must not be empty");
     _directory = std::move(directory);
 
-    // In the cache state, we check our cache directory for all values, in a later step
-    // we remove all persistent values, so that only the non-persistent values remain
-    // Under normal operation, the resulting vector should be of size == 0, but if the
-    // last execution of the application crashed, the directory was not cleaned up
-    // properly
-    std::vector<LoadedCacheInfo> cacheState = cacheInformationFromDirectory(_directory);
-    std::string path = FileSys.pathByAppendingComponent(_directory, _cacheFile);
-
-    std::ifstream file(path);
-    if (file.good()) {
-        std::string line;
-        // The first line of the file contains the version number
-        std::getline(file, line);
-        if (line != std::to_string(_version)) {
-            LINFO(fmt::format(
-                "Cache version has changed. Current version {}; new version {}",
-                line, _version
-            ));
-            for (const LoadedCacheInfo& cache : cacheState) {
-                LINFO(fmt::format("Deleting file '{}'", cache.second));
-                FileSys.deleteFile(cache.second);
-            }
-            cleanDirectory(_directory);
-            file.close();
-            FileSys.deleteFile(path);
-            return;
-        }
-
-        // loading the cache file that might exist from a previous run of the application
-        // and reading all the persistent files from that file
-        while (std::getline(file, line)) {
-            // The structure of the cache file is assumed as follows (writting in the
-            // destructor call of the application's previous run):
-            // for each file:
-            //   hash number\n
-            //   filepath\n
-            unsigned long hash;
-            try {
-                hash = std::stoul(line);
-            } catch (const std::invalid_argument&) {
-                throw MalformedCacheException(path);
-            }
+    std::random_device rd;
+    _instanceId = (static_cast<uint64_t>(rd()) << 32) | rd();
 
-            CacheInformation info;
-            std::getline(file, info.file);
-            if (!file.good()) {
-                throw MalformedCacheException(path);
-            }
+    _journalLock = std::make_unique<CacheFileHandle>(
+        FileSys.pathByAppendingComponent(_directory, _journalLockFile)
+    );
+    _usersLock = std::make_unique<CacheFileHandle>(
+        FileSys.pathByAppendingComponent(_directory, _usersLockFile)
+    );
 
-            info.isPersistent = true;
-            _files[hash] = info;
-
-            // If the current hash + file is contained in the cache state, we have to
-            // remove it
-            cacheState.erase(
-                std::remove_if(
-                    cacheState.begin(), cacheState.end(),
-                    [hash, &info](const LoadedCacheInfo& i) {
-                        return hash == i.first && info.file == i.second;
-                    }
-                ),
-                cacheState.end()
-            );
-        }
+    // If we can get the exclusive lock, no other process is using the cache directory
+    // and we are free to clean up after a previous crash. Afterwards, we only keep a
+    // shared lock to signal other processes that we are using the directory
+    const bool isOnlyUser = _usersLock->tryLockExclusive();
+    {
+        FileLock lock(*_journalLock);
+        loadJournal(isOnlyUser);
     }
+    _usersLock->unlock();
+    _usersLock->lockShared();
+}
 
-    // At this point all values that remain in the cache state vector are left from a
-    // previous crash of the application
-    if (!cacheState.empty()) {
-        LINFO("There was a crash in the previous run and it left the cache unclean. "
-              "Cleaning it now");
-        for (const LoadedCacheInfo& cache : cacheState) {
-            LINFO(fmt::format("Deleting file '{}'", cache.second));
-            FileSys.deleteFile(cache.second);
-        }
-        // First clean the cache directory with all contents
-        cleanDirectory(_directory);
-        //FileSys.deleteDirectory(_directory, true);
-        file.close();
-        FileSys.deleteFile(path);
-        if (!FileSys.directoryExists(_directory)) {
-            // Then recreate the directory for further use
-            FileSys.createDirectory(_directory);
+CacheManager::~CacheManager() {
+    if (_evictionThread.joinable()) {
+        {
+            std::lock_guard lock(_evictionMutex);
+            _stopEviction = true;
         }
+        _evictionCondition.notify_one();
+        _evictionThread.join();
     }
-}
+    flushAccesses();
 
-CacheManager::~CacheManager() {
-    std::string path = FileSys.pathByAppendingComponent(_directory, _cacheFile);
-    std::ofstream file(path, std::ofstream::out);
-    if (file.good()) {
-        file << _version << std::endl;
-        for (const std::pair<const unsigned long, CacheInformation>& p : _files) {
-            if (!p.second.isPersistent) {
+    for (Shard& s : _shards) {
+        std::lock_guard lock(s.mutex);
+        for (auto it = s.files.begin(); it != s.files.end();) {
+            if (!it->second.isPersistent) {
                 // Delete all the non-persistent files
-                FileSys.deleteFile(p.second.file);
+                FileSys.deleteFile(it->second.file);
+                it = s.files.erase(it);
             }
             else {
-                // Save the persistent files in the cache file
-                file << p.first << '\n' << p.second.file << '\n';
+                ++it;
             }
         }
-        file.close();
     }
-    else {
-        LERROR(fmt::format(
-            "Could not open file '{}' for writing parmanent cache files", path
+
+    // The last process that uses the cache directory cleans it up. All persistent
+    // entries are already in the journal, so compacting it only speeds up the next
+    // startup
+    _usersLock->unlock();
+    if (_usersLock->tryLockExclusive()) {
+        try {
+            compactJournal();
+        }
+        catch (const CacheException& e) {
+            LERROR(e.message);
+        }
+        cleanDirectory(_directory);
+        _usersLock->unlock();
+    }
+}
+
+std::string CacheManager::contentInformation(const File& file) const {
+    // The hash is only computed again if the file has changed since the last time
+    std::error_code error;
+    const uint64_t size = std::filesystem::file_size(file.path(), error);
+    const int64_t lastWriteTime = std::filesystem::last_write_time(
+        file.path(),
+        error
+    ).time_since_epoch().count();
+    if (error) {
+        throw CacheException(fmt::format(
+            "Could not open file '{}' for hashing", file.path()
         ));
     }
-    cleanDirectory(_directory);
+
+    {
+        std::lock_guard lock(_contentHashMutex);
+        auto it = _contentHashes.find(file.path());
+        if (it != _contentHashes.end() && it->second.size == size &&
+            it->second.lastWriteTime == lastWriteTime)
+        {
+            return it->second.hash;
+        }
+    }
+
+    std::call_once(_hashPoolCreated, [this]() {
+        const int nThreads = static_cast<int>(std::thread::hardware_concurrency());
+        _hashPool = std::make_unique<ThreadPool>(std::max(nThreads - 1, 1));
+    });
+    std::string hash = fmt::format(
+        "{:016x}",
+        contentHash(file.path(), static_cast<size_t>(size), *_hashPool)
+    );
+
+    std::lock_guard lock(_contentHashMutex);
+    _contentHashes[file.path()] = { size, lastWriteTime, hash };
+    return hash;
 }
 
 std::string CacheManager::cachedFilename(const File& file, Persistent isPersistent) {
-    std::string lastModifiedTime = file.lastModifiedDate();
-    return cachedFilename(file, lastModifiedTime, isPersistent);
+    return cachedFilename(file, contentInformation(file), isPersistent);
 }
 
 std::string CacheManager::cachedFilename(const File& file, const std::string& information,
@@ -208,36 +789,58 @@ std::string CacheManager::cachedFilename(const std::string& baseName,
         throw IllegalArgumentException(baseName);
     }
 
-    unsigned int hash = generateHash(baseName, information);
-
-    // If we couldn't find the file, we have to generate a directory with the name of the
-    // hash and return the full path containing of the cache path + requested filename +
-    // hash value
-    std::string destinationBase = FileSys.pathByAppendingComponent(_directory, baseName);
+    const uint64_t hash = generateHash(baseName, information);
+    Shard& s = shard(hash);
 
-    // If this is the first time anyone requests a cache for the file name, we have to
-    // create the base directory under the cache directory
-    if (!FileSys.directoryExists(destinationBase)) {
-        FileSys.createDirectory(destinationBase);
+    std::unique_lock lock(s.mutex);
+    auto it = s.files.find(hash);
+    if (it == s.files.end() || it->second.isPersistent) {
+        // Another process might have created or removed the entry since we last looked
+        lock.unlock();
+        syncJournal();
+        lock.lock();
+        it = s.files.find(hash);
+    }
+    if (it != s.files.end()) {
+        // If we find the hash, it has been created before and we can just return the
+        // file name to the caller
+        touch(it->second);
+        bool needsFlush = false;
+        if (it->second.isPersistent) {
+            // The access information is written to the journal in batches, as writing
+            // it for every request would turn each cache hit into a write
+            std::lock_guard accessLock(_accessMutex);
+            _pendingAccesses.push_back(hash);
+            needsFlush = _pendingAccesses.size() >= AccessFlushThreshold;
+        }
+        std::string cachedFileName = it->second.file;
+        lock.unlock();
+        if (needsFlush) {
+            flushAccesses();
+        }
+        compactJournalIfNecessary();
+        return cachedFileName;
     }
 
+    // If we couldn't find the file, we have to generate a directory with the name of the
+    // hash and return the full path containing of the cache path + requested filename +
+    // hash value. To keep the number of entries per directory small, the hash
+    // directories are fanned out into two levels of directories named after the two
+    // most significant bytes of the hash
     std::string destination = FileSys.pathByAppendingComponent(
-        destinationBase,
-        std::to_string(hash)
+        _directory,
+        fmt::format(
+            "{:02x}{}{:02x}{}{}",
+            (hash >> 56) & 0xFF, FileSystem::PathSeparator, (hash >> 48) & 0xFF,
+            FileSystem::PathSeparator, hash
+        )
     );
 
     // The new destination should always not exist, since we checked before if we have the
     // value in the map and only get here if it isn't; persistent cache entries are always
     // in the map and non-persistent entries should have been deleted on application close
     if (!FileSys.directoryExists(destination)) {
-        FileSys.createDirectory(destination);
-    }
-
-    auto it = _files.find(hash);
-    if (it != _files.end()) {
-        // If we find the hash, it has been created before and we can just return the
-        // file name to the caller
-        return it->second.file;
+        FileSys.createDirectory(destination, FileSystem::Recursive::Yes);
     }
 
     // Generate and output the newly generated cache name
@@ -245,13 +848,29 @@ std::string CacheManager::cachedFilename(const std::string& baseName,
 
     // Store the cache information in the map
     CacheInformation info = { cachedFileName, isPersistent };
-    _files[hash] = info;
+    touch(info);
+    if (info.isPersistent) {
+        // Persistent entries are written to the journal right away so that they survive
+        // a crash of the application and are visible to other processes
+        journalAdd(hash, info);
+    }
+    s.files[hash] = info;
+    lock.unlock();
+
+    if (isPersistent) {
+        compactJournalIfNecessary();
+
+        std::lock_guard evictionLock(_evictionMutex);
+        if (_sizeLimit > 0) {
+            _evictionRequested = true;
+            _evictionCondition.notify_one();
+        }
+    }
     return cachedFileName;
 }
 
 bool CacheManager::hasCachedFile(const File& file) const {
-    std::string lastModifiedTime = file.lastModifiedDate();
-    return hasCachedFile(file, lastModifiedTime);
+    return hasCachedFile(file, contentInformation(file));
 }
 
 bool CacheManager::hasCachedFile(const File& file, const std::string& information) const {
@@ -266,13 +885,23 @@ bool CacheManager::hasCachedFile(const std::string& baseName,
         throw IllegalArgumentException(baseName);
     }
 
-    unsigned long hash = generateHash(baseName, information);
-    return _files.find(hash) != _files.end();
+    const uint64_t hash = generateHash(baseName, information);
+    Shard& s = shard(hash);
+    {
+        std::lock_guard lock(s.mutex);
+        if (s.files.find(hash) != s.files.end()) {
+            return true;
+        }
+    }
+
+    // Another process might have created the entry since we last looked
+    syncJournal();
+    std::lock_guard lock(s.mutex);
+    return s.files.find(hash) != s.files.end();
 }
 
 void CacheManager::removeCacheFile(const File& file) {
-    std::string lastModifiedTime = file.lastModifiedDate();
-    removeCacheFile(file, lastModifiedTime);
+    removeCacheFile(file, contentInformation(file));
 }
 
 void CacheManager::removeCacheFile(const File& file, const std::string& information) {
@@ -287,18 +916,619 @@ void CacheManager::removeCacheFile(const std::string& baseName,
         throw IllegalArgumentException(baseName);
     }
 
-    unsigned int hash = generateHash(baseName, information);
+    const uint64_t hash = generateHash(baseName, information);
+    Shard& s = shard(hash);
 
-    auto it = _files.find(hash);
-    if (it != _files.end()) {
-        // If we find the hash, it has been created before and we can just return the
-        // file name to the caller
+    std::unique_lock lock(s.mutex);
+    auto it = s.files.find(hash);
+    if (it == s.files.end()) {
+        // Another process might have created the entry since we last looked
+        lock.unlock();
+        syncJournal();
+        lock.lock();
+        it = s.files.find(hash);
+    }
+    if (it != s.files.end()) {
         const std::string& cachedFileName = it->second.file;
-        FileSys.deleteFile(cachedFileName);
-        _files.erase(it);
+        if (FileSys.fileExists(cachedFileName)) {
+            FileSys.deleteFile(cachedFileName);
+        }
+        if (it->second.isPersistent) {
+            journalRemove(hash);
+        }
+        s.files.erase(it);
+    }
+    lock.unlock();
+    compactJournalIfNecessary();
+}
+
+void CacheManager::setSizeLimit(uint64_t bytes, EvictionPolicy policy) {
+    {
+        std::lock_guard lock(_evictionMutex);
+        _sizeLimit = bytes;
+        _evictionPolicy = policy;
+        _evictionRequested = true;
+    }
+    if (bytes > 0 && !_evictionThread.joinable()) {
+        _evictionThread = std::thread(&CacheManager::evictionThread, this);
+    }
+    _evictionCondition.notify_one();
+}
+
+uint64_t CacheManager::sizeLimit() const {
+    std::lock_guard lock(_evictionMutex);
+    return _sizeLimit;
+}
+
+void CacheManager::enforceSizeLimit() {
+    uint64_t limit;
+    EvictionPolicy policy;
+    {
+        std::lock_guard lock(_evictionMutex);
+        limit = _sizeLimit;
+        policy = _evictionPolicy;
+    }
+    if (limit == 0) {
+        return;
+    }
+
+    // The files that were cached by other processes count towards the limit as well and
+    // they should see our accesses when they evict files
+    flushAccesses();
+    syncJournal();
+
+    struct Candidate {
+        uint64_t hash;
+        std::string file;
+        int64_t lastAccess;
+        uint64_t nAccesses;
+        uint64_t size;
+    };
+    std::vector<Candidate> candidates;
+    for (const Shard& s : _shards) {
+        std::lock_guard lock(s.mutex);
+        for (const std::pair<const uint64_t, CacheInformation>& p : s.files) {
+            if (p.second.isPersistent) {
+                candidates.push_back(
+                    { p.first, p.second.file, p.second.lastAccess, p.second.nAccesses, 0 }
+                );
+            }
+        }
+    }
+
+    // Getting the file sizes is the expensive part, so we do that without holding the
+    // locks and instead check later whether the entry was used in the meantime
+    uint64_t totalSize = 0;
+    for (Candidate& c : candidates) {
+        c.size = fileSize(c.file);
+        totalSize += c.size;
+    }
+    if (totalSize <= limit) {
+        return;
+    }
+
+    std::sort(
+        candidates.begin(),
+        candidates.end(),
+        [policy](const Candidate& lhs, const Candidate& rhs) {
+            if (policy == EvictionPolicy::LeastFrequentlyUsed &&
+                lhs.nAccesses != rhs.nAccesses)
+            {
+                return lhs.nAccesses < rhs.nAccesses;
+            }
+            return lhs.lastAccess < rhs.lastAccess;
+        }
+    );
+
+    for (const Candidate& c : candidates) {
+        if (totalSize <= limit) {
+            break;
+        }
+
+        Shard& s = shard(c.hash);
+        std::lock_guard lock(s.mutex);
+        auto it = s.files.find(c.hash);
+        if (it == s.files.end() || it->second.lastAccess != c.lastAccess) {
+            // The entry was removed or requested again since we looked at it
+            continue;
+        }
+
+        LDEBUG(fmt::format("Evicting cached file '{}'", c.file));
+        if (FileSys.fileExists(c.file)) {
+            FileSys.deleteFile(c.file);
+        }
+        const std::string directory = c.file.substr(
+            0,
+            c.file.rfind(FileSystem::PathSeparator)
+        );
+        if (FileSys.directoryExists(directory) && FileSys.emptyDirectory(directory)) {
+            FileSys.deleteDirectory(directory);
+        }
+        journalRemove(c.hash);
+        s.files.erase(it);
+        totalSize -= c.size;
+    }
+    compactJournalIfNecessary();
+}
+
+CacheManager::Shard& CacheManager::shard(uint64_t hash) const {
+    return _shards[hash % NShards];
+}
+
+void CacheManager::touch(CacheInformation& info) {
+    using namespace std::chrono;
+    const int64_t now = duration_cast<microseconds>(
+        system_clock::now().time_since_epoch()
+    ).count();
+    // Make the access times unique so that the eviction order is well-defined
+    int64_t last = _lastAccess;
+    int64_t next;
+    do {
+        next = std::max(now, last + 1);
+    } while (!_lastAccess.compare_exchange_weak(last, next));
+    info.lastAccess = next;
+    ++info.nAccesses;
+}
+
+void CacheManager::evictionThread() {
+    std::unique_lock lock(_evictionMutex);
+    while (!_stopEviction) {
+        _evictionCondition.wait_for(
+            lock,
+            EvictionInterval,
+            [this]() { return _evictionRequested || _stopEviction; }
+        );
+        if (_stopEviction) {
+            break;
+        }
+        _evictionRequested = false;
+
+        lock.unlock();
+        try {
+            enforceSizeLimit();
+        }
+        catch (const ghoul::RuntimeError& e) {
+            LERRORC(e.component, e.message);
+        }
+        lock.lock();
+    }
+}
+
+void CacheManager::loadJournal(bool isOnlyUser) {
+    // In the cache state, we check our cache directory for all values, in a later step
+    // we remove all persistent values, so that only the non-persistent values remain
+    // Under normal operation, the resulting vector should be of size == 0, but if the
+    // last execution of the application crashed, the directory was not cleaned up
+    // properly. If other processes are using the directory, their non-persistent files
+    // would look the same, so we can only do this if we are the only user
+    std::vector<LoadedCacheInfo> cacheState;
+    if (isOnlyUser) {
+        cacheState = cacheInformationFromDirectory(_directory);
+    }
+
+    _journal = std::make_unique<CacheFileHandle>(journalPath());
+    std::vector<char> journal = _journal->read(0);
+
+    // An empty journal was just created by us and only has to be initialized
+    bool needsCompaction = journal.empty();
+    if (!journal.empty()) {
+        Header header;
+        const bool hasHeader = journal.size() >= sizeof(Header);
+        if (hasHeader) {
+            std::memcpy(&header, journal.data(), sizeof(Header));
+        }
+        const bool isValid = hasHeader &&
+            std::equal(std::begin(header.magic), std::end(header.magic), JournalMagic) &&
+            header.formatVersion == JournalVersion && header.version == _version;
+        if (!isValid) {
+            if (!isOnlyUser) {
+                throw ErrorLoadingCacheException(fmt::format(
+                    "Cache directory '{}' is used by another process with a different "
+                    "cache version", _directory.path()
+                ));
+            }
+
+            LINFO(fmt::format(
+                "Cache version has changed or the cache file is from an older version. "
+                "New version {}", _version
+            ));
+            // As the layout might have changed as well, we can't rely on the cache state
+            // and remove everything instead. The lock files have to stay, as other
+            // processes might already be waiting for them
+            for (const std::string& d : _directory.readDirectories()) {
+                FileSys.deleteDirectory(d, FileSystem::Recursive::Yes);
+            }
+            for (const std::string& f : _directory.read()) {
+                const std::string name = File(f).filename();
+                if (name != _journalLockFile && name != _usersLockFile) {
+                    FileSys.deleteFile(f);
+                }
+            }
+            cacheState.clear();
+            needsCompaction = true;
+        }
+        else {
+            const char* records = journal.data() + sizeof(Header);
+            const size_t size = journal.size() - sizeof(Header);
+            size_t nRecords = 0;
+            const size_t valid = validRecordsSize(records, size, nRecords);
+            if (valid != size) {
+                // A process crashed while writing the last record
+                LINFO("Discarding incomplete record at the end of the cache file");
+                needsCompaction = true;
+            }
+            applyJournal(records, valid, false, false);
+
+            size_t nFiles = 0;
+            for (const Shard& s : _shards) {
+                nFiles += s.files.size();
+            }
+            _nJournalRecords = nRecords;
+            needsCompaction |=
+                nRecords > std::max(MinCompactionRecords, CompactionFactor * nFiles);
+        }
+    }
+
+    // All files that remain in the cache state that are not registered as persistent
+    // entries in the journal are left from a previous crash of the application
+    cacheState.erase(
+        std::remove_if(
+            cacheState.begin(),
+            cacheState.end(),
+            [this](const LoadedCacheInfo& i) {
+                const Shard& s = shard(i.first);
+                auto it = s.files.find(i.first);
+                return it != s.files.end() && it->second.file == i.second;
+            }
+        ),
+        cacheState.end()
+    );
+    if (!cacheState.empty()) {
+        LINFO("There was a crash in the previous run and it left the cache unclean. "
+              "Cleaning it now");
+        for (const LoadedCacheInfo& cache : cacheState) {
+            LINFO(fmt::format("Deleting file '{}'", cache.second));
+            FileSys.deleteFile(cache.second);
+        }
+        cleanDirectory(_directory);
+    }
+
+    if (needsCompaction) {
+        writeCompactedJournal();
+    }
+    else {
+        _journalOffset = journal.size();
+    }
+}
+
+std::string CacheManager::journalPath() const {
+    return FileSys.pathByAppendingComponent(_directory, _cacheFile);
+}
+
+void CacheManager::applyJournal(const char* data, size_t size, bool shardsLocked,
+                                bool isSnapshot) const
+{
+    ghoul_assert(!isSnapshot || shardsLocked, "Snapshots require locked shards");
+
+    if (isSnapshot) {
+        // The snapshot contains all persistent entries, so the ones that are missing
+        // from it were removed by another process
+        for (Shard& s : _shards) {
+            for (auto it = s.files.begin(); it != s.files.end();) {
+                it = it->second.isPersistent ? s.files.erase(it) : std::next(it);
+            }
+        }
+    }
+
+    const std::string directory = _directory.path() + FileSystem::PathSeparator;
+    const char* end = data + size;
+    while (data != end) {
+        uint32_t payloadSize = 0;
+        uint32_t checksum = 0;
+        extract(data, end, payloadSize);
+        extract(data, end, checksum);
+        const char* payload = data;
+        const char* payloadEnd = data + payloadSize;
+        data = payloadEnd;
+
+        uint8_t type;
+        uint64_t writer;
+        uint64_t hash;
+        const bool success = extract(payload, payloadEnd, type) &&
+            extract(payload, payloadEnd, writer) && extract(payload, payloadEnd, hash);
+        if (!success || (!isSnapshot && writer == _instanceId)) {
+            // Our own records are already reflected in the cache entries
+            continue;
+        }
+
+        Shard& s = shard(hash);
+        std::unique_lock lock(s.mutex, std::defer_lock);
+        if (!shardsLocked) {
+            lock.lock();
+        }
+        switch (static_cast<RecordType>(type)) {
+            case RecordType::Add:
+            {
+                CacheInformation info;
+                uint32_t pathLength;
+                const bool isComplete = extract(payload, payloadEnd, info.lastAccess) &&
+                    extract(payload, payloadEnd, info.nAccesses) &&
+                    extract(payload, payloadEnd, pathLength) &&
+                    static_cast<size_t>(payloadEnd - payload) == pathLength;
+                if (isComplete) {
+                    info.file = directory + std::string(payload, pathLength);
+                    info.isPersistent = true;
+                    raiseTo(_lastAccess, info.lastAccess);
+                    s.files[hash] = std::move(info);
+                }
+                break;
+            }
+            case RecordType::Access:
+            {
+                auto it = s.files.find(hash);
+                if (it != s.files.end()) {
+                    extract(payload, payloadEnd, it->second.lastAccess);
+                    extract(payload, payloadEnd, it->second.nAccesses);
+                    raiseTo(_lastAccess, it->second.lastAccess);
+                }
+                break;
+            }
+            case RecordType::Remove:
+                s.files.erase(hash);
+                break;
+            default:
+                break;
+        }
     }
 }
 
+void CacheManager::readJournalTail(bool isLocked) const {
+    const std::string path = journalPath();
+    if (CacheFileHandle::identity(path) != _journal->identity()) {
+        // Another process has compacted the journal and replaced the file. The new
+        // journal contains all persistent entries and has to be read from the beginning
+        auto journal = std::make_unique<CacheFileHandle>(path);
+        if (journal->size() < sizeof(Header)) {
+            if (!isLocked) {
+                // The journal is being created or was deleted from outside. Only the
+                // next write, which holds the lock, can start a new journal
+                return;
+            }
+            journal->truncate(0);
+            journal->append(headerData(_version));
+        }
+        _journal = std::move(journal);
+        _journalOffset = sizeof(Header);
+        _pendingRecords.clear();
+        _pendingIsSnapshot = true;
+        _nJournalRecords = 0;
+    }
+
+    std::vector<char> tail = _journal->read(_journalOffset);
+    size_t nRecords = 0;
+    const size_t valid = validRecordsSize(tail.data(), tail.size(), nRecords);
+    if (valid != tail.size() && isLocked) {
+        // A process crashed while writing a record. As we are holding the lock, nobody
+        // else can be writing to the journal right now. Without the lock, the record
+        // might still be being written and is read once it is complete
+        LINFO("Discarding incomplete record at the end of the cache file");
+        _journal->truncate(_journalOffset + valid);
+    }
+    _pendingRecords.insert(_pendingRecords.end(), tail.begin(), tail.begin() + valid);
+    _journalOffset += valid;
+    _nJournalRecords += nRecords;
+}
+
+void CacheManager::syncJournal() const {
+    std::lock_guard syncLock(_syncMutex);
+
+    std::vector<char> records;
+    bool isSnapshot;
+    {
+        // Reading the records does not need the lock for the journal, as records are
+        // only appended and are only accepted once they are complete
+        std::lock_guard lock(_journalMutex);
+        readJournalTail(false);
+        isSnapshot = _pendingIsSnapshot;
+        if (!isSnapshot) {
+            records.swap(_pendingRecords);
+        }
+    }
+
+    if (!isSnapshot) {
+        applyJournal(records.data(), records.size(), false, false);
+        return;
+    }
+
+    // A snapshot replaces all persistent entries, so no other thread must be able to
+    // write a record between reading the journal and applying it
+    std::array<std::unique_lock<std::mutex>, NShards> shardLocks;
+    for (size_t i = 0; i < NShards; ++i) {
+        shardLocks[i] = std::unique_lock(_shards[i].mutex);
+    }
+    std::lock_guard lock(_journalMutex);
+    readJournalTail(false);
+    applyJournal(
+        _pendingRecords.data(),
+        _pendingRecords.size(),
+        true,
+        _pendingIsSnapshot
+    );
+    _pendingRecords.clear();
+    _pendingIsSnapshot = false;
+}
+
+void CacheManager::journalAdd(uint64_t hash, const CacheInformation& info) {
+    // The paths are stored relative to the cache directory
+    const std::string relative = info.file.substr(_directory.path().size() + 1);
+    writeToJournal(
+        addRecord(_instanceId, hash, info.lastAccess, info.nAccesses, relative)
+    );
+}
+
+void CacheManager::flushAccesses() {
+    std::vector<uint64_t> hashes;
+    {
+        std::lock_guard lock(_accessMutex);
+        hashes.swap(_pendingAccesses);
+    }
+    std::sort(hashes.begin(), hashes.end());
+    hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+
+    std::vector<char> records;
+    size_t nRecords = 0;
+    for (uint64_t hash : hashes) {
+        const Shard& s = shard(hash);
+        std::lock_guard lock(s.mutex);
+        auto it = s.files.find(hash);
+        if (it == s.files.end() || !it->second.isPersistent) {
+            // The entry was removed in the meantime
+            continue;
+        }
+        appendRecord(
+            records,
+            accessRecord(_instanceId, hash, it->second.lastAccess, it->second.nAccesses)
+        );
+        ++nRecords;
+    }
+    if (nRecords > 0) {
+        writeRecordsToJournal(records, nRecords);
+    }
+}
+
+void CacheManager::journalRemove(uint64_t hash) {
+    writeToJournal(removeRecord(_instanceId, hash));
+}
+
+void CacheManager::writeToJournal(const std::vector<char>& payload) {
+    std::vector<char> record;
+    appendRecord(record, payload);
+    writeRecordsToJournal(record, 1);
+}
+
+void CacheManager::writeRecordsToJournal(const std::vector<char>& records,
+                                         size_t nRecords)
+{
+    std::lock_guard lock(_journalMutex);
+    FileLock fileLock(*_journalLock);
+    try {
+        // The records of other processes have to be read first so that the offset
+        // points behind our record afterwards. They are applied the next time we sync
+        readJournalTail(true);
+
+        // Every record is written in full so that another crash can at most lose the
+        // last record, which is detected by its checksum
+        _journal->append(records);
+    }
+    catch (const CacheException& e) {
+        LERROR(e.message);
+        return;
+    }
+
+    _journalOffset += records.size();
+    _nJournalRecords += nRecords;
+    if (_pendingIsSnapshot) {
+        // A pending snapshot replaces all persistent entries, so it has to include our
+        // own records that were written after it
+        _pendingRecords.insert(_pendingRecords.end(), records.begin(), records.end());
+    }
+}
+
+void CacheManager::compactJournalIfNecessary() {
+    if (_nJournalRecords <= MinCompactionRecords) {
+        return;
+    }
+
+    size_t nFiles = 0;
+    for (const Shard& s : _shards) {
+        std::lock_guard lock(s.mutex);
+        nFiles += s.files.size();
+    }
+    if (_nJournalRecords > CompactionFactor * nFiles) {
+        try {
+            compactJournal();
+        }
+        catch (const CacheException& e) {
+            // The journal is still valid, it just keeps growing until the next attempt
+            LERROR(e.message);
+        }
+    }
+}
+
+void CacheManager::compactJournal() {
+    std::lock_guard syncLock(_syncMutex);
+    std::array<std::unique_lock<std::mutex>, NShards> shardLocks;
+    for (size_t i = 0; i < NShards; ++i) {
+        shardLocks[i] = std::unique_lock(_shards[i].mutex);
+    }
+    std::lock_guard lock(_journalMutex);
+    FileLock fileLock(*_journalLock);
+
+    // The records of other processes have to be part of the compacted journal
+    readJournalTail(true);
+    applyJournal(
+        _pendingRecords.data(),
+        _pendingRecords.size(),
+        true,
+        _pendingIsSnapshot
+    );
+    _pendingRecords.clear();
+    _pendingIsSnapshot = false;
+
+    writeCompactedJournal();
+}
+
+void CacheManager::writeCompactedJournal() {
+    // The compacted journal contains the current access information of all entries
+    {
+        std::lock_guard lock(_accessMutex);
+        _pendingAccesses.clear();
+    }
+
+    std::vector<char> data = headerData(_version);
+    size_t nRecords = 0;
+    for (const Shard& s : _shards) {
+        for (const std::pair<const uint64_t, CacheInformation>& p : s.files) {
+            if (p.second.isPersistent) {
+                const std::string relative = p.second.file.substr(
+                    _directory.path().size() + 1
+                );
+                appendRecord(
+                    data,
+                    addRecord(
+                        _instanceId,
+                        p.first,
+                        p.second.lastAccess,
+                        p.second.nAccesses,
+                        relative
+                    )
+                );
+                ++nRecords;
+            }
+        }
+    }
+
+    // The compacted journal is written into a new file which then atomically replaces
+    // the old journal. This way, a crash during the compaction leaves either the old or
+    // the new journal intact. Other processes notice the replacement the next time they
+    // access the journal
+    const std::string path = journalPath();
+    const std::string temporary = path + ".tmp";
+    writeFileDurably(temporary, data);
+    _journal = nullptr;
+    try {
+        replaceFile(temporary, path);
+    }
+    catch (const CacheException&) {
+        _journal = std::make_unique<CacheFileHandle>(path);
+        throw;
+    }
+
+    _journal = std::make_unique<CacheFileHandle>(path);
+    _journalOffset = data.size();
+    _nJournalRecords = nRecords;
+}
+
 void CacheManager::cleanDirectory(const Directory& dir) const {
     // First search for all subdirectories and call this function recursively on them
     std::vector<std::string> contents = dir.readDirectories();
@@ -327,44 +1557,46 @@ std::vector<CacheManager::LoadedCacheInfo> CacheManager::cacheInformationFromDir
                                                                const Directory& dir) const
 {
     std::vector<LoadedCacheInfo> result;
-    std::vector<std::string> directories = dir.readDirectories();
-    for (const std::string& directory : directories) {
-        Directory d(directory);
-
-        // Extract the name of the directory
-        // +1 as the last path delimiter is missing from the path
-        std::string directoryName = directory.substr(dir.path().size() + 1);
 
-        std::vector<std::string> hashes = d.readDirectories();
-        for (const std::string& hash : hashes) {
-            // Extract the hash from the directory name
+    Directory::WalkOptions options;
+    options.includeDirectories = false;
+    dir.walk(
+        [&](const std::string& path, bool) {
             // +1 as the last path delimiter is missing from the path
-            std::string hashName = hash.substr(d.path().size() + 1);
+            const std::string relative = path.substr(dir.path().size() + 1);
 
-            std::vector<std::string> files = Directory(hash).readFiles();
-            // Cache directories should only contain a single file with the
-            // same name as the directory
-            if (files.size() > 1) {
-                throw ErrorLoadingCacheException(fmt::format(
-                    "Directory '{}' contained more than one file", hash
-                ));
+            std::vector<std::string> components;
+            size_t begin = 0;
+            size_t end = relative.find(FileSystem::PathSeparator);
+            while (end != std::string::npos) {
+                components.push_back(relative.substr(begin, end - begin));
+                begin = end + 1;
+                end = relative.find(FileSystem::PathSeparator, begin);
             }
-            if (files.size() == 1) {
-                // Extract the file name from the full path
-                // +1 as the last path delimiter is missing from the path
-                std::string filename = files[0].substr(Directory(hash).path().size() + 1);
-                if (filename != directoryName) {
-                    throw ErrorLoadingCacheException(fmt::format(
-                        "File contained in cache directory '{}' contains a file with "
-                        "name '{}' instead of expected '{}'",
-                        hash, filename, directoryName
-                    ));
-                }
+            components.push_back(relative.substr(begin));
 
-                result.emplace_back(std::stoul(hashName), files[0]);
+            if (components.size() == 1) {
+                // Files in the root directory, like the cache file, are not cache entries
+                return;
             }
-        }
-    }
+
+            // Cache entries are stored as <shard>/<shard>/<hash>/<file>. Anything else
+            // is left over from a previous layout and is returned with a hash of 0 so
+            // that it does not match any entry and gets removed
+            uint64_t hash = 0;
+            const std::string& hashName = components.size() == 4 ? components[2] : "";
+            const bool isNumber = !hashName.empty() && std::all_of(
+                hashName.begin(),
+                hashName.end(),
+                [](char c) { return c >= '0' && c <= '9'; }
+            );
+            if (isNumber) {
+                hash = std::stoull(hashName);
+            }
+            result.emplace_back(hash, path);
+        },
+        options
+    );
 
     return result;
 }
@@ -26,13 +26,26 @@
 #include <ghoul/filesystem/directory.h>
 
 #include <ghoul/filesystem/filesystem.h>
+#include <ghoul/misc/assert.h>
+#include <ghoul/misc/defer.h>
+#include <ghoul/misc/threadpool.h>
 #include <algorithm>
-#include <stack>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string_view>
 
 #ifdef WIN32
 #include <windows.h>
 #include <tchar.h>
 #include <direct.h>
+#elif defined(__linux__)
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 #else
 #include <stdio.h>
 #include <unistd.h>
@@ -43,6 +56,254 @@
 using std::string;
 using std::vector;
 
+namespace {
+    using ghoul::filesystem::Directory;
+
+#ifdef __linux__
+    /// The layout of the entries that are returned by the getdents64 system call
+    struct Dirent64 {
+        uint64_t d_ino;
+        int64_t d_off;
+        unsigned short d_reclen;
+        unsigned char d_type;
+        char d_name[1];
+    };
+#endif // __linux__
+
+    bool isDotEntry(const char* name) {
+        return name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'));
+    }
+
+    /**
+     * Calls the function \p f with the name of each entry in the directory at \p path and
+     * whether the entry is a directory. The <code>.</code> and <code>..</code> entries
+     * are not reported. Directories that cannot be opened are silently ignored.
+     */
+    template <typename Func>
+    void listDirectory(const string& path, Func&& f) {
+#ifdef WIN32
+        WIN32_FIND_DATA findFileData = {0};
+        const string directory = path + "\\*";
+
+        HANDLE findHandle = FindFirstFile(directory.c_str(), &findFileData);
+        if (findHandle == INVALID_HANDLE_VALUE) { // NOLINT
+            return;
+        }
+        // The callback might throw
+        defer { FindClose(findHandle); };
+        do {
+            if (!isDotEntry(findFileData.cFileName)) {
+                const DWORD isDir =
+                    findFileData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY;
+                f(std::string_view(findFileData.cFileName), isDir != 0);
+            }
+        } while (FindNextFile(findHandle, &findFileData) != 0);
+#elif defined(__linux__)
+        const int fd = openat(AT_FDCWD, path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0) {
+            return;
+        }
+        // The callback might throw
+        defer { close(fd); };
+
+        // Reading the directory in large batches keeps the number of system calls low
+        // even for directories with many thousand entries
+        alignas(Dirent64) char buffer[32 * 1024];
+        while (true) {
+            const long nBytes = syscall(SYS_getdents64, fd, buffer, sizeof(buffer));
+            if (nBytes <= 0) {
+                break;
+            }
+            for (long offset = 0; offset < nBytes;) {
+                const Dirent64* entry = reinterpret_cast<const Dirent64*>(
+                    buffer + offset
+                );
+                offset += entry->d_reclen;
+
+                const char* name = entry->d_name;
+                if (isDotEntry(name)) {
+                    continue;
+                }
+
+                bool isDir = (entry->d_type == DT_DIR);
+                if (entry->d_type == DT_UNKNOWN) {
+                    // Some filesystems do not provide the type in the listing
+                    struct stat st;
+                    isDir = fstatat(fd, name, &st, AT_SYMLINK_NOFOLLOW) == 0 &&
+                            S_ISDIR(st.st_mode);
+                }
+                f(std::string_view(name), isDir);
+            }
+        }
+#else
+        DIR* dir = opendir(path.c_str());
+        if (!dir) {
+            return;
+        }
+        // The callback might throw
+        defer { closedir(dir); };
+        while (struct dirent* ent = readdir(dir)) {
+            if (!isDotEntry(ent->d_name)) {
+                f(std::string_view(ent->d_name), ent->d_type == DT_DIR);
+            }
+        }
+#endif
+    }
+
+    /// Returns whether the \p name matches the glob \p pattern containing * and ?
+    bool matchesPattern(std::string_view name, std::string_view pattern) {
+        size_t n = 0;
+        size_t p = 0;
+        // The positions to return to if the current attempt of matching a * fails
+        size_t starPattern = std::string_view::npos;
+        size_t starName = 0;
+        while (n < name.size()) {
+            if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n])) {
+                ++n;
+                ++p;
+            }
+            else if (p < pattern.size() && pattern[p] == '*') {
+                starPattern = p++;
+                starName = n;
+            }
+            else if (starPattern != std::string_view::npos) {
+                p = starPattern + 1;
+                n = ++starName;
+            }
+            else {
+                return false;
+            }
+        }
+        while (p < pattern.size() && pattern[p] == '*') {
+            ++p;
+        }
+        return p == pattern.size();
+    }
+
+    bool matchesExtension(std::string_view name, const vector<string>& extensions) {
+        const size_t dot = name.rfind('.');
+        if (dot == std::string_view::npos) {
+            return false;
+        }
+        const std::string_view extension = name.substr(dot + 1);
+        return std::find(extensions.begin(), extensions.end(), extension) !=
+               extensions.end();
+    }
+
+    /// The state that is shared between all threads participating in a Directory::walk
+    struct WalkState {
+        const Directory::WalkCallback* callback;
+        const Directory::WalkOptions* options;
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        /// The directories that have been found but not been listed yet
+        vector<string> pending;
+        /// The number of directories that are currently being listed
+        int nActive = 0;
+        /// The first exception that was thrown during the walk, which aborts the walk
+        std::exception_ptr exception;
+    };
+
+    /**
+     * Lists the directory at \p path, reports all of its entries that pass the filters,
+     * and adds the subdirectories to the \p subdirectories list if the walk is recursive
+     */
+    void walkDirectory(const WalkState& state, const string& path,
+                       vector<string>& subdirectories)
+    {
+        using ghoul::filesystem::FileSystem;
+        const Directory::WalkOptions& options = *state.options;
+
+        // All entries reuse the same string for their path to prevent allocations
+        string entryPath = path;
+        if (entryPath.empty() || entryPath.back() != FileSystem::PathSeparator) {
+            entryPath += FileSystem::PathSeparator;
+        }
+        const size_t basePathLength = entryPath.size();
+
+        listDirectory(path, [&](std::string_view name, bool isDirectory) {
+            entryPath.resize(basePathLength);
+            entryPath.append(name);
+
+            if (isDirectory && options.recursive) {
+                subdirectories.push_back(entryPath);
+            }
+
+            const bool isIncluded =
+                isDirectory ? options.includeDirectories : options.includeFiles;
+            if (!isIncluded) {
+                return;
+            }
+            if (!isDirectory && !options.extensions.empty() &&
+                !matchesExtension(name, options.extensions))
+            {
+                return;
+            }
+            if (!options.pattern.empty() && !matchesPattern(name, options.pattern)) {
+                return;
+            }
+            (*state.callback)(entryPath, isDirectory);
+        });
+    }
+
+    /**
+     * Takes directories from the list of pending directories and walks them until all
+     * directories have been processed. This function is executed by the calling thread
+     * and every participating worker of the ThreadPool.
+     */
+    void processPendingDirectories(WalkState& state) {
+        vector<string> subdirectories;
+        std::unique_lock lock(state.mutex);
+        while (true) {
+            if (!state.pending.empty()) {
+                string path = std::move(state.pending.back());
+                state.pending.pop_back();
+                ++state.nActive;
+                lock.unlock();
+
+                subdirectories.clear();
+                std::exception_ptr exception;
+                try {
+                    walkDirectory(state, path, subdirectories);
+                }
+                catch (...) {
+                    // The active count has to be decreased regardless or the other
+                    // threads would wait for this directory forever
+                    exception = std::current_exception();
+                }
+
+                lock.lock();
+                --state.nActive;
+                if (exception && !state.exception) {
+                    state.exception = exception;
+                }
+                if (state.exception) {
+                    // Once the walk has failed, no further directories are listed
+                    state.pending.clear();
+                    subdirectories.clear();
+                }
+                const bool hasNewWork = !subdirectories.empty();
+                std::move(
+                    subdirectories.begin(),
+                    subdirectories.end(),
+                    std::back_inserter(state.pending)
+                );
+                if (hasNewWork || state.nActive == 0) {
+                    state.cv.notify_all();
+                }
+            }
+            else if (state.nActive == 0) {
+                // Nothing is pending and no one else can produce more work
+                return;
+            }
+            else {
+                state.cv.wait(lock);
+            }
+        }
+    }
+} // namespace
+
 namespace ghoul::filesystem {
 
 Directory::Directory() : _directoryPath(FileSys.absolutePath(".")) {}
@@ -94,9 +355,22 @@ Directory Directory::parentDirectory([[maybe_unused]] AbsolutePath absolutePath)
 }
 
 vector<string> Directory::read(Recursive recursiveSearch, Sort sort) const {
+    // Directories are listed before files, but both are collected in the same pass
     vector<string> result;
-    internalReadDirectories(result, _directoryPath, recursiveSearch);
-    internalReadFiles(result, _directoryPath, recursiveSearch);
+    vector<string> files;
+    WalkOptions options;
+    options.recursive = recursiveSearch;
+    walk(
+        [&result, &files](const string& path, bool isDirectory) {
+            (isDirectory ? result : files).push_back(path);
+        },
+        options
+    );
+    result.insert(
+        result.end(),
+        std::make_move_iterator(files.begin()),
+        std::make_move_iterator(files.end())
+    );
     if (sort) {
         std::sort(result.begin(), result.end());
     }
@@ -105,114 +379,54 @@ vector<string> Directory::read(Recursive recursiveSearch, Sort sort) const {
 
 vector<string> Directory::readFiles(Recursive recursiveSearch, Sort sort) const {
     vector<string> result;
-    internalReadFiles(result, _directoryPath, recursiveSearch);
+    WalkOptions options;
+    options.recursive = recursiveSearch;
+    options.includeDirectories = false;
+    walk([&result](const string& path, bool) { result.push_back(path); }, options);
     if (sort) {
         std::sort(result.begin(), result.end());
     }
     return result;
 }
 
-void Directory::internalReadFiles(vector<string>& result, const string& path,
-                                  Recursive recursiveSearch) const
-{
-    std::stack<string> directories;
-#ifdef WIN32
-    WIN32_FIND_DATA findFileData = {0};
-    string directory = path + "\\*";
-
-    HANDLE findHandle = FindFirstFile(directory.c_str(), &findFileData);
-    if (findHandle != INVALID_HANDLE_VALUE) { // NOLINT
-        do {
-            string file(findFileData.cFileName);
-            const DWORD isDir = findFileData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY;
-            if (!isDir) {
-                result.push_back(path + "\\" + file);
-            }
-            if (recursiveSearch && isDir && (file != ".") && (file != "..")) {
-                directories.push(path + "\\" + file);
-            }
-        } while (FindNextFile(findHandle, &findFileData) != 0);
-    }
-    FindClose(findHandle);
-#else
-    DIR* dir = opendir(path.c_str());
-    struct dirent* ent;
-    if (dir) {
-        string name;
-        while ((ent = readdir(dir))) {
-            name = ent->d_name;
-            if ((name != ".") && (name != "..")) {
-                if (ent->d_type != DT_DIR) {
-                    result.push_back(path + "/" + ent->d_name);
-                }
-                if (recursiveSearch && (ent->d_type == DT_DIR)) {
-                    directories.push(path + "/" + ent->d_name);
-                }
-            }
-        }
-        closedir(dir);
-    }
-#endif
-    while (!directories.empty()) {
-        const string& d = directories.top();
-        internalReadFiles(result, d, recursiveSearch);
-        directories.pop();
-    }
-}
-
 vector<string> Directory::readDirectories(Recursive recursiveSearch, Sort sort) const {
-    std::vector<std::string> result;
-    internalReadDirectories(result, _directoryPath, recursiveSearch);
+    vector<string> result;
+    WalkOptions options;
+    options.recursive = recursiveSearch;
+    options.includeFiles = false;
+    walk([&result](const string& path, bool) { result.push_back(path); }, options);
     if (sort) {
         std::sort(result.begin(), result.end());
     }
     return result;
 }
 
-void Directory::internalReadDirectories(vector<string>& result, const string& path,
-                                        Recursive recursiveSearch) const
+void Directory::walk(const WalkCallback& callback, const WalkOptions& options,
+                     ThreadPool* threadPool) const
 {
-    std::stack<string> directories;
+    ghoul_assert(callback, "Callback must not be empty");
 
-#ifdef WIN32
-    WIN32_FIND_DATA findFileData = {0};
-    std::string directory = path + "\\*";
+    // The state is shared with the tasks in the ThreadPool. A task might only start
+    // after the walk has finished, in which case it returns immediately but still needs
+    // the state to be alive
+    std::shared_ptr<WalkState> state = std::make_shared<WalkState>();
+    state->callback = &callback;
+    state->options = &options;
+    state->pending.push_back(_directoryPath);
 
-    HANDLE findHandle = FindFirstFile(directory.c_str(), &findFileData);
-    if (findHandle != INVALID_HANDLE_VALUE) { // NOLINT
-        do {
-            string file(findFileData.cFileName);
-            const DWORD isDir = findFileData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY;
-            if (isDir && (file != ".") && (file != "..")) {
-                result.push_back(path + "\\" + file);
-                if (recursiveSearch) {
-                    directories.push(path + "\\" + file);
-                }
-            }
-        } while (FindNextFile(findHandle, &findFileData) != 0);
-    }
-    FindClose(findHandle);
-#else
-    DIR* dir = opendir(path.c_str());
-    struct dirent* ent;
-    if (dir) {
-        string name;
-        while ((ent = readdir(dir))) {
-            name = ent->d_name;
-            if ((ent->d_type == DT_DIR) && (name != ".") && (name != "..")) {
-                result.push_back(path + "/" + ent->d_name);
-                if (recursiveSearch) {
-                    directories.push(path + "/" + ent->d_name);
-                }
-            }
+    if (threadPool && options.recursive) {
+        for (int i = 0; i < threadPool->size(); ++i) {
+            threadPool->queue([state]() { processPendingDirectories(*state); });
         }
-        closedir(dir);
     }
-#endif
-    while (!directories.empty()) {
-        const string& d = directories.top();
-        internalReadDirectories(result, d, recursiveSearch);
-        directories.pop();
+
+    // The calling thread participates as well, which guarantees progress even if all
+    // workers of the ThreadPool are busy with other tasks
+    processPendingDirectories(*state);
+
+    // At this point, no other thread is listing a directory anymore
+    if (state->exception) {
+        std::rethrow_exception(state->exception);
     }
 }
 
@@ -0,0 +1,137 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2020                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <ghoul/filesystem/filesource.h>
+
+#include <ghoul/fmt.h>
+#include <ghoul/filesystem/file.h>
+#include <ghoul/filesystem/filesystem.h>
+#include <ghoul/filesystem/mappedfile.h>
+#include <ghoul/misc/assert.h>
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+#include <utility>
+
+namespace ghoul::filesystem {
+
+FileContents::FileContents(std::shared_ptr<const void> owner, const char* data,
+                           size_t size)
+    : _owner(std::move(owner))
+    , _data(data)
+    , _size(size)
+{
+    ghoul_assert(_data || _size == 0, "Data must not be nullptr");
+}
+
+FileContents::FileContents(std::string contents) {
+    auto owner = std::make_shared<const std::string>(std::move(contents));
+    _data = owner->data();
+    _size = owner->size();
+    _owner = std::move(owner);
+}
+
+const char* FileContents::data() const {
+    return _data;
+}
+
+size_t FileContents::size() const {
+    return _size;
+}
+
+bool FileContents::empty() const {
+    return _size == 0;
+}
+
+std::string_view FileContents::view() const {
+    return std::string_view(_data, _size);
+}
+
+FileSource::FileSourceException::FileSourceException(std::string f, std::string msg)
+    : RuntimeError(fmt::format("Error reading file '{}': {}", f, msg), "FileSource")
+    , file(std::move(f))
+{}
+
+DirectorySource::DirectorySource(std::string directory)
+    : _directory(FileSys.absolutePath(std::move(directory)))
+{
+    ghoul_assert(FileSys.directoryExists(_directory), "Directory must exist");
+
+    while (_directory.size() > 1 && (_directory.back() == '/' ||
+           _directory.back() == FileSystem::PathSeparator))
+    {
+        _directory.pop_back();
+    }
+}
+
+// The FileSystem is not used to check for files as it would consult the mount points
+// first, which recurses infinitely if this directory is inside its own mount point
+
+bool DirectorySource::hasFile(std::string_view path) const {
+    std::error_code error;
+    return std::filesystem::is_regular_file(fullPath(path), error);
+}
+
+bool DirectorySource::hasDirectory(std::string_view path) const {
+    std::error_code error;
+    return std::filesystem::is_directory(fullPath(path), error);
+}
+
+FileContents DirectorySource::read(std::string_view path) const {
+    try {
+        auto file = std::make_shared<const MappedFile>(fullPath(path));
+        const char* data = file->data();
+        const size_t size = file->size();
+        return FileContents(std::move(file), data, size);
+    }
+    catch (const MappedFile::MappedFileException& e) {
+        throw FileSourceException(std::string(path), e.message);
+    }
+}
+
+std::vector<std::string> DirectorySource::files() const {
+    const Directory directory(_directory, Directory::RawPath::Yes);
+    std::vector<std::string> result = directory.readFiles(Directory::Recursive::Yes);
+    for (std::string& f : result) {
+        f = FileSys.convertPathSeparator(
+            f.substr(_directory.size() + 1),
+            '/'
+        );
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+std::string DirectorySource::fullPath(std::string_view path) const {
+    std::string result = _directory;
+    result.reserve(result.size() + path.size() + 1);
+    result += FileSystem::PathSeparator;
+    for (char c : path) {
+        result += (c == '/') ? FileSystem::PathSeparator : c;
+    }
+    return result;
+}
+
+} // namespace ghoul::filesystem
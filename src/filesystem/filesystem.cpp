@@ -28,11 +28,13 @@
 #include <ghoul/fmt.h>
 #include <ghoul/filesystem/cachemanager.h>
 #include <ghoul/filesystem/file.h>
+#include <ghoul/filesystem/mappedfile.h>
 #include <ghoul/logging/logmanager.h>
 #include <ghoul/misc/assert.h>
 #include <ghoul/misc/profiling.h>
 #include <algorithm>
 #include <regex>
+#include <string_view>
 
 #ifdef WIN32
 #include <direct.h>
@@ -49,10 +51,6 @@
 #include <errno.h>
 #endif
 
-#if !defined(WIN32) && !defined(__APPLE__)
-#include <sys/inotify.h>
-#endif
-
 using std::string;
 using std::vector;
 
@@ -71,6 +69,47 @@ namespace {
     constexpr size_t TokenClosingBracesSize = constLength(
         ghoul::filesystem::FileSystem::TokenClosingBraces
     );
+
+    // Once the cache of absolute paths grows beyond this size, it is cleared to prevent
+    // it from growing without bounds if a lot of unique paths are resolved
+    constexpr size_t MaxAbsolutePathCacheSize = 16384;
+
+    /**
+     * Removes all '.' and '..' components and duplicate separators from the absolute
+     * \p path without consulting the file system, as paths inside a mount point do not
+     * have to exist on disk. A trailing separator is preserved.
+     */
+    string lexicallyNormalPath(const string& path, char separator) {
+        vector<std::string_view> components;
+        size_t begin = 0;
+        while (begin < path.size()) {
+            size_t end = path.find(separator, begin);
+            if (end == string::npos) {
+                end = path.size();
+            }
+            const std::string_view component(path.data() + begin, end - begin);
+            if (component == "..") {
+                if (!components.empty()) {
+                    components.pop_back();
+                }
+            }
+            else if (!component.empty() && component != ".") {
+                components.push_back(component);
+            }
+            begin = end + 1;
+        }
+
+        string result;
+        result.reserve(path.size());
+        for (std::string_view component : components) {
+            result += separator;
+            result.append(component);
+        }
+        if (result.empty() || path.back() == separator) {
+            result += separator;
+        }
+        return result;
+    }
 } // namespace
 
 namespace ghoul::filesystem {
@@ -115,9 +154,7 @@ FileSystem::FileSystem() {
     }
 
 #if !defined(WIN32) && !defined(__APPLE__)
-    _inotifyHandle = inotify_init();
-    _keepGoing = true;
-    _t = std::thread(inotifyWatcher);
+    initializeInternalLinux();
 #endif
 }
 
@@ -153,6 +190,31 @@ FileSystem& FileSystem::ref() {
 
 string FileSystem::absolutePath(string path, const vector<string>& ignoredTokens) const {
     ghoul_assert(!path.empty(), "Path must not be empty");
+
+    // Paths with ignored tokens are rarely used, so they are not worth caching
+    const bool useCache = ignoredTokens.empty();
+    const uint64_t generation = _pathGeneration;
+    string unresolvedPath;
+    if (useCache) {
+        std::shared_lock lock(_absolutePathCacheMutex);
+        auto it = _absolutePathCache.find(path);
+        if (it != _absolutePathCache.end() && it->second.generation == generation) {
+            return it->second.path;
+        }
+        unresolvedPath = path;
+    }
+
+    auto cacheResult = [&](const string& result) {
+        if (!useCache) {
+            return;
+        }
+        std::unique_lock lock(_absolutePathCacheMutex);
+        if (_absolutePathCache.size() >= MaxAbsolutePathCacheSize) {
+            _absolutePathCache.clear();
+        }
+        _absolutePathCache[std::move(unresolvedPath)] = { generation, result };
+    };
+
     expandPathTokens(path, ignoredTokens);
 
     const int PathBufferSize = 4096;
@@ -173,11 +235,24 @@ string FileSystem::absolutePath(string path, const vector<string>& ignoredTokens
     else {
         path = buffer.data();
     }
+    cacheResult(path);
 #else
+    // Paths inside a mount point do not have to exist on disk, so trying to resolve them
+    // would only cost a number of failed lookups. The '..' components have to be
+    // resolved first, as they might lead out of the mount point
+    string relativePath;
+    const string normalized =
+        path.front() == PathSeparator ? lexicallyNormalPath(path, PathSeparator) : path;
+    if (path.front() == PathSeparator && findMount(normalized, relativePath)) {
+        cacheResult(normalized);
+        return normalized;
+    }
+
     bool hadTrailingSlash = path.back() == '/';
     if (!realpath(path.c_str(), buffer.data())) {
-        // Find the longest path that exists
-        string fullPath(path);
+        // Find the longest path that exists. A '..' cannot be resolved by the operating
+        // system if it follows a directory that does not exist
+        string fullPath(normalized);
         string::size_type match;
         string::size_type lastMatch = std::string::npos;
         while ((match = fullPath.rfind(PathSeparator, lastMatch - 1)) != string::npos) {
@@ -201,6 +276,9 @@ string FileSystem::absolutePath(string path, const vector<string>& ignoredTokens
     if (hadTrailingSlash) {
         path += "/";
     }
+    // Only paths that exist are cached as the result for the others might change once
+    // parts of the path are created
+    cacheResult(path);
 #endif
 
     return path;
@@ -330,9 +408,17 @@ void FileSystem::setCurrentDirectory(const Directory& directory) const {
         ));
     }
 #endif
+    // Relative paths are resolved against the current directory
+    ++_pathGeneration;
 }
 
 bool FileSystem::fileExists(const File& path) const {
+    string relativePath;
+    std::shared_ptr<const FileSource> source = findMount(path.path(), relativePath);
+    if (source && source->hasFile(relativePath)) {
+        return true;
+    }
+
 #ifdef WIN32
     BOOL exists = PathFileExists(path.path().c_str());
     if (exists == FALSE) {
@@ -389,6 +475,12 @@ bool FileSystem::fileExists(const File& path) const {
 }
 
 bool FileSystem::directoryExists(const Directory& path) const {
+    string relativePath;
+    std::shared_ptr<const FileSource> source = findMount(path.path(), relativePath);
+    if (source && source->hasDirectory(relativePath)) {
+        return true;
+    }
+
 #ifdef WIN32
     BOOL isDirectory = PathIsDirectory(path.path().c_str());
     return isDirectory == static_cast<BOOL>(FILE_ATTRIBUTE_DIRECTORY);
@@ -449,7 +541,7 @@ void FileSystem::createDirectory(const Directory& path, Recursive recursive) con
         BOOL success = CreateDirectory(path.path().c_str(), nullptr);
         if (!success) {
             DWORD error = GetLastError();
-            if (ERROR == ERROR_ALREADY_EXISTS) {
+            if (error == ERROR_ALREADY_EXISTS) {
                 return;
             }
             else {
@@ -564,11 +656,18 @@ void FileSystem::deleteDirectory(const Directory& path, Recursive recursive) con
             int statResult = stat(fullName.c_str(), &statbuf);
             if (statResult == 0) {
                 if (S_ISDIR(statbuf.st_mode)) {
-                    deleteDirectory(fullName);
+                    try {
+                        deleteDirectory(fullName, recursive);
+                    }
+                    catch (...) {
+                        closedir(directory);
+                        throw;
+                    }
                 }
                 else {
                     int removeSuccess = remove(fullName.c_str());
                     if (removeSuccess != 0) {
+                        closedir(directory);
                         throw FileSystemException(fmt::format(
                             "Error deleting file '{}' in directory '{}': {}",
                             fullName, path.path(), strerror(errno)
@@ -577,6 +676,7 @@ void FileSystem::deleteDirectory(const Directory& path, Recursive recursive) con
                 }
             }
             else {
+                closedir(directory);
                 throw FileSystemException(fmt::format(
                     "Error getting information about file '{}' in directory '{}': {}",
                     fullName, path.path(), strerror(errno)
@@ -644,88 +744,116 @@ void FileSystem::registerPathToken(string token, string path, Override override)
         }
     }
     _tokenMap[std::move(token)] = std::move(path);
+    buildTokenTrie();
+    ++_pathGeneration;
 }
 
 bool FileSystem::expandPathTokens(string& path, const vector<string>& ignoredTokens) const
 {
-    // TokenInformation = <token, beginning position, length>
-    struct TokenInformation {
-        string token;
-        string::size_type beginning;
-        string::size_type length;
-    };
-    auto nextToken = [ignoredTokens, &path]() -> TokenInformation {
-        string::size_type currentPosition = 0;
-        while (true) {
-            string::size_type beginning = path.find(TokenOpeningBraces, currentPosition);
-            string::size_type closing = path.find(
-                TokenClosingBraces, beginning + std::strlen(TokenOpeningBraces)
-            );
-            string::size_type closingLocation = closing + TokenClosingBracesSize;
+    string::size_type currentPosition = 0;
+    while (true) {
+        const string::size_type beginning = path.find(
+            TokenOpeningBraces,
+            currentPosition
+        );
+        if (beginning == string::npos) {
+            // There is no token left
+            break;
+        }
 
-            if (beginning == string::npos || closing == string::npos) {
+        const std::string* replacement = nullptr;
+        string::size_type length = matchToken(path, beginning, replacement);
+        if (length == 0) {
+            // Not a registered token, so we need the extent of the token to check whether
+            // it is ignored or to report it
+            const string::size_type closing = path.find(
+                TokenClosingBraces,
+                beginning + TokenOpeningBracesSize
+            );
+            if (closing == string::npos) {
                 // There is no token left
-                return { "", string::npos, 0 };
+                break;
             }
+            length = closing + TokenClosingBracesSize - beginning;
+        }
 
-            std::string currentToken = path.substr(
-                beginning,
-                closingLocation - beginning
+        if (!ignoredTokens.empty()) {
+            auto it = std::find_if(
+                ignoredTokens.begin(),
+                ignoredTokens.end(),
+                [&](const string& t) { return path.compare(beginning, length, t) == 0; }
             );
-
-            auto it = std::find(ignoredTokens.begin(), ignoredTokens.end(), currentToken);
             if (it != ignoredTokens.end()) {
                 // The found token is an ignored one
-                currentPosition = closingLocation;
+                currentPosition = beginning + length;
                 continue;
             }
-            else {
-                return { currentToken, beginning, closingLocation - beginning };
-            }
         }
-    };
 
-    while (true) {
-        TokenInformation tokenInformation = nextToken();
-        if (tokenInformation.token.empty()) {
-            break;
+        if (!replacement) {
+            throw ResolveTokenException(path.substr(beginning, length));
         }
 
-        const std::string& replacement = resolveToken(tokenInformation.token);
-        path.replace(
-            tokenInformation.beginning,
-            tokenInformation.length,
-            replacement
+        // The replacement might contain tokens itself, so we continue at the same place
+        path.replace(beginning, length, *replacement);
+        currentPosition = beginning;
+    }
+    return true;
+}
+
+size_t FileSystem::matchToken(const string& path, size_t begin,
+                              const string*& replacement) const
+{
+    // Walk down the prefix tree until the path no longer matches any token. A token ends
+    // at the first closing braces, so the first node that has a replacement is the only
+    // possible match
+    int node = 0;
+    for (size_t i = begin; i < path.size(); ++i) {
+        const std::vector<std::pair<char, int>>& children = _tokenTrie[node].children;
+        auto it = std::lower_bound(
+            children.begin(),
+            children.end(),
+            path[i],
+            [](const std::pair<char, int>& c, char v) { return c.first < v; }
         );
+        if (it == children.end() || it->first != path[i]) {
+            return 0;
+        }
+        node = it->second;
+        if (_tokenTrie[node].replacement) {
+            replacement = _tokenTrie[node].replacement;
+            return i - begin + 1;
+        }
     }
+    return 0;
+}
 
-    //while (containsToken(path)) {
-    //    string::size_type beginning = path.find(TokenOpeningBraces, currentPosition);
-    //    string::size_type closing = path.find(
-    //        TokenClosingBraces, beginning + TokenOpeningBraces.size()
-    //    );
-    //    string::size_type closingLocation = closing + TokenClosingBraces.size();
-    //    std::string currentToken = path.substr(beginning, closingLocation - beginning);
-
-    //    currentPosition = closingLocation;
-    //    auto it = std::find(ignoredTokens.begin(), ignoredTokens.end(), currentToken);
-    //    if (it != ignoredTokens.end()) {
-    //        // The token we have found has to be ignored
-    //        continue;
-    //    }
-    //    const std::string& replacement = resolveToken(currentToken);
-    //    if (replacement == currentToken) {
-    //        // replacement == currentToken will be true if the respective token could
-    //        // not be found;  resolveToken will print an error in that case
-    //        return false;
-    //    }
-    //    path.replace(
-    //        beginning,
-    //        closing + TokenClosingBraces.size() - beginning,
-    //        replacement
-    //    );
-    //}
-    return true;
+void FileSystem::buildTokenTrie() {
+    std::vector<TokenTrieNode> trie(1);
+    for (const std::pair<const string, string>& token : _tokenMap) {
+        int node = 0;
+        for (char c : token.first) {
+            std::vector<std::pair<char, int>>& children = trie[node].children;
+            auto it = std::lower_bound(
+                children.begin(),
+                children.end(),
+                c,
+                [](const std::pair<char, int>& v, char value) { return v.first < value; }
+            );
+            if (it != children.end() && it->first == c) {
+                node = it->second;
+            }
+            else {
+                const int newNode = static_cast<int>(trie.size());
+                children.insert(it, { c, newNode });
+                // Adding the node might invalidate the reference to the children
+                trie.emplace_back();
+                node = newNode;
+            }
+        }
+        trie[node].replacement = &token.second;
+    }
+    _tokenTrie = std::move(trie);
 }
 
 std::vector<string> FileSystem::tokens() const {
@@ -740,6 +868,105 @@ bool FileSystem::hasRegisteredToken(const string& token) const {
     return _tokenMap.find(token) != _tokenMap.end();
 }
 
+void FileSystem::mount(string mountPoint, std::unique_ptr<FileSource> source) {
+    ghoul_assert(!mountPoint.empty(), "Mount point must not be empty");
+    ghoul_assert(source, "Source must not be nullptr");
+
+    mountPoint = cleanupPath(absolutePath(std::move(mountPoint)));
+
+    std::unique_lock lock(_mountsMutex);
+    ghoul_assert(
+        std::none_of(
+            _mounts.begin(),
+            _mounts.end(),
+            [&mountPoint](const Mount& m) { return m.mountPoint == mountPoint; }
+        ),
+        "Mount point must not be used already"
+    );
+    auto it = std::find_if(
+        _mounts.begin(),
+        _mounts.end(),
+        [&mountPoint](const Mount& m) { return m.mountPoint.size() < mountPoint.size(); }
+    );
+    _mounts.insert(it, { std::move(mountPoint), std::move(source) });
+    // Paths inside the new mount point might resolve differently now
+    ++_pathGeneration;
+}
+
+void FileSystem::unmount(string mountPoint) {
+    mountPoint = cleanupPath(absolutePath(std::move(mountPoint)));
+
+    std::unique_lock lock(_mountsMutex);
+    auto it = std::find_if(
+        _mounts.begin(),
+        _mounts.end(),
+        [&mountPoint](const Mount& m) { return m.mountPoint == mountPoint; }
+    );
+    ghoul_assert(it != _mounts.end(), "Mount point was not used");
+    _mounts.erase(it);
+    ++_pathGeneration;
+}
+
+FileContents FileSystem::readFile(const string& path) const {
+    ghoul_assert(!path.empty(), "Path must not be empty");
+
+    const string p = absolutePath(path);
+    string relativePath;
+    std::shared_ptr<const FileSource> source = findMount(p, relativePath);
+    if (source && source->hasFile(relativePath)) {
+        return source->read(relativePath);
+    }
+
+    try {
+        auto file = std::make_shared<const MappedFile>(p);
+        const char* data = file->data();
+        const size_t size = file->size();
+        return FileContents(std::move(file), data, size);
+    }
+    catch (const MappedFile::MappedFileException& e) {
+        throw FileSystemException(e.message);
+    }
+}
+
+bool FileSystem::isMountedFile(const string& path) const {
+    ghoul_assert(!path.empty(), "Path must not be empty");
+
+    string relativePath;
+    std::shared_ptr<const FileSource> source = findMount(
+        absolutePath(path),
+        relativePath
+    );
+    return source && source->hasFile(relativePath);
+}
+
+std::shared_ptr<const FileSource> FileSystem::findMount(const string& path,
+                                                        string& relativePath) const
+{
+    std::shared_lock lock(_mountsMutex);
+    for (const Mount& m : _mounts) {
+        const string& mountPoint = m.mountPoint;
+        if (path.compare(0, mountPoint.size(), mountPoint) != 0) {
+            continue;
+        }
+        if (path.size() == mountPoint.size()) {
+            relativePath.clear();
+            return m.source;
+        }
+        const char separator = path[mountPoint.size()];
+        if (separator != PathSeparator && separator != '/') {
+            // The mount point only matches part of a directory name
+            continue;
+        }
+
+        relativePath = convertPathSeparator(path.substr(mountPoint.size() + 1), '/');
+        while (!relativePath.empty() && relativePath.back() == '/') {
+            relativePath.pop_back();
+        }
+        return m.source;
+    }
+    return nullptr;
+}
+
 void FileSystem::createCacheManager(const Directory& cacheDirectory, int version) {
     ghoul_assert(directoryExists(cacheDirectory), "Cache directory did not exist");
     ghoul_assert(!_cacheManager, "CacheManager was already created");
@@ -766,6 +993,8 @@ void FileSystem::triggerFilesystemEvents() {
 #endif
 #if defined(__APPLE__)
     triggerFilesystemEventsInternalApple();
+#elif !defined(WIN32)
+    triggerFilesystemEventsInternalLinux();
 #endif
 }
 
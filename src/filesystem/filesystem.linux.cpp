@@ -28,152 +28,526 @@
 #include <ghoul/filesystem/filesystem.h>
 
 #include <ghoul/fmt.h>
-#include <ghoul/filesystem/cachemanager.h>
 #include <ghoul/filesystem/file.h>
 #include <ghoul/logging/logmanager.h>
 #include <ghoul/misc/assert.h>
+#include <ghoul/misc/defer.h>
 #include <algorithm>
-#include <cassert>
-#include <cstdio>
-#include <dirent.h>
-#include <pwd.h>
-#include <regex>
+#include <array>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
 #include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/inotify.h>
-#include <sys/param.h>
-#include <sys/stat.h>
-#include <sys/types.h>
-
-#define EVENT_SIZE  ( sizeof (struct inotify_event) )
-#define BUF_LEN     ( 1024 * ( EVENT_SIZE + 16 ) )
-
-using std::string;
 
 namespace {
     constexpr const char* _loggerCat = "FileSystem";
-    const uint32_t mask = IN_ALL_EVENTS | IN_IGNORED | IN_Q_OVERFLOW |
-                          IN_UNMOUNT | IN_ISDIR;
+
+    // Every event that might signal a changed content of a file inside a watched
+    // directory. Editors that save by writing a temporary file and renaming it show up
+    // as IN_MOVED_TO, which a watch on the file itself would not have survived
+    constexpr const uint32_t DirectoryMask = IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE |
+        IN_MOVED_TO | IN_CREATE | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+
+    constexpr const size_t BufferSize = 64 * (sizeof(inotify_event) + NAME_MAX + 1);
+
+    std::pair<std::string, std::string> splitPath(const std::string& path) {
+        const size_t p = path.rfind('/');
+        if (p == std::string::npos) {
+            return { ".", path };
+        }
+        return { p == 0 ? "/" : path.substr(0, p), path.substr(p + 1) };
+    }
+
+    std::string joinPath(const std::string& directory, const std::string& name) {
+        return directory == "/" ? directory + name : directory + '/' + name;
+    }
+
+    /**
+     * Returns the absolute path of the \p directory with all symbolic links, '.', and
+     * '..' components resolved, so that all spellings of a directory result in the same
+     * path. If the directory cannot be resolved, it is returned unchanged.
+     */
+    std::string normalizedDirectory(const std::string& directory) {
+        char* resolved = realpath(directory.c_str(), nullptr);
+        if (!resolved) {
+            return directory;
+        }
+        std::string result = resolved;
+        free(resolved);
+        return result;
+    }
 } // namespace
 
 namespace ghoul::filesystem {
 
 void FileSystem::initializeInternalLinux() {
-    _inotifyHandle = inotify_init();
+    _inotifyHandle = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    _epollHandle = epoll_create1(EPOLL_CLOEXEC);
+    _wakeupHandle = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (_inotifyHandle == -1 || _epollHandle == -1 || _wakeupHandle == -1) {
+        LERROR(fmt::format(
+            "Could not initialize file watcher: {}", std::strerror(errno)
+        ));
+        return;
+    }
+
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = _inotifyHandle;
+    epoll_ctl(_epollHandle, EPOLL_CTL_ADD, _inotifyHandle, &event);
+    event.data.fd = _wakeupHandle;
+    epoll_ctl(_epollHandle, EPOLL_CTL_ADD, _wakeupHandle, &event);
+
     _keepGoing = true;
-    _t = std::thread(inotifyWatcher);
+    _t = std::thread(&FileSystem::inotifyWatcher, this);
 }
 
 void FileSystem::deinitializeInternalLinux() {
     _keepGoing = false;
+    if (_wakeupHandle != -1) {
+        const uint64_t value = 1;
+        [[maybe_unused]] ssize_t res = write(_wakeupHandle, &value, sizeof(value));
+    }
     if (_t.joinable()) {
         _t.join();
     }
-    close(_inotifyHandle);
+
+    for (int handle : { _inotifyHandle, _epollHandle, _wakeupHandle }) {
+        if (handle != -1) {
+            close(handle);
+        }
+    }
+    _inotifyHandle = -1;
+    _epollHandle = -1;
+    _wakeupHandle = -1;
 }
 
 void FileSystem::addFileListener(File* file) {
     ghoul_assert(file != nullptr, "File cannot be nullptr");
-    const std::string filename = file->path();
-    int wd = inotify_add_watch(_inotifyHandle, filename.c_str(), mask);
-    auto eqRange = _trackedFiles.equal_range(wd);
-    for (auto it = eqRange.first; it != eqRange.second; ++it) {
-        if (it->second == file) {
-            LERROR("Already tracking fileobject");
-            return;
-        }
+
+    auto [path, filename] = splitPath(file->path());
+    const std::string directory = normalizedDirectory(path);
+
+    std::lock_guard lock(_trackedFilesMutex);
+    if (_fileWatches.find(file) != _fileWatches.end()) {
+        LERROR("Already tracking fileobject");
+        return;
+    }
+
+    const int wd = watchDirectory(directory);
+    if (wd == -1) {
+        LERROR(fmt::format(
+            "Could not watch directory '{}': {}", directory, std::strerror(errno)
+        ));
+        return;
     }
-    _trackedFiles.emplace(wd, file);
+    _watchedDirectories[wd].files.emplace(std::move(filename), file);
+    _fileWatches[file] = wd;
 }
 
 void FileSystem::removeFileListener(File* file) {
     ghoul_assert(file != nullptr, "File cannot be nullptr");
 
-    const std::string filename = file->path();
-    int wd = inotify_add_watch(_inotifyHandle, filename.c_str(), mask);
-    auto eqRange = _trackedFiles.equal_range(wd);
-    for (auto it = eqRange.first; it != eqRange.second; ++it) {
-        if (it->second == file) {
-            _trackedFiles.erase(it);
+    std::unique_lock lock(_trackedFilesMutex);
+
+    // The File object is usually destroyed after this, so we have to wait for a callback
+    // that is currently using it, unless we are called from inside that callback
+    _callbackFinished.wait(lock, [this, file]() {
+        auto eqRange = _filesInCallback.equal_range(file);
+        return std::all_of(
+            eqRange.first,
+            eqRange.second,
+            [](const std::pair<const File* const, std::thread::id>& p) {
+                return p.second == std::this_thread::get_id();
+            }
+        );
+    });
+
+    auto fileIt = _fileWatches.find(file);
+    if (fileIt == _fileWatches.end()) {
+        LWARNING(fmt::format(
+            "Could not find tracked '{}' for path '{}'",
+            reinterpret_cast<void*>(file), file->path()
+        ));
+        return;
+    }
+    const int wd = fileIt->second;
+    _fileWatches.erase(fileIt);
+
+    if (wd == -1) {
+        // The directory was removed and has not reappeared yet
+        for (auto& [directory, files] : _removedDirectories) {
+            auto it = std::find_if(
+                files.begin(),
+                files.end(),
+                [file](const std::pair<const std::string, File*>& p) {
+                    return p.second == file;
+                }
+            );
+            if (it != files.end()) {
+                files.erase(it);
+                const std::string path = directory;
+                releaseRemovedDirectory(path);
+                return;
+            }
+        }
+        return;
+    }
+
+    auto dirIt = _watchedDirectories.find(wd);
+    if (dirIt == _watchedDirectories.end()) {
+        return;
+    }
+
+    WatchedDirectory& dir = dirIt->second;
+    const std::string filename = splitPath(file->path()).second;
+    auto eqRange = dir.files.equal_range(filename);
+    auto it = std::find_if(
+        eqRange.first,
+        eqRange.second,
+        [file](const std::pair<const std::string, File*>& p) { return p.second == file; }
+    );
+    if (it != eqRange.second) {
+        dir.files.erase(it);
+    }
+
+    // Last file in this directory, so we might no longer need the watch
+    releaseDirectory(wd);
+}
+
+int FileSystem::watchDirectory(const std::string& directory) {
+    auto dirIt = _directoryWatches.find(directory);
+    if (dirIt != _directoryWatches.end()) {
+        return dirIt->second;
+    }
+
+    const int wd = inotify_add_watch(_inotifyHandle, directory.c_str(), DirectoryMask);
+    if (wd == -1) {
+        return -1;
+    }
+    // If the directory is reachable through multiple paths that could not be normalized
+    // to the same one, inotify returns the existing watch descriptor
+    _directoryWatches.emplace(directory, wd);
+    _watchedDirectories[wd].paths.push_back(directory);
+    return wd;
+}
+
+void FileSystem::restoreDirectory(const std::string& directory,
+                                  std::multimap<std::string, File*> files)
+{
+    const std::string parent = splitPath(directory).first;
+    int wd = watchDirectory(directory);
+    if (wd == -1 && parent != directory) {
+        const bool isParentRemoved =
+            _removedDirectories.find(parent) != _removedDirectories.end();
+        if (!isParentRemoved && watchDirectory(parent) == -1) {
+            // The parent directory is gone as well, so it waits for its own parent
+            restoreDirectory(parent, {});
+        }
+        // The directory might have reappeared before its parent was watched
+        wd = watchDirectory(directory);
+    }
+    if (wd == -1) {
+        for (const std::pair<const std::string, File*>& f : files) {
+            _fileWatches[f.second] = -1;
+        }
+        _removedDirectories[directory].merge(files);
+        return;
+    }
+
+    // The files might have been changed while the directory was gone, or they belong to
+    // a different directory that replaced the old one
+    WatchedDirectory& dir = _watchedDirectories[wd];
+    for (const std::pair<const std::string, File*>& f : files) {
+        _fileWatches[f.second] = wd;
+        dir.files.insert(f);
+        markChanged(wd, f.first);
+    }
+
+    // Subdirectories that were removed might have reappeared together with the directory
+    std::vector<std::string> subdirectories;
+    for (const auto& [path, subdirectoryFiles] : _removedDirectories) {
+        if (splitPath(path).first == directory) {
+            subdirectories.push_back(path);
+        }
+    }
+    for (const std::string& path : subdirectories) {
+        auto node = _removedDirectories.extract(path);
+        restoreDirectory(path, std::move(node.mapped()));
+    }
+
+    // The parent might only have been watched to wait for this directory
+    auto parentIt = _directoryWatches.find(parent);
+    if (parentIt != _directoryWatches.end()) {
+        releaseDirectory(parentIt->second);
+    }
+    else if (parent != directory) {
+        releaseRemovedDirectory(parent);
+    }
+}
+
+void FileSystem::releaseDirectory(int wd) {
+    auto dirIt = _watchedDirectories.find(wd);
+    if (dirIt == _watchedDirectories.end() || !dirIt->second.files.empty()) {
+        return;
+    }
+    for (const std::string& path : dirIt->second.paths) {
+        if (hasRemovedSubdirectory(path)) {
             return;
         }
     }
-    LWARNING(fmt::format(
-        "Could not find tracked '{}' for path '{}'",
-        reinterpret_cast<void*>(file), file->path()
-    ));
+
+    inotify_rm_watch(_inotifyHandle, wd);
+    for (const std::string& path : dirIt->second.paths) {
+        _directoryWatches.erase(path);
+    }
+    _watchedDirectories.erase(dirIt);
+    auto p = _pendingChanges.lower_bound({ wd, std::string() });
+    while (p != _pendingChanges.end() && p->first.first == wd) {
+        p = _pendingChanges.erase(p);
+    }
+}
+
+void FileSystem::releaseRemovedDirectory(const std::string& directory) {
+    auto it = _removedDirectories.find(directory);
+    if (it == _removedDirectories.end() || !it->second.empty() ||
+        hasRemovedSubdirectory(directory))
+    {
+        return;
+    }
+    _removedDirectories.erase(it);
+
+    const std::string parent = splitPath(directory).first;
+    auto parentIt = _directoryWatches.find(parent);
+    if (parentIt != _directoryWatches.end()) {
+        releaseDirectory(parentIt->second);
+    }
+    else if (parent != directory) {
+        releaseRemovedDirectory(parent);
+    }
+}
+
+bool FileSystem::hasRemovedSubdirectory(const std::string& directory) const {
+    return std::any_of(
+        _removedDirectories.begin(),
+        _removedDirectories.end(),
+        [&directory](const std::pair<const std::string,
+                                     std::multimap<std::string, File*>>& d)
+        {
+            return d.first != directory && splitPath(d.first).first == directory;
+        }
+    );
+}
+
+void FileSystem::triggerFilesystemEventsInternalLinux() {
+    using namespace std::chrono;
+
+    std::vector<std::pair<int, std::string>> changed;
+    {
+        std::lock_guard lock(_trackedFilesMutex);
+        const steady_clock::time_point now = steady_clock::now();
+        for (auto it = _pendingChanges.begin(); it != _pendingChanges.end();) {
+            // Only report files that have settled down to not fire the callbacks while
+            // the file is still being written
+            if (now - it->second >= FileChangeDebounceInterval) {
+                changed.push_back(it->first);
+                it = _pendingChanges.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+
+    for (const std::pair<int, std::string>& c : changed) {
+        std::vector<File*> files;
+        {
+            std::lock_guard lock(_trackedFilesMutex);
+            auto dirIt = _watchedDirectories.find(c.first);
+            if (dirIt == _watchedDirectories.end()) {
+                continue;
+            }
+            auto eqRange = dirIt->second.files.equal_range(c.second);
+            for (auto it = eqRange.first; it != eqRange.second; ++it) {
+                files.push_back(it->second);
+            }
+        }
+
+        for (File* f : files) {
+            std::unique_lock lock(_trackedFilesMutex);
+            // A previous callback might have removed this File object, so we have to make
+            // sure it is still tracked before using it
+            auto dirIt = _watchedDirectories.find(c.first);
+            if (dirIt == _watchedDirectories.end()) {
+                break;
+            }
+            auto eqRange = dirIt->second.files.equal_range(c.second);
+            auto it = std::find_if(
+                eqRange.first,
+                eqRange.second,
+                [f](const std::pair<const std::string, File*>& p) {
+                    return p.second == f;
+                }
+            );
+            if (it == eqRange.second || !f->callback()) {
+                continue;
+            }
+            // The callback might replace itself, so we must not call it in place
+            const File::FileChangedCallback callback = f->callback();
+
+            // Registering the callback prevents other threads from removing and
+            // destroying the File object while the callback is running
+            auto running = _filesInCallback.emplace(f, std::this_thread::get_id());
+            lock.unlock();
+            defer {
+                lock.lock();
+                _filesInCallback.erase(running);
+                lock.unlock();
+                _callbackFinished.notify_all();
+            };
+            callback(*f);
+        }
+    }
+}
+
+void FileSystem::markChanged(int wd, const std::string& file) {
+    auto dirIt = _watchedDirectories.find(wd);
+    if (dirIt == _watchedDirectories.end()) {
+        return;
+    }
+    if (dirIt->second.files.find(file) == dirIt->second.files.end()) {
+        // Another file in a watched directory that nobody is interested in
+        return;
+    }
+    // Multiple changes to the same file are coalesced by only storing the time of the
+    // latest change, which also restarts the debounce period
+    _pendingChanges[{ wd, file }] = std::chrono::steady_clock::now();
+}
+
+void FileSystem::handleInotifyEvent(int wd, uint32_t mask, const std::string& file) {
+    if (mask & IN_Q_OVERFLOW) {
+        // We missed events, so we have to assume that every file has changed and that
+        // every removed directory might have reappeared
+        for (const std::pair<const int, WatchedDirectory>& d : _watchedDirectories) {
+            for (const std::pair<const std::string, File*>& f : d.second.files) {
+                markChanged(d.first, f.first);
+            }
+        }
+        std::vector<std::string> removed;
+        for (const auto& [path, files] : _removedDirectories) {
+            removed.push_back(path);
+        }
+        for (const std::string& path : removed) {
+            auto node = _removedDirectories.extract(path);
+            if (!node.empty()) {
+                restoreDirectory(path, std::move(node.mapped()));
+            }
+        }
+        return;
+    }
+
+    if (mask & (IN_IGNORED | IN_MOVE_SELF)) {
+        // The watched directory was removed, renamed, or unmounted. If we removed the
+        // watch ourselves, the directory is no longer known
+        auto dirIt = _watchedDirectories.find(wd);
+        if (dirIt == _watchedDirectories.end()) {
+            return;
+        }
+        if (mask & IN_MOVE_SELF) {
+            // The watch would follow the directory to its new path
+            inotify_rm_watch(_inotifyHandle, wd);
+        }
+
+        WatchedDirectory dir = std::move(dirIt->second);
+        _watchedDirectories.erase(dirIt);
+        for (const std::string& path : dir.paths) {
+            _directoryWatches.erase(path);
+        }
+        auto p = _pendingChanges.lower_bound({ wd, std::string() });
+        while (p != _pendingChanges.end() && p->first.first == wd) {
+            p = _pendingChanges.erase(p);
+        }
+
+        // A directory that is replaced by renaming another one over it, or that is
+        // created again, should continue to report changes to its files
+        const std::string& path = dir.paths.front();
+        if (!dir.files.empty() || hasRemovedSubdirectory(path)) {
+            restoreDirectory(path, std::move(dir.files));
+        }
+        return;
+    }
+
+    if ((mask & IN_ISDIR) && (mask & (IN_CREATE | IN_MOVED_TO))) {
+        // A removed directory might have reappeared in its watched parent directory
+        auto dirIt = _watchedDirectories.find(wd);
+        if (dirIt == _watchedDirectories.end()) {
+            return;
+        }
+        const std::vector<std::string> paths = dirIt->second.paths;
+        for (const std::string& path : paths) {
+            auto node = _removedDirectories.extract(joinPath(path, file));
+            if (!node.empty()) {
+                restoreDirectory(node.key(), std::move(node.mapped()));
+            }
+        }
+        return;
+    }
+
+    if (!file.empty()) {
+        markChanged(wd, file);
+    }
 }
 
 void FileSystem::inotifyWatcher() {
-    int fd = FileSys._inotifyHandle;
-    char buffer[BUF_LEN];
-    struct timeval tv;
-    tv.tv_sec = 1;
-    tv.tv_usec = 0;
-    fd_set rfds;
-    while (FileSys._keepGoing) {
-        FD_ZERO (&rfds);
-        FD_SET (fd, &rfds);
-        if (select(FD_SETSIZE, &rfds, nullptr, nullptr, &tv) < 1) {
-            continue;
-        }
-
-        ssize_t length = read(fd, buffer, BUF_LEN );
-        if (length < 0) {
-            continue;
-        }
-
-        long unsigned int offset = 0;
-        while (offset < static_cast<long unsigned int>(length)) {
-            struct inotify_event* e = reinterpret_cast<inotify_event*>(buffer + offset);
-            switch (e->mask) {
-                case IN_MODIFY:
-                case IN_ATTRIB:
-                {
-                    int wd = e->wd;
-                    auto eqRange = FileSys._trackedFiles.equal_range(wd);
-                    for (auto it = eqRange.first; it != eqRange.second; ++it) {
-                        File* fileobject = it->second;
-                        fileobject->callback()(*fileobject);
-                    }
+    alignas(inotify_event) char buffer[BufferSize];
+
+    while (_keepGoing) {
+        std::array<epoll_event, 2> events;
+        const int nEvents = epoll_wait(
+            _epollHandle,
+            events.data(),
+            static_cast<int>(events.size()),
+            -1
+        );
+        if (nEvents < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+
+        for (int i = 0; i < nEvents; ++i) {
+            if (events[i].data.fd != _inotifyHandle) {
+                // The wakeup handle is only signalled when we are supposed to stop
+                continue;
+            }
+
+            // Drain all available events so that a single wakeup handles the whole
+            // batch and the lock is only acquired once per read
+            while (true) {
+                const ssize_t length = read(_inotifyHandle, buffer, BufferSize);
+                if (length <= 0) {
                     break;
                 }
-                case IN_IGNORED:
-                {
-                    int wd = e->wd;
-
-                    auto eqRange = FileSys._trackedFiles.equal_range(wd);
-                    auto it = eqRange.first;
-
-                    // remove tracking of the removed descriptor
-                    inotify_rm_watch(fd, wd);
-
-                    // if there are files tracking
-                    if (it != eqRange.second) {
-                        // add new tracking
-                        int new_wd = inotify_add_watch(
-                            fd,
-                            it->second->path().c_str(),
-                            mask
-                        );
-
-                        // save all files
-                        std::vector<File*> v;
-                        for (; it != eqRange.second; ++it) {
-                            v.push_back(it->second);
-                        }
-
-                        // erase all previous files and add them again
-                        FileSys._trackedFiles.erase(eqRange.first, eqRange.second);
-                        for (auto f : v) {
-                            FileSys._trackedFiles.emplace(new_wd, f);
-                        }
-                    }
-                    break;
+
+                std::lock_guard lock(_trackedFilesMutex);
+                ssize_t offset = 0;
+                while (offset < length) {
+                    const inotify_event* e =
+                        reinterpret_cast<const inotify_event*>(buffer + offset);
+                    handleInotifyEvent(
+                        e->wd,
+                        e->mask,
+                        e->len > 0 ? std::string(e->name) : std::string()
+                    );
+                    offset += sizeof(inotify_event) + e->len;
                 }
-                default:
-                    break;
             }
-            offset += EVENT_SIZE + e->len;
         }
     }
 }
@@ -0,0 +1,252 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2020                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <ghoul/filesystem/mappedfile.h>
+
+#include <ghoul/fmt.h>
+#include <ghoul/misc/assert.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+
+namespace ghoul::filesystem {
+
+MappedFile::MappedFileException::MappedFileException(std::string f, std::string msg)
+    : RuntimeError(fmt::format("Error mapping file '{}': {}", f, msg), "MappedFile")
+    , file(std::move(f))
+{}
+
+#ifdef WIN32
+
+MappedFile::MappedFile(std::string path, Advice advice, UseHugePages)
+    : _path(std::move(path))
+{
+    ghoul_assert(!_path.empty(), "Path must not be empty");
+
+    HANDLE file = CreateFile(
+        _path.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr
+    );
+    if (file == INVALID_HANDLE_VALUE) {
+        throw MappedFileException(_path, "Could not open file");
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        throw MappedFileException(_path, "Could not determine the file size");
+    }
+    _size = static_cast<size_t>(size.QuadPart);
+    if (_size == 0) {
+        // Empty files cannot be mapped
+        CloseHandle(file);
+        return;
+    }
+
+    // Large pages are only available for anonymous memory on Windows, so the hint is
+    // ignored. The view keeps the file mapping alive after the handles are closed
+    HANDLE mapping = CreateFileMapping(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping) {
+        throw MappedFileException(_path, "Could not create the file mapping");
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!view) {
+        throw MappedFileException(_path, "Could not map the file");
+    }
+    _data = static_cast<const char*>(view);
+
+    advise(advice);
+}
+
+void MappedFile::advise(Advice advice, size_t offset, size_t size) const {
+    if (!_data || offset >= _size) {
+        return;
+    }
+    size = size > _size - offset ? _size - offset : size;
+
+    // Windows only supports prefetching, the other access patterns have to be specified
+    // when opening the file, which does not affect the mapping
+#if defined(_WIN32_WINNT) && (_WIN32_WINNT >= _WIN32_WINNT_WIN8)
+    if (advice == Advice::WillNeed) {
+        WIN32_MEMORY_RANGE_ENTRY range;
+        range.VirtualAddress = const_cast<char*>(_data + offset);
+        range.NumberOfBytes = size;
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+    }
+#else
+    (void)advice;
+#endif
+}
+
+void MappedFile::unmap() {
+    if (_data) {
+        UnmapViewOfFile(_data);
+    }
+}
+
+#else // ^^^^ WIN32 // !WIN32 vvvv
+
+MappedFile::MappedFile(std::string path, Advice advice, UseHugePages useHugePages)
+    : _path(std::move(path))
+{
+    ghoul_assert(!_path.empty(), "Path must not be empty");
+
+    const int fd = open(_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        throw MappedFileException(_path, strerror(errno));
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        const int error = errno;
+        close(fd);
+        throw MappedFileException(_path, strerror(error));
+    }
+    _size = static_cast<size_t>(info.st_size);
+    if (_size == 0) {
+        // Empty files cannot be mapped
+        close(fd);
+        return;
+    }
+
+    // The mapping stays valid after the file descriptor is closed
+    void* memory = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+    const int error = errno;
+    close(fd);
+    if (memory == MAP_FAILED) {
+        throw MappedFileException(_path, strerror(error));
+    }
+    _data = static_cast<const char*>(memory);
+
+#ifdef MADV_HUGEPAGE
+    if (useHugePages) {
+        // Only succeeds if the kernel supports transparent huge pages for the page cache
+        // of this filesystem, otherwise the mapping just keeps using regular pages
+        madvise(memory, _size, MADV_HUGEPAGE);
+    }
+#else
+    (void)useHugePages;
+#endif // MADV_HUGEPAGE
+
+    advise(advice);
+}
+
+void MappedFile::advise(Advice advice, size_t offset, size_t size) const {
+    if (!_data || offset >= _size) {
+        return;
+    }
+    size = std::min(size, _size - offset);
+
+    // The advice has to start at a page boundary
+    const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t alignment = offset % pageSize;
+    offset -= alignment;
+    size += alignment;
+
+    int value = POSIX_MADV_NORMAL;
+    switch (advice) {
+        case Advice::Normal:
+            value = POSIX_MADV_NORMAL;
+            break;
+        case Advice::Sequential:
+            value = POSIX_MADV_SEQUENTIAL;
+            break;
+        case Advice::Random:
+            value = POSIX_MADV_RANDOM;
+            break;
+        case Advice::WillNeed:
+            value = POSIX_MADV_WILLNEED;
+            break;
+    }
+    posix_madvise(const_cast<char*>(_data + offset), size, value);
+}
+
+void MappedFile::unmap() {
+    if (_data) {
+        munmap(const_cast<char*>(_data), _size);
+    }
+}
+
+#endif // WIN32
+
+MappedFile::~MappedFile() {
+    unmap();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : _path(std::move(other._path))
+    , _data(std::exchange(other._data, nullptr))
+    , _size(std::exchange(other._size, 0))
+{}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        unmap();
+        _path = std::move(other._path);
+        _data = std::exchange(other._data, nullptr);
+        _size = std::exchange(other._size, 0);
+    }
+    return *this;
+}
+
+const std::string& MappedFile::path() const {
+    return _path;
+}
+
+const char* MappedFile::data() const {
+    return _data;
+}
+
+size_t MappedFile::size() const {
+    return _size;
+}
+
+bool MappedFile::empty() const {
+    return _size == 0;
+}
+
+std::string_view MappedFile::view() const {
+    return std::string_view(_data, _size);
+}
+
+} // namespace ghoul::filesystem
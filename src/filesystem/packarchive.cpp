@@ -0,0 +1,299 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2020                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <ghoul/filesystem/packarchive.h>
+
+#include <ghoul/fmt.h>
+#include <ghoul/filesystem/filesystem.h>
+#include <ghoul/filesystem/mappedfile.h>
+#include <ghoul/misc/assert.h>
+#include <lz4/lz4.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+namespace {
+    constexpr const char Magic[8] = { 'G', 'H', 'L', 'P', 'A', 'C', 'K', '\0' };
+    constexpr const uint32_t Version = 1;
+    constexpr const size_t HeaderSize = sizeof(Magic) + 2 * sizeof(uint32_t) +
+                                        sizeof(uint64_t);
+    constexpr const size_t EntryHeaderSize = 3 * sizeof(uint64_t) + 2 * sizeof(uint32_t);
+
+    // The entry is compressed with LZ4
+    constexpr const uint32_t FlagLZ4 = 1 << 0;
+
+    // The largest ratio between the decompressed and compressed size that the LZ4 block
+    // format can represent
+    constexpr const uint64_t LZ4MaxRatio = 255;
+
+    template <typename T>
+    T readLE(const char* data) {
+        T value = 0;
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            value |= static_cast<T>(static_cast<unsigned char>(data[i])) << (8 * i);
+        }
+        return value;
+    }
+
+    template <typename T>
+    void appendLE(std::string& buffer, T value) {
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            buffer += static_cast<char>((value >> (8 * i)) & 0xFF);
+        }
+    }
+} // namespace
+
+namespace ghoul::filesystem {
+
+PackArchive::PackArchiveException::PackArchiveException(std::string f, std::string msg)
+    : RuntimeError(fmt::format("Error in archive '{}': {}", f, msg), "PackArchive")
+    , file(std::move(f))
+{}
+
+PackArchive::PackArchive(std::string path)
+    : _path(std::move(path))
+{
+    ghoul_assert(!_path.empty(), "Path must not be empty");
+
+    try {
+        _file = std::make_shared<const MappedFile>(_path);
+    }
+    catch (const MappedFile::MappedFileException& e) {
+        throw PackArchiveException(_path, e.message);
+    }
+
+    const char* data = _file->data();
+    const size_t size = _file->size();
+    if (size < HeaderSize || std::memcmp(data, Magic, sizeof(Magic)) != 0) {
+        throw PackArchiveException(_path, "File is not an archive");
+    }
+    const uint32_t version = readLE<uint32_t>(data + sizeof(Magic));
+    if (version != Version) {
+        throw PackArchiveException(
+            _path,
+            fmt::format("Unsupported version {}", version)
+        );
+    }
+    const uint32_t nEntries = readLE<uint32_t>(data + sizeof(Magic) + sizeof(uint32_t));
+    const uint64_t indexOffset = readLE<uint64_t>(
+        data + sizeof(Magic) + 2 * sizeof(uint32_t)
+    );
+    if (indexOffset < HeaderSize || indexOffset > size) {
+        throw PackArchiveException(_path, "Index is out of bounds");
+    }
+
+    // The entire index is parsed right away
+    _file->advise(MappedFile::Advice::WillNeed, indexOffset);
+    // The number of entries is read from the file, so it cannot be trusted before the
+    // index was parsed
+    const uint64_t maxEntries = (size - indexOffset) / EntryHeaderSize;
+    _entries.reserve(std::min<uint64_t>(nEntries, maxEntries));
+    size_t pos = indexOffset;
+    for (uint32_t i = 0; i < nEntries; ++i) {
+        if (size - pos < EntryHeaderSize) {
+            throw PackArchiveException(_path, "Index is truncated");
+        }
+        Entry e;
+        e.offset = readLE<uint64_t>(data + pos);
+        e.storedSize = readLE<uint64_t>(data + pos + 8);
+        e.size = readLE<uint64_t>(data + pos + 16);
+        e.flags = readLE<uint32_t>(data + pos + 24);
+        const uint32_t pathLength = readLE<uint32_t>(data + pos + 28);
+        pos += EntryHeaderSize;
+        if (size - pos < pathLength) {
+            throw PackArchiveException(_path, "Index is truncated");
+        }
+        e.path = std::string_view(data + pos, pathLength);
+        pos += pathLength;
+
+        if (e.offset < HeaderSize || e.offset > indexOffset ||
+            e.storedSize > indexOffset - e.offset)
+        {
+            throw PackArchiveException(
+                _path,
+                fmt::format("Contents of '{}' are out of bounds", e.path)
+            );
+        }
+        const bool isSizeValid = (e.flags & FlagLZ4) ?
+            (e.size <= e.storedSize * LZ4MaxRatio && e.size <= LZ4_MAX_INPUT_SIZE &&
+             e.storedSize <= LZ4_MAX_INPUT_SIZE) :
+            (e.storedSize == e.size);
+        if (!isSizeValid) {
+            throw PackArchiveException(
+                _path,
+                fmt::format("Size of '{}' is inconsistent", e.path)
+            );
+        }
+        if (!_entries.empty() && _entries.back().path >= e.path) {
+            throw PackArchiveException(_path, "Index is not sorted");
+        }
+        _entries.push_back(e);
+    }
+}
+
+PackArchive::~PackArchive() = default;
+
+void PackArchive::create(const std::string& path, const std::string& directory,
+                         Compress compress)
+{
+    ghoul_assert(!path.empty(), "Path must not be empty");
+    ghoul_assert(FileSys.directoryExists(directory), "Directory must exist");
+
+    DirectorySource source(directory);
+    const std::vector<std::string> files = source.files();
+
+    std::ofstream stream(path, std::ofstream::binary | std::ofstream::trunc);
+    if (!stream.good()) {
+        throw PackArchiveException(path, "Could not open file for writing");
+    }
+
+    // The header is written again with the final index offset once all files are known
+    stream.write(std::string(HeaderSize, '\0').data(), HeaderSize);
+
+    std::string index;
+    uint64_t offset = HeaderSize;
+    for (const std::string& f : files) {
+        const FileContents contents = source.read(f);
+
+        uint32_t flags = 0;
+        std::string compressed;
+        std::string_view stored = contents.view();
+        if (compress && !stored.empty() && stored.size() <= LZ4_MAX_INPUT_SIZE) {
+            // Contents that do not become smaller are stored uncompressed
+            compressed.resize(stored.size() - 1);
+            const int compressedSize = LZ4_compress_limitedOutput(
+                stored.data(),
+                compressed.data(),
+                static_cast<int>(stored.size()),
+                static_cast<int>(compressed.size())
+            );
+            if (compressedSize > 0) {
+                compressed.resize(compressedSize);
+                flags |= FlagLZ4;
+                stored = compressed;
+            }
+        }
+        stream.write(stored.data(), stored.size());
+
+        appendLE<uint64_t>(index, offset);
+        appendLE<uint64_t>(index, stored.size());
+        appendLE<uint64_t>(index, contents.size());
+        appendLE<uint32_t>(index, flags);
+        appendLE<uint32_t>(index, static_cast<uint32_t>(f.size()));
+        index += f;
+        offset += stored.size();
+    }
+    stream.write(index.data(), index.size());
+
+    std::string header(Magic, sizeof(Magic));
+    appendLE<uint32_t>(header, Version);
+    appendLE<uint32_t>(header, static_cast<uint32_t>(files.size()));
+    appendLE<uint64_t>(header, offset);
+    stream.seekp(0);
+    stream.write(header.data(), header.size());
+
+    if (!stream.good()) {
+        throw PackArchiveException(path, "Error writing file");
+    }
+}
+
+bool PackArchive::hasFile(std::string_view path) const {
+    return findEntry(path) != nullptr;
+}
+
+bool PackArchive::hasDirectory(std::string_view path) const {
+    if (path.empty()) {
+        // The root of the archive
+        return true;
+    }
+
+    std::string prefix = std::string(path);
+    if (prefix.back() != '/') {
+        prefix += '/';
+    }
+    auto it = std::lower_bound(
+        _entries.begin(),
+        _entries.end(),
+        prefix,
+        [](const Entry& e, const std::string& p) { return e.path < p; }
+    );
+    return it != _entries.end() && it->path.substr(0, prefix.size()) == prefix;
+}
+
+FileContents PackArchive::read(std::string_view path) const {
+    const Entry* e = findEntry(path);
+    if (!e) {
+        throw FileSourceException(
+            std::string(path),
+            fmt::format("File does not exist in archive '{}'", _path)
+        );
+    }
+
+    const char* data = _file->data() + e->offset;
+    if (!(e->flags & FlagLZ4)) {
+        return FileContents(_file, data, e->size);
+    }
+
+    std::string result(e->size, '\0');
+    const int size = LZ4_decompress_safe(
+        data,
+        result.data(),
+        static_cast<int>(e->storedSize),
+        static_cast<int>(result.size())
+    );
+    if (size != static_cast<int>(result.size())) {
+        throw FileSourceException(
+            std::string(path),
+            fmt::format("Compressed contents in archive '{}' are corrupted", _path)
+        );
+    }
+    return FileContents(std::move(result));
+}
+
+std::vector<std::string> PackArchive::files() const {
+    std::vector<std::string> result;
+    result.reserve(_entries.size());
+    for (const Entry& e : _entries) {
+        result.emplace_back(e.path);
+    }
+    return result;
+}
+
+const std::string& PackArchive::path() const {
+    return _path;
+}
+
+const PackArchive::Entry* PackArchive::findEntry(std::string_view path) const {
+    auto it = std::lower_bound(
+        _entries.begin(),
+        _entries.end(),
+        path,
+        [](const Entry& e, std::string_view p) { return e.path < p; }
+    );
+    return (it != _entries.end() && it->path == path) ? &*it : nullptr;
+}
+
+} // namespace ghoul::filesystem
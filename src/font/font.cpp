@@ -253,9 +253,9 @@ bool Font::hasOutline() const {
 glm::vec2 Font::boundingBox(const std::string& text) {
     glm::vec2 result(0.f);
 
-    const std::vector<std::string>& lines = ghoul::tokenizeString(text, '\n');
-
-    for (const std::string& line : lines) {
+    int nLines = 0;
+    for (std::string_view line : ghoul::splitString(text, '\n')) {
+        ++nLines;
         float width = 0.f;
         float height = 0.f;
         for (size_t j = 0 ; j < line.size(); ++j) {
@@ -272,7 +272,7 @@ glm::vec2 Font::boundingBox(const std::string& text) {
         result.y += height;
     }
 
-    result.y += (lines.size() - 1) * _height;
+    result.y += (nLines - 1) * _height;
 
     return result;
 }
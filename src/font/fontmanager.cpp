@@ -31,7 +31,7 @@
 #include <ghoul/font/font.h>
 #include <ghoul/logging/logmanager.h>
 #include <ghoul/misc/assert.h>
-#include <ghoul/misc/crc32.h>
+#include <ghoul/misc/hash.h>
 #include <ghoul/opengl/texture.h>
 
 namespace {
@@ -76,13 +76,13 @@ opengl::TextureAtlas& FontManager::textureAtlas() {
     return _textureAtlas;
 }
 
-unsigned int FontManager::registerFontPath(const std::string& fontName,
-                                           const std::string& filePath)
+uint64_t FontManager::registerFontPath(const std::string& fontName,
+                                       const std::string& filePath)
 {
     ghoul_assert(!fontName.empty(), "Fontname must not be empty");
     ghoul_assert(!filePath.empty(), "Filepath must not be empty");
 
-    unsigned int hash = hashCRC32(fontName);
+    uint64_t hash = hash64(fontName);
     auto it = _fontPaths.find(hash);
     if (it != _fontPaths.end()) {
         const std::string& registeredPath = it->second;
@@ -109,7 +109,7 @@ std::shared_ptr<Font> FontManager::font(const std::string& name, float fontSize,
 {
     ghoul_assert(!name.empty(), "Name must not be empty");
 
-    unsigned int hash = hashCRC32(name);
+    uint64_t hash = hash64(name);
 
     auto itPath = _fontPaths.find(hash);
     if (itPath == _fontPaths.end()) {
@@ -128,7 +128,7 @@ std::shared_ptr<Font> FontManager::font(const std::string& name, float fontSize,
     return font(hash, fontSize, withOutline, loadGlyphs);
 }
 
-std::shared_ptr<Font> FontManager::font(unsigned int hashName, float fontSize,
+std::shared_ptr<Font> FontManager::font(uint64_t hashName, float fontSize,
                                         Outline withOutline, LoadGlyphs loadGlyphs)
 {
     auto itPath = _fontPaths.find(hashName);
@@ -35,9 +35,9 @@
 #include <ghoul/opengl/texture.h>
 #include <ghoul/opengl/textureatlas.h>
 #include <ghoul/opengl/textureunit.h>
+#include <algorithm>
 #include <fstream>
 #include <glm/gtc/matrix_transform.hpp>
-#include <numeric>
 
 namespace {
     constexpr const char* _loggerCat = "FontRenderer";
@@ -340,7 +340,7 @@ FontRenderer& FontRenderer::defaultProjectionRenderer() {
 FontRenderer::BoundingBoxInformation FontRenderer::boundingBox(Font& font,
                                                             const std::string& text) const
 {
-    const std::vector<std::string>& lines = ghoul::tokenizeString(text, '\n');
+    const int nLines = static_cast<int>(std::count(text.begin(), text.end(), '\n')) + 1;
 
     float h = font.height();
 
@@ -349,7 +349,7 @@ FontRenderer::BoundingBoxInformation FontRenderer::boundingBox(Font& font,
     glm::vec2 movingPos = glm::vec2(0.f);
 
     glm::vec2 size = glm::vec2(0.f);
-    for (const std::string& line : lines) {
+    for (std::string_view line : ghoul::splitString(text, '\n')) {
         movingPos.x = 0.f;
         float width = 0.f;
         float height = 0.f;
@@ -375,9 +375,9 @@ FontRenderer::BoundingBoxInformation FontRenderer::boundingBox(Font& font,
         size.y += height;
         movingPos.y -= h;
     }
-    size.y = lines.size() * font.height();
+    size.y = nLines * font.height();
 
-    return { size, static_cast<int>(lines.size()) };
+    return { size, nLines };
 }
 
 FontRenderer::BoundingBoxInformation FontRenderer::render(Font& font,
@@ -394,7 +394,7 @@ FontRenderer::BoundingBoxInformation FontRenderer::render(Font& font,
                                                           const glm::vec4& color,
                                                       const glm::vec4& outlineColor) const
 {
-    const std::vector<std::string>& lines = ghoul::tokenizeString(text, '\n');
+    const int nLines = static_cast<int>(std::count(text.begin(), text.end(), '\n')) + 1;
 
     glDisable(GL_DEPTH_TEST);
     glEnable(GL_BLEND);
@@ -411,12 +411,8 @@ FontRenderer::BoundingBoxInformation FontRenderer::render(Font& font,
         float outlineT;
     };
 
-    int nCharacters = std::accumulate(
-        lines.begin(),
-        lines.end(),
-        0,
-        [](int lhs, const std::string& rhs) { return static_cast<int>(rhs.size()) + lhs; }
-    );
+    // The line breaks are not rendered as characters
+    const int nCharacters = static_cast<int>(text.size()) - (nLines - 1);
     std::vector<Vertex> vertices;
     vertices.reserve(nCharacters * 4); // each character is four vertices
 
@@ -427,7 +423,7 @@ FontRenderer::BoundingBoxInformation FontRenderer::render(Font& font,
     GLushort vertexIndex = 0;
     glm::vec2 size = glm::vec2(0.f);
     glm::vec2 movingPos = pos;
-    for (const std::string& line : lines) {
+    for (std::string_view line : ghoul::splitString(text, '\n')) {
         movingPos.x = pos.x;
         float width = 0.f;
         float height = 0.f;
@@ -486,7 +482,7 @@ FontRenderer::BoundingBoxInformation FontRenderer::render(Font& font,
         //size.y += height;
         movingPos.y -= font.height();
     }
-    size.y = (lines.size() - 1) * font.height();
+    size.y = (nLines - 1) * font.height();
 
     opengl::TextureUnit atlasUnit;
     atlasUnit.activate();
@@ -552,7 +548,7 @@ FontRenderer::BoundingBoxInformation FontRenderer::render(Font& font,
     glBindVertexArray(0);
     glEnable(GL_DEPTH_TEST);
 
-    return { size, static_cast<int>(lines.size()) };
+    return { size, nLines };
 }
 
 FontRenderer::BoundingBoxInformation FontRenderer::render(Font& font,
@@ -565,7 +561,7 @@ FontRenderer::BoundingBoxInformation FontRenderer::render(Font& font,
 {
     float h = font.height();
 
-    const std::vector<std::string>& lines = ghoul::tokenizeString(text, '\n');
+    const int nLines = static_cast<int>(std::count(text.begin(), text.end(), '\n')) + 1;
 
     unsigned int vertexIndex = 0;
     std::vector<GLuint> indices;
@@ -577,7 +573,7 @@ FontRenderer::BoundingBoxInformation FontRenderer::render(Font& font,
     glm::vec2 size = glm::vec2(0.f);
     float heightInPixels = 0.f;
 
-    for (const std::string& line : lines) {
+    for (std::string_view line : ghoul::splitString(text, '\n')) {
         //movingPos.x = 0.f;
         //movingPos.x = pos.x;
         float width = 0.f;
@@ -664,7 +660,7 @@ FontRenderer::BoundingBoxInformation FontRenderer::render(Font& font,
                 heightInPixels > _framebufferSize.x ||
                 heightInPixels > _framebufferSize.y)
             {
-                return { size, static_cast<int>(lines.size()) };
+                return { size, nLines };
             }
 
             if (heightInPixels > labelInfo.maxSize) {
@@ -716,7 +712,7 @@ FontRenderer::BoundingBoxInformation FontRenderer::render(Font& font,
         size.y += height;
         movingPos.y -= h;
     }
-    size.y = (lines.size() - 1) * font.height();
+    size.y = (nLines - 1) * font.height();
 
     if (!labelInfo.enableDepth) {
         glDisable(GL_DEPTH_TEST);
@@ -795,7 +791,7 @@ FontRenderer::BoundingBoxInformation FontRenderer::render(Font& font,
         glEnable(GL_DEPTH_TEST);
     }
 
-    return { size, static_cast<int>(lines.size()) };
+    return { size, nLines };
 }
 
 FontRenderer::BoundingBoxInformation FontRenderer::render(Font& font,
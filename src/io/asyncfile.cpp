@@ -0,0 +1,748 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2020                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <ghoul/io/asyncfile.h>
+
+#include <ghoul/fmt.h>
+#include <ghoul/logging/logmanager.h>
+#include <ghoul/misc/assert.h>
+#include <ghoul/misc/threadpool.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+namespace {
+    constexpr const char* _loggerCat = "AsyncFile";
+
+#ifdef __linux__
+    // The number of submission queue entries of the io_uring. The completion queue has
+    // twice as many entries, which limits the number of reads that are in flight
+    constexpr const unsigned int RingEntries = 256;
+#endif
+} // namespace
+
+namespace ghoul::io {
+
+struct AsyncFile::Handle {
+    explicit Handle(const std::string& path);
+    ~Handle();
+
+    uint64_t size() const;
+
+    // Reads up to size bytes at the offset into the destination and only returns fewer
+    // bytes if the file ends before. Returns false if the read failed
+    bool readAt(uint64_t offset, char* destination, size_t size, size_t& nRead) const;
+
+#ifdef WIN32
+    HANDLE handle = INVALID_HANDLE_VALUE;
+#else
+    int fd = -1;
+#endif
+};
+
+#ifdef WIN32
+
+AsyncFile::Handle::Handle(const std::string& path) {
+    handle = CreateFile(
+        path.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ | FILE_SHARE_WRITE,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr
+    );
+    if (handle == INVALID_HANDLE_VALUE) {
+        throw AsyncFileException(path, "Could not open file");
+    }
+}
+
+AsyncFile::Handle::~Handle() {
+    CloseHandle(handle);
+}
+
+uint64_t AsyncFile::Handle::size() const {
+    LARGE_INTEGER s;
+    return GetFileSizeEx(handle, &s) ? static_cast<uint64_t>(s.QuadPart) : 0;
+}
+
+bool AsyncFile::Handle::readAt(uint64_t offset, char* destination, size_t size,
+                               size_t& nRead) const
+{
+    nRead = 0;
+    while (nRead < size) {
+        OVERLAPPED overlapped = {};
+        overlapped.Offset = static_cast<DWORD>((offset + nRead) & 0xFFFFFFFF);
+        overlapped.OffsetHigh = static_cast<DWORD>((offset + nRead) >> 32);
+        DWORD n = 0;
+        const DWORD toRead = static_cast<DWORD>(std::min<size_t>(size - nRead, MAXDWORD));
+        if (!ReadFile(handle, destination + nRead, toRead, &n, &overlapped)) {
+            return GetLastError() == ERROR_HANDLE_EOF;
+        }
+        if (n == 0) {
+            break;
+        }
+        nRead += n;
+    }
+    return true;
+}
+
+#else // ^^^^ WIN32 // !WIN32 vvvv
+
+AsyncFile::Handle::Handle(const std::string& path) {
+    fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        throw AsyncFileException(path, strerror(errno));
+    }
+}
+
+AsyncFile::Handle::~Handle() {
+    close(fd);
+}
+
+uint64_t AsyncFile::Handle::size() const {
+    struct stat info;
+    return fstat(fd, &info) == 0 ? static_cast<uint64_t>(info.st_size) : 0;
+}
+
+bool AsyncFile::Handle::readAt(uint64_t offset, char* destination, size_t size,
+                               size_t& nRead) const
+{
+    nRead = 0;
+    while (nRead < size) {
+        const ssize_t n = pread(
+            fd,
+            destination + nRead,
+            size - nRead,
+            static_cast<off_t>(offset + nRead)
+        );
+        if (n == -1 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            return false;
+        }
+        if (n == 0) {
+            break;
+        }
+        nRead += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+#endif // WIN32
+
+namespace {
+
+// A request for one or more ranges of a file that completes once all ranges are read
+struct Request {
+    Request(std::string p, std::shared_ptr<AsyncFile::Handle> f,
+            std::vector<AsyncFile::Range> r,
+            std::function<void (Request&)> complete)
+        : path(std::move(p))
+        , file(std::move(f))
+        , ranges(std::move(r))
+        , buffers(ranges.size())
+        , nRemaining(ranges.size())
+        , onComplete(std::move(complete))
+    {
+        for (size_t i = 0; i < ranges.size(); ++i) {
+            buffers[i].resize(ranges[i].size);
+        }
+    }
+
+    // Shrinks the buffer of the range to the number of bytes that were read and
+    // completes the request if this was the last outstanding range
+    void finishRange(size_t index, size_t nRead) {
+        buffers[index].resize(nRead);
+        if (--nRemaining == 0) {
+            try {
+                onComplete(*this);
+            }
+            catch (const std::exception& e) {
+                LERROR(fmt::format("Error in callback for '{}': {}", path, e.what()));
+            }
+        }
+    }
+
+    void fail(const std::string& message) {
+        std::lock_guard lock(errorMutex);
+        if (!error) {
+            error = std::make_exception_ptr(
+                AsyncFile::AsyncFileException(path, message)
+            );
+        }
+    }
+
+    const std::string path;
+    const std::shared_ptr<AsyncFile::Handle> file;
+    const std::vector<AsyncFile::Range> ranges;
+    std::vector<std::vector<char>> buffers;
+    std::atomic<size_t> nRemaining;
+
+    std::mutex errorMutex;
+    std::exception_ptr error;
+
+    std::function<void (Request&)> onComplete;
+};
+
+class Backend {
+public:
+    virtual ~Backend() = default;
+
+    // Issues the reads for all ranges of the request
+    virtual void submit(std::shared_ptr<Request> request) = 0;
+
+    virtual bool isIoUring() const = 0;
+};
+
+// Performs the reads as blocking reads on a ThreadPool. Every range is a separate task so
+// that the ranges of a vectored read are read in parallel
+class ThreadPoolBackend final : public Backend {
+public:
+    ThreadPoolBackend()
+        : _pool(std::max(static_cast<int>(std::thread::hardware_concurrency()), 4))
+    {}
+
+    void submit(std::shared_ptr<Request> request) override {
+        for (size_t i = 0; i < request->ranges.size(); ++i) {
+            _pool.queue([request, i]() {
+                const AsyncFile::Range& range = request->ranges[i];
+                size_t nRead = 0;
+                const bool success = request->file->readAt(
+                    range.offset,
+                    request->buffers[i].data(),
+                    range.size,
+                    nRead
+                );
+                if (!success) {
+                    request->fail(strerror(errno));
+                }
+                request->finishRange(i, nRead);
+            });
+        }
+    }
+
+    bool isIoUring() const override {
+        return false;
+    }
+
+private:
+    ThreadPool _pool;
+};
+
+#ifdef __linux__
+
+// Submits the reads to an io_uring that is set up and driven through the raw system calls
+// and collects their completions on a single background thread. A read that returns
+// fewer bytes than requested is resubmitted for the remaining bytes until the end of the
+// file is reached
+class IoUringBackend final : public Backend {
+public:
+    // Returns nullptr if the kernel does not support io_uring or prevents its use
+    static std::unique_ptr<IoUringBackend> create() {
+        std::unique_ptr<IoUringBackend> backend(new IoUringBackend);
+        return backend->initialize() ? std::move(backend) : nullptr;
+    }
+
+    ~IoUringBackend() override {
+        if (_completionThread.joinable()) {
+            // A no-op without a segment signals the completion thread to terminate
+            {
+                std::lock_guard lock(_submitMutex);
+                io_uring_sqe& sqe = nextSqe();
+                sqe.opcode = IORING_OP_NOP;
+                sqe.user_data = 0;
+                flush();
+            }
+            _completionThread.join();
+        }
+        for (Segment* segment : _backlog) {
+            delete segment;
+        }
+        if (_sqes) {
+            munmap(_sqes, _sqesSize);
+        }
+        if (_cqRing && _cqRing != _sqRing) {
+            munmap(_cqRing, _cqRingSize);
+        }
+        if (_sqRing) {
+            munmap(_sqRing, _sqRingSize);
+        }
+        if (_ring != -1) {
+            close(_ring);
+        }
+    }
+
+    void submit(std::shared_ptr<Request> request) override {
+        for (size_t i = 0; i < request->ranges.size(); ++i) {
+            if (request->ranges[i].size == 0) {
+                request->finishRange(i, 0);
+                continue;
+            }
+
+            Segment* segment = new Segment{ request, i, 0, {} };
+            {
+                // Every read in flight occupies a completion queue entry, which must not
+                // overflow
+                std::unique_lock lock(_flightMutex);
+                if (std::this_thread::get_id() == _completionThread.get_id()) {
+                    // A callback that issues another read cannot wait for a free entry,
+                    // as only the completion thread frees them. The read is submitted
+                    // by the completion thread once an entry has become free
+                    if (_nInFlight >= _cqEntries) {
+                        _backlog.push_back(segment);
+                        continue;
+                    }
+                }
+                else {
+                    _flightCondition.wait(
+                        lock,
+                        [this]() { return _nInFlight < _cqEntries; }
+                    );
+                }
+                ++_nInFlight;
+            }
+
+            std::lock_guard lock(_submitMutex);
+            push(segment);
+        }
+
+        // All reads of the request are submitted to the kernel with a single call
+        std::lock_guard lock(_submitMutex);
+        flush();
+    }
+
+    bool isIoUring() const override {
+        return true;
+    }
+
+private:
+    // A single range of a request that is read by one submission queue entry
+    struct Segment {
+        std::shared_ptr<Request> request;
+        size_t index;
+        size_t nRead;
+        iovec iov;
+    };
+
+    IoUringBackend() = default;
+
+    bool initialize() {
+        io_uring_params params = {};
+        _ring = static_cast<int>(syscall(__NR_io_uring_setup, RingEntries, &params));
+        if (_ring < 0) {
+            _ring = -1;
+            return false;
+        }
+
+        _sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+        _cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool isSingleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (isSingleMap) {
+            _sqRingSize = std::max(_sqRingSize, _cqRingSize);
+            _cqRingSize = _sqRingSize;
+        }
+
+        _sqRing = mmap(
+            nullptr,
+            _sqRingSize,
+            PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE,
+            _ring,
+            IORING_OFF_SQ_RING
+        );
+        if (_sqRing == MAP_FAILED) {
+            _sqRing = nullptr;
+            return false;
+        }
+        if (isSingleMap) {
+            _cqRing = _sqRing;
+        }
+        else {
+            _cqRing = mmap(
+                nullptr,
+                _cqRingSize,
+                PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_POPULATE,
+                _ring,
+                IORING_OFF_CQ_RING
+            );
+            if (_cqRing == MAP_FAILED) {
+                _cqRing = nullptr;
+                return false;
+            }
+        }
+        _sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = mmap(
+            nullptr,
+            _sqesSize,
+            PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE,
+            _ring,
+            IORING_OFF_SQES
+        );
+        if (sqes == MAP_FAILED) {
+            return false;
+        }
+        _sqes = static_cast<io_uring_sqe*>(sqes);
+
+        char* sq = static_cast<char*>(_sqRing);
+        _sqHead = reinterpret_cast<unsigned int*>(sq + params.sq_off.head);
+        _sqTail = reinterpret_cast<unsigned int*>(sq + params.sq_off.tail);
+        _sqMask = *reinterpret_cast<unsigned int*>(sq + params.sq_off.ring_mask);
+        _sqArray = reinterpret_cast<unsigned int*>(sq + params.sq_off.array);
+        _sqEntries = params.sq_entries;
+
+        char* cq = static_cast<char*>(_cqRing);
+        _cqHead = reinterpret_cast<unsigned int*>(cq + params.cq_off.head);
+        _cqTail = reinterpret_cast<unsigned int*>(cq + params.cq_off.tail);
+        _cqMask = *reinterpret_cast<unsigned int*>(cq + params.cq_off.ring_mask);
+        _cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        _cqEntries = params.cq_entries;
+
+        _completionThread = std::thread(&IoUringBackend::completionThread, this);
+        return true;
+    }
+
+    int enter(unsigned int toSubmit, unsigned int minComplete, unsigned int flags) {
+        return static_cast<int>(syscall(
+            __NR_io_uring_enter, _ring, toSubmit, minComplete, flags, nullptr, 0
+        ));
+    }
+
+    // Returns the next free submission queue entry. The submission queue is flushed if
+    // it is full. The kernel only reads the entries when they are submitted in flush, so
+    // the entry can be filled after it was added. Expects the _submitMutex to be held by
+    // the caller
+    io_uring_sqe& nextSqe() {
+        const unsigned int tail = *_sqTail;
+        if (tail - __atomic_load_n(_sqHead, __ATOMIC_ACQUIRE) == _sqEntries) {
+            flush();
+        }
+        const unsigned int index = tail & _sqMask;
+        io_uring_sqe& sqe = _sqes[index];
+        std::memset(&sqe, 0, sizeof(io_uring_sqe));
+        _sqArray[index] = index;
+        __atomic_store_n(_sqTail, tail + 1, __ATOMIC_RELEASE);
+        return sqe;
+    }
+
+    // Adds a read for the remaining bytes of the segment to the submission queue.
+    // Expects the _submitMutex to be held by the caller
+    void push(Segment* segment) {
+        const AsyncFile::Range& range = segment->request->ranges[segment->index];
+        segment->iov.iov_base = segment->request->buffers[segment->index].data() +
+                                segment->nRead;
+        segment->iov.iov_len = range.size - segment->nRead;
+
+        io_uring_sqe& sqe = nextSqe();
+        sqe.opcode = IORING_OP_READV;
+        sqe.fd = segment->request->file->fd;
+        sqe.off = range.offset + segment->nRead;
+        sqe.addr = reinterpret_cast<uint64_t>(&segment->iov);
+        sqe.len = 1;
+        sqe.user_data = reinterpret_cast<uint64_t>(segment);
+    }
+
+    // Submits all entries in the submission queue to the kernel. Expects the
+    // _submitMutex to be held by the caller
+    void flush() {
+        unsigned int pending = *_sqTail - __atomic_load_n(_sqHead, __ATOMIC_ACQUIRE);
+        while (pending > 0) {
+            const int res = enter(pending, 0, 0);
+            if (res < 0) {
+                if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                LERROR(fmt::format("Error submitting reads: {}", strerror(errno)));
+                return;
+            }
+            pending -= static_cast<unsigned int>(res);
+        }
+    }
+
+    void completionThread() {
+        bool isRunning = true;
+        while (isRunning) {
+            const int res = enter(0, 1, IORING_ENTER_GETEVENTS);
+            if (res < 0 && errno != EINTR) {
+                LERROR(fmt::format("Error waiting for reads: {}", strerror(errno)));
+                return;
+            }
+
+            std::vector<Segment*> resubmit;
+            size_t nCompleted = 0;
+            unsigned int head = *_cqHead;
+            const unsigned int tail = __atomic_load_n(_cqTail, __ATOMIC_ACQUIRE);
+            {
+                // The segments were handed to us through the kernel, which is invisible
+                // to the memory model. Acquiring the mutex that the submitting threads
+                // held orders their writes to the segments before our reads
+                std::lock_guard lock(_submitMutex);
+            }
+            for (; head != tail; ++head) {
+                const io_uring_cqe& cqe = _cqes[head & _cqMask];
+                Segment* segment = reinterpret_cast<Segment*>(cqe.user_data);
+                if (!segment) {
+                    isRunning = false;
+                    continue;
+                }
+
+                Request& request = *segment->request;
+                const size_t size = request.ranges[segment->index].size;
+                if (cqe.res == -EINTR || cqe.res == -EAGAIN) {
+                    resubmit.push_back(segment);
+                    continue;
+                }
+                if (cqe.res < 0) {
+                    request.fail(strerror(-cqe.res));
+                }
+                else {
+                    segment->nRead += static_cast<size_t>(cqe.res);
+                    if (cqe.res > 0 && segment->nRead < size) {
+                        // A short read that did not reach the end of the file
+                        resubmit.push_back(segment);
+                        continue;
+                    }
+                }
+                request.finishRange(segment->index, segment->nRead);
+                delete segment;
+                ++nCompleted;
+            }
+            __atomic_store_n(_cqHead, head, __ATOMIC_RELEASE);
+
+            if (nCompleted > 0) {
+                {
+                    std::lock_guard lock(_flightMutex);
+                    _nInFlight -= nCompleted;
+                    // Reads issued by the callbacks take precedence over the waiting
+                    // threads, since they have been waiting longer
+                    while (!_backlog.empty() && _nInFlight < _cqEntries) {
+                        resubmit.push_back(_backlog.front());
+                        _backlog.pop_front();
+                        ++_nInFlight;
+                    }
+                }
+                _flightCondition.notify_all();
+            }
+            if (!resubmit.empty()) {
+                std::lock_guard lock(_submitMutex);
+                for (Segment* segment : resubmit) {
+                    push(segment);
+                }
+                flush();
+            }
+        }
+    }
+
+    int _ring = -1;
+
+    void* _sqRing = nullptr;
+    size_t _sqRingSize = 0;
+    unsigned int* _sqHead = nullptr;
+    unsigned int* _sqTail = nullptr;
+    unsigned int _sqMask = 0;
+    unsigned int* _sqArray = nullptr;
+    unsigned int _sqEntries = 0;
+    io_uring_sqe* _sqes = nullptr;
+    size_t _sqesSize = 0;
+
+    void* _cqRing = nullptr;
+    size_t _cqRingSize = 0;
+    unsigned int* _cqHead = nullptr;
+    unsigned int* _cqTail = nullptr;
+    unsigned int _cqMask = 0;
+    io_uring_cqe* _cqes = nullptr;
+    size_t _cqEntries = 0;
+
+    // Protects the submission queue
+    std::mutex _submitMutex;
+
+    std::mutex _flightMutex;
+    std::condition_variable _flightCondition;
+    size_t _nInFlight = 0;
+    // Reads that were issued on the completion thread while the completion queue was
+    // full. Protected by the _flightMutex
+    std::deque<Segment*> _backlog;
+
+    std::thread _completionThread;
+};
+
+#endif // __linux__
+
+Backend& backend() {
+    static std::unique_ptr<Backend> b = []() -> std::unique_ptr<Backend> {
+#ifdef __linux__
+        std::unique_ptr<IoUringBackend> ioUring = IoUringBackend::create();
+        if (ioUring) {
+            return ioUring;
+        }
+        LDEBUG("io_uring is not available, reading files on a thread pool instead");
+#endif // __linux__
+        return std::make_unique<ThreadPoolBackend>();
+    }();
+    return *b;
+}
+
+} // namespace
+
+AsyncFile::AsyncFileException::AsyncFileException(std::string f, std::string msg)
+    : RuntimeError(fmt::format("Error reading '{}': {}", f, msg), "AsyncFile")
+    , file(std::move(f))
+{}
+
+AsyncFile::AsyncFile(std::string path)
+    : _path(std::move(path))
+{
+    ghoul_assert(!_path.empty(), "Path must not be empty");
+
+    _handle = std::make_shared<Handle>(_path);
+    _size = _handle->size();
+}
+
+AsyncFile::~AsyncFile() = default;
+
+const std::string& AsyncFile::path() const {
+    return _path;
+}
+
+uint64_t AsyncFile::size() const {
+    return _size;
+}
+
+std::future<std::vector<char>> AsyncFile::read(uint64_t offset, size_t size) const {
+    auto promise = std::make_shared<std::promise<std::vector<char>>>();
+    std::future<std::vector<char>> future = promise->get_future();
+    read(
+        offset,
+        size,
+        [promise](std::vector<char> data, std::exception_ptr error) {
+            if (error) {
+                promise->set_exception(error);
+            }
+            else {
+                promise->set_value(std::move(data));
+            }
+        }
+    );
+    return future;
+}
+
+void AsyncFile::read(uint64_t offset, size_t size, Callback callback) const {
+    ghoul_assert(callback, "Callback must not be empty");
+
+    backend().submit(std::make_shared<Request>(
+        _path,
+        _handle,
+        std::vector<Range>{ { offset, size } },
+        [callback = std::move(callback)](Request& request) {
+            if (request.error) {
+                callback({}, request.error);
+            }
+            else {
+                callback(std::move(request.buffers[0]), nullptr);
+            }
+        }
+    ));
+}
+
+std::future<std::vector<std::vector<char>>> AsyncFile::read(
+                                                          std::vector<Range> ranges) const
+{
+    using Result = std::vector<std::vector<char>>;
+    auto promise = std::make_shared<std::promise<Result>>();
+    std::future<Result> future = promise->get_future();
+    if (ranges.empty()) {
+        promise->set_value(Result());
+        return future;
+    }
+
+    backend().submit(std::make_shared<Request>(
+        _path,
+        _handle,
+        std::move(ranges),
+        [promise](Request& request) {
+            if (request.error) {
+                promise->set_exception(request.error);
+            }
+            else {
+                promise->set_value(std::move(request.buffers));
+            }
+        }
+    ));
+    return future;
+}
+
+std::future<std::vector<char>> AsyncFile::readAll() const {
+    return read(0, static_cast<size_t>(_size));
+}
+
+std::vector<std::future<std::vector<char>>> AsyncFile::readFiles(
+                                                    const std::vector<std::string>& paths)
+{
+    std::vector<std::future<std::vector<char>>> result;
+    result.reserve(paths.size());
+    for (const std::string& path : paths) {
+        try {
+            // The file is kept open by the pending read after the AsyncFile is gone
+            result.push_back(AsyncFile(path).readAll());
+        }
+        catch (const AsyncFileException&) {
+            std::promise<std::vector<char>> promise;
+            promise.set_exception(std::current_exception());
+            result.push_back(promise.get_future());
+        }
+    }
+    return result;
+}
+
+bool AsyncFile::isUsingIoUring() {
+    return backend().isIoUring();
+}
+
+} // namespace ghoul::io
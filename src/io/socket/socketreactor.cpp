@@ -0,0 +1,340 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2020                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifdef __linux__
+
+#include <ghoul/io/socket/socketreactor.h>
+
+#include <ghoul/fmt.h>
+#include <ghoul/logging/logmanager.h>
+#include <ghoul/misc/assert.h>
+#include <ghoul/misc/exception.h>
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+namespace {
+    constexpr const char* _loggerCat = "SocketReactor";
+
+    // The identifier of the wakeup handle in the epoll instances, which is never handed
+    // out for a socket registration
+    constexpr const uint64_t WakeupId = 0;
+
+    // Protects the Registration::waitingFor of all SocketReactors, as callbacks of one
+    // reactor might unregister sockets of another one
+    std::mutex WaitMutex;
+
+    uint32_t epollEvents(int events) {
+        using ghoul::io::SocketReactor;
+        uint32_t res = 0;
+        if (events & SocketReactor::Readable) {
+            res |= EPOLLIN | EPOLLRDHUP;
+        }
+        if (events & SocketReactor::Writable) {
+            res |= EPOLLOUT;
+        }
+        return res;
+    }
+
+    int reactorEvents(uint32_t events) {
+        using ghoul::io::SocketReactor;
+        int res = SocketReactor::None;
+        if (events & EPOLLIN) {
+            res |= SocketReactor::Readable;
+        }
+        if (events & EPOLLOUT) {
+            res |= SocketReactor::Writable;
+        }
+        if (events & (EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+            res |= SocketReactor::Closed;
+        }
+        return res;
+    }
+} // namespace
+
+namespace ghoul::io {
+
+thread_local SocketReactor::Registration* SocketReactor::_runningRegistration = nullptr;
+
+SocketReactor::SocketReactor(int nThreads) {
+    ghoul_assert(nThreads > 0, "nThreads must be bigger than 0");
+
+    _loops.reserve(nThreads);
+    for (int i = 0; i < nThreads; ++i) {
+        auto loop = std::make_unique<Loop>();
+        loop->epollHandle = epoll_create1(EPOLL_CLOEXEC);
+        loop->wakeupHandle = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (loop->epollHandle == -1 || loop->wakeupHandle == -1) {
+            const std::string error = std::strerror(errno);
+            for (int handle : { loop->epollHandle, loop->wakeupHandle }) {
+                if (handle != -1) {
+                    close(handle);
+                }
+            }
+            stopLoops();
+            throw RuntimeError(
+                fmt::format("Could not create event loop: {}", error),
+                "SocketReactor"
+            );
+        }
+
+        epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.u64 = WakeupId;
+        epoll_ctl(loop->epollHandle, EPOLL_CTL_ADD, loop->wakeupHandle, &event);
+
+        Loop& l = *loop;
+        _loops.push_back(std::move(loop));
+        l.thread = std::thread([this, &l]() { runLoop(l); });
+    }
+}
+
+SocketReactor::~SocketReactor() {
+    stopLoops();
+}
+
+void SocketReactor::stopLoops() {
+    _keepGoing = false;
+    for (const std::unique_ptr<Loop>& loop : _loops) {
+        const uint64_t value = 1;
+        [[maybe_unused]] ssize_t res = write(loop->wakeupHandle, &value, sizeof(value));
+    }
+    for (const std::unique_ptr<Loop>& loop : _loops) {
+        if (loop->thread.joinable()) {
+            loop->thread.join();
+        }
+        close(loop->epollHandle);
+        close(loop->wakeupHandle);
+    }
+    _loops.clear();
+}
+
+SocketReactor& SocketReactor::ref() {
+    // A handful of threads is enough to saturate the network, since the callbacks only
+    // move bytes between the sockets and the queues. The reactor is never destroyed, as
+    // sockets that are destroyed during the destruction of static objects still have to
+    // unregister themselves
+    static SocketReactor* reactor = new SocketReactor(
+        std::clamp(static_cast<int>(std::thread::hardware_concurrency()) / 4, 1, 4)
+    );
+    return *reactor;
+}
+
+uint64_t SocketReactor::registerSocket(_SOCKET socket, int events, Callback callback) {
+    ghoul_assert(socket != INVALID_SOCKET, "Socket must be valid");
+    ghoul_assert(callback, "Callback must not be empty");
+
+    const uint64_t id = _nextId++;
+    Loop& loop = loopFor(id);
+
+    auto registration = std::make_shared<Registration>();
+    registration->socket = socket;
+    registration->events = events;
+    registration->callback = std::move(callback);
+
+    std::lock_guard lock(loop.registrationMutex);
+    if (events != None) {
+        epoll_event event = {};
+        event.events = epollEvents(events);
+        event.data.u64 = id;
+        if (epoll_ctl(loop.epollHandle, EPOLL_CTL_ADD, socket, &event) == -1) {
+            throw RuntimeError(
+                fmt::format("Could not register socket: {}", std::strerror(errno)),
+                "SocketReactor"
+            );
+        }
+    }
+    loop.registrations[id] = std::move(registration);
+    return id;
+}
+
+void SocketReactor::setEvents(uint64_t id, int events) {
+    updateEvents(id, events, Readable | Writable | Closed);
+}
+
+void SocketReactor::addEvents(uint64_t id, int events) {
+    updateEvents(id, events, events);
+}
+
+void SocketReactor::removeEvents(uint64_t id, int events) {
+    updateEvents(id, None, events);
+}
+
+void SocketReactor::updateEvents(uint64_t id, int events, int mask) {
+    Loop& loop = loopFor(id);
+
+    std::lock_guard lock(loop.registrationMutex);
+    auto it = loop.registrations.find(id);
+    if (it == loop.registrations.end() || it->second->isUnregistered) {
+        return;
+    }
+    Registration& registration = *it->second;
+    events = (registration.events & ~mask) | (events & mask);
+    if (registration.events == events) {
+        return;
+    }
+
+    epoll_event event = {};
+    event.events = epollEvents(events);
+    event.data.u64 = id;
+    int operation = EPOLL_CTL_MOD;
+    if (registration.events == None) {
+        operation = EPOLL_CTL_ADD;
+    }
+    else if (events == None) {
+        // Hangups and errors are reported regardless of the requested events, so the
+        // socket has to be removed to stop receiving them
+        operation = EPOLL_CTL_DEL;
+    }
+    if (epoll_ctl(loop.epollHandle, operation, registration.socket, &event) == -1) {
+        LERROR(fmt::format("Could not change socket events: {}", std::strerror(errno)));
+        return;
+    }
+    registration.events = events;
+}
+
+void SocketReactor::unregisterSocket(uint64_t id) {
+    Loop& loop = loopFor(id);
+
+    std::unique_lock lock(loop.registrationMutex);
+    auto it = loop.registrations.find(id);
+    if (it == loop.registrations.end() || it->second->isUnregistered) {
+        return;
+    }
+    const std::shared_ptr<Registration> registration = it->second;
+    if (registration->events != None) {
+        epoll_ctl(loop.epollHandle, EPOLL_CTL_DEL, registration->socket, nullptr);
+        registration->events = None;
+    }
+    if (!registration->isRunning) {
+        loop.registrations.erase(it);
+        return;
+    }
+
+    // The callback is currently running, so the loop removes the registration once the
+    // callback returns
+    registration->isUnregistered = true;
+    Registration* self = _runningRegistration;
+    if (registration.get() == self) {
+        // We are called from the socket's own callback, which cannot be waited for
+        return;
+    }
+
+    if (self) {
+        // We are called from the callback of another socket, which must not wait if the
+        // running callback is itself waiting, directly or indirectly, for our callback
+        std::lock_guard waitLock(WaitMutex);
+        for (const Registration* r = registration.get(); r; r = r->waitingFor) {
+            if (r == self) {
+                return;
+            }
+        }
+        self->waitingFor = registration.get();
+    }
+    loop.callbackFinished.wait(lock, [&registration]() {
+        return !registration->isRunning;
+    });
+    if (self) {
+        std::lock_guard waitLock(WaitMutex);
+        self->waitingFor = nullptr;
+    }
+}
+
+int SocketReactor::nThreads() const {
+    return static_cast<int>(_loops.size());
+}
+
+SocketReactor::Loop& SocketReactor::loopFor(uint64_t id) {
+    return *_loops[id % _loops.size()];
+}
+
+void SocketReactor::runLoop(Loop& loop) {
+    std::array<epoll_event, 64> events;
+    while (_keepGoing) {
+        const int nEvents = epoll_wait(
+            loop.epollHandle,
+            events.data(),
+            static_cast<int>(events.size()),
+            -1
+        );
+        if (nEvents < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LERROR(fmt::format("Event loop failed: {}", std::strerror(errno)));
+            break;
+        }
+
+        for (int i = 0; i < nEvents; ++i) {
+            const uint64_t id = events[i].data.u64;
+            if (id == WakeupId) {
+                // The wakeup handle is only signalled when we are supposed to stop
+                continue;
+            }
+
+            std::shared_ptr<Registration> registration;
+            {
+                // The socket might have been unregistered or disabled by an earlier
+                // callback of the same batch
+                std::lock_guard lock(loop.registrationMutex);
+                auto it = loop.registrations.find(id);
+                if (it == loop.registrations.end() || it->second->events == None) {
+                    continue;
+                }
+                registration = it->second;
+                registration->isRunning = true;
+            }
+
+            _runningRegistration = registration.get();
+            try {
+                registration->callback(reactorEvents(events[i].events));
+            }
+            catch (const std::exception& e) {
+                LERROR(fmt::format("Socket callback failed: {}", e.what()));
+            }
+            catch (...) {
+                LERROR("Socket callback failed with an unknown exception");
+            }
+            _runningRegistration = nullptr;
+
+            {
+                std::lock_guard lock(loop.registrationMutex);
+                registration->isRunning = false;
+                if (registration->isUnregistered) {
+                    loop.registrations.erase(id);
+                }
+            }
+            loop.callbackFinished.notify_all();
+        }
+    }
+}
+
+} // namespace ghoul::io
+
+#endif // __linux__
@@ -24,11 +24,14 @@
  ****************************************************************************************/
 
 #include <ghoul/io/socket/tcpsocket.h>
+
+#include <ghoul/io/socket/socketreactor.h>
 #include <ghoul/logging/logmanager.h>
 #include <fmt/format.h>
 
 #include <algorithm>
 #include <cstring>
+#include <tuple>
 
 #ifdef WIN32
 #define NOMINMAX
@@ -60,6 +63,9 @@
 #include <arpa/inet.h>
 #include <netdb.h>
 #include <errno.h>
+#ifdef __linux__
+#include <fcntl.h>
+#endif // __linux__
 
 #ifndef SOCKET_ERROR
 #define SOCKET_ERROR (-1)
@@ -81,6 +87,28 @@
 namespace {
     constexpr const char* _loggerCat = "TcpSocket";
     constexpr const char DefaultDelimiter = '\n';
+
+#ifdef __linux__
+    // The number of reads for a single event of the SocketReactor, which prevents a busy
+    // socket from starving the other sockets that are served by the same thread
+    constexpr const int MaxReadsPerEvent = 16;
+
+    void setNonBlocking(_SOCKET socket) {
+        const int flags = fcntl(socket, F_GETFL, 0);
+        fcntl(socket, F_SETFL, flags | O_NONBLOCK);
+    }
+
+    // Returns whether a call on a nonblocking socket failed only because it would have
+    // had to wait. Both error codes are allowed by POSIX, but they are the same value on
+    // most systems, in which case comparing against both of them only causes a warning
+    bool wouldBlock(int error) {
+#if EAGAIN != EWOULDBLOCK
+        return error == EAGAIN || error == EWOULDBLOCK;
+#else // ^^^^ EAGAIN != EWOULDBLOCK // EAGAIN == EWOULDBLOCK vvvv
+        return error == EAGAIN;
+#endif // EAGAIN != EWOULDBLOCK
+    }
+#endif // __linux__
 } // namespace
 
 namespace ghoul::io {
@@ -91,22 +119,31 @@ TcpSocket::TcpSocketError::TcpSocketError(std::string msg, std::string comp)
     : RuntimeError(std::move(msg), std::move(comp))
 {}
 
-TcpSocket::TcpSocket(std::string address, int port)
+TcpSocket::TcpSocket(std::string address, int port, QueueCapacity queueCapacity)
     : _address(std::move(address))
     , _port(port)
     , _socket(INVALID_SOCKET)
+    , _inputQueue(queueCapacity.bytes)
+    , _outputQueue(queueCapacity.bytes)
     , _delimiter(DefaultDelimiter)
 {}
 
-TcpSocket::TcpSocket(std::string address, int port, _SOCKET socket)
+TcpSocket::TcpSocket(std::string address, int port, _SOCKET socket,
+                     QueueCapacity queueCapacity)
     : _address(std::move(address))
     , _port(port)
     , _isConnected(true)
     , _socket(socket)
+    , _inputQueue(queueCapacity.bytes)
+    , _outputQueue(queueCapacity.bytes)
     , _delimiter(DefaultDelimiter)
 {}
 
 TcpSocket::~TcpSocket() {
+#ifdef __linux__
+    // The reactor might still be serving a socket that has disconnected already
+    disconnect();
+#else // ^^^^ __linux__ // !__linux__ vvvv
     if (_isConnected) {
         disconnect();
     }
@@ -117,6 +154,7 @@ TcpSocket::~TcpSocket() {
     if (_outputThread.joinable()) {
         _outputThread.join();
     }
+#endif // __linux__
 }
 
 std::string TcpSocket::address() const {
@@ -128,12 +166,23 @@ int TcpSocket::port() const {
 }
 
 void TcpSocket::startStreams() {
+#ifdef __linux__
+    setNonBlocking(_socket);
+    registerWithReactor(SocketReactor::Readable);
+
+    // Bytes might have been put into the socket before the streams were started
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (hasPendingOutput()) {
+        requestWritable();
+    }
+#else // ^^^^ __linux__ // !__linux__ vvvv
     _inputThread = std::thread(
         [this]() { streamInput(); }
     );
     _outputThread = std::thread(
         [this]() { streamOutput(); }
     );
+#endif // __linux__
 }
 
 void TcpSocket::connect() {
@@ -169,17 +218,31 @@ void TcpSocket::connect() {
 
     _isConnecting = true;
 
+#ifdef __linux__
+    // The connection is established asynchronously by the reactor
+    establishConnection(addresult);
+#else // ^^^^ __linux__ // !__linux__ vvvv
     _outputThread = std::thread([this, addresult]() {
         establishConnection(addresult);
         _inputThread = std::thread([this]() { streamInput(); });
         streamOutput();
     });
+#endif // __linux__
 }
 
 void TcpSocket::closeSocket() {
+#ifdef __linux__
+    // A socket that failed is disabled in the reactor, but stays open until here
+    if (_socket == INVALID_SOCKET) {
+        _isConnected = false;
+        _isConnecting = false;
+        return;
+    }
+#else // ^^^^ __linux__ // !__linux__ vvvv
     if (!_isConnected && !_isConnecting) {
         return;
     }
+#endif // __linux__
 
 #ifdef WIN32
     shutdown(_socket, SD_BOTH);
@@ -195,6 +258,20 @@ void TcpSocket::closeSocket() {
 }
 
 void TcpSocket::disconnect(int) {
+#ifdef __linux__
+    // The socket must not be closed while the reactor might still be using it
+    unregisterFromReactor();
+    if (_socket == INVALID_SOCKET) {
+        return;
+    }
+
+    _shouldStopThreads = true;
+    closeSocket();
+
+    _inputNotifier.notify_all();
+    _outputNotifier.notify_all();
+    _shouldStopThreads = false;
+#else // ^^^^ __linux__ // !__linux__ vvvv
     if (!_isConnected && !_isConnecting) {
         return;
     }
@@ -212,6 +289,7 @@ void TcpSocket::disconnect(int) {
         _outputThread.join();
     }
     _shouldStopThreads = false;
+#endif // __linux__
 }
 
 bool TcpSocket::isConnected() const {
@@ -223,18 +301,21 @@ bool TcpSocket::isConnecting() const {
 }
 
 bool TcpSocket::getMessage(std::string& message) {
-    int delimiterIndex = waitForDelimiter();
-    if (delimiterIndex == 0) {
+    std::lock_guard inputLock(_inputQueueMutex);
+    std::string_view view;
+    if (!nextMessage(view)) {
         return false;
     }
-    std::lock_guard<std::mutex> inputLock(_inputQueueMutex);
-    message = std::string(_inputQueue.begin(), _inputQueue.begin() + delimiterIndex);
-    if (static_cast<int>(_inputQueue.size()) >= delimiterIndex + 1) {
-        _inputQueue.erase(_inputQueue.begin(), _inputQueue.begin() + delimiterIndex + 1);
-    }
+    message = view;
+    releaseMessage();
     return true;
 }
 
+bool TcpSocket::getMessage(std::string_view& message) {
+    std::lock_guard inputLock(_inputQueueMutex);
+    return nextMessage(message);
+}
+
 bool TcpSocket::putMessage(const std::string& message) {
     if (!putBytes(message.data(), message.size())) {
         return false;
@@ -314,12 +395,196 @@ void TcpSocket::establishConnection(addrinfo *info) {
         return;
     }
 
+#ifdef __linux__
+    // Try to connect. The connection is completed in the background and the reactor
+    // signals its completion by reporting the socket as writable
+    setNonBlocking(_socket);
+    result = ::connect(_socket, info->ai_addr, static_cast<int>(info->ai_addrlen));
+    freeaddrinfo(info);
+    if (result == SOCKET_ERROR && errno != EINPROGRESS) {
+        LWARNING(fmt::format("Socket error: {}", _ERRNO));
+        closeSocket();
+        _shouldStopThreads = true;
+        _inputNotifier.notify_all();
+        _outputNotifier.notify_all();
+        return;
+    }
+
+    _isWaitingForWritable = true;
+    registerWithReactor(SocketReactor::Writable);
+#else // ^^^^ __linux__ // !__linux__ vvvv
     // Try to connect
     ::connect(_socket, info->ai_addr, static_cast<int>(info->ai_addrlen));
     _isConnected = true;
     _isConnecting = false;
+#endif // __linux__
+}
+
+#ifdef __linux__
+
+void TcpSocket::registerWithReactor(int events) {
+    SocketReactor& reactor = SocketReactor::ref();
+
+    // The socket is registered without events first, as the callback needs the id
+    _reactorId = reactor.registerSocket(
+        _socket,
+        SocketReactor::None,
+        [this](int e) { handleEvents(e); }
+    );
+    reactor.setEvents(_reactorId, events);
+}
+
+void TcpSocket::requestWritable() {
+    // Only the first thread that finds the socket not waiting has to change the events
+    if (!_isWaitingForWritable.exchange(true)) {
+        SocketReactor::ref().addEvents(_reactorId, SocketReactor::Writable);
+    }
+}
+
+void TcpSocket::unregisterFromReactor() {
+    const uint64_t id = _reactorId.exchange(0);
+    if (id != 0) {
+        SocketReactor::ref().unregisterSocket(id);
+    }
+}
+
+void TcpSocket::handleEvents(int events) {
+    SocketReactor& reactor = SocketReactor::ref();
+
+    bool success = true;
+    if (_isConnecting) {
+        int error = 0;
+        socklen_t length = sizeof(error);
+        getsockopt(_socket, SOL_SOCKET, SO_ERROR, &error, &length);
+        success = (error == 0);
+
+        if (success) {
+            // From now on we are always interested in the incoming data, but only in the
+            // socket being writable if there is something to send
+            _isConnected = true;
+            _isConnecting = false;
+            reactor.setEvents(_reactorId, SocketReactor::Readable);
+            _isWaitingForWritable = false;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (hasPendingOutput()) {
+                requestWritable();
+            }
+            return;
+        }
+    }
+    else {
+        if (events & (SocketReactor::Readable | SocketReactor::Closed)) {
+            success = receiveInput();
+        }
+        if (success && (events & SocketReactor::Writable)) {
+            success = sendOutput();
+        }
+    }
+
+    if (!success) {
+        // The socket is only disabled here and closed in disconnect, as other threads
+        // might still be using it
+        _isConnected = false;
+        _isConnecting = false;
+        reactor.setEvents(_reactorId, SocketReactor::None);
+        _shouldStopThreads = true;
+        {
+            std::lock_guard lock(_inputBufferMutex);
+        }
+        _inputNotifier.notify_all();
+        _outputNotifier.notify_all();
+    }
+}
+
+bool TcpSocket::receiveInput() {
+    for (int i = 0; i < MaxReadsPerEvent; ++i) {
+        std::lock_guard lock(_inputInterceptionMutex);
+
+        char* buffer = _inputBuffer.data();
+        size_t size = _inputBuffer.size();
+        if (!_inputInterceptor) {
+            // The bytes are received directly into the input queue
+            std::tie(buffer, size) = _inputQueue.writeRegion();
+            if (size == 0) {
+                // The queue is full, so we stop reading until the consumer makes room
+                SocketReactor::ref().removeEvents(_reactorId, SocketReactor::Readable);
+                _isInputPaused = true;
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (_inputQueue.freeSpace() > 0) {
+                    resumeInput();
+                }
+                return true;
+            }
+        }
+
+        const ssize_t nReadBytes = recv(_socket, buffer, size, 0);
+        if (nReadBytes == 0) {
+            // The connection was closed by the other side
+            return false;
+        }
+        if (nReadBytes < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return wouldBlock(errno);
+        }
+
+        if (_inputInterceptor) {
+            _inputInterceptor(buffer, nReadBytes);
+        }
+        else {
+            _inputQueue.commit(nReadBytes);
+            notifyInput();
+        }
+
+        if (static_cast<size_t>(nReadBytes) < size) {
+            // The socket has been drained
+            return true;
+        }
+    }
+    // There is more data waiting, but the reactor will call us again for it
+    return true;
+}
+
+bool TcpSocket::sendOutput() {
+    while (true) {
+        const std::pair<const char*, size_t> region = _outputQueue.readRegion();
+        if (region.second == 0) {
+            if (_hasOutputOverflow && moveOutputOverflow()) {
+                continue;
+            }
+            break;
+        }
+
+        const ssize_t nSentBytes = send(
+            _socket,
+            region.first,
+            region.second,
+            MSG_NOSIGNAL
+        );
+        if (nSentBytes < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // If the send buffer is full, we are called again once there is room
+            return wouldBlock(errno);
+        }
+        _outputQueue.consume(nSentBytes);
+    }
+
+    // Everything has been sent, so there is no need to wait for the socket anymore. If
+    // more bytes were put in the meantime, we have to keep waiting after all
+    SocketReactor::ref().removeEvents(_reactorId, SocketReactor::Writable);
+    _isWaitingForWritable = false;
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (hasPendingOutput()) {
+        requestWritable();
+    }
+    return true;
 }
 
+#else // ^^^^ __linux__ // !__linux__ vvvv
+
 void TcpSocket::streamInput() {
 #ifdef WIN32
     int nReadBytes = 0;
@@ -331,6 +596,10 @@ void TcpSocket::streamInput() {
     auto failed = [](ssize_t nBytes) { return nBytes == ssize_t(-1); };
 #endif // WIN32
 
+    auto hasSpaceOrDisconnected = [this]() {
+        return _inputQueue.freeSpace() > 0 || _shouldStopThreads || !_isConnected;
+    };
+
     while (_isConnected && !_shouldStopThreads) {
         nReadBytes = recv(
             _socket,
@@ -347,20 +616,34 @@ void TcpSocket::streamInput() {
             return;
         }
 
-        std::lock_guard<std::mutex> lock(_inputInterceptionMutex);
-
-        if (_inputInterceptor) {
-            _inputInterceptor(_inputBuffer.data(), nReadBytes);
+        {
+            std::lock_guard<std::mutex> lock(_inputInterceptionMutex);
+            if (_inputInterceptor) {
+                _inputInterceptor(_inputBuffer.data(), nReadBytes);
+                continue;
+            }
         }
-        else {
-            std::lock_guard inputGuard(_inputQueueMutex);
-            _inputQueue.insert(
-                _inputQueue.end(),
-                _inputBuffer.begin(),
-                _inputBuffer.begin() + nReadBytes
+
+        size_t nWritten = 0;
+        while (nWritten < static_cast<size_t>(nReadBytes)) {
+            nWritten += _inputQueue.write(
+                _inputBuffer.data() + nWritten,
+                static_cast<size_t>(nReadBytes) - nWritten
             );
+            notifyInput();
+
+            if (nWritten < static_cast<size_t>(nReadBytes)) {
+                // The queue is full, so we have to wait for the consumer to make room
+                std::unique_lock lock(_inputBufferMutex);
+                _isInputPaused = true;
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                _inputNotifier.wait(lock, hasSpaceOrDisconnected);
+                _isInputPaused = false;
+                if (_shouldStopThreads || !_isConnected) {
+                    return;
+                }
+            }
         }
-        _inputNotifier.notify_one();
     }
 }
 
@@ -368,21 +651,26 @@ void TcpSocket::streamOutput() {
     while (_isConnected && !_shouldStopThreads) {
         waitForOutput(1);
 
-        size_t nBytesToSend = 0;
-        std::lock_guard outputGuard(_outputQueueMutex);
-        while ((nBytesToSend = std::min(_outputQueue.size(), _outputBuffer.size())) > 0) {
-            std::copy_n(_outputQueue.begin(), nBytesToSend, _outputBuffer.begin());
+        while (true) {
+            const std::pair<const char*, size_t> region = _outputQueue.readRegion();
+            if (region.second == 0) {
+                if (_hasOutputOverflow && moveOutputOverflow()) {
+                    continue;
+                }
+                break;
+            }
 
 #ifdef WIN32
-            int nSentBytes = send(_socket,
-                _outputBuffer.data(),
-                static_cast<int>(nBytesToSend),
+            int nSentBytes = send(
+                _socket,
+                region.first,
+                static_cast<int>(region.second),
                 0
             );
 
             auto failed = [](int nBytes) { return nBytes <= 0; };
 #else
-            ssize_t nSentBytes = send(_socket, _outputBuffer.data(), nBytesToSend, 0);
+            ssize_t nSentBytes = send(_socket, region.first, region.second, 0);
             auto failed = [](ssize_t nBytes) { return nBytes == ssize_t(-1); };
 #endif //WIN32
 
@@ -393,71 +681,149 @@ void TcpSocket::streamOutput() {
                 _outputNotifier.notify_all();
                 return;
             }
-            _outputQueue.erase(_outputQueue.begin(), _outputQueue.begin() + nBytesToSend);
+            _outputQueue.consume(static_cast<size_t>(nSentBytes));
         }
     }
 }
 
-void TcpSocket::waitForInput(size_t nBytes) {
+void TcpSocket::waitForOutput(size_t nBytes) {
     if (nBytes == 0) {
         return;
     }
 
-    auto receivedRequestedInputOrDisconnected = [this, nBytes]() {
+    auto receivedRequestedOutputOrDisconnected = [this, nBytes]() {
         if (_shouldStopThreads || (!_isConnected && !_isConnecting)) {
             return true;
         }
-        std::lock_guard<std::mutex> queueMutex(_inputQueueMutex);
-        return _inputQueue.size() >= nBytes;
+        return _outputQueue.size() >= nBytes || _hasOutputOverflow;
     };
 
-    // Block execution until enough data has come into the input queue.
-    if (!receivedRequestedInputOrDisconnected()) {
-        std::unique_lock<std::mutex> lock(_inputBufferMutex);
-        _inputNotifier.wait(lock, receivedRequestedInputOrDisconnected);
+    // Block execution until enough data has come into the output queue.
+    if (!receivedRequestedOutputOrDisconnected()) {
+        std::unique_lock<std::mutex> lock(_outputBufferMutex);
+        ++_nWaitingForOutput;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        _outputNotifier.wait(lock, receivedRequestedOutputOrDisconnected);
+        --_nWaitingForOutput;
     }
 }
 
-int TcpSocket::waitForDelimiter() {
-    size_t currentIndex = 0;
-    auto receivedRequestedInputOrDisconnected = [this, &currentIndex,
-                                                 d = _delimiter.load()]()
-    {
-        if (_shouldStopThreads || (!_isConnected && !_isConnecting)) {
+#endif // __linux__
+
+bool TcpSocket::nextMessage(std::string_view& message) {
+    releaseMessage();
+    _messageBuffer.clear();
+
+    const char delimiter = _delimiter;
+    size_t nSearched = 0;
+    while (true) {
+        // The I/O thread might commit more bytes during the search, so only the bytes
+        // that were available before are known to have been searched
+        const size_t size = _inputQueue.size();
+        const size_t index = _inputQueue.find(delimiter, nSearched, size);
+        if (index != RingBuffer::npos) {
+            const char* data = _messageBuffer.empty() ?
+                _inputQueue.contiguousData(index) :
+                nullptr;
+
+            if (data) {
+                // The message is removed from the queue once the view is not needed
+                message = std::string_view(data, index);
+                _nMessageBytes = index + 1;
+            }
+            else {
+                // The message wraps around the end of the queue or was too long for it
+                const size_t offset = _messageBuffer.size();
+                _messageBuffer.resize(offset + index);
+                _inputQueue.read(_messageBuffer.data() + offset, index);
+                _inputQueue.consume(1);
+                resumeInput();
+                message = _messageBuffer;
+            }
             return true;
         }
-        std::lock_guard queueMutex(_inputQueueMutex);
-        auto it = std::find(_inputQueue.begin() + currentIndex, _inputQueue.end(), d);
-        currentIndex = it - _inputQueue.begin();
-        return it != _inputQueue.end();
+
+        nSearched = size;
+        if (nSearched == _inputQueue.capacity()) {
+            // The queue is full without a delimiter, so we have to make room
+            const size_t offset = _messageBuffer.size();
+            _messageBuffer.resize(offset + nSearched);
+            _inputQueue.read(_messageBuffer.data() + offset, nSearched);
+            resumeInput();
+            nSearched = 0;
+        }
+
+        if (!waitForInput(nSearched + 1)) {
+            return false;
+        }
+    }
+}
+
+void TcpSocket::releaseMessage() {
+    if (_nMessageBytes > 0) {
+        _inputQueue.consume(_nMessageBytes);
+        _nMessageBytes = 0;
+        resumeInput();
+    }
+}
+
+bool TcpSocket::waitForInput(size_t nBytes) {
+    auto receivedRequestedInputOrDisconnected = [this, nBytes]() {
+        return _inputQueue.size() >= nBytes || _shouldStopThreads ||
+               (!_isConnected && !_isConnecting);
     };
 
-    // Block execution until the delimiter character was found in the input queue.
+    // Block execution until enough data has come into the input queue. The I/O thread
+    // only takes the mutex to notify us if we announced that we are waiting
     if (!receivedRequestedInputOrDisconnected()) {
-        std::unique_lock lock(_inputBufferMutex);
+        std::unique_lock<std::mutex> lock(_inputBufferMutex);
+        ++_nWaitingForInput;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
         _inputNotifier.wait(lock, receivedRequestedInputOrDisconnected);
+        --_nWaitingForInput;
     }
-    return static_cast<int>(currentIndex);
+    return _inputQueue.size() >= nBytes;
 }
 
-void TcpSocket::waitForOutput(size_t nBytes) {
-    if (nBytes == 0) {
+void TcpSocket::resumeInput() {
+    // The I/O thread only stops reading if the input queue was full
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!_isInputPaused.exchange(false)) {
         return;
     }
+#ifdef __linux__
+    SocketReactor::ref().addEvents(_reactorId, SocketReactor::Readable);
+#else // ^^^^ __linux__ // !__linux__ vvvv
+    std::lock_guard lock(_inputBufferMutex);
+    _inputNotifier.notify_all();
+#endif // __linux__
+}
 
-    auto receivedRequestedOutputOrDisconnected = [this, nBytes]() {
-        if (_shouldStopThreads || (!_isConnected && !_isConnecting)) {
-            return true;
-        }
-        std::lock_guard queueMutex(_outputQueueMutex);
-        return _outputQueue.size() >= nBytes;
-    };
+void TcpSocket::notifyInput() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_nWaitingForInput > 0) {
+        std::lock_guard lock(_inputBufferMutex);
+        _inputNotifier.notify_all();
+    }
+}
 
-    // Block execution until enough data has come into the output queue.
-    if (!receivedRequestedOutputOrDisconnected()) {
-        std::unique_lock<std::mutex> lock(_outputBufferMutex);
-        _outputNotifier.wait(lock, receivedRequestedOutputOrDisconnected);
+bool TcpSocket::hasPendingOutput() const {
+    return !_outputQueue.empty() || _hasOutputOverflow;
+}
+
+bool TcpSocket::moveOutputOverflow() {
+    std::lock_guard outputLock(_outputQueueMutex);
+    const size_t n = _outputQueue.write(
+        _outputOverflow.data() + _outputOverflowOffset,
+        _outputOverflow.size() - _outputOverflowOffset
+    );
+    _outputOverflowOffset += n;
+    if (_outputOverflowOffset == _outputOverflow.size()) {
+        _outputOverflow.clear();
+        _outputOverflowOffset = 0;
+        _hasOutputOverflow = false;
     }
+    return n > 0;
 }
 
 void TcpSocket::initializeNetworkApi() {
@@ -493,42 +859,46 @@ void TcpSocket::uninterceptInput() {
 }
 
 bool TcpSocket::getBytes(char* buffer, size_t nItems) {
-    waitForInput(nItems);
-    if (_shouldStopThreads) {
-        return false;
-    }
-    if (!_isConnected && !_isConnecting) {
-        return false;
-    }
     std::lock_guard inputLock(_inputQueueMutex);
-    std::copy_n(_inputQueue.begin(), nItems, buffer);
-    _inputQueue.erase(_inputQueue.begin(), _inputQueue.begin() + nItems);
+    releaseMessage();
+
+    // Requests that are larger than the input queue are served in multiple parts
+    while (nItems > 0) {
+        if (!waitForInput(std::min(nItems, _inputQueue.capacity()))) {
+            return false;
+        }
+        const size_t n = _inputQueue.read(buffer, nItems);
+        buffer += n;
+        nItems -= n;
+        resumeInput();
+    }
     return true;
 }
 
 bool TcpSocket::peekBytes(char* buffer, size_t nItems) {
-    waitForInput(nItems);
-    if (_shouldStopThreads) {
-        return false;
-    }
-    if (!_isConnected && !_isConnecting) {
+    std::lock_guard inputLock(_inputQueueMutex);
+    releaseMessage();
+
+    if (nItems > _inputQueue.capacity() || !waitForInput(nItems)) {
         return false;
     }
-    std::lock_guard inputLock(_inputQueueMutex);
-    std::copy_n(_inputQueue.begin(), nItems, buffer);
+    _inputQueue.peek(buffer, nItems);
     return true;
 }
 
 bool TcpSocket::skipBytes(size_t nItems) {
-    waitForInput(nItems);
-    if (_shouldStopThreads) {
-        return false;
-    }
-    if (!_isConnected && !_isConnecting) {
-        return false;
-    }
     std::lock_guard inputLock(_inputQueueMutex);
-    _inputQueue.erase(_inputQueue.begin(), _inputQueue.begin() + nItems);
+    releaseMessage();
+
+    while (nItems > 0) {
+        if (!waitForInput(std::min(nItems, _inputQueue.capacity()))) {
+            return false;
+        }
+        const size_t n = std::min(nItems, _inputQueue.size());
+        _inputQueue.consume(n);
+        nItems -= n;
+        resumeInput();
+    }
     return true;
 }
 
@@ -536,9 +906,34 @@ bool TcpSocket::putBytes(const char* buffer, size_t size) {
     if (_shouldStopThreads) {
         return false;
     }
-    std::lock_guard<std::mutex> outputLock(_outputQueueMutex);
-    _outputQueue.insert(_outputQueue.end(), buffer, buffer + size);
-    _outputNotifier.notify_one();
+    {
+        std::lock_guard<std::mutex> outputLock(_outputQueueMutex);
+        if (!_hasOutputOverflow) {
+            const size_t n = _outputQueue.write(buffer, size);
+            buffer += n;
+            size -= n;
+        }
+        if (size > 0) {
+            // The bytes have to stay in order, so once anything is in the overflow, all
+            // following bytes have to go there as well until the I/O thread caught up
+            _outputOverflow.insert(_outputOverflow.end(), buffer, buffer + size);
+            _hasOutputOverflow = true;
+        }
+    }
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+#ifdef __linux__
+    // While connecting or before the streams are started, the writable event is
+    // requested once the socket is registered with the reactor
+    if (_isConnected && _reactorId != 0) {
+        requestWritable();
+    }
+#else // ^^^^ __linux__ // !__linux__ vvvv
+    if (_nWaitingForOutput > 0) {
+        std::lock_guard lock(_outputBufferMutex);
+        _outputNotifier.notify_one();
+    }
+#endif // __linux__
     return _isConnected || _isConnecting;
 }
 
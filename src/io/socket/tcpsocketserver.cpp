@@ -25,6 +25,7 @@
 
 #include <ghoul/io/socket/tcpsocketserver.h>
 
+#include <ghoul/io/socket/socketreactor.h>
 #include <ghoul/io/socket/tcpsocket.h>
 #include <cstring>
 
@@ -54,6 +55,9 @@
 #include <arpa/inet.h>
 #include <netdb.h>
 #include <errno.h>
+#ifdef __linux__
+#include <fcntl.h>
+#endif // __linux__
 #ifndef SOCKET_ERROR
 #define SOCKET_ERROR (-1)
 #endif
@@ -121,10 +125,16 @@ void TcpSocketServer::close() {
 
     // Notify all threads waiting for connections.
     _connectionNotifier.notify_all();
+#ifdef __linux__
+    SocketReactor::ref().unregisterSocket(_reactorId);
+    _reactorId = 0;
+#endif // __linux__
     const _SOCKET serverSocket = _serverSocket;
     _serverSocket = INVALID_SOCKET;
     closeSocket(serverSocket);
+#ifndef __linux__
     _serverThread->join();
+#endif // __linux__
 }
 
 void TcpSocketServer::listen(int port) {
@@ -186,6 +196,14 @@ void TcpSocketServer::listen(int port) {
     // Clean up
     freeaddrinfo(result);
 
+    if (_port == 0) {
+        // The operating system picked a free port for us
+        sockaddr_in info {};
+        _SOCKLEN infoSize = sizeof(info);
+        getsockname(_serverSocket, reinterpret_cast<sockaddr*>(&info), &infoSize);
+        _port = ntohs(info.sin_port);
+    }
+
     if (::listen(_serverSocket, SOMAXCONN) == SOCKET_ERROR) {
         closeSocket(_serverSocket);
 #if defined(WIN32)
@@ -195,7 +213,19 @@ void TcpSocketServer::listen(int port) {
     }
 
     _listening = true;
+#ifdef __linux__
+    const int flags = fcntl(_serverSocket, F_GETFL, 0);
+    fcntl(_serverSocket, F_SETFL, flags | O_NONBLOCK);
+
+    SocketReactor& reactor = SocketReactor::ref();
+    _reactorId = reactor.registerSocket(
+        _serverSocket,
+        SocketReactor::Readable,
+        [this](int) { acceptConnections(); }
+    );
+#else // ^^^^ __linux__ // !__linux__ vvvv
     _serverThread = std::make_unique<std::thread>([this]() { waitForConnections(); });
+#endif // __linux__
 }
 
 bool TcpSocketServer::isListening() const {
@@ -247,6 +277,31 @@ std::unique_ptr<Socket> TcpSocketServer::awaitPendingSocket() {
     return awaitPendingTcpSocket();
 }
 
+#ifdef __linux__
+
+void TcpSocketServer::acceptConnections() {
+    // The server socket is non-blocking, so we accept connections until none are left
+    while (true) {
+        sockaddr_in clientInfo {};
+        _SOCKLEN clientInfoSize = sizeof(clientInfo);
+        _SOCKET socketHandle = accept4(
+            _serverSocket,
+            reinterpret_cast<sockaddr*>(&clientInfo),
+            &clientInfoSize,
+            SOCK_CLOEXEC
+        );
+        if (socketHandle == INVALID_SOCKET) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            return;
+        }
+        addPendingConnection(socketHandle, clientInfo);
+    }
+}
+
+#else // ^^^^ __linux__ // !__linux__ vvvv
+
 void TcpSocketServer::waitForConnections() {
     while (_listening) {
         sockaddr_in clientInfo {};
@@ -269,22 +324,33 @@ void TcpSocketServer::waitForConnections() {
         if (socketHandle == INVALID_SOCKET) {
             continue;
         }
+        addPendingConnection(socketHandle, clientInfo);
+    }
+}
+
+#endif // __linux__
 
-        char addressBuffer[INET_ADDRSTRLEN];
-        inet_ntop(AF_INET, &(clientInfo.sin_addr), addressBuffer, INET_ADDRSTRLEN);
-        std::string address = addressBuffer;
-        int port = static_cast<int>(clientInfo.sin_port);
+void TcpSocketServer::addPendingConnection(_SOCKET socketHandle,
+                                           const sockaddr_in& clientInfo)
+{
+    char addressBuffer[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &(clientInfo.sin_addr), addressBuffer, INET_ADDRSTRLEN);
+    std::string address = addressBuffer;
+    int port = static_cast<int>(clientInfo.sin_port);
 
-        // @CLEANUP(abock): Can the _pendingConnections be moved to Socket instead of
-        //                  unique_ptr?
-        auto socket = std::make_unique<TcpSocket>(address, port, socketHandle);
+    // @CLEANUP(abock): Can the _pendingConnections be moved to Socket instead of
+    //                  unique_ptr?
+    auto socket = std::make_unique<TcpSocket>(address, port, socketHandle);
 
+    {
         std::lock_guard lock(_connectionMutex);
         _pendingConnections.push_back(std::move(socket));
-
-        // Notify `awaitPendingConnection` to return the acquired connection.
-        _connectionNotifier.notify_one();
     }
+
+    // Notify `awaitPendingConnection` to return the acquired connection. The mutex makes
+    // sure that the notification can't slip in between its check and its wait
+    std::lock_guard notificationLock(_connectionNotificationMutex);
+    _connectionNotifier.notify_one();
 }
 
 } // namespace ghoul::io
@@ -27,6 +27,7 @@
 
 #include <ghoul/fmt.h>
 #include <ghoul/filesystem/file.h>
+#include <ghoul/filesystem/mappedfile.h>
 #include <ghoul/io/texture/texturereaderbase.h>
 #include <ghoul/misc/assert.h>
 #include <ghoul/opengl/texture.h>
@@ -77,6 +78,26 @@ std::unique_ptr<opengl::Texture> TextureReader::loadTexture(void* memory,
     return reader->loadTexture(memory, size);
 }
 
+std::unique_ptr<opengl::Texture> TextureReader::loadTexture(
+                                                      const filesystem::MappedFile& file,
+                                                      const std::string& format)
+{
+    ghoul_assert(!file.empty(), "File must not be empty");
+    ghoul_assert(!_readers.empty(), "No readers were registered before");
+
+    const std::string extension = format.empty() ?
+        ghoul::filesystem::File(file.path()).fileExtension() :
+        format;
+    TextureReaderBase* reader = readerForExtension(extension);
+    if (!reader) {
+        throw MissingReaderException(extension, file.path());
+    }
+
+    // The readers only read from the memory, so passing them the read-only mapping is
+    // safe even though their interface is not const-correct
+    return reader->loadTexture(const_cast<char*>(file.data()), file.size());
+}
+
 std::vector<std::string> TextureReader::supportedExtensions() {
     std::vector<std::string> result;
     for (const std::unique_ptr<TextureReaderBase>& i : _readers) {
@@ -28,13 +28,27 @@
 #include <ghoul/fmt.h>
 #include <ghoul/glm.h>
 #include <ghoul/misc/assert.h>
+#include <ghoul/misc/defer.h>
+#include <algorithm>
 #include <atomic>
+#include <cstring>
 #include <fstream>
 
 namespace {
-    constexpr const uint8_t CURRENT_VERSION = 1;
+    constexpr const uint8_t CURRENT_VERSION = 2;
 
-    struct Header {
+    using BufferLog = ghoul::logging::BufferLog;
+
+    // The callback must not throw, as the buffer might be left in any state. Calling it
+    // from a noexcept function terminates the application if it throws nonetheless
+    void invokeCallback(const BufferLog::MemoryExhaustedCallback& callback,
+                        BufferLog& log, unsigned long long& timestamp) noexcept
+    {
+        callback(log, timestamp);
+    }
+
+    /// The header layout that was used in version 1 of the buffer
+    struct HeaderV1 {
         /**
         * The version header contains in increasing unsigned integer, which specifies the
         * general layout of the buffer in this BufferLog. The size of the header and,
@@ -64,6 +78,66 @@ namespace {
         uint32_t firstEmptyByte;
     };
 
+    struct Header {
+        /// The version of the buffer layout; always located in the first byte
+        uint8_t version;
+
+        /**
+        * The attributes are used for user-defined behavior. Information that is
+        * necessary to interpret the buffer may be put in here.
+        */
+        uint8_t attributes;
+
+        uint8_t padding[2];
+
+        /**
+        * This value provides an offset to find the first byte in the buffer that has not
+        * been reserved already. Producers reserve the space for their record by
+        * atomically adding the record size to this value. If a reservation fails because
+        * the buffer is exhausted, this value can temporarily point past the end of the
+        * buffer.
+        */
+        std::atomic<uint32_t> firstEmptyByte;
+
+        /**
+        * The generation is increased every time the buffer is reset. A record is only
+        * valid if its commit word is equal to <code>generation + 1</code>, which makes
+        * records that remained in the buffer from a previous generation invalid.
+        */
+        std::atomic<uint32_t> generation;
+
+        /**
+        * The lower 31 bits contain the number of producers that are currently writing
+        * into the buffer. The highest bit is set if some thread requested exclusive
+        * access to the buffer, for example to reset it or to write it to disk. It is not
+        * guaranteed that this value is usable when the buffer is written to disk.
+        */
+        std::atomic<uint32_t> access;
+    };
+    static_assert(sizeof(Header) == 16, "Header must not contain implicit padding");
+
+    /// The header that precedes every log entry in version 2 of the buffer
+    struct Record {
+        /// <code>generation + 1</code> as soon as the record is completely written
+        std::atomic<uint32_t> commit;
+
+        /// The size of the record in bytes, including this header and the padding
+        uint32_t size;
+
+        /// The timestamp that was passed with the message
+        unsigned long long timestamp;
+
+        // The \0 terminated message directly follows the record header
+    };
+    static_assert(sizeof(Record) == 16, "Record must not contain implicit padding");
+    static_assert(
+        std::atomic<uint32_t>::is_always_lock_free,
+        "The buffer can only be shared between processes with lock-free atomics"
+    );
+
+    constexpr const uint32_t ExclusiveBit = 1u << 31;
+    constexpr const size_t RecordAlignment = alignof(Record);
+
     /**
     * This method returns the beginning part of the buffer that contains the header
     * information.
@@ -72,17 +146,109 @@ namespace {
         return *reinterpret_cast<Header*>(buffer);
     }
 
+    /// Returns the record that starts at the \p offset into the data block of the buffer
+    Record& record(void* buffer, uint32_t offset) {
+        return *reinterpret_cast<Record*>(
+            reinterpret_cast<char*>(buffer) + sizeof(Header) + offset
+        );
+    }
+
+    /// Returns the number of bytes that a record containing \p message will occupy
+    size_t recordSize(const std::string& message) {
+        // +1 for the terminating \0 character
+        const size_t size = sizeof(Record) + message.length() + 1;
+        return (size + RecordAlignment - 1) & ~(RecordAlignment - 1);
+    }
+
     /**
-    This method returns the buffer block that begins at the first empty byte. This offset
-    * is guaranteed to be in valid memory if the values provided in the constructor or
-    * the \see setBuffer function were correct.
+    * Spins for a few iterations before yielding the remainder of the time slice so that
+    * waiting threads do not burn cycles that the thread they are waiting for could use.
     */
-    void* firstEmptyMemory(void* buffer) {
-        const Header& h = header(buffer);
+    void backoff(int& iteration) {
+        constexpr const int SpinIterations = 64;
+        if (iteration < SpinIterations) {
+            ++iteration;
+        }
+        else {
+            std::this_thread::yield();
+        }
+    }
+
+    /**
+    * Registers the calling thread as a writer. Returns <code>false</code> if another
+    * thread currently has exclusive access to the buffer, in which case the writer was
+    * not registered.
+    */
+    bool enterWriter(Header& h) {
+        const uint32_t previous = h.access.fetch_add(1, std::memory_order_acquire);
+        if (previous & ExclusiveBit) {
+            h.access.fetch_sub(1, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    void leaveWriter(Header& h) {
+        h.access.fetch_sub(1, std::memory_order_release);
+    }
+
+    std::vector<ghoul::logging::BufferLog::Entry> entriesV1(const char* buffer,
+                                                            size_t bufferSize)
+    {
+        const HeaderV1& h = *reinterpret_cast<const HeaderV1*>(buffer);
+        const size_t end = std::min<size_t>(
+            sizeof(HeaderV1) + h.firstEmptyByte,
+            bufferSize
+        );
+
+        std::vector<ghoul::logging::BufferLog::Entry> result;
+        size_t offset = sizeof(HeaderV1);
+        while (offset + sizeof(unsigned long long) < end) {
+            ghoul::logging::BufferLog::Entry e;
+            std::memcpy(&e.timestamp, buffer + offset, sizeof(unsigned long long));
+            offset += sizeof(unsigned long long);
+
+            const char* message = buffer + offset;
+            const size_t length = strnlen(message, end - offset);
+            e.message = std::string(message, length);
+            offset += length + 1;
+
+            result.push_back(std::move(e));
+        }
+        return result;
+    }
 
-        return reinterpret_cast<void*>(
-            reinterpret_cast<char*>(buffer) + sizeof(Header) + h.firstEmptyByte
+    std::vector<ghoul::logging::BufferLog::Entry> entriesV2(const char* buffer,
+                                                            size_t bufferSize)
+    {
+        const Header& h = *reinterpret_cast<const Header*>(buffer);
+        const uint32_t commit = h.generation.load(std::memory_order_acquire) + 1;
+        const size_t end = std::min<size_t>(
+            h.firstEmptyByte.load(std::memory_order_acquire),
+            bufferSize - sizeof(Header)
         );
+
+        std::vector<ghoul::logging::BufferLog::Entry> result;
+        size_t offset = 0;
+        while (offset + sizeof(Record) <= end) {
+            const Record& r = *reinterpret_cast<const Record*>(
+                buffer + sizeof(Header) + offset
+            );
+            if (r.commit.load(std::memory_order_acquire) != commit) {
+                // This record has not been committed yet, so we cannot know whether the
+                // following records are valid either
+                break;
+            }
+            if (r.size < sizeof(Record) || offset + r.size > end) {
+                break;
+            }
+
+            const char* message = reinterpret_cast<const char*>(&r) + sizeof(Record);
+            const size_t length = strnlen(message, r.size - sizeof(Record));
+            result.push_back({ r.timestamp, std::string(message, length) });
+            offset += r.size;
+        }
+        return result;
     }
 } // namespace
 
@@ -103,11 +269,9 @@ BufferLog::BufferLog(void* address, size_t bufferSize)
     , _totalSize(bufferSize)
 {
     ghoul_assert(address, "Address must not be nullptr");
-    ghoul_assert(bufferSize > 0, "Total size must be positive");
+    ghoul_assert(bufferSize > sizeof(Header), "Total size must be bigger than header");
 
-    initializeBuffer();
-    Header& h = header(_buffer);
-    h.mutex.clear();
+    initializeBuffer(address, bufferSize);
 }
 
 BufferLog::BufferLog(void* address, size_t bufferSize, MemoryExhaustedCallback callback)
@@ -116,18 +280,64 @@ BufferLog::BufferLog(void* address, size_t bufferSize, MemoryExhaustedCallback c
     , _callback(std::move(callback))
 {
     ghoul_assert(address, "Address must not be nullptr");
-    ghoul_assert(bufferSize > 0, "Total size must be positive");
+    ghoul_assert(bufferSize > sizeof(Header), "Total size must be bigger than header");
 
-    initializeBuffer();
-    Header& h = header(_buffer);
-    h.mutex.clear();
+    initializeBuffer(address, bufferSize);
 }
 
-void BufferLog::initializeBuffer() {
-    Header& h = header(_buffer);
+void BufferLog::initializeBuffer(void* buffer, size_t bufferSize) {
+    Header& h = header(buffer);
     h.version = CURRENT_VERSION;
     h.attributes = 0;
-    h.firstEmptyByte = 0;
+    h.padding[0] = 0;
+    h.padding[1] = 0;
+    new (&h.firstEmptyByte) std::atomic<uint32_t>(0);
+    new (&h.generation) std::atomic<uint32_t>(0);
+    new (&h.access) std::atomic<uint32_t>(0);
+
+    // Clearing the data block once ensures that no uninitialized memory can be mistaken
+    // for a committed record of the first generation
+    std::memset(
+        reinterpret_cast<char*>(buffer) + sizeof(Header),
+        0,
+        bufferSize - sizeof(Header)
+    );
+}
+
+void* BufferLog::acquireExclusiveAccess() {
+    if (_callbackThread.load() == std::this_thread::get_id()) {
+        // We are called from the callback which already owns the buffer
+        return nullptr;
+    }
+
+    int iteration = 0;
+    while (true) {
+        void* buffer = _buffer.load();
+        Header& h = header(buffer);
+        const uint32_t previous = h.access.fetch_or(ExclusiveBit);
+        if (previous & ExclusiveBit) {
+            // Someone else has exclusive access already
+            backoff(iteration);
+            continue;
+        }
+        if (_buffer.load() != buffer) {
+            // The buffer was exchanged while we were waiting for it
+            h.access.fetch_and(~ExclusiveBit);
+            continue;
+        }
+
+        // No new writers can enter now, so we only have to wait for the current ones
+        while ((h.access.load(std::memory_order_acquire) & ~ExclusiveBit) != 0) {
+            backoff(iteration);
+        }
+        return buffer;
+    }
+}
+
+void BufferLog::releaseExclusiveAccess(void* buffer) {
+    if (buffer) {
+        header(buffer).access.fetch_and(~ExclusiveBit, std::memory_order_release);
+    }
 }
 
 void BufferLog::setCallback(MemoryExhaustedCallback callback) {
@@ -136,80 +346,97 @@ void BufferLog::setCallback(MemoryExhaustedCallback callback) {
 
 void BufferLog::resetBuffer() {
     // Resetting the buffer does not overwrite any of the data but resets the
-    // firstEmptyByte pointer so that following log will overwrite the buffer
-    Header& h = header(_buffer);
-
-    // if test_and_set returns 'true', someone else is in the critical section
-    // unless we are currently in a callstack containing the callback function. In which
-    // case we are already safe
-    while (h.mutex.test_and_set() && !_inCallbackStack) {}
-    // the moment we return, we own the mutex
+    // firstEmptyByte pointer so that following log will overwrite the buffer and
+    // advances the generation so that the old records are no longer considered valid
+    void* owned = acquireExclusiveAccess();
+    Header& h = header(_buffer.load());
     h.firstEmptyByte = 0;
-    if (!_inCallbackStack) {
-        // only release the mutex if we are not in the callback stack
-        h.mutex.clear();
-    }
+    h.generation.fetch_add(1);
+    releaseExclusiveAccess(owned);
 }
 
 void BufferLog::log(unsigned long long timestamp, const std::string& message) {
     ghoul_assert(!message.empty(), "Message must not be empty");
 
-    Header& h = header(_buffer);
-    // This is the full size of the incoming message. +1 for the terminating \0 character
-    size_t fullSize = sizeof(unsigned long long) + message.length() + 1;
+    const size_t fullSize = recordSize(message);
+
+    int iteration = 0;
+    while (true) {
+        void* buffer = _buffer.load();
+        Header& h = header(buffer);
+        if (!enterWriter(h)) {
+            // Someone is resetting or exchanging the buffer
+            backoff(iteration);
+            continue;
+        }
+        if (_buffer.load() != buffer) {
+            leaveWriter(h);
+            continue;
+        }
+
+        const size_t capacity = _totalSize - sizeof(Header);
+        const uint32_t offset = h.firstEmptyByte.fetch_add(
+            static_cast<uint32_t>(fullSize),
+            std::memory_order_relaxed
+        );
 
-    // if test_and_set returns 'true', someone else is in the critical section
-    while (h.mutex.test_and_set()) {}
-    // the moment we return, we own the mutex
+        if (offset + fullSize <= capacity) {
+            // We have exclusive ownership of our part of the buffer
+            Record& r = record(buffer, offset);
+            r.size = static_cast<uint32_t>(fullSize);
+            r.timestamp = timestamp;
+            std::memcpy(
+                reinterpret_cast<char*>(&r) + sizeof(Record),
+                message.c_str(),
+                message.length() + 1
+            );
+            // Publishing the commit word has to be the last write into the record
+            r.commit.store(
+                h.generation.load(std::memory_order_relaxed) + 1,
+                std::memory_order_release
+            );
+            leaveWriter(h);
+            return;
+        }
 
-    size_t requestedSize = h.firstEmptyByte + sizeof(Header) + fullSize;
+        // The reservation failed. If no other thread has reserved anything after us, we
+        // can return the space so that a smaller message might still fit in
+        uint32_t expected = static_cast<uint32_t>(offset + fullSize);
+        h.firstEmptyByte.compare_exchange_strong(expected, offset);
+        leaveWriter(h);
+
+        // Only one thread at a time gets to handle the exhausted memory; all others will
+        // wait in here and retry their reservation once the buffer has been dealt with
+        void* owned = acquireExclusiveAccess();
+        defer { releaseExclusiveAccess(owned); };
+
+        const size_t used = header(owned).firstEmptyByte;
+        if (used + fullSize > capacity) {
+            const size_t requestedSize = used + sizeof(Header) + fullSize;
+            if (!_callback) {
+                // We have to fail if there is no callback
+                throw MemoryExhaustionException(
+                    static_cast<int>(_totalSize),
+                    static_cast<int>(requestedSize)
+                );
+            }
 
-    // If this message would exceed the available memory...
-    if (requestedSize > _totalSize) {
-        // ... and we have a valid callback function
-        if (_callback) {
             // delegate the cleaning up to the callback
-            _inCallbackStack = true;
-            _callback(*this, timestamp);
-            _inCallbackStack = false;
-            if (h.firstEmptyByte + fullSize > _totalSize) {
+            _callbackThread = std::this_thread::get_id();
+            invokeCallback(_callback, *this, timestamp);
+            _callbackThread = std::thread::id();
+
+            // The callback might have provided a new buffer
+            const size_t newUsed = header(_buffer.load()).firstEmptyByte;
+            if (newUsed + fullSize > _totalSize - sizeof(Header)) {
                 // The callback failed to clear the memory
-                h.mutex.clear();
                 throw MemoryExhaustionException(
                     static_cast<int>(_totalSize),
                     static_cast<int>(requestedSize)
                 );
             }
         }
-        else {
-            // We have to fail if there is no callback
-            h.mutex.clear();
-            throw MemoryExhaustionException(
-                static_cast<int>(_totalSize),
-                static_cast<int>(requestedSize)
-            );
-        }
     }
-    // Copy the values of the timestamp
-    memcpy(
-        firstEmptyMemory(_buffer),
-        reinterpret_cast<void*>(&timestamp),
-        sizeof(unsigned long long)
-    );
-    // Advance the empty pointer
-    h.firstEmptyByte += sizeof(unsigned long long);
-
-    // Copy the message into the buffer, strcpy will copy the \0 terminator character, too
-    char* destination = reinterpret_cast<char*>(firstEmptyMemory(_buffer));
-#ifdef WIN32
-    strcpy_s(destination, message.length() + 1, message.c_str());
-#else
-    strcpy(destination, message.c_str());
-#endif
-    // Advance the empty pointer; +1 for the \0 terminator
-    h.firstEmptyByte += uint32_t(message.length() + 1);
-
-    h.mutex.clear();
 }
 
 void* BufferLog::buffer() {
@@ -221,45 +448,58 @@ size_t BufferLog::totalSize() const {
 }
 
 size_t BufferLog::usedSize() const {
-    const Header& h = header(_buffer);
-    return h.firstEmptyByte + sizeof(Header);
+    const Header& h = header(_buffer.load());
+    return std::min<size_t>(h.firstEmptyByte, _totalSize - sizeof(Header)) +
+           sizeof(Header);
 }
 
 void BufferLog::setBuffer(void* buffer, size_t bufferSize) {
     ghoul_assert(buffer, "Buffer must not be nullptr");
-    ghoul_assert(bufferSize > 0, "Total size must be positive");
+    ghoul_assert(bufferSize > sizeof(Header), "Total size must be bigger than header");
 
-    Header& h = header(_buffer);
-    // if test_and_set returns 'true', someone else is in the critical section
-    // unless we are currently in a callstack containing the callback function. In which
-    // case we are already safe
-    while (h.mutex.test_and_set() && !_inCallbackStack) {}
-    // the moment we return, we own the mutex
+    // The new buffer has to be fully initialized before any writer can see it
+    initializeBuffer(buffer, bufferSize);
 
-    _buffer = buffer;
+    void* owned = acquireExclusiveAccess();
     _totalSize = bufferSize;
-    initializeBuffer();
-
-    if (!_inCallbackStack) {
-        // only release the mutex if we are not in the callback stack
-        h.mutex.clear();
-    }
+    _buffer = buffer;
+    releaseExclusiveAccess(owned);
 }
 
 void BufferLog::writeToDisk(const std::string& filename) {
     std::ofstream file;
     file.exceptions(std::ofstream::failbit | std::ofstream::badbit);
-    file.open(filename);
-    Header& h = header(_buffer);
-    // if test_and_set returns 'true', someone else is in the critical section
-    // unless we are currently in a callstack containing the callback function. In
-    // which case we are already safe
-    while (h.mutex.test_and_set() && !_inCallbackStack) {}
-    // the moment we return, we own the mutex
-    file.write(reinterpret_cast<char*>(_buffer), usedSize());
-    if (!_inCallbackStack) {
-        // only release the mutex if we are not in the callback stack
-        h.mutex.clear();
+    file.open(filename, std::ofstream::binary);
+
+    void* owned = acquireExclusiveAccess();
+    defer { releaseExclusiveAccess(owned); };
+    file.write(reinterpret_cast<char*>(_buffer.load()), usedSize());
+}
+
+std::vector<BufferLog::Entry> BufferLog::entries(const void* buffer, size_t bufferSize) {
+    ghoul_assert(buffer, "Buffer must not be nullptr");
+
+    const char* b = reinterpret_cast<const char*>(buffer);
+    if (bufferSize == 0) {
+        return {};
+    }
+
+    switch (static_cast<uint8_t>(b[0])) {
+        case 1:
+            if (bufferSize < sizeof(HeaderV1)) {
+                return {};
+            }
+            return entriesV1(b, bufferSize);
+        case 2:
+            if (bufferSize < sizeof(Header)) {
+                return {};
+            }
+            return entriesV2(b, bufferSize);
+        default:
+            throw RuntimeError(
+                fmt::format("Unsupported BufferLog version {}", static_cast<int>(b[0])),
+                "BufferLog"
+            );
     }
 }
 
@@ -25,12 +25,80 @@
 
 #include <ghoul/logging/logmanager.h>
 
+#include <ghoul/fmt.h>
 #include <ghoul/logging/log.h>
 #include <ghoul/misc/assert.h>
+#include <ghoul/misc/exception.h>
 #include <algorithm>
+#include <chrono>
+#include <limits>
 #include <map>
 #include <vector>
 
+namespace {
+    int64_t nanosecondsNow() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()
+        ).count();
+    }
+
+    int64_t rateInterval(double messagesPerSecond) {
+        return static_cast<int64_t>(1e9 / messagesPerSecond);
+    }
+
+    /**
+     * Returns whether a token could currently be consumed from the token bucket
+     * described by \p nextAllowed and \p tolerance; see #consumeToken.
+     */
+    bool hasToken(const std::atomic<int64_t>& nextAllowed, int64_t tolerance,
+                  int64_t now)
+    {
+        const int64_t next = nextAllowed.load(std::memory_order_relaxed);
+        return std::max(next, now) - now <= tolerance;
+    }
+
+    /**
+     * Implements a token bucket as a generic cell rate algorithm. \p nextAllowed is the
+     * theoretical time at which the next message would be allowed if no tokens were
+     * saved; the bucket allows messages that arrive at most \p tolerance ns before that
+     * time. Returns <code>true</code> if the message is allowed, in which case the
+     * token was consumed.
+     */
+    bool consumeToken(std::atomic<int64_t>& nextAllowed, int64_t interval,
+                      int64_t tolerance, int64_t now)
+    {
+        int64_t next = nextAllowed.load(std::memory_order_relaxed);
+        while (true) {
+            const int64_t start = std::max(next, now);
+            if (start - now > tolerance) {
+                return false;
+            }
+            const bool success = nextAllowed.compare_exchange_weak(
+                next,
+                start + interval,
+                std::memory_order_relaxed
+            );
+            if (success) {
+                return true;
+            }
+        }
+    }
+
+    void storeMinimum(std::atomic<int64_t>& value, int64_t candidate) {
+        int64_t current = value.load(std::memory_order_relaxed);
+        while (candidate < current) {
+            const bool success = value.compare_exchange_weak(
+                current,
+                candidate,
+                std::memory_order_relaxed
+            );
+            if (success) {
+                return;
+            }
+        }
+    }
+} // namespace
+
 namespace ghoul::logging {
 
 LogManager* LogManager::_instance = nullptr;
@@ -38,7 +106,17 @@ LogManager* LogManager::_instance = nullptr;
 LogManager::LogManager(LogLevel level, ImmediateFlush immediateFlush)
     : _level(level)
     , _immediateFlush(immediateFlush)
-{}
+    , _minimumLevel(level)
+{
+    for (std::atomic<LogLevel>& l : _categoryLevels) {
+        l = level;
+    }
+    for (int i = 0; i < MaxCategories; ++i) {
+        _categoryRateIntervals[i] = 0;
+        _categoryRateTolerances[i] = 0;
+        _categoryNextAllowed[i] = 0;
+    }
+}
 
 void LogManager::initialize(LogLevel level, ImmediateFlush immediateFlush) {
     ghoul_assert(!isInitialized(), "LogManager is already initialized");
@@ -76,7 +154,13 @@ void LogManager::removeLog(Log* log) {
     }
 }
 
+LogManager::~LogManager() {
+    reportSuppressedMessages();
+    flushLogs();
+}
+
 void LogManager::flushLogs() {
+    reportSuppressedMessages();
     for (const std::unique_ptr<Log>& log : _logs) {
         log->flush();
     }
@@ -85,21 +169,27 @@ void LogManager::flushLogs() {
 void LogManager::logMessage(LogLevel level, const std::string& category,
                             const std::string& message)
 {
-    if (level >= _level) {
-        std::lock_guard lock(_mutex);
-
-        for (const std::unique_ptr<Log>& log : _logs) {
-            if (level >= log->logLevel()) {
-                log->log(level, category, message);
-                if (_immediateFlush) {
-                    log->flush();
-                }
+    if (isEnabled(level, category)) {
+        dispatchMessage(level, category, message);
+    }
+}
+
+void LogManager::dispatchMessage(LogLevel level, const std::string& category,
+                                 const std::string& message)
+{
+    std::lock_guard lock(_mutex);
+
+    for (const std::unique_ptr<Log>& log : _logs) {
+        if (level >= log->logLevel()) {
+            log->log(level, category, message);
+            if (_immediateFlush) {
+                log->flush();
             }
         }
-
-        int l = std::underlying_type<LogLevel>::type(level);
-        ++(_logCounters[l]);
     }
+
+    int l = std::underlying_type<LogLevel>::type(level);
+    ++(_logCounters[l]);
 }
 
 void LogManager::logMessage(LogLevel level, const std::string& message) {
@@ -110,6 +200,314 @@ LogLevel LogManager::logLevel() const {
     return _level;
 }
 
+bool LogManager::isEnabled(LogLevel level, std::string_view category) {
+    if (level < _minimumLevel.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    if (_nCategoryOverrides.load(std::memory_order_relaxed) == 0) {
+        return level >= _level;
+    }
+
+    std::shared_lock lock(_categoryMutex);
+    auto it = _categoryIndices.find(category);
+    if (it == _categoryIndices.end()) {
+        return level >= _level;
+    }
+    return level >= _categoryLevels[it->second].load(std::memory_order_relaxed);
+}
+
+int LogManager::categoryIndex(std::string_view category) {
+    {
+        std::shared_lock lock(_categoryMutex);
+        auto it = _categoryIndices.find(category);
+        if (it != _categoryIndices.end()) {
+            return it->second;
+        }
+    }
+
+    std::unique_lock lock(_categoryMutex);
+    // Someone else might have added the category while we were waiting for the lock
+    auto it = _categoryIndices.find(category);
+    if (it != _categoryIndices.end()) {
+        return it->second;
+    }
+
+    const int index = _nCategories.load(std::memory_order_relaxed);
+    if (index == MaxCategories) {
+        return -1;
+    }
+    _categoryNames[index] = std::string(category);
+    _categoryLevels[index] = _level;
+    _categoryIndices[std::string(category)] = index;
+    // Publishing the new number of categories has to happen after the name was written
+    _nCategories.store(index + 1, std::memory_order_release);
+    return index;
+}
+
+int LogManager::aliasIndex(const char* category) {
+    {
+        std::shared_lock lock(_categoryMutex);
+        auto it = _aliasIndices.find(category);
+        if (it != _aliasIndices.end()) {
+            return it->second;
+        }
+    }
+
+    const int index = categoryIndex(category);
+    if (index == -1) {
+        return -1;
+    }
+
+    std::unique_lock lock(_categoryMutex);
+    // Someone else might have added the alias while we were waiting for the lock
+    auto it = _aliasIndices.find(category);
+    if (it != _aliasIndices.end()) {
+        return it->second;
+    }
+
+    const int alias = _nAliases.load(std::memory_order_relaxed);
+    if (alias == MaxCategoryAliases) {
+        return -1;
+    }
+    _aliasNames[alias] = category;
+    _aliasCategories[alias] = index;
+    _aliasIndices[category] = alias;
+    // Publishing the new number of aliases has to happen after the alias was written
+    _nAliases.store(alias + 1, std::memory_order_release);
+    return alias;
+}
+
+void LogManager::setCategoryLogLevel(std::string_view category, LogLevel level) {
+    const int index = categoryIndex(category);
+    if (index == -1) {
+        throw RuntimeError(
+            "Exceeded the maximum number of logging categories", "LogManager"
+        );
+    }
+
+    std::unique_lock lock(_categoryMutex);
+    _categoryOverrides[index] = level;
+    _categoryLevels[index] = level;
+    _nCategoryOverrides = static_cast<int>(_categoryOverrides.size());
+    updateMinimumLevel();
+}
+
+void LogManager::removeCategoryLogLevel(std::string_view category) {
+    std::unique_lock lock(_categoryMutex);
+    auto it = _categoryIndices.find(category);
+    if (it == _categoryIndices.end()) {
+        return;
+    }
+
+    _categoryOverrides.erase(it->second);
+    _categoryLevels[it->second] = _level;
+    _nCategoryOverrides = static_cast<int>(_categoryOverrides.size());
+    updateMinimumLevel();
+}
+
+LogLevel LogManager::categoryLogLevel(std::string_view category) {
+    std::shared_lock lock(_categoryMutex);
+    auto it = _categoryIndices.find(category);
+    if (it == _categoryIndices.end()) {
+        return _level;
+    }
+    return _categoryLevels[it->second];
+}
+
+void LogManager::setCallSiteRateLimit(double messagesPerSecond, int burst) {
+    ghoul_assert(messagesPerSecond > 0.0, "Rate must be positive");
+    ghoul_assert(burst > 0, "Burst must be positive");
+
+    std::unique_lock lock(_categoryMutex);
+    const int64_t interval = rateInterval(messagesPerSecond);
+    _callSiteRateTolerance = interval * (burst - 1);
+    _callSiteRateInterval = interval;
+    updateRateLimitCount();
+}
+
+void LogManager::removeCallSiteRateLimit() {
+    std::unique_lock lock(_categoryMutex);
+    _callSiteRateInterval = 0;
+    _callSiteRateTolerance = 0;
+    updateRateLimitCount();
+}
+
+void LogManager::setCategoryRateLimit(std::string_view category, double messagesPerSecond,
+                                      int burst)
+{
+    ghoul_assert(messagesPerSecond > 0.0, "Rate must be positive");
+    ghoul_assert(burst > 0, "Burst must be positive");
+
+    const int index = categoryIndex(category);
+    if (index == -1) {
+        throw RuntimeError(
+            "Exceeded the maximum number of logging categories", "LogManager"
+        );
+    }
+
+    std::unique_lock lock(_categoryMutex);
+    const int64_t interval = rateInterval(messagesPerSecond);
+    _categoryRateTolerances[index] = interval * (burst - 1);
+    _categoryRateIntervals[index] = interval;
+    _rateLimitedCategories.insert(index);
+    updateRateLimitCount();
+}
+
+void LogManager::removeCategoryRateLimit(std::string_view category) {
+    std::unique_lock lock(_categoryMutex);
+    auto it = _categoryIndices.find(category);
+    if (it == _categoryIndices.end()) {
+        return;
+    }
+
+    _categoryRateIntervals[it->second] = 0;
+    _categoryRateTolerances[it->second] = 0;
+    _rateLimitedCategories.erase(it->second);
+    updateRateLimitCount();
+}
+
+bool LogManager::consumeRateLimits(LogLevel level, int categoryIndex,
+                                   LogCallSite& site)
+{
+    const int64_t now = nanosecondsNow();
+
+    // Call sites that had messages suppressed are reported once they could log again,
+    // even if they never do
+    if (now >= _nextSuppressionReport.load(std::memory_order_relaxed)) {
+        reportSuppressedMessages(now);
+    }
+
+    const int64_t siteInterval = _callSiteRateInterval.load(std::memory_order_relaxed);
+    const int64_t siteTolerance = _callSiteRateTolerance.load(std::memory_order_relaxed);
+    const int64_t categoryInterval = categoryIndex >= 0 ?
+        _categoryRateIntervals[categoryIndex].load(std::memory_order_relaxed) :
+        0;
+    const int64_t categoryTolerance = categoryIndex >= 0 ?
+        _categoryRateTolerances[categoryIndex].load(std::memory_order_relaxed) :
+        0;
+
+    // Both limits are checked before any token is consumed, so that a message rejected
+    // by one limit does not use up the token of the other one
+    bool allowed =
+        (siteInterval == 0 || hasToken(site.nextAllowed, siteTolerance, now)) &&
+        (categoryInterval == 0 ||
+         hasToken(_categoryNextAllowed[categoryIndex], categoryTolerance, now));
+
+    if (allowed && siteInterval > 0) {
+        allowed = consumeToken(site.nextAllowed, siteInterval, siteTolerance, now);
+    }
+    if (allowed && categoryInterval > 0) {
+        allowed = consumeToken(
+            _categoryNextAllowed[categoryIndex],
+            categoryInterval,
+            categoryTolerance,
+            now
+        );
+        if (!allowed && siteInterval > 0) {
+            // Another call site took the category's token in the meantime, so we return
+            // the token of our call site
+            site.nextAllowed.fetch_sub(siteInterval, std::memory_order_relaxed);
+        }
+    }
+
+    if (!allowed) {
+        site.suppressedLevel.store(level, std::memory_order_relaxed);
+        site.nSuppressed.fetch_add(1);
+
+        // Remember the call site so that the suppressed messages can still be reported
+        // if no other message is logged from it
+        const void* owner = site.owner.load();
+        if (owner != this && site.owner.compare_exchange_strong(owner, this)) {
+            std::lock_guard lock(_suppressingSitesMutex);
+            _suppressingSites.push_back(&site);
+        }
+        storeMinimum(_nextSuppressionReport, suppressionEnd(site));
+    }
+    return allowed;
+}
+
+void LogManager::reportSuppressedMessages(int64_t now) {
+    // Sites that are added while the report is running schedule their own report
+    _nextSuppressionReport = std::numeric_limits<int64_t>::max();
+    std::vector<LogCallSite*> sites;
+    {
+        std::lock_guard lock(_suppressingSitesMutex);
+        sites.swap(_suppressingSites);
+    }
+
+    std::vector<LogCallSite*> pendingSites;
+    int64_t nextReport = std::numeric_limits<int64_t>::max();
+    for (LogCallSite* site : sites) {
+        const int64_t end = suppressionEnd(*site);
+        if (end > now) {
+            pendingSites.push_back(site);
+            nextReport = std::min(nextReport, end);
+            continue;
+        }
+
+        site->owner = nullptr;
+        const uint32_t nSuppressed = site->nSuppressed.exchange(0);
+        if (nSuppressed == 0) {
+            // A later message from the call site has already reported the count
+            continue;
+        }
+
+        const int index = site->index;
+        const std::string category = index >= 0 ? _categoryNames[index] : "";
+        std::string message = "(suppressed " + std::to_string(nSuppressed) + " times";
+        if (site->file) {
+            message += fmt::format(" at {}:{}", site->file, site->line);
+        }
+        message += ")";
+        dispatchMessage(site->suppressedLevel, category, message);
+    }
+
+    if (!pendingSites.empty()) {
+        {
+            std::lock_guard lock(_suppressingSitesMutex);
+            _suppressingSites.insert(
+                _suppressingSites.end(),
+                pendingSites.begin(),
+                pendingSites.end()
+            );
+        }
+        storeMinimum(_nextSuppressionReport, nextReport);
+    }
+}
+
+int64_t LogManager::suppressionEnd(const LogCallSite& site) const {
+    // A limit allows the next message once the time that it can borrow for bursts
+    // reaches the time at which the next message would be allowed without a burst
+    int64_t end = 0;
+    if (_callSiteRateInterval.load(std::memory_order_relaxed) > 0) {
+        end = site.nextAllowed.load(std::memory_order_relaxed) -
+              _callSiteRateTolerance.load(std::memory_order_relaxed);
+    }
+    const int index = site.index.load(std::memory_order_relaxed);
+    if (index >= 0 && _categoryRateIntervals[index].load(std::memory_order_relaxed) > 0) {
+        end = std::max(
+            end,
+            _categoryNextAllowed[index].load(std::memory_order_relaxed) -
+                _categoryRateTolerances[index].load(std::memory_order_relaxed)
+        );
+    }
+    return end;
+}
+
+void LogManager::updateRateLimitCount() {
+    const bool hasCallSiteLimit = _callSiteRateInterval > 0;
+    _nRateLimits = static_cast<int>(_rateLimitedCategories.size()) +
+                   (hasCallSiteLimit ? 1 : 0);
+}
+
+void LogManager::updateMinimumLevel() {
+    LogLevel minimum = _level;
+    for (const std::pair<const int, LogLevel>& p : _categoryOverrides) {
+        minimum = std::min(minimum, p.second);
+    }
+    _minimumLevel = minimum;
+}
+
 int LogManager::messageCounter(LogLevel level) {
     return _logCounters[std::underlying_type<LogLevel>::type(level)];
 }
@@ -25,14 +25,30 @@
 
 #include <ghoul/lua/lua_helper.h>
 
+#include <ghoul/filesystem/cachemanager.h>
 #include <ghoul/filesystem/file.h>
 #include <ghoul/filesystem/filesystem.h>
 #include <ghoul/logging/logmanager.h>
 #include <ghoul/lua/ghoul_lua.h>
 #include <ghoul/misc/dictionary.h>
+#include <ghoul/misc/hash.h>
+#include <ghoul/misc/stringconversion.h>
 #include <ghoul/fmt.h>
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
 #include <fstream>
 #include <sstream>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#ifdef WIN32
+#include <process.h>
+#else // ^^^^ WIN32 // !WIN32 vvvv
+#include <unistd.h>
+#endif // WIN32
 
 static lua_State* _state = nullptr;
 
@@ -92,6 +108,211 @@ std::string luaTableToString(lua_State* state, int tableLocation) {
     return result.str();
 }
 
+int bytecodeWriter(lua_State*, const void* p, size_t size, void* userData) {
+    std::vector<char>* buffer = reinterpret_cast<std::vector<char>*>(userData);
+    const char* data = reinterpret_cast<const char*>(p);
+    buffer->insert(buffer->end(), data, data + size);
+    return 0;
+}
+
+// The cached bytecode is preceded by the hash of the script it was compiled from and a
+// checksum of the bytecode, as Lua does not verify binary chunks before running them
+struct BytecodeHeader {
+    uint64_t scriptHash;
+    uint64_t checksum;
+};
+
+int processId() {
+#ifdef WIN32
+    return _getpid();
+#else // ^^^^ WIN32 // !WIN32 vvvv
+    return getpid();
+#endif // WIN32
+}
+
+bool loadCachedBytecode(lua_State* state, const std::string& cachedFile,
+                        uint64_t scriptHash)
+{
+    std::ifstream file(cachedFile, std::ios::binary | std::ios::ate);
+    if (!file.good()) {
+        return false;
+    }
+    const size_t size = static_cast<size_t>(file.tellg());
+    if (size <= sizeof(BytecodeHeader)) {
+        return false;
+    }
+    file.seekg(0);
+    BytecodeHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(BytecodeHeader));
+    if (!file.good() || header.scriptHash != scriptHash) {
+        // The bytecode belongs to a previous version of the script
+        return false;
+    }
+    std::vector<char> bytecode(size - sizeof(BytecodeHeader));
+    file.read(bytecode.data(), bytecode.size());
+    if (!file.good()) {
+        return false;
+    }
+    if (ghoul::hash64(bytecode.data(), bytecode.size()) != header.checksum) {
+        LDEBUGC(
+            "Lua",
+            fmt::format("Discarding bytecode '{}': Checksum mismatch", cachedFile)
+        );
+        return false;
+    }
+
+    // Only binary chunks are accepted, which also rejects a cache file that was replaced
+    // with source code. A mismatching Lua version or number format fails the header check
+    const int status = luaL_loadbufferx(
+        state,
+        bytecode.data(),
+        bytecode.size(),
+        cachedFile.c_str(),
+        "b"
+    );
+    if (status != LUA_OK) {
+        LDEBUGC(
+            "Lua",
+            fmt::format(
+                "Discarding bytecode '{}': {}", cachedFile, lua_tostring(state, -1)
+            )
+        );
+        lua_pop(state, 1);
+        return false;
+    }
+    return true;
+}
+
+void storeCachedBytecode(lua_State* state, const std::string& cachedFile,
+                         uint64_t scriptHash)
+{
+    std::vector<char> bytecode;
+    if (lua_dump(state, bytecodeWriter, &bytecode, 0) != 0 || bytecode.empty()) {
+        return;
+    }
+    const BytecodeHeader header = {
+        scriptHash,
+        ghoul::hash64(bytecode.data(), bytecode.size())
+    };
+
+    // The bytecode is written to a temporary file first so that a concurrent reader never
+    // sees a partially written file. The cache directory can be shared between processes
+    const std::string temporary = fmt::format(
+        "{}.{}.{:x}.tmp",
+        cachedFile, processId(), std::hash<std::thread::id>()(std::this_thread::get_id())
+    );
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(BytecodeHeader));
+        file.write(bytecode.data(), bytecode.size());
+        if (!file.good()) {
+            file.close();
+            std::remove(temporary.c_str());
+            return;
+        }
+    }
+    std::remove(cachedFile.c_str());
+    if (std::rename(temporary.c_str(), cachedFile.c_str()) != 0) {
+        std::remove(temporary.c_str());
+    }
+}
+
+// Loads the script file as a function onto the stack of the state. If a CacheManager is
+// available, the compiled bytecode is stored in it and reused as long as the contents of
+// the file and the Lua version do not change. Each script has a single cache entry that
+// is overwritten when the script changes, so edits do not leave outdated entries behind
+void loadScriptFile(lua_State* state, const std::string& filename) {
+    const ghoul::filesystem::FileContents contents = FileSys.readFile(filename);
+    std::string_view script(contents.data(), contents.size());
+
+    // Same as luaL_loadfile, a byte order mark and a first line starting with '#' are
+    // skipped. The newline is kept so that the line numbers stay the same
+    if (script.substr(0, 3) == "\xEF\xBB\xBF") {
+        script.remove_prefix(3);
+    }
+    if (!script.empty() && script.front() == '#') {
+        script.remove_prefix(std::min(script.find('\n'), script.size()));
+    }
+
+    std::string cachedFile;
+    const uint64_t scriptHash = ghoul::hash64(script);
+    ghoul::filesystem::CacheManager* cache = FileSys.cacheManager();
+    if (cache) {
+        const ghoul::filesystem::File file(filename);
+        const std::string information = fmt::format(
+            "{}|{}|{}",
+            LUA_RELEASE, sizeof(void*), file.path()
+        );
+        cachedFile = cache->cachedFilename(
+            file,
+            information,
+            ghoul::filesystem::CacheManager::Persistent::Yes
+        );
+        if (loadCachedBytecode(state, cachedFile, scriptHash)) {
+            return;
+        }
+    }
+
+    const std::string chunkName = "@" + filename;
+    const int status = luaL_loadbufferx(
+        state,
+        script.data(),
+        script.size(),
+        chunkName.c_str(),
+        nullptr
+    );
+    if (status != LUA_OK) {
+        throw ghoul::lua::LuaLoadingException(lua_tostring(state, -1), filename);
+    }
+
+    if (!cachedFile.empty()) {
+        storeCachedBytecode(state, cachedFile, scriptHash);
+    }
+}
+
+// Converts the value at the absolute stack location and stores it in the dictionary.
+// Plain keys are inserted directly, bypassing the key splitting of Dictionary::setValue;
+// keys containing a '.' still go through setValue so they resolve to nested dictionaries
+void storeValue(lua_State* state, int location, ghoul::Dictionary& dictionary,
+                const std::string& key)
+{
+    const bool isNested = key.find('.') != std::string::npos;
+    auto store = [&](auto value) {
+        if (isNested) {
+            dictionary.setValue(key, std::move(value));
+        }
+        else {
+            dictionary.insert_or_assign(key, std::move(value));
+        }
+    };
+
+    const int type = lua_type(state, location);
+    switch (type) {
+        case LUA_TNUMBER:
+            store(lua_tonumber(state, location));
+            break;
+        case LUA_TBOOLEAN:
+            store(lua_toboolean(state, location) == 1);
+            break;
+        case LUA_TSTRING: {
+            size_t length = 0;
+            const char* value = lua_tolstring(state, location, &length);
+            store(std::string(value, length));
+            break;
+        }
+        case LUA_TTABLE: {
+            ghoul::Dictionary d;
+            ghoul::lua::luaDictionaryFromState(state, d, location);
+            store(std::move(d));
+            break;
+        }
+        default:
+            throw ghoul::lua::LuaFormatException(
+                "Unknown type: " + std::to_string(type)
+            );
+    }
+}
+
 lua_State* staticLuaState() {
     if (!_state) {
         _state = ghoul::lua::createNewLuaState();
@@ -190,10 +411,7 @@ void loadDictionaryFromFile(const std::string& filename, ghoul::Dictionary& dict
         state = staticLuaState();
     }
 
-    const int loadStatus = luaL_loadfile(state, filename.c_str());
-    if (loadStatus != LUA_OK) {
-        throw LuaLoadingException(lua_tostring(state, -1), filename);
-    }
+    loadScriptFile(state, filename);
 
     const int callStatus = lua_pcall(state, 0, LUA_MULTRET, 0);
     if (callStatus != LUA_OK) {
@@ -310,13 +528,13 @@ void luaDictionaryFromState(lua_State* state, Dictionary& dictionary,
 
     int location = luaAbsoluteLocation(state, relativeLocation);
 
+    std::string key;
     lua_pushnil(state);
     while (lua_next(state, location) != 0) {
         // get the key
-        std::string key;
         const int keyType = lua_type(state, KeyTableIndex);
         switch (keyType) {
-            case LUA_TNUMBER:
+            case LUA_TNUMBER: {
                 if (type == TableType::Map) {
                     throw LuaFormatException(
                         "Dictionary can only contain a pure map or a pure array"
@@ -324,9 +542,16 @@ void luaDictionaryFromState(lua_State* state, Dictionary& dictionary,
                 }
 
                 type = TableType::Array;
-                key = std::to_string(lua_tointeger(state, KeyTableIndex));
+                char buffer[MaxCharsLength<lua_Integer>];
+                const std::to_chars_result res = ghoul::to_chars(
+                    buffer,
+                    buffer + sizeof(buffer),
+                    lua_tointeger(state, KeyTableIndex)
+                );
+                key.assign(buffer, res.ptr);
                 break;
-            case LUA_TSTRING:
+            }
+            case LUA_TSTRING: {
                 if (type == TableType::Array) {
                     throw LuaFormatException(
                         "Dictionary can only contain a pure map or a pure array"
@@ -334,36 +559,17 @@ void luaDictionaryFromState(lua_State* state, Dictionary& dictionary,
                 }
 
                 type = TableType::Map;
-                key = lua_tostring(state, KeyTableIndex);
+                size_t length = 0;
+                const char* k = lua_tolstring(state, KeyTableIndex, &length);
+                key.assign(k, length);
                 break;
+            }
             default:
                 throw LuaFormatException("Table index type is not a number or a string");
         }
 
         // get the value
-        switch (lua_type(state, ValueTableIndex)) {
-            case LUA_TNUMBER: {
-                double value = lua_tonumber(state, ValueTableIndex);
-                dictionary.setValue(key, value);
-            } break;
-            case LUA_TBOOLEAN: {
-                bool value = (lua_toboolean(state, ValueTableIndex) == 1);
-                dictionary.setValue(key, value);
-            } break;
-            case LUA_TSTRING: {
-                std::string value = lua_tostring(state, ValueTableIndex);
-                dictionary.setValue(key, value);
-            } break;
-            case LUA_TTABLE: {
-                Dictionary d;
-                luaDictionaryFromState(state, d);
-                dictionary.setValue(key, d);
-            } break;
-            default:
-                throw LuaFormatException(
-                    "Unknown type: " + std::to_string(lua_type(state, ValueTableIndex))
-                );
-        }
+        storeValue(state, lua_gettop(state), dictionary, key);
 
         // get back up one level
         lua_pop(state, 1);
@@ -379,33 +585,7 @@ void luaArrayDictionaryFromState(lua_State* state, Dictionary& dictionary) {
     const int nValues = lua_gettop(state);
 
     for (int i = 1; i <= nValues; ++i) {
-        switch (lua_type(state, i)) {
-        case LUA_TNUMBER: {
-            double value = lua_tonumber(state, i);
-            dictionary.setValue(std::to_string(i), value);
-            break;
-        }
-        case LUA_TBOOLEAN: {
-            bool value = (lua_toboolean(state, i) == 1);
-            dictionary.setValue(std::to_string(i), value);
-            break;
-        }
-        case LUA_TSTRING: {
-            std::string value = lua_tostring(state, i);
-            dictionary.setValue(std::to_string(i), value);
-            break;
-        }
-        case LUA_TTABLE: {
-            Dictionary d;
-            luaDictionaryFromState(state, d, i);
-            dictionary.setValue(std::to_string(i), d);
-            break;
-        }
-        default:
-            throw LuaFormatException(
-                "Unknown type: " + std::to_string(lua_type(state, i))
-            );
-        }
+        storeValue(state, i, dictionary, ghoul::to_string(i));
     }
 }
 
@@ -448,13 +628,9 @@ void runScriptFile(lua_State* state, const std::string& filename) {
     ghoul_assert(!filename.empty(), "filename must not be empty");
     ghoul_assert(FileSys.fileExists(filename), "Filename must be a file that exists");
 
-    int status = luaL_loadfile(state, filename.c_str());
-    if (status != LUA_OK) {
-        std::string error = lua_tostring(state, -1);
-        throw LuaLoadingException(std::move(error));
-    }
+    loadScriptFile(state, filename);
 
-    status = lua_pcall(state, 0, LUA_MULTRET, 0);
+    const int status = lua_pcall(state, 0, LUA_MULTRET, 0);
     if (status != LUA_OK) {
         std::string error = lua_tostring(state, -1);
         throw LuaExecutionException(std::move(error));
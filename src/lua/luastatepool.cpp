@@ -0,0 +1,177 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2020                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <ghoul/lua/luastatepool.h>
+
+#include <ghoul/fmt.h>
+#include <ghoul/lua/ghoul_lua.h>
+#include <ghoul/lua/lua_helper.h>
+#include <ghoul/misc/assert.h>
+
+namespace {
+    // The address of this variable is used as the registry key for the snapshot
+    constexpr const char SnapshotKey = 0;
+
+    // Both functions are called through lua_pcall as they can raise errors, for example
+    // if a table has to grow and no memory is available
+
+    int snapshotGlobals(lua_State* state) {
+        lua_newtable(state);                       // 1: snapshot
+        lua_pushglobaltable(state);                // 2: _G
+        lua_pushnil(state);
+        while (lua_next(state, 2) != 0) {          // 3: key, 4: value
+            lua_pushvalue(state, 3);
+            lua_insert(state, -2);
+            lua_rawset(state, 1);
+        }
+        lua_pop(state, 1);
+        lua_rawsetp(state, LUA_REGISTRYINDEX, &SnapshotKey);
+        return 0;
+    }
+
+    int restoreGlobals(lua_State* state) {
+        lua_rawgetp(state, LUA_REGISTRYINDEX, &SnapshotKey); // 1: snapshot
+        lua_pushglobaltable(state);                           // 2: _G
+
+        // Restore all globals that were added or overwritten. Assigning to existing
+        // fields, including clearing them, is allowed while traversing the table
+        lua_pushnil(state);
+        while (lua_next(state, 2) != 0) {          // 3: key, 4: value
+            lua_pushvalue(state, 3);
+            lua_rawget(state, 1);                  // 5: snapshot value
+            if (lua_rawequal(state, 4, 5)) {
+                lua_pop(state, 2);
+            }
+            else {
+                lua_pushvalue(state, 3);
+                lua_insert(state, -2);
+                lua_rawset(state, 2);
+                lua_pop(state, 1);
+            }
+        }
+
+        // Restore all globals that were removed
+        lua_pushnil(state);
+        while (lua_next(state, 1) != 0) {          // 3: key, 4: snapshot value
+            lua_pushvalue(state, 3);
+            if (lua_rawget(state, 2) == LUA_TNIL) {
+                lua_pop(state, 1);
+                lua_pushvalue(state, 3);
+                lua_insert(state, -2);
+                lua_rawset(state, 2);
+            }
+            else {
+                lua_pop(state, 2);
+            }
+        }
+        return 0;
+    }
+} // namespace
+
+namespace ghoul::lua {
+
+LuaStatePool::Handle::Handle(LuaStatePool& pool, LuaState state)
+    : _pool(&pool)
+    , _state(std::move(state))
+{}
+
+LuaStatePool::Handle::Handle(Handle&& other) noexcept
+    : _pool(other._pool)
+    , _state(std::move(other._state))
+{
+    other._pool = nullptr;
+}
+
+LuaStatePool::Handle::~Handle() {
+    if (_pool) {
+        _pool->release(std::move(_state));
+    }
+}
+
+LuaStatePool::Handle::operator lua_State*() const {
+    return _state;
+}
+
+LuaStatePool::LuaStatePool(int nStates, LuaState::IncludeStandardLibrary include,
+                           std::function<void(lua_State*)> initializer)
+    : _includeStandardLibrary(include)
+    , _initializer(std::move(initializer))
+{
+    ghoul_assert(nStates >= 0, "nStates must be non-negative");
+
+    _idleStates.reserve(nStates);
+    for (int i = 0; i < nStates; ++i) {
+        _idleStates.push_back(createState());
+    }
+}
+
+LuaStatePool::Handle LuaStatePool::acquire() {
+    {
+        std::lock_guard lock(_mutex);
+        if (!_idleStates.empty()) {
+            LuaState state = std::move(_idleStates.back());
+            _idleStates.pop_back();
+            return Handle(*this, std::move(state));
+        }
+    }
+
+    // Creating the state is done outside the lock as it is the expensive part
+    return Handle(*this, createState());
+}
+
+int LuaStatePool::nIdleStates() const {
+    std::lock_guard lock(_mutex);
+    return static_cast<int>(_idleStates.size());
+}
+
+LuaState LuaStatePool::createState() const {
+    LuaState state(_includeStandardLibrary);
+    if (_initializer) {
+        _initializer(state);
+    }
+    lua_settop(state, 0);
+    lua_pushcfunction(state, snapshotGlobals);
+    if (lua_pcall(state, 0, 0, 0) != LUA_OK) {
+        throw LuaRuntimeException(fmt::format(
+            "Error recording global variables: {}", lua_tostring(state, -1)
+        ));
+    }
+    return state;
+}
+
+void LuaStatePool::release(LuaState state) {
+    lua_settop(state, 0);
+    lua_pushcfunction(state, restoreGlobals);
+    if (lua_pcall(state, 0, 0, 0) != LUA_OK) {
+        // This is called from the Handle's destructor, so there is no one to report the
+        // error to. The state is in an unknown condition and is destroyed instead
+        return;
+    }
+
+    std::lock_guard lock(_mutex);
+    _idleStates.push_back(std::move(state));
+}
+
+}  // namespace ghoul::lua
@@ -27,30 +27,312 @@
  *****************************************************************************************
  * Slicing-by-8 algorithms by Michael E. Kounavis and Frank L. Berry from Intel Corp.    *
  * http://www.intel.com/technology/comms/perfnet/download/CRC_generators.pdf             *
+ *****************************************************************************************
+ * Folding with PCLMULQDQ by Vinodh Gopal et al. from Intel Corp. "Fast CRC Computation  *
+ * for Generic Polynomials Using PCLMULQDQ Instruction"                                  *
  ****************************************************************************************/
 
 #include <ghoul/misc/crc32.h>
 
+#include <ghoul/filesystem/mappedfile.h>
 #include <ghoul/misc/assert.h>
-#include <fstream>
+#include <ghoul/misc/exception.h>
+#include <cstdint>
+#include <cstring>
+#include <istream>
 #include <vector>
 
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define GHOUL_CRC32_PCLMUL
+#ifdef _MSC_VER
+#include <intrin.h>
+#define GHOUL_TARGET_PCLMUL
+#else // ^^^^ _MSC_VER // !_MSC_VER vvvv
+#include <cpuid.h>
+#include <immintrin.h>
+#define GHOUL_TARGET_PCLMUL __attribute__((target("pclmul,sse4.1")))
+#endif // _MSC_VER
+#endif // x86
+
+// The CRC32 instructions are optional in ARMv8.0 and mandatory from ARMv8.1, so they are
+// only used if the compiler targets a CPU that supports them
+#if (defined(__ARM_FEATURE_CRC32) && !defined(__ARM_BIG_ENDIAN)) || defined(_M_ARM64)
+#define GHOUL_CRC32_ARMV8
+#ifdef _MSC_VER
+#include <intrin.h>
+#else // ^^^^ _MSC_VER // !_MSC_VER vvvv
+#include <arm_acle.h>
+#endif // _MSC_VER
+#endif // __ARM_FEATURE_CRC32
+
+namespace {
+    // The size of the blocks in which streams are read
+    constexpr const size_t StreamBlockSize = 64 * 1024;
+
+    struct SlicingTables {
+        uint32_t values[8][256];
+    };
+
+    // Each table advances the CRC by one more byte than the previous one, which makes it
+    // possible to process 8 bytes at once with independent lookups
+    constexpr SlicingTables createSlicingTables() {
+        SlicingTables res = {};
+        for (int i = 0; i < 256; ++i) {
+            res.values[0][i] = ghoul::CRC32Table[i];
+        }
+        for (int t = 1; t < 8; ++t) {
+            for (int i = 0; i < 256; ++i) {
+                const uint32_t prev = res.values[t - 1][i];
+                res.values[t][i] = (prev >> 8) ^ res.values[0][prev & 0xFF];
+            }
+        }
+        return res;
+    }
+
+    constexpr SlicingTables Tables = createSlicingTables();
+
+    // Loads the little-endian value independent of the alignment and the endianness of
+    // the platform. Compilers turn this into a single load on little-endian platforms
+    uint32_t loadLittleEndian(const unsigned char* data) {
+        return static_cast<uint32_t>(data[0]) |
+               (static_cast<uint32_t>(data[1]) << 8) |
+               (static_cast<uint32_t>(data[2]) << 16) |
+               (static_cast<uint32_t>(data[3]) << 24);
+    }
+
+    // All implementations work on the CRC register, which is the inverted hash value
+    using Implementation = uint32_t(*)(uint32_t crc, const unsigned char* data,
+        size_t size);
+
+    uint32_t updateSlicingBy8(uint32_t crc, const unsigned char* data, size_t size) {
+        const auto& t = Tables.values;
+        while (size >= 8) {
+            const uint32_t one = loadLittleEndian(data) ^ crc;
+            const uint32_t two = loadLittleEndian(data + 4);
+            crc = t[7][one & 0xFF] ^ t[6][(one >> 8) & 0xFF] ^
+                  t[5][(one >> 16) & 0xFF] ^ t[4][one >> 24] ^
+                  t[3][two & 0xFF] ^ t[2][(two >> 8) & 0xFF] ^
+                  t[1][(two >> 16) & 0xFF] ^ t[0][two >> 24];
+            data += 8;
+            size -= 8;
+        }
+        while (size > 0) {
+            crc = t[0][(crc ^ *data) & 0xFF] ^ (crc >> 8);
+            ++data;
+            --size;
+        }
+        return crc;
+    }
+
+#ifdef GHOUL_CRC32_PCLMUL
+    bool hasPclmul() {
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 1);
+        const unsigned int ecx = static_cast<unsigned int>(info[2]);
+#else // ^^^^ _MSC_VER // !_MSC_VER vvvv
+        unsigned int eax, ebx, ecx, edx;
+        if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+            return false;
+        }
+#endif // _MSC_VER
+        constexpr const unsigned int Pclmulqdq = 1 << 1;
+        constexpr const unsigned int Sse41 = 1 << 19;
+        return (ecx & Pclmulqdq) && (ecx & Sse41);
+    }
+
+    GHOUL_TARGET_PCLMUL
+    inline __m128i load(const unsigned char* data) {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    }
+
+    // Folds the 128 bit block over the distance given by the constant onto the next block
+    GHOUL_TARGET_PCLMUL
+    inline __m128i fold(__m128i value, __m128i constant, __m128i next) {
+        const __m128i lo = _mm_clmulepi64_si128(value, constant, 0x00);
+        const __m128i hi = _mm_clmulepi64_si128(value, constant, 0x11);
+        return _mm_xor_si128(_mm_xor_si128(lo, hi), next);
+    }
+
+    // Folds four 128 bit blocks in parallel until less than 64 bytes are left, reduces
+    // them to a single block, folds the remaining 16 byte blocks into it, and finally
+    // uses a Barrett reduction to get the 32 bit result. The constants are the powers of
+    // x modulo the bit-reflected polynomial that are needed for the folding distances
+    GHOUL_TARGET_PCLMUL
+    uint32_t foldPclmul(uint32_t crc, const unsigned char* data, size_t size) {
+        ghoul_assert(size >= 64 && size % 16 == 0, "Invalid size for folding");
+
+        alignas(16) static constexpr const uint64_t K1K2[] = { 0x154442BD4, 0x1C6E41596 };
+        alignas(16) static constexpr const uint64_t K3K4[] = { 0x1751997D0, 0x0CCAA009E };
+        alignas(16) static constexpr const uint64_t K5K0[] = { 0x163CD6124, 0x000000000 };
+        alignas(16) static constexpr const uint64_t Poly[] = { 0x1DB710641, 0x1F7011641 };
+
+        __m128i x1 = _mm_xor_si128(load(data), _mm_cvtsi32_si128(static_cast<int>(crc)));
+        __m128i x2 = load(data + 16);
+        __m128i x3 = load(data + 32);
+        __m128i x4 = load(data + 48);
+        data += 64;
+        size -= 64;
+
+        __m128i k = _mm_load_si128(reinterpret_cast<const __m128i*>(K1K2));
+        while (size >= 64) {
+            x1 = fold(x1, k, load(data));
+            x2 = fold(x2, k, load(data + 16));
+            x3 = fold(x3, k, load(data + 32));
+            x4 = fold(x4, k, load(data + 48));
+            data += 64;
+            size -= 64;
+        }
+
+        k = _mm_load_si128(reinterpret_cast<const __m128i*>(K3K4));
+        x1 = fold(x1, k, x2);
+        x1 = fold(x1, k, x3);
+        x1 = fold(x1, k, x4);
+        while (size >= 16) {
+            x1 = fold(x1, k, load(data));
+            data += 16;
+            size -= 16;
+        }
+
+        // Fold 128 bits to 64 bits
+        const __m128i mask = _mm_setr_epi32(~0, 0, ~0, 0);
+        x2 = _mm_clmulepi64_si128(x1, k, 0x10);
+        x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+        k = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(K5K0));
+        x2 = _mm_srli_si128(x1, 4);
+        x1 = _mm_and_si128(x1, mask);
+        x1 = _mm_xor_si128(_mm_clmulepi64_si128(x1, k, 0x00), x2);
+
+        // Barrett reduction to 32 bits
+        k = _mm_load_si128(reinterpret_cast<const __m128i*>(Poly));
+        x2 = _mm_and_si128(x1, mask);
+        x2 = _mm_clmulepi64_si128(x2, k, 0x10);
+        x2 = _mm_and_si128(x2, mask);
+        x2 = _mm_clmulepi64_si128(x2, k, 0x00);
+        x1 = _mm_xor_si128(x1, x2);
+        return static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
+    }
+
+    uint32_t updatePclmul(uint32_t crc, const unsigned char* data, size_t size) {
+        // Folding only pays off for larger buffers and works on multiples of 16 bytes
+        if (size >= 64) {
+            const size_t folded = size & ~size_t(15);
+            crc = foldPclmul(crc, data, folded);
+            data += folded;
+            size -= folded;
+        }
+        return updateSlicingBy8(crc, data, size);
+    }
+#endif // GHOUL_CRC32_PCLMUL
+
+#ifdef GHOUL_CRC32_ARMV8
+    uint32_t updateArmV8(uint32_t crc, const unsigned char* data, size_t size) {
+        while (size >= 8) {
+            uint64_t value;
+            std::memcpy(&value, data, sizeof(uint64_t));
+            crc = __crc32d(crc, value);
+            data += 8;
+            size -= 8;
+        }
+        while (size > 0) {
+            crc = __crc32b(crc, *data);
+            ++data;
+            --size;
+        }
+        return crc;
+    }
+#endif // GHOUL_CRC32_ARMV8
+
+    Implementation selectImplementation() {
+#ifdef GHOUL_CRC32_PCLMUL
+        if (hasPclmul()) {
+            return &updatePclmul;
+        }
+#endif // GHOUL_CRC32_PCLMUL
+#ifdef GHOUL_CRC32_ARMV8
+        return &updateArmV8;
+#else // ^^^^ GHOUL_CRC32_ARMV8 // !GHOUL_CRC32_ARMV8 vvvv
+        return &updateSlicingBy8;
+#endif // GHOUL_CRC32_ARMV8
+    }
+} // namespace
+
 namespace ghoul {
 
+unsigned int updateCRC32(unsigned int crc, const char* buffer, size_t size) {
+    ghoul_assert(buffer || size == 0, "buffer must not be nullptr");
+
+    // The CPU features are only checked once, which also works for calls from static
+    // initializers in other translation units
+    static const Implementation Update = selectImplementation();
+    return ~Update(~crc, reinterpret_cast<const unsigned char*>(buffer), size);
+}
+
+bool hasCRC32Implementation(CRC32Implementation implementation) {
+    switch (implementation) {
+        case CRC32Implementation::SlicingBy8:
+            return true;
+        case CRC32Implementation::Pclmul:
+#ifdef GHOUL_CRC32_PCLMUL
+            return hasPclmul();
+#else // ^^^^ GHOUL_CRC32_PCLMUL // !GHOUL_CRC32_PCLMUL vvvv
+            return false;
+#endif // GHOUL_CRC32_PCLMUL
+        case CRC32Implementation::ArmV8:
+#ifdef GHOUL_CRC32_ARMV8
+            return true;
+#else // ^^^^ GHOUL_CRC32_ARMV8 // !GHOUL_CRC32_ARMV8 vvvv
+            return false;
+#endif // GHOUL_CRC32_ARMV8
+        default:
+            throw MissingCaseException();
+    }
+}
+
+unsigned int updateCRC32(unsigned int crc, const char* buffer, size_t size,
+                         CRC32Implementation implementation)
+{
+    ghoul_assert(buffer || size == 0, "buffer must not be nullptr");
+    ghoul_assert(
+        hasCRC32Implementation(implementation),
+        "implementation must be available"
+    );
+
+    Implementation update = &updateSlicingBy8;
+#ifdef GHOUL_CRC32_PCLMUL
+    if (implementation == CRC32Implementation::Pclmul) {
+        update = &updatePclmul;
+    }
+#endif // GHOUL_CRC32_PCLMUL
+#ifdef GHOUL_CRC32_ARMV8
+    if (implementation == CRC32Implementation::ArmV8) {
+        update = &updateArmV8;
+    }
+#endif // GHOUL_CRC32_ARMV8
+    return ~update(~crc, reinterpret_cast<const unsigned char*>(buffer), size);
+}
+
 unsigned int hashCRC32(const std::string& s) {
-    return hashCRC32(s.c_str());
+    return updateCRC32(0, s.data(), s.size());
 }
 
 unsigned int hashCRC32File(const std::string& file) {
-    std::fstream f(file);
-    f.seekg(0, std::ios::end);
-    unsigned int length = static_cast<int>(f.tellg());
-    f.seekg(0, std::ios::beg);
-    std::vector<char> buffer(length);
-    f.read(buffer.data(), length);
-    f.close();
-
-    return hashCRC32(buffer.data(), length);
+    // The contents are hashed straight from the page cache without copying them
+    filesystem::MappedFile f(file, filesystem::MappedFile::Advice::Sequential);
+    return updateCRC32(0, f.data(), f.size());
+}
+
+unsigned int hashCRC32(std::istream& stream) {
+    std::vector<char> buffer(StreamBlockSize);
+    unsigned int crc = 0;
+    while (stream) {
+        stream.read(buffer.data(), buffer.size());
+        crc = updateCRC32(crc, buffer.data(), static_cast<size_t>(stream.gcount()));
+    }
+    if (stream.bad()) {
+        throw RuntimeError("Error reading from stream", "CRC32");
+    }
+    return crc;
 }
 
 } // namespace ghoul
@@ -29,27 +29,196 @@
 #include <ghoul/misc/assert.h>
 #include <ghoul/misc/exception.h>
 #include <ghoul/misc/misc.h>
+#include <ghoul/misc/stringconversion.h>
+#include <ghoul/misc/threadpool.h>
 #include <algorithm>
-#include <fstream>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+
+#if defined(__AVX2__)
+#define GHOUL_CSV_AVX2
+#endif // __AVX2__
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GHOUL_CSV_SSE2
+#endif // __SSE2__
+
+#ifdef GHOUL_CSV_AVX2
+#include <immintrin.h>
+#elif defined(GHOUL_CSV_SSE2)
+#include <emmintrin.h>
+#endif // GHOUL_CSV_AVX2
+
+#ifdef WIN32
+#include <intrin.h>
+#endif // WIN32
 
 namespace {
-    std::vector<std::vector<std::string>> internalLoadCSV(std::ifstream& file,
-                                                          const std::vector<int>& indices)
+    // Chunks of a file that is parsed in parallel are at least this large
+    constexpr const size_t MinChunkSize = 1024 * 1024;
+
+    constexpr const char Quote = '"';
+
+    [[maybe_unused]] int countTrailingZeros(uint32_t value) {
+#ifdef WIN32
+        unsigned long index;
+        _BitScanForward(&index, value);
+        return static_cast<int>(index);
+#else // ^^^^ WIN32 // !WIN32 vvvv
+        return __builtin_ctz(value);
+#endif // WIN32
+    }
+
+    // Returns the position of the first delimiter or '\n' at or after the position, or
+    // the size of the contents if there is none. These are the only structural
+    // characters in an unquoted cell, so they are searched for 32 or 16 characters at a
+    // time where the instruction set allows it
+    size_t findSeparator(std::string_view contents, size_t position, char delimiter) {
+        const char* data = contents.data();
+        const size_t size = contents.size();
+
+#ifdef GHOUL_CSV_AVX2
+        const __m256i delimiters256 = _mm256_set1_epi8(delimiter);
+        const __m256i newlines256 = _mm256_set1_epi8('\n');
+        while (position + sizeof(__m256i) <= size) {
+            const __m256i block = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(data + position)
+            );
+            const __m256i matches = _mm256_or_si256(
+                _mm256_cmpeq_epi8(block, delimiters256),
+                _mm256_cmpeq_epi8(block, newlines256)
+            );
+            const uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(matches));
+            if (mask != 0) {
+                return position + countTrailingZeros(mask);
+            }
+            position += sizeof(__m256i);
+        }
+#endif // GHOUL_CSV_AVX2
+
+#ifdef GHOUL_CSV_SSE2
+        const __m128i delimiters = _mm_set1_epi8(delimiter);
+        const __m128i newlines = _mm_set1_epi8('\n');
+        while (position + sizeof(__m128i) <= size) {
+            const __m128i block = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(data + position)
+            );
+            const __m128i matches = _mm_or_si128(
+                _mm_cmpeq_epi8(block, delimiters),
+                _mm_cmpeq_epi8(block, newlines)
+            );
+            const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(matches));
+            if (mask != 0) {
+                return position + countTrailingZeros(mask);
+            }
+            position += sizeof(__m128i);
+        }
+#endif // GHOUL_CSV_SSE2
+
+        while (position < size && data[position] != delimiter && data[position] != '\n') {
+            ++position;
+        }
+        return position;
+    }
+
+    // Removes the '\r' of a "\r\n" line break if the cell is the last one in the row
+    std::string_view removeCarriageReturn(std::string_view cell,
+                                          std::string_view contents, size_t separator)
+    {
+        const bool isLast = separator >= contents.size() || contents[separator] == '\n';
+        if (isLast && !cell.empty() && cell.back() == '\r') {
+            cell.remove_suffix(1);
+        }
+        return cell;
+    }
+
+    ghoul::CSVReader openFile(const std::string& fileName, char delimiter) {
+        using ghoul::filesystem::MappedFile;
+        // The file is parsed directly from the page cache without copying it first
+        return ghoul::CSVReader(
+            MappedFile(fileName, MappedFile::Advice::Sequential),
+            delimiter
+        );
+    }
+
+    std::vector<std::string_view> readHeader(ghoul::CSVReader& reader,
+                                             const std::string& fileName)
+    {
+        std::vector<std::string_view> header;
+        if (!reader.readRow(header)) {
+            throw ghoul::RuntimeError(
+                fmt::format("CSV file {} did not contain any lines", fileName)
+            );
+        }
+        return header;
+    }
+
+    std::vector<int> columnIndices(const std::vector<std::string_view>& header,
+                                   const std::vector<std::string>& columns,
+                                   const std::string& fileName)
+    {
+        std::vector<int> indices(columns.size());
+        std::transform(
+            columns.begin(),
+            columns.end(),
+            indices.begin(),
+            [&header, &fileName](const std::string& column) {
+                auto it = std::find(header.begin(), header.end(), column);
+                if (it == header.end()) {
+                    throw ghoul::RuntimeError(fmt::format(
+                        "CSV file {} did not contain the requested key {}",
+                        fileName, column
+                    ));
+                }
+
+                return static_cast<int>(std::distance(header.begin(), it));
+            }
+        );
+        return indices;
+    }
+
+    void checkIndices(const std::vector<std::string_view>& cells,
+                      const std::vector<int>& indices, const std::string& fileName,
+                      size_t lineNumber)
     {
-        ghoul_assert(file.good(), "File handle should be good");
+        for (int idx : indices) {
+            if (idx < 0 || static_cast<size_t>(idx) >= cells.size()) {
+                throw ghoul::RuntimeError(fmt::format(
+                    "CSV file {} does not contain column {} in line {}",
+                    fileName, idx, lineNumber
+                ));
+            }
+        }
+    }
 
+    std::vector<std::vector<std::string>> internalLoadCSV(ghoul::CSVReader& reader,
+                                                          const std::string& fileName,
+                                                          const std::vector<int>& indices)
+    {
         std::vector<std::vector<std::string>> result;
 
-        std::string line;
-        while (std::getline(file, line)) {
-            std::vector<std::string> lineValues = ghoul::tokenizeString(line, ',');
+        std::vector<std::string_view> cells;
+        while (reader.readRow(cells)) {
+            std::vector<std::string> lineValues;
             // If indices have been specified, we use those to reorganize and filter the
             // line values
-            if (!indices.empty()) {
-                std::vector<std::string> copy = lineValues;
-                lineValues.clear();
+            if (indices.empty()) {
+                lineValues.assign(cells.begin(), cells.end());
+            }
+            else {
+                checkIndices(cells, indices, fileName, reader.lineNumber());
+                lineValues.reserve(indices.size());
                 for (int idx : indices) {
-                    lineValues.push_back(copy[idx]);
+                    lineValues.emplace_back(cells[idx]);
                 }
             }
             result.push_back(std::move(lineValues));
@@ -57,93 +226,598 @@ namespace {
 
         return result;
     }
+
+    template <typename T>
+    bool parseValue(std::string_view cell, T& value) {
+        ghoul::trimWhitespace(cell);
+        if (cell.empty()) {
+            if constexpr (std::is_floating_point_v<T>) {
+                value = std::numeric_limits<T>::quiet_NaN();
+                return true;
+            }
+            return false;
+        }
+        const char* end = cell.data() + cell.size();
+        const std::from_chars_result res = ghoul::from_chars(cell.data(), end, value);
+        return res.ec == std::errc() && res.ptr == end;
+    }
+
+    // The first problem that was encountered while parsing a chunk of the file
+    struct ParseError {
+        enum class Type { MissingColumn, InvalidValue };
+        Type type;
+        // The line number relative to the beginning of the chunk
+        size_t line;
+        int column;
+        std::string value;
+    };
+
+    template <typename T>
+    struct Chunk {
+        std::string_view contents;
+        std::vector<std::vector<T>> columns;
+        std::optional<ParseError> error;
+        std::exception_ptr exception;
+    };
+
+    // Parses the contents of the chunk into its columns and stops at the first error.
+    // This function does not throw, so it can be used on other threads
+    template <typename T>
+    void parseColumns(Chunk<T>& chunk, const std::vector<int>& indices,
+                      char delimiter) noexcept
+    {
+        try {
+            chunk.columns.resize(indices.size());
+
+            ghoul::CSVReader reader(chunk.contents, delimiter);
+            std::vector<std::string_view> cells;
+            while (reader.readRow(cells)) {
+                for (size_t i = 0; i < indices.size(); ++i) {
+                    const int idx = indices[i];
+                    if (idx < 0 || static_cast<size_t>(idx) >= cells.size()) {
+                        chunk.error = ParseError {
+                            ParseError::Type::MissingColumn,
+                            reader.lineNumber(),
+                            idx,
+                            ""
+                        };
+                        return;
+                    }
+
+                    T value;
+                    if (!parseValue(cells[idx], value)) {
+                        chunk.error = ParseError {
+                            ParseError::Type::InvalidValue,
+                            reader.lineNumber(),
+                            idx,
+                            std::string(cells[idx])
+                        };
+                        return;
+                    }
+                    chunk.columns[i].push_back(value);
+                }
+            }
+        }
+        catch (...) {
+            chunk.exception = std::current_exception();
+        }
+    }
+
+    // Throws the first error of the chunks in the order in which they appear in the
+    // file, whose complete contents are passed in 'file'
+    template <typename T>
+    void throwChunkErrors(const std::vector<Chunk<T>>& chunks, std::string_view file,
+                          const std::string& fileName)
+    {
+        for (const Chunk<T>& chunk : chunks) {
+            if (chunk.exception) {
+                std::rethrow_exception(chunk.exception);
+            }
+            if (!chunk.error) {
+                continue;
+            }
+
+            // Only the line numbers relative to the chunk are known while parsing
+            const ParseError& e = *chunk.error;
+            const size_t line =
+                e.line + std::count(file.data(), chunk.contents.data(), '\n');
+            switch (e.type) {
+                case ParseError::Type::MissingColumn:
+                    throw ghoul::RuntimeError(fmt::format(
+                        "CSV file {} does not contain column {} in line {}",
+                        fileName, e.column, line
+                    ));
+                case ParseError::Type::InvalidValue:
+                    throw ghoul::RuntimeError(fmt::format(
+                        "CSV file {} contains invalid value '{}' in line {}",
+                        fileName, e.value, line
+                    ));
+            }
+        }
+    }
+
+    // The state is shared with the tasks in the ThreadPool. A task might only start
+    // after all jobs have been run, in which case it returns immediately but still needs
+    // the state to be alive
+    struct ParallelState {
+        std::function<void(size_t)> job;
+        size_t nJobs = 0;
+        std::atomic<size_t> nextJob = 0;
+
+        std::mutex mutex;
+        std::condition_variable jobFinished;
+        size_t nFinishedJobs = 0;
+    };
+
+    void runPendingJobs(ParallelState& state) {
+        size_t i;
+        while ((i = state.nextJob++) < state.nJobs) {
+            state.job(i);
+            {
+                std::lock_guard lock(state.mutex);
+                ++state.nFinishedJobs;
+            }
+            state.jobFinished.notify_one();
+        }
+    }
+
+    // Runs the job for all indices in [0, nJobs) on the workers of the ThreadPool and the
+    // calling thread and returns once all of them have finished. The job must not throw
+    void runParallel(ghoul::ThreadPool& threadPool, size_t nJobs,
+                     std::function<void(size_t)> job)
+    {
+        std::shared_ptr<ParallelState> state = std::make_shared<ParallelState>();
+        state->job = std::move(job);
+        state->nJobs = nJobs;
+        const size_t nThreads = static_cast<size_t>(threadPool.size()) + 1;
+        for (size_t i = 1; i < std::min(nThreads, nJobs); ++i) {
+            threadPool.queue([state]() { runPendingJobs(*state); });
+        }
+
+        // The calling thread participates as well, which guarantees progress even if all
+        // workers of the ThreadPool are busy with other tasks
+        runPendingJobs(*state);
+        std::unique_lock lock(state->mutex);
+        state->jobFinished.wait(lock, [&state]() {
+            return state->nFinishedJobs == state->nJobs;
+        });
+    }
+
+    // The states that decide whether a line break ends a row. A quote only starts a
+    // quoted section at the beginning of a cell. The closing quote of a quoted section
+    // leads to the same transitions as the beginning of a cell: another quote continues
+    // the quoted section as an escaped quote, any other character is trailing content
+    enum RowState : uint8_t { CellStart = 0, Unquoted, Quoted, NRowStates };
+
+    enum CharacterClass : uint8_t { Other = 0, QuoteClass, DelimiterClass, NewlineClass };
+
+    constexpr const RowState Transitions[NRowStates][4] = {
+        { Unquoted, Quoted, CellStart, CellStart },    // CellStart
+        { Unquoted, Unquoted, CellStart, CellStart },  // Unquoted
+        { Quoted, CellStart, Quoted, Quoted }          // Quoted
+    };
+
+    // A part of the contents whose row boundaries are found independently of the other
+    // blocks by following every state that the block might start in
+    struct Block {
+        size_t begin = 0;
+        size_t end = 0;
+        /// The offset behind the first line break that ends a row for each start state,
+        /// or std::string_view::npos if the block does not contain one
+        std::array<size_t, NRowStates> rowEnd;
+        /// The state at the end of the block for each start state
+        std::array<RowState, NRowStates> endState;
+    };
+
+    void scanBlock(std::string_view contents, Block& block, char delimiter) noexcept {
+        std::array<CharacterClass, 256> classes;
+        classes.fill(Other);
+        classes[static_cast<unsigned char>(Quote)] = QuoteClass;
+        classes[static_cast<unsigned char>(delimiter)] = DelimiterClass;
+        classes[static_cast<unsigned char>('\n')] = NewlineClass;
+
+        // The states for all start states are combined into a single index, so that they
+        // are all advanced with one lookup per character
+        constexpr size_t NCombined = NRowStates * NRowStates * NRowStates;
+        auto combine = [](const std::array<RowState, NRowStates>& states) {
+            return static_cast<uint8_t>(
+                states[0] + NRowStates * (states[1] + NRowStates * states[2])
+            );
+        };
+        auto split = [](uint8_t combined) {
+            std::array<RowState, NRowStates> states;
+            for (RowState& state : states) {
+                state = static_cast<RowState>(combined % NRowStates);
+                combined /= NRowStates;
+            }
+            return states;
+        };
+        std::array<std::array<uint8_t, 4>, NCombined> transitions;
+        for (size_t i = 0; i < NCombined; ++i) {
+            const std::array<RowState, NRowStates> states =
+                split(static_cast<uint8_t>(i));
+            for (uint8_t c = 0; c < 4; ++c) {
+                transitions[i][c] = combine({
+                    Transitions[states[0]][c],
+                    Transitions[states[1]][c],
+                    Transitions[states[2]][c]
+                });
+            }
+        }
+
+        uint8_t combined = combine({ CellStart, Unquoted, Quoted });
+        block.rowEnd.fill(std::string_view::npos);
+        size_t nMissingRowEnds = NRowStates;
+        for (size_t i = block.begin; i < block.end; ++i) {
+            const CharacterClass c = classes[static_cast<unsigned char>(contents[i])];
+            if (c == NewlineClass && nMissingRowEnds > 0) {
+                const std::array<RowState, NRowStates> states = split(combined);
+                for (size_t s = 0; s < NRowStates; ++s) {
+                    const bool isFirst = block.rowEnd[s] == std::string_view::npos;
+                    if (states[s] != Quoted && isFirst) {
+                        block.rowEnd[s] = i + 1;
+                        --nMissingRowEnds;
+                    }
+                }
+            }
+            combined = transitions[combined][c];
+        }
+        block.endState = split(combined);
+    }
+
+    // Splits the contents into about equally sized chunks that end at row boundaries.
+    // Whether a line break ends a row depends on every quote before it, so the blocks
+    // between the target offsets are first scanned in parallel for every state they
+    // might start in. The actual states then follow from the beginning of the contents
+    // one block at a time, which decides where the chunks are split
+    std::vector<std::string_view> splitChunks(std::string_view contents, size_t nChunks,
+                                              char delimiter,
+                                              ghoul::ThreadPool& threadPool)
+    {
+        std::vector<Block> blocks(nChunks);
+        for (size_t i = 0; i < nChunks; ++i) {
+            blocks[i].begin = contents.size() * i / nChunks;
+            blocks[i].end = contents.size() * (i + 1) / nChunks;
+        }
+        runParallel(threadPool, nChunks, [&](size_t i) {
+            scanBlock(contents, blocks[i], delimiter);
+        });
+
+        std::vector<std::string_view> result;
+        size_t begin = 0;
+        RowState state = blocks[0].endState[CellStart];
+        for (size_t i = 1; i < nChunks; ++i) {
+            // A single long row might cover more than one block
+            const size_t end = blocks[i].rowEnd[state];
+            if (end != std::string_view::npos) {
+                result.push_back(contents.substr(begin, end - begin));
+                begin = end;
+            }
+            state = blocks[i].endState[state];
+        }
+        if (begin < contents.size()) {
+            result.push_back(contents.substr(begin));
+        }
+        return result;
+    }
+
+    // Parses the columns of the file starting at the offset 'begin'. If a ThreadPool with
+    // more than one worker is passed, the contents are split into chunks that are parsed
+    // in parallel and the results are joined in order
+    template <typename T>
+    std::vector<std::vector<T>> internalLoadColumns(std::string_view file, size_t begin,
+                                                    const std::string& fileName,
+                                                    const std::vector<int>& indices,
+                                                    char delimiter,
+                                                    ghoul::ThreadPool* threadPool)
+    {
+        const std::string_view contents = file.substr(begin);
+        const size_t nThreads = threadPool ? threadPool->size() + 1 : 1;
+        // Each thread gets a couple of chunks to balance out differences in row lengths,
+        // but chunks have to be large enough to be worth the overhead
+        const size_t nChunks = std::min(nThreads * 4, contents.size() / MinChunkSize);
+
+        if (nThreads == 1 || nChunks <= 1) {
+            std::vector<Chunk<T>> chunks(1);
+            chunks[0].contents = contents;
+            parseColumns(chunks[0], indices, delimiter);
+            throwChunkErrors(chunks, file, fileName);
+            return std::move(chunks[0].columns);
+        }
+
+        const std::vector<std::string_view> parts =
+            splitChunks(contents, nChunks, delimiter, *threadPool);
+        std::vector<Chunk<T>> chunks(parts.size());
+        for (size_t i = 0; i < parts.size(); ++i) {
+            chunks[i].contents = parts[i];
+        }
+        runParallel(*threadPool, chunks.size(), [&](size_t i) {
+            parseColumns(chunks[i], indices, delimiter);
+        });
+        throwChunkErrors(chunks, file, fileName);
+
+        std::vector<std::vector<T>> result(indices.size());
+        for (size_t i = 0; i < indices.size(); ++i) {
+            size_t nValues = 0;
+            for (const Chunk<T>& chunk : chunks) {
+                nValues += chunk.columns[i].size();
+            }
+            result[i].reserve(nValues);
+            for (Chunk<T>& chunk : chunks) {
+                result[i].insert(
+                    result[i].end(),
+                    chunk.columns[i].begin(),
+                    chunk.columns[i].end()
+                );
+                // Release the memory of the chunk early to keep the peak memory usage low
+                std::vector<T>().swap(chunk.columns[i]);
+            }
+        }
+        return result;
+    }
 } // namespace
 
 namespace ghoul {
 
+CSVReader::CSVReader(filesystem::MappedFile file, char delimiter)
+    : _file(std::move(file))
+    , _contents(_file->view())
+    , _delimiter(delimiter)
+{
+    ghoul_assert(
+        _delimiter != Quote && _delimiter != '\r' && _delimiter != '\n',
+        "Delimiter must not be a quote or line break"
+    );
+}
+
+CSVReader::CSVReader(std::string_view contents, char delimiter)
+    : _contents(contents)
+    , _delimiter(delimiter)
+{
+    ghoul_assert(
+        _delimiter != Quote && _delimiter != '\r' && _delimiter != '\n',
+        "Delimiter must not be a quote or line break"
+    );
+}
+
+bool CSVReader::readRow(std::vector<std::string_view>& cells) {
+    cells.clear();
+    if (_position >= _contents.size()) {
+        return false;
+    }
+
+    _lineNumber = _nextLineNumber;
+    _buffer.clear();
+    _bufferedCells.clear();
+
+    size_t position = _position;
+    while (true) {
+        size_t separator;
+        if (position < _contents.size() && _contents[position] == Quote) {
+            separator = readQuotedCell(position, cells);
+        }
+        else {
+            separator = findSeparator(_contents, position, _delimiter);
+            cells.push_back(removeCarriageReturn(
+                _contents.substr(position, separator - position),
+                _contents,
+                separator
+            ));
+        }
+
+        if (separator < _contents.size() && _contents[separator] == _delimiter) {
+            position = separator + 1;
+        }
+        else {
+            // We reached the line break at the end of the row or the end of the contents
+            _position = separator + 1;
+            ++_nextLineNumber;
+            break;
+        }
+    }
+
+    // The buffer might have been reallocated while the row was read, so the cells can
+    // only point into it once it is complete
+    for (const auto& [index, offset, length] : _bufferedCells) {
+        cells[index] = std::string_view(_buffer.data() + offset, length);
+    }
+    return true;
+}
+
+size_t CSVReader::readQuotedCell(size_t position, std::vector<std::string_view>& cells) {
+    const size_t begin = position + 1;
+    size_t current = begin;
+    size_t end = _contents.size();
+    bool isBuffered = false;
+    const size_t bufferOffset = _buffer.size();
+
+    while (current < _contents.size()) {
+        const size_t quote = std::min(_contents.find(Quote, current), _contents.size());
+        _nextLineNumber += std::count(
+            _contents.begin() + current,
+            _contents.begin() + quote,
+            '\n'
+        );
+
+        const bool isEscaped = quote + 1 < _contents.size() &&
+                               _contents[quote + 1] == Quote;
+        if (isEscaped) {
+            // Everything up to and including the first of the two quotes is kept
+            _buffer.append(_contents.substr(current, quote + 1 - current));
+            isBuffered = true;
+            current = quote + 2;
+            continue;
+        }
+
+        if (isBuffered) {
+            _buffer.append(_contents.substr(current, quote - current));
+        }
+        end = quote;
+        current = quote + 1;
+        break;
+    }
+
+    // RFC 4180 does not allow any characters between the closing quote and the next
+    // delimiter. If there are any, they are kept as part of the cell
+    current = std::min(current, _contents.size());
+    const size_t separator = findSeparator(_contents, current, _delimiter);
+    const std::string_view trailing = removeCarriageReturn(
+        _contents.substr(current, separator - current),
+        _contents,
+        separator
+    );
+    if (!trailing.empty()) {
+        if (!isBuffered) {
+            _buffer.append(_contents.substr(begin, end - begin));
+            isBuffered = true;
+        }
+        _buffer.append(trailing);
+    }
+
+    if (isBuffered) {
+        _bufferedCells.emplace_back(
+            cells.size(),
+            bufferOffset,
+            _buffer.size() - bufferOffset
+        );
+        cells.emplace_back();
+    }
+    else {
+        cells.push_back(_contents.substr(begin, end - begin));
+    }
+    return separator;
+}
+
+bool CSVReader::skipRow() {
+    return readRow(_skippedCells);
+}
+
+size_t CSVReader::lineNumber() const {
+    return _lineNumber;
+}
+
+size_t CSVReader::position() const {
+    return std::min(_position, _contents.size());
+}
+
 std::vector<std::vector<std::string>> loadCSVFile(const std::string& fileName,
-                                                  bool includeFirstLine)
+                                                  bool includeFirstLine, char delimiter)
 {
     ghoul_assert(!fileName.empty(), "fileName must not be empty");
 
-    std::ifstream file;
-    file.exceptions(std::ifstream::badbit);
-    file.open(fileName);
+    CSVReader reader = openFile(fileName, delimiter);
 
     // Just skip over the first line if we don't want to include it
     if (!includeFirstLine) {
-        std::string line;
-        std::getline(file, line);
+        reader.skipRow();
     }
 
-    return internalLoadCSV(file, std::vector<int>());
+    return internalLoadCSV(reader, fileName, std::vector<int>());
 }
 
 std::vector<std::vector<std::string>> loadCSVFile(const std::string& fileName,
                                                   const std::vector<std::string>& columns,
-                                                  bool includeFirstLine)
+                                                  bool includeFirstLine, char delimiter)
 {
     ghoul_assert(!fileName.empty(), "fileName must not be empty");
     ghoul_assert(!columns.empty(), "columns must not be empty");
 
-    std::ifstream file;
-    file.exceptions(std::ifstream::badbit);
-    file.open(fileName);
+    CSVReader reader = openFile(fileName, delimiter);
 
     // Get the file line that contains the column names
-    std::string line;
-    std::getline(file, line);
-    std::vector<std::string> elements = ghoul::tokenizeString(line, ',');
-    if (elements.empty()) {
-        throw ghoul::RuntimeError(
-            fmt::format("CSV file {} did not contain any lines", fileName)
-        );
-    }
-
-    std::vector<int> indices(columns.size());
-
-    std::transform(
-        columns.begin(),
-        columns.end(),
-        indices.begin(),
-        [elements, &fileName](const std::string& column) {
-            auto it = std::find(elements.begin(), elements.end(), column);
-            if (it == elements.end()) {
-                throw ghoul::RuntimeError(fmt::format(
-                    "CSV file {} did not contain the requested key {}", fileName, column
-                ));
-            }
-
-            return static_cast<int>(std::distance(elements.begin(), it));
-        }
+    const std::vector<int> indices = columnIndices(
+        readHeader(reader, fileName),
+        columns,
+        fileName
     );
 
-    // Reset the file stream if we want to include the first line
+    // Start from the beginning again if we want to include the first line
     if (includeFirstLine) {
-        file.seekg(0);
+        reader = openFile(fileName, delimiter);
     }
 
-    return internalLoadCSV(file, indices);
+    return internalLoadCSV(reader, fileName, indices);
 }
 
 std::vector<std::vector<std::string>> loadCSVFile(const std::string& fileName,
                                                   const std::vector<int>& columns,
-                                                  bool includeFirstLine)
+                                                  bool includeFirstLine, char delimiter)
 {
     ghoul_assert(!fileName.empty(), "fileName must not be empty");
     ghoul_assert(!columns.empty(), "columns must not be empty");
 
-    std::ifstream file;
-    file.exceptions(std::ifstream::badbit);
-    file.open(fileName);
+    CSVReader reader = openFile(fileName, delimiter);
 
     // Just skip over the first line if we don't want to include it
     if (!includeFirstLine) {
-        std::string line;
-        std::getline(file, line);
+        reader.skipRow();
+    }
+
+    return internalLoadCSV(reader, fileName, columns);
+}
+
+template <typename T>
+std::vector<std::vector<T>> loadCSVColumns(const std::string& fileName,
+                                           const std::vector<int>& columns,
+                                           bool includeFirstLine, ThreadPool* threadPool,
+                                           char delimiter)
+{
+    ghoul_assert(!fileName.empty(), "fileName must not be empty");
+    ghoul_assert(!columns.empty(), "columns must not be empty");
+
+    filesystem::MappedFile file(fileName, filesystem::MappedFile::Advice::Sequential);
+    CSVReader reader(file.view(), delimiter);
+    if (!includeFirstLine) {
+        reader.skipRow();
     }
 
-    return internalLoadCSV(file, columns);
+    return internalLoadColumns<T>(
+        file.view(),
+        reader.position(),
+        fileName,
+        columns,
+        delimiter,
+        threadPool
+    );
 }
 
+template <typename T>
+std::vector<std::vector<T>> loadCSVColumns(const std::string& fileName,
+                                           const std::vector<std::string>& columns,
+                                           ThreadPool* threadPool, char delimiter)
+{
+    ghoul_assert(!fileName.empty(), "fileName must not be empty");
+    ghoul_assert(!columns.empty(), "columns must not be empty");
+
+    filesystem::MappedFile file(fileName, filesystem::MappedFile::Advice::Sequential);
+    CSVReader reader(file.view(), delimiter);
+    const std::vector<int> indices = columnIndices(
+        readHeader(reader, fileName),
+        columns,
+        fileName
+    );
+
+    return internalLoadColumns<T>(
+        file.view(),
+        reader.position(),
+        fileName,
+        indices,
+        delimiter,
+        threadPool
+    );
+}
+
+#define INSTANTIATE_LOAD_CSV_COLUMNS(__TYPE__)                                           \
+template std::vector<std::vector<__TYPE__>> loadCSVColumns<__TYPE__>(                    \
+    const std::string&, const std::vector<int>&, bool, ThreadPool*, char);               \
+template std::vector<std::vector<__TYPE__>> loadCSVColumns<__TYPE__>(                    \
+    const std::string&, const std::vector<std::string>&, ThreadPool*, char)
+
+INSTANTIATE_LOAD_CSV_COLUMNS(float);
+INSTANTIATE_LOAD_CSV_COLUMNS(double);
+INSTANTIATE_LOAD_CSV_COLUMNS(int);
+INSTANTIATE_LOAD_CSV_COLUMNS(int64_t);
+
+#undef INSTANTIATE_LOAD_CSV_COLUMNS
+
 } // namespace ghoul
@@ -27,6 +27,8 @@
 
 #include <ghoul/glm.h>
 #include <ghoul/misc/dictionary.h>
+#include <array>
+#include <charconv>
 #include <numeric>
 #include <string>
 
@@ -40,7 +42,15 @@ namespace {
         }
         const int exponent = static_cast<int>(std::log10(std::abs(d)));
         const double base = d / std::pow(10, exponent);
-        return std::to_string(base) + "E" + std::to_string(exponent);
+
+        // The base is written with the six fixed digits that std::to_string produces,
+        // but without the round-trip through the C locale
+        std::array<char, 64> buffer;
+        char* last = buffer.data() + buffer.size();
+        std::to_chars_result res = to_chars(buffer.data(), last, base, 6);
+        *res.ptr = 'E';
+        res = to_chars(res.ptr + 1, last, exponent);
+        return std::string(buffer.data(), res.ptr);
     }
 
 
@@ -87,7 +97,7 @@ namespace {
 
         if (dictionary.hasValue<int>(key)) {
             int value = dictionary.value<int>(key);
-            return std::to_string(value);
+            return ghoul::to_string(value);
         }
 
         if (dictionary.hasValue<std::string>(key)) {
@@ -0,0 +1,90 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2020                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ *****************************************************************************************
+ * The hash function is xxHash64 by Yann Collet, https://github.com/Cyan4973/xxHash      *
+ * Licensed under the BSD 2-Clause license.                                              *
+ ****************************************************************************************/
+
+#include <ghoul/misc/hash.h>
+
+#include <ghoul/misc/assert.h>
+#include <algorithm>
+#include <cstring>
+
+namespace ghoul {
+
+StreamingHash64::StreamingHash64(uint64_t seed)
+    : _lanes{
+        seed + internal::Hash64Prime1 + internal::Hash64Prime2,
+        seed + internal::Hash64Prime2,
+        seed,
+        seed - internal::Hash64Prime1
+    }
+    , _seed(seed)
+{}
+
+void StreamingHash64::update(const char* buffer, size_t size) {
+    ghoul_assert(buffer || size == 0, "buffer must not be nullptr");
+
+    _totalSize += size;
+
+    // Complete the stripe that was started by a previous call
+    if (_bufferSize > 0) {
+        const size_t n = std::min(size, sizeof(_buffer) - _bufferSize);
+        std::memcpy(_buffer + _bufferSize, buffer, n);
+        _bufferSize += n;
+        buffer += n;
+        size -= n;
+        if (_bufferSize < sizeof(_buffer)) {
+            return;
+        }
+        internal::hash64Stripe(_lanes, _buffer);
+        _bufferSize = 0;
+    }
+
+    while (size >= sizeof(_buffer)) {
+        internal::hash64Stripe(_lanes, buffer);
+        buffer += sizeof(_buffer);
+        size -= sizeof(_buffer);
+    }
+
+    if (size > 0) {
+        std::memcpy(_buffer, buffer, size);
+        _bufferSize = size;
+    }
+}
+
+void StreamingHash64::update(std::string_view s) {
+    update(s.data(), s.size());
+}
+
+uint64_t StreamingHash64::value() const {
+    // Data of less than a stripe is hashed without the lanes, same as in hash64
+    const uint64_t h = _totalSize >= sizeof(_buffer) ?
+        internal::hash64MergeLanes(_lanes) :
+        _seed + internal::Hash64Prime5;
+    return internal::hash64Finalize(h + _totalSize, _buffer, _bufferSize);
+}
+
+} // namespace ghoul
@@ -31,30 +31,108 @@
 namespace ghoul {
 
 std::vector<std::string> tokenizeString(const std::string& input, char separator) {
-    size_t separatorPos = input.find(separator);
-    if (separatorPos == std::string::npos) {
-        return { input };
+    std::vector<std::string> result;
+    result.reserve(std::count(input.begin(), input.end(), separator) + 1);
+    for (std::string_view part : splitString(input, separator)) {
+        result.emplace_back(part);
+    }
+    return result;
+}
+
+StringSplitRange::Iterator::Iterator(std::string_view input, char separator)
+    : _rest(input)
+    , _separator(separator)
+    , _hasRest(true)
+    , _isEnd(false)
+{
+    advance();
+}
+
+StringSplitRange::Iterator::reference StringSplitRange::Iterator::operator*() const {
+    return _current;
+}
+
+StringSplitRange::Iterator::pointer StringSplitRange::Iterator::operator->() const {
+    return &_current;
+}
+
+StringSplitRange::Iterator& StringSplitRange::Iterator::operator++() {
+    if (_hasRest) {
+        advance();
     }
     else {
-        std::vector<std::string> result;
-        size_t prevSeparator = 0;
-        while (separatorPos != std::string::npos) {
-            result.push_back(input.substr(prevSeparator, separatorPos - prevSeparator));
-            prevSeparator = separatorPos + 1;
-            separatorPos = input.find(separator, separatorPos + 1);
-        }
-        result.push_back(input.substr(prevSeparator));
-        return result;
+        _isEnd = true;
     }
+    return *this;
 }
 
-std::string join(std::vector<std::string> input, const std::string& separator) {
-    std::string result;
-    for (std::string& s : input) {
-        result += std::move(s) + separator;
+StringSplitRange::Iterator StringSplitRange::Iterator::operator++(int) {
+    Iterator it = *this;
+    ++(*this);
+    return it;
+}
+
+bool StringSplitRange::Iterator::operator==(const Iterator& rhs) const {
+    if (_isEnd || rhs._isEnd) {
+        return _isEnd == rhs._isEnd;
+    }
+    return _current.data() == rhs._current.data() && _hasRest == rhs._hasRest;
+}
+
+bool StringSplitRange::Iterator::operator!=(const Iterator& rhs) const {
+    return !(*this == rhs);
+}
+
+void StringSplitRange::Iterator::advance() {
+    const size_t separatorPos = _rest.find(_separator);
+    if (separatorPos == std::string_view::npos) {
+        // This is the last part
+        _current = _rest;
+        _rest = std::string_view();
+        _hasRest = false;
+    }
+    else {
+        _current = _rest.substr(0, separatorPos);
+        _rest = _rest.substr(separatorPos + 1);
     }
+}
+
+StringSplitRange::StringSplitRange(std::string_view input, char separator)
+    : _input(input)
+    , _separator(separator)
+{}
+
+StringSplitRange::Iterator StringSplitRange::begin() const {
+    return Iterator(_input, _separator);
+}
+
+StringSplitRange::Iterator StringSplitRange::end() const {
+    return Iterator();
+}
 
-    return result.substr(0, result.size() - separator.size());
+StringSplitRange splitString(std::string_view input, char separator) {
+    return StringSplitRange(input, separator);
+}
+
+std::string join(const std::vector<std::string>& input, std::string_view separator) {
+    if (input.empty()) {
+        return std::string();
+    }
+
+    // Allocate the result only once
+    size_t size = separator.size() * (input.size() - 1);
+    for (const std::string& s : input) {
+        size += s.size();
+    }
+    std::string result;
+    result.reserve(size);
+
+    result += input.front();
+    for (auto it = input.begin() + 1; it != input.end(); ++it) {
+        result += separator;
+        result += *it;
+    }
+    return result;
 }
 
 void trimWhitespace(std::string& value) {
@@ -75,4 +153,18 @@ void trimWhitespace(std::string& value) {
     );
 }
 
+void trimWhitespace(std::string_view& value) {
+    auto isSpace = [](char ch) { return std::isspace(static_cast<unsigned char>(ch)); };
+
+    size_t begin = 0;
+    while (begin < value.size() && isSpace(value[begin])) {
+        ++begin;
+    }
+    size_t end = value.size();
+    while (end > begin && isSpace(value[end - 1])) {
+        --end;
+    }
+    value = value.substr(begin, end - begin);
+}
+
 } // namespace ghoul
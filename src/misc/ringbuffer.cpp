@@ -0,0 +1,173 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2020                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <ghoul/misc/ringbuffer.h>
+
+#include <ghoul/misc/assert.h>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    size_t nextPowerOfTwo(size_t value) {
+        size_t res = 1;
+        while (res < value) {
+            res <<= 1;
+        }
+        return res;
+    }
+} // namespace
+
+namespace ghoul {
+
+RingBuffer::RingBuffer(size_t capacity)
+    : _capacity(nextPowerOfTwo(capacity))
+    , _mask(_capacity - 1)
+    // The storage is not initialized, as only bytes that have been written are read
+    , _data(new char[_capacity])
+{
+    ghoul_assert(capacity > 0, "Capacity must be bigger than 0");
+}
+
+size_t RingBuffer::capacity() const {
+    return _capacity;
+}
+
+size_t RingBuffer::size() const {
+    const size_t readIndex = _readIndex.load(std::memory_order_acquire);
+    return _writeIndex.load(std::memory_order_acquire) - readIndex;
+}
+
+bool RingBuffer::empty() const {
+    return size() == 0;
+}
+
+size_t RingBuffer::freeSpace() const {
+    return _capacity - size();
+}
+
+size_t RingBuffer::write(const char* data, size_t nBytes) {
+    size_t nWritten = 0;
+    while (nWritten < nBytes) {
+        const std::pair<char*, size_t> region = writeRegion();
+        if (region.second == 0) {
+            break;
+        }
+        const size_t n = std::min(region.second, nBytes - nWritten);
+        std::memcpy(region.first, data + nWritten, n);
+        commit(n);
+        nWritten += n;
+    }
+    return nWritten;
+}
+
+std::pair<char*, size_t> RingBuffer::writeRegion() {
+    // Only the producer changes the write index, so it does not have to be synchronized
+    const size_t writeIndex = _writeIndex.load(std::memory_order_relaxed);
+    const size_t readIndex = _readIndex.load(std::memory_order_acquire);
+    const size_t free = _capacity - (writeIndex - readIndex);
+    const size_t begin = writeIndex & _mask;
+    return { _data.get() + begin, std::min(free, _capacity - begin) };
+}
+
+void RingBuffer::commit(size_t nBytes) {
+    const size_t writeIndex = _writeIndex.load(std::memory_order_relaxed);
+    ghoul_assert(
+        nBytes <= _capacity - (writeIndex - _readIndex.load(std::memory_order_acquire)),
+        "Cannot commit more bytes than there is space"
+    );
+    _writeIndex.store(writeIndex + nBytes, std::memory_order_release);
+}
+
+std::pair<const char*, size_t> RingBuffer::readRegion() const {
+    // Only the consumer changes the read index, so it does not have to be synchronized
+    const size_t readIndex = _readIndex.load(std::memory_order_relaxed);
+    const size_t available = _writeIndex.load(std::memory_order_acquire) - readIndex;
+    const size_t begin = readIndex & _mask;
+    return { _data.get() + begin, std::min(available, _capacity - begin) };
+}
+
+const char* RingBuffer::contiguousData(size_t nBytes) const {
+    ghoul_assert(nBytes <= size(), "Cannot access more bytes than are available");
+
+    const size_t begin = _readIndex.load(std::memory_order_relaxed) & _mask;
+    return (begin + nBytes <= _capacity) ? _data.get() + begin : nullptr;
+}
+
+size_t RingBuffer::peek(char* buffer, size_t nBytes) const {
+    const size_t readIndex = _readIndex.load(std::memory_order_relaxed);
+    const size_t available = _writeIndex.load(std::memory_order_acquire) - readIndex;
+    const size_t n = std::min(nBytes, available);
+
+    // The bytes might wrap around the end of the storage, so we copy in two parts
+    const size_t begin = readIndex & _mask;
+    const size_t first = std::min(n, _capacity - begin);
+    std::memcpy(buffer, _data.get() + begin, first);
+    std::memcpy(buffer + first, _data.get(), n - first);
+    return n;
+}
+
+size_t RingBuffer::read(char* buffer, size_t nBytes) {
+    const size_t n = peek(buffer, nBytes);
+    consume(n);
+    return n;
+}
+
+void RingBuffer::consume(size_t nBytes) {
+    ghoul_assert(nBytes <= size(), "Cannot consume more bytes than are available");
+
+    const size_t readIndex = _readIndex.load(std::memory_order_relaxed);
+    _readIndex.store(readIndex + nBytes, std::memory_order_release);
+}
+
+size_t RingBuffer::find(char value, size_t offset) const {
+    return find(value, offset, npos);
+}
+
+size_t RingBuffer::find(char value, size_t offset, size_t limit) const {
+    const size_t readIndex = _readIndex.load(std::memory_order_relaxed);
+    const size_t available = std::min(
+        _writeIndex.load(std::memory_order_acquire) - readIndex,
+        limit
+    );
+    if (offset >= available) {
+        return npos;
+    }
+
+    // Search the part up to the end of the storage first and then the wrapped part
+    const size_t begin = (readIndex + offset) & _mask;
+    const size_t n = available - offset;
+    const size_t first = std::min(n, _capacity - begin);
+    const void* p = std::memchr(_data.get() + begin, value, first);
+    if (p) {
+        return offset + (static_cast<const char*>(p) - (_data.get() + begin));
+    }
+    p = std::memchr(_data.get(), value, n - first);
+    if (p) {
+        return offset + first + (static_cast<const char*>(p) - _data.get());
+    }
+    return npos;
+}
+
+} // namespace ghoul
@@ -25,7 +25,7 @@
 
 #include <ghoul/misc/sharedmemory.h>
 
-#include <ghoul/misc/crc32.h>
+#include <ghoul/misc/hash.h>
 #include <atomic>
 
 #ifndef WIN32
@@ -59,7 +59,9 @@ namespace {
     }
 
     unsigned int hash(const std::string& name) {
-        return hashCRC32(name);
+        // The System V keys only have 32 bits, so both halves of the hash are combined
+        const uint64_t h = hash64(name);
+        return static_cast<unsigned int>(h ^ (h >> 32));
     }
 
 #ifdef WIN32
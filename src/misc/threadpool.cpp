@@ -212,11 +212,14 @@ void ThreadPool::activateWorker(Worker& worker) {
     std::function<void()> workerDeinitialization = _workerDeinitialization;
 
 
-    volatile bool finishedInitializing = false;
+    // The worker keeps setting this flag after this function has returned, so it cannot
+    // live on the stack of this function
+    std::shared_ptr<std::atomic_bool> finishedInitializing =
+        std::make_shared<std::atomic_bool>(false);
 
     // capturing the shared_ptrs by value to maintain a copy
     auto workerLoop = [
-        shouldTerminate, threadPoolIsRunning, &finishedInitializing, nWaiting, taskQueue,
+        shouldTerminate, threadPoolIsRunning, finishedInitializing, nWaiting, taskQueue,
         mutex, cv, workerInitialization, workerDeinitialization
     ]() {
         // Invoke the user-defined initialization function
@@ -233,7 +236,7 @@ void ThreadPool::activateWorker(Worker& worker) {
         while (true) {  // loop #1
             // If there is something in the queue
             while (hasTask) { // loop #2
-                finishedInitializing = true;
+                *finishedInitializing = true;
 
                 // Do the task
                 task();
@@ -254,7 +257,7 @@ void ThreadPool::activateWorker(Worker& worker) {
             // If the ThreadPool has stopped running and there are no more tasks, we don't
             // need to sleep first, but can return immediately
             if (!*threadPoolIsRunning) {
-                finishedInitializing = true;
+                *finishedInitializing = true;
                 return;
             }
 
@@ -262,7 +265,7 @@ void ThreadPool::activateWorker(Worker& worker) {
             // still running, so we can sleep until there is more work
             (*nWaiting)++;
             while (true) { // loop #3
-                finishedInitializing = true;
+                *finishedInitializing = true;
 
                 // We are doing this in an infinite loop, as we want to check regularly
                 // if there is more work. This shouldn't be necessary in normal cases, but
@@ -312,7 +315,7 @@ void ThreadPool::activateWorker(Worker& worker) {
         std::move(shouldTerminate)
     };
 
-    while (!finishedInitializing) {}
+    while (!*finishedInitializing) {}
 }
 
 std::tuple<ThreadPool::Task, bool> ThreadPool::TaskQueue::pop() {
@@ -26,7 +26,7 @@
 #include <ghoul/opengl/shadermanager.h>
 
 #include <ghoul/misc/assert.h>
-#include <ghoul/misc/crc32.h>
+#include <ghoul/misc/hash.h>
 #include <ghoul/opengl/shaderobject.h>
 
 namespace ghoul::opengl {
@@ -40,7 +40,7 @@ ShaderManager& ShaderManager::ref() {
     return manager;
 }
 
-ShaderObject* ShaderManager::shaderObject(unsigned int hashedName) {
+ShaderObject* ShaderManager::shaderObject(uint64_t hashedName) {
     const auto it = _objects.find(hashedName);
     if (it == _objects.cend()) {
         throw ShaderManagerError(
@@ -53,7 +53,7 @@ ShaderObject* ShaderManager::shaderObject(unsigned int hashedName) {
 }
 
 ShaderObject* ShaderManager::shaderObject(const std::string& name) {
-    const unsigned int hash = hashCRC32(name);
+    const uint64_t hash = hash64(name);
     try {
         return shaderObject(hash);
     }
@@ -63,10 +63,10 @@ ShaderObject* ShaderManager::shaderObject(const std::string& name) {
     }
 }
 
-unsigned int ShaderManager::registerShaderObject(const std::string& name,
-                                                 std::unique_ptr<ShaderObject> shader)
+uint64_t ShaderManager::registerShaderObject(const std::string& name,
+                                             std::unique_ptr<ShaderObject> shader)
 {
-    const unsigned int hashedName = hashCRC32(name);
+    const uint64_t hashedName = hash64(name);
     const auto it = _objects.find(hashedName);
     if (it == _objects.cend()) {
         _objects[hashedName] = std::move(shader);
@@ -80,12 +80,12 @@ unsigned int ShaderManager::registerShaderObject(const std::string& name,
 std::unique_ptr<ShaderObject> ShaderManager::unregisterShaderObject(
                                                                   const std::string& name)
 {
-    const unsigned int hashedName = hashCRC32(name);
+    const uint64_t hashedName = hash64(name);
     return unregisterShaderObject(hashedName);
 }
 
 std::unique_ptr<ShaderObject> ShaderManager::unregisterShaderObject(
-                                                                  unsigned int hashedName)
+                                                                      uint64_t hashedName)
 {
     const auto it = _objects.find(hashedName);
     if (it == _objects.cend()) {
@@ -97,8 +97,8 @@ std::unique_ptr<ShaderObject> ShaderManager::unregisterShaderObject(
     return tmp;
 }
 
-unsigned int ShaderManager::hashedNameForName(const std::string& name) const {
-    return hashCRC32(name);
+uint64_t ShaderManager::hashedNameForName(const std::string& name) const {
+    return hash64(name);
 }
 
 } // namespace ghoul::opengl
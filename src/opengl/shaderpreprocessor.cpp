@@ -30,9 +30,9 @@
 #include <ghoul/misc/dictionary.h>
 #include <ghoul/opengl/ghoul_gl.h>
 #include <ghoul/systemcapabilities/openglcapabilitiescomponent.h>
-#include <fstream>
 #include <string>
 #include <sstream>
+#include <string_view>
 
 namespace {
     bool isString(std::string str) {
@@ -116,9 +116,9 @@ ShaderPreprocessor::IncludeError::IncludeError(std::string f)
     , file(std::move(f))
 {}
 
-ShaderPreprocessor::Input::Input(std::ifstream& str, ghoul::filesystem::File& f,
+ShaderPreprocessor::Input::Input(filesystem::FileContents c, ghoul::filesystem::File& f,
                                  std::string indent)
-    : stream(str)
+    : contents(std::move(c))
     , file(f)
     , indentation(std::move(indent))
 {}
@@ -218,33 +218,34 @@ void ShaderPreprocessor::includeFile(const std::string& path, TrackChanges track
     ghoul_assert(!FileSys.containsToken(path), "Path must not contain path tokens");
 
     if (_includedFiles.find(path) == _includedFiles.end()) {
+        // Files that are provided by a mounted FileSource do not exist on disk
+        const bool isTracked = trackChanges && !FileSys.isMountedFile(path);
         const auto it = _includedFiles.emplace(
             path,
             FileStruct {
                 filesystem::File(path),
                 _includedFiles.size(),
-                trackChanges
+                isTracked
             }
         ).first;
-        if (trackChanges) {
+        if (isTracked) {
             it->second.file.setCallback([this](const filesystem::File&) {
                 _onChangeCallback();
             });
         }
     }
 
-    std::ifstream stream(path);
-    if (!stream.good()) {
-        perror(path.c_str());
-    }
-    ghoul_assert(stream.good() , "Input stream '" + path + "' is not good");
-
     ghoul::filesystem::File file(path);
 
     std::string prevIndent =
         !environment.inputs.empty() ? environment.inputs.back().indentation : "";
 
-    environment.inputs.emplace_back(stream, file, prevIndent + environment.indentation);
+    // Reading through the FileSystem makes it possible to include files from mounts
+    environment.inputs.emplace_back(
+        FileSys.readFile(path),
+        file,
+        prevIndent + environment.indentation
+    );
     if (environment.inputs.size() > 1) {
         addLineNumber(environment);
     }
@@ -311,9 +312,16 @@ bool ShaderPreprocessor::isInsideEmptyForStatement(ShaderPreprocessor::Env& env)
 
 bool ShaderPreprocessor::parseLine(ShaderPreprocessor::Env& env) {
     Input& input = env.inputs.back();
-    if (!std::getline(input.stream, env.line)) {
+    const std::string_view contents = input.contents.view();
+    if (input.position >= contents.size()) {
         return false;
     }
+    size_t end = contents.find('\n', input.position);
+    if (end == std::string_view::npos) {
+        end = contents.size();
+    }
+    env.line = contents.substr(input.position, end - input.position);
+    input.position = end + 1;
     input.lineNumber++;
 
     // Trim away any whitespaces in the start and end of the line.
@@ -774,7 +782,7 @@ bool ShaderPreprocessor::parseFor(ShaderPreprocessor::Env& env) {
     env.forStatements.push_back({
         static_cast<unsigned int>(env.inputs.size() - 1),
         input.lineNumber,
-        static_cast<unsigned int>(input.stream.tellg()),
+        static_cast<unsigned int>(input.position),
         keyName,
         valueName,
         dictionaryRef,
@@ -832,7 +840,7 @@ bool ShaderPreprocessor::parseEndFor(ShaderPreprocessor::Env& env) {
             addLineNumber(env);
             // Restore input to its state from when #for was found
             Input& input = env.inputs.back();
-            input.stream.seekg(forStatement.streamPos);
+            input.position = forStatement.position;
             input.lineNumber = forStatement.lineNumber;
         }
         else {
@@ -0,0 +1,82 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2020                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+#include "catch2/catch.hpp"
+
+#include <ghoul/fmt.h>
+#include <ghoul/misc/crc32.h>
+#include <chrono>
+#include <random>
+#include <vector>
+
+// The benchmarks are hidden and have to be run explicitly with the [benchmark] tag
+
+TEST_CASE("CRC32: Benchmark", "[.][benchmark][crc32]") {
+    constexpr const size_t Size = 64 * 1024 * 1024;
+    constexpr const int NRepetitions = 4;
+
+    std::vector<char> data(Size);
+    std::default_random_engine e(1337);
+    std::uniform_int_distribution<int> dist(0, 255);
+    for (char& c : data) {
+        c = static_cast<char>(dist(e));
+    }
+
+    using Clock = std::chrono::steady_clock;
+    // Hashes the first nBytes of the data until 64 MiB have been hashed in total, returns
+    // the throughput in bytes per second. The hashes are written into a volatile variable
+    // so that the compiler cannot drop the calls
+    volatile unsigned int result = 0;
+    auto throughput = [&](size_t nBytes, auto hash) {
+        const Clock::time_point begin = Clock::now();
+        for (int i = 0; i < NRepetitions; ++i) {
+            for (size_t j = 0; j < Size / nBytes; ++j) {
+                result = hash(nBytes);
+            }
+        }
+        const double s = std::chrono::duration<double>(Clock::now() - begin).count();
+        return static_cast<double>(NRepetitions * (Size / nBytes) * nBytes) / s;
+    };
+
+    for (size_t nBytes : { Size, size_t(4096), size_t(64) }) {
+        const double table = throughput(nBytes, [&](size_t n) {
+            return ghoul::hashCRC32(data.data(), static_cast<unsigned int>(n));
+        });
+        WARN(fmt::format("Table {} B: {:.4g} bytes/s", nBytes, table));
+
+        using Impl = ghoul::CRC32Implementation;
+        for (Impl impl : { Impl::SlicingBy8, Impl::Pclmul, Impl::ArmV8 }) {
+            if (!ghoul::hasCRC32Implementation(impl)) {
+                continue;
+            }
+            const double update = throughput(nBytes, [&](size_t n) {
+                return ghoul::updateCRC32(0, data.data(), n, impl);
+            });
+            WARN(fmt::format(
+                "Implementation {} {} B: {:.4g} bytes/s",
+                static_cast<int>(impl), nBytes, update
+            ));
+        }
+    }
+}
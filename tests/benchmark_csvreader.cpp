@@ -0,0 +1,72 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2020                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <ghoul/filesystem/file.h>
+#include <ghoul/filesystem/filesystem.h>
+#include <ghoul/misc/csvreader.h>
+#include <ghoul/misc/threadpool.h>
+#include <algorithm>
+#include <fstream>
+#include <thread>
+
+// The benchmarks are hidden and have to be run explicitly with the [benchmark] tag
+
+TEST_CASE("CSVReader: Benchmark", "[.][benchmark][csvreader]") {
+    using Indices = std::vector<int>;
+    constexpr const int NRows = 10000000;
+
+    // A catalog with 10M stars and five columns (~400 MB)
+    const std::string path = absPath("${TEMPORARY}/ghoul_csvreader_benchmark.csv");
+    {
+        std::ofstream f(path);
+        f << "x,y,z,magnitude,name\n";
+        for (int i = 0; i < NRows; ++i) {
+            const int v = i % 100000;
+            f << v << ".125," << -v << ".5,1.0e" << (i % 20) - 10 << ',' << (i % 30)
+              << ".25,star" << i << '\n';
+        }
+    }
+
+    // The calling thread participates in the parsing as well
+    const int nCores = static_cast<int>(std::thread::hardware_concurrency());
+    ghoul::ThreadPool pool(std::max(nCores - 1, 1));
+    const Indices columns = { 0, 1, 2, 3 };
+
+    BENCHMARK("Strings") {
+        return ghoul::loadCSVFile(path, columns).size();
+    };
+
+    BENCHMARK("Columns") {
+        return ghoul::loadCSVColumns<double>(path, columns)[0].size();
+    };
+
+    BENCHMARK("Columns Parallel") {
+        return ghoul::loadCSVColumns<double>(path, columns, false, &pool)[0].size();
+    };
+
+    FileSys.deleteFile(ghoul::filesystem::File(path));
+}
@@ -0,0 +1,71 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2020                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <ghoul/filesystem/file.h>
+#include <ghoul/filesystem/filesystem.h>
+#include <ghoul/lua/lua_helper.h>
+#include <ghoul/misc/dictionary.h>
+#include <fstream>
+#include <sstream>
+
+// The benchmarks are hidden and have to be run explicitly with the [benchmark] tag
+
+TEST_CASE("LuaToDictionary: Benchmark", "[.][benchmark][luatodictionary]") {
+    constexpr const int NAssets = 2000;
+    constexpr const int NSamples = 200;
+
+    // A scene description with 2000 assets, each of which has a few scalar values, a
+    // small and a large numeric array, and a deeply nested renderable (~4 MB)
+    std::stringstream s;
+    s << "return { Assets = {\n";
+    for (int i = 0; i < NAssets; ++i) {
+        s << "  { Identifier = 'asset" << i << "', Enabled = "
+          << (i % 2 ? "true" : "false") << ", Position = { " << i << ".5, " << -i
+          << ".25, 1.0 },\n    Samples = { ";
+        for (int j = 0; j < NSamples; ++j) {
+            s << (i + j) % 1000 << ".125, ";
+        }
+        s << "},\n    Renderable = { Type = 'Sphere', Layers = { ColorLayers = {"
+          << " { Identifier = 'Texture', Settings = { Gamma = 1.0, Multiplier = 2.0 }"
+          << " } } } }\n  },\n";
+    }
+    s << "} }\n";
+    const std::string script = s.str();
+
+    const std::string path = absPath("${TEMPORARY}/ghoul_luatodictionary_benchmark.lua");
+    std::ofstream(path) << script;
+
+    BENCHMARK("String") {
+        return ghoul::lua::loadDictionaryFromString(script).size();
+    };
+
+    BENCHMARK("File") {
+        return ghoul::lua::loadDictionaryFromFile(path).size();
+    };
+
+    FileSys.deleteFile(ghoul::filesystem::File(path));
+}
@@ -0,0 +1,96 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2020                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <ghoul/fmt.h>
+#include <ghoul/io/socket/tcpsocket.h>
+#include <ghoul/io/socket/tcpsocketserver.h>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// The benchmarks are hidden and have to be run explicitly with the [benchmark] tag
+
+TEST_CASE("TcpSocket: Benchmark", "[.][benchmark][tcpsocket]") {
+    constexpr const size_t NBytes = size_t(1) << 30;
+    constexpr const size_t ChunkSize = 64 * 1024;
+    constexpr const int NMessages = 1000000;
+
+    ghoul::io::TcpSocketServer server;
+    server.listen(0);
+    ghoul::io::TcpSocket client("127.0.0.1", server.port());
+    client.connect();
+    std::unique_ptr<ghoul::io::TcpSocket> socket = server.awaitPendingTcpSocket();
+    REQUIRE(socket);
+    socket->startStreams();
+
+    using Clock = std::chrono::steady_clock;
+    auto seconds = [](Clock::time_point begin) {
+        return std::chrono::duration<double>(Clock::now() - begin).count();
+    };
+
+    {
+        // 1 GB of binary data in 64 KB chunks
+        const std::vector<char> data(ChunkSize, 'a');
+        const Clock::time_point begin = Clock::now();
+        std::thread writer([&]() {
+            for (size_t i = 0; i < NBytes / ChunkSize; ++i) {
+                client.put(data.data(), data.size());
+            }
+        });
+        std::vector<char> buffer(ChunkSize);
+        for (size_t i = 0; i < NBytes / ChunkSize; ++i) {
+            REQUIRE(socket->get(buffer.data(), buffer.size()));
+        }
+        writer.join();
+        const double s = seconds(begin);
+        WARN(fmt::format("Bytes: {:.1f} MB/s", NBytes / s / (1024.0 * 1024.0)));
+    }
+
+    {
+        // One million short messages, like the commands of a remote scripting console
+        const std::string message = "setPropertyValue('Scene.Earth.Enabled', true)";
+        const Clock::time_point begin = Clock::now();
+        std::thread writer([&]() {
+            for (int i = 0; i < NMessages; ++i) {
+                client.putMessage(message);
+            }
+        });
+        size_t nBytes = 0;
+        for (int i = 0; i < NMessages; ++i) {
+            std::string_view view;
+            REQUIRE(socket->getMessage(view));
+            nBytes += view.size();
+        }
+        writer.join();
+        REQUIRE(nBytes == message.size() * NMessages);
+        const double s = seconds(begin);
+        WARN(fmt::format("Messages: {:.0f} messages/s", NMessages / s));
+    }
+}
@@ -0,0 +1,186 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2020                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <ghoul/io/asyncfile.h>
+#include <ghoul/filesystem/file.h>
+#include <ghoul/filesystem/filesystem.h>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace {
+    // Writes a file whose bytes follow a pattern that makes misplaced reads detectable
+    std::string writeTestFile(const std::string& name, size_t size) {
+        const std::string path = absPath("${TEMPORARY}/" + name);
+        std::ofstream file(path, std::ofstream::binary);
+        for (size_t i = 0; i < size; ++i) {
+            file.put(static_cast<char>(i % 251));
+        }
+        return path;
+    }
+
+    bool hasPattern(const std::vector<char>& data, size_t offset) {
+        for (size_t i = 0; i < data.size(); ++i) {
+            if (data[i] != static_cast<char>((offset + i) % 251)) {
+                return false;
+            }
+        }
+        return true;
+    }
+} // namespace
+
+TEST_CASE("AsyncFile: Read", "[asyncfile]") {
+    using ghoul::io::AsyncFile;
+
+    constexpr const size_t Size = 3 * 1024 * 1024 + 17;
+    AsyncFile file(writeTestFile("ghoul_asyncfile_read", Size));
+    REQUIRE(file.size() == Size);
+
+    const std::vector<char> all = file.readAll().get();
+    REQUIRE(all.size() == Size);
+    REQUIRE(hasPattern(all, 0));
+
+    const std::vector<char> part = file.read(1000, 500).get();
+    REQUIRE(part.size() == 500);
+    REQUIRE(hasPattern(part, 1000));
+
+    // Reads past the end of the file only return the existing bytes
+    const std::vector<char> end = file.read(Size - 10, 100).get();
+    REQUIRE(end.size() == 10);
+    REQUIRE(hasPattern(end, Size - 10));
+    REQUIRE(file.read(Size + 10, 100).get().empty());
+}
+
+TEST_CASE("AsyncFile: Vectored Read", "[asyncfile]") {
+    using ghoul::io::AsyncFile;
+
+    AsyncFile file(writeTestFile("ghoul_asyncfile_vectored", 100000));
+    const std::vector<AsyncFile::Range> ranges = {
+        { 99000, 2000 }, { 0, 10 }, { 5000, 0 }, { 12345, 54321 }
+    };
+    const std::vector<std::vector<char>> result = file.read(ranges).get();
+    REQUIRE(result.size() == 4);
+    REQUIRE(result[0].size() == 1000);
+    REQUIRE(hasPattern(result[0], 99000));
+    REQUIRE(result[1].size() == 10);
+    REQUIRE(hasPattern(result[1], 0));
+    REQUIRE(result[2].empty());
+    REQUIRE(result[3].size() == 54321);
+    REQUIRE(hasPattern(result[3], 12345));
+}
+
+TEST_CASE("AsyncFile: Callback", "[asyncfile]") {
+    using ghoul::io::AsyncFile;
+
+    std::promise<std::vector<char>> promise;
+    {
+        // The pending read keeps the file open after the AsyncFile is destroyed
+        AsyncFile file(writeTestFile("ghoul_asyncfile_callback", 4096));
+        file.read(
+            100,
+            200,
+            [&promise](std::vector<char> data, std::exception_ptr error) {
+                REQUIRE_FALSE(error);
+                promise.set_value(std::move(data));
+            }
+        );
+    }
+    const std::vector<char> data = promise.get_future().get();
+    REQUIRE(data.size() == 200);
+    REQUIRE(hasPattern(data, 100));
+}
+
+TEST_CASE("AsyncFile: Chained Reads", "[asyncfile]") {
+    using ghoul::io::AsyncFile;
+
+    // More reads than fit into the completion queue at once, each of which issues the
+    // next read of its chain from the callback
+    constexpr const int NChains = 2000;
+    constexpr const int ChainLength = 4;
+    AsyncFile file(writeTestFile("ghoul_asyncfile_chained", 65536));
+    std::atomic_int nFinished = 0;
+    std::atomic_int nErrors = 0;
+    std::promise<void> promise;
+
+    std::function<void (int, int)> readNext = [&](int chain, int step) {
+        const uint64_t offset = static_cast<uint64_t>((chain * 31 + step * 7) % 60000);
+        file.read(
+            offset,
+            100,
+            [&, chain, step, offset](std::vector<char> data, std::exception_ptr error) {
+                if (error || data.size() != 100 || !hasPattern(data, offset)) {
+                    ++nErrors;
+                }
+                if (step + 1 < ChainLength) {
+                    readNext(chain, step + 1);
+                }
+                else if (++nFinished == NChains) {
+                    promise.set_value();
+                }
+            }
+        );
+    };
+    for (int i = 0; i < NChains; ++i) {
+        readNext(i, 0);
+    }
+
+    std::future<void> future = promise.get_future();
+    REQUIRE(future.wait_for(std::chrono::seconds(30)) == std::future_status::ready);
+    REQUIRE(nErrors == 0);
+}
+
+TEST_CASE("AsyncFile: Read Files", "[asyncfile]") {
+    using ghoul::io::AsyncFile;
+
+    REQUIRE_THROWS_AS(
+        AsyncFile(absPath("${TEMPORARY}/ghoul_asyncfile_missing")),
+        AsyncFile::AsyncFileException
+    );
+
+    std::vector<std::string> paths;
+    for (size_t i = 0; i < 64; ++i) {
+        const std::string name = "ghoul_asyncfile_batch_" + std::to_string(i);
+        paths.push_back(writeTestFile(name, i * 97));
+    }
+    paths.push_back(absPath("${TEMPORARY}/ghoul_asyncfile_missing"));
+
+    std::vector<std::future<std::vector<char>>> futures = AsyncFile::readFiles(paths);
+    REQUIRE(futures.size() == paths.size());
+    for (size_t i = 0; i < 64; ++i) {
+        const std::vector<char> data = futures[i].get();
+        REQUIRE(data.size() == i * 97);
+        REQUIRE(hasPattern(data, 0));
+    }
+    REQUIRE_THROWS_AS(futures.back().get(), AsyncFile::AsyncFileException);
+
+    for (size_t i = 0; i < 64; ++i) {
+        FileSys.deleteFile(ghoul::filesystem::File(paths[i]));
+    }
+}
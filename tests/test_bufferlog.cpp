@@ -0,0 +1,161 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2020                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <ghoul/logging/bufferlog.h>
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("BufferLog: Entries", "[bufferlog]") {
+    std::vector<char> memory(1024);
+    ghoul::logging::BufferLog log(memory.data(), memory.size());
+
+    log.log(1, "first");
+    log.log(2, "second message");
+    log.log(3, "x");
+
+    std::vector<ghoul::logging::BufferLog::Entry> entries =
+        ghoul::logging::BufferLog::entries(memory.data(), log.usedSize());
+    REQUIRE(entries.size() == 3);
+    CHECK(entries[0].timestamp == 1);
+    CHECK(entries[0].message == "first");
+    CHECK(entries[1].timestamp == 2);
+    CHECK(entries[1].message == "second message");
+    CHECK(entries[2].timestamp == 3);
+    CHECK(entries[2].message == "x");
+
+    // Records of the previous generation must no longer be visible after a reset
+    log.resetBuffer();
+    log.log(4, "after reset");
+    entries = ghoul::logging::BufferLog::entries(memory.data(), memory.size());
+    REQUIRE(entries.size() == 1);
+    CHECK(entries[0].timestamp == 4);
+    CHECK(entries[0].message == "after reset");
+
+    // Version 1 layout: version, lock, attributes, firstEmptyByte, followed by the
+    // timestamp and the \0 terminated message of every entry
+    std::vector<char> v1(64, 0);
+    v1[0] = 1;
+    const uint32_t used = 2 * sizeof(unsigned long long) + 3 + 4;
+    std::memcpy(v1.data() + 4, &used, sizeof(uint32_t));
+    const unsigned long long t1 = 10;
+    const unsigned long long t2 = 20;
+    std::memcpy(v1.data() + 8, &t1, sizeof(unsigned long long));
+    std::memcpy(v1.data() + 16, "ab", 3);
+    std::memcpy(v1.data() + 19, &t2, sizeof(unsigned long long));
+    std::memcpy(v1.data() + 27, "cde", 4);
+    entries = ghoul::logging::BufferLog::entries(v1.data(), v1.size());
+    REQUIRE(entries.size() == 2);
+    CHECK(entries[0].timestamp == 10);
+    CHECK(entries[0].message == "ab");
+    CHECK(entries[1].timestamp == 20);
+    CHECK(entries[1].message == "cde");
+
+    std::vector<char> unknown(64, 0);
+    unknown[0] = 100;
+    CHECK_THROWS_AS(
+        ghoul::logging::BufferLog::entries(unknown.data(), unknown.size()),
+        ghoul::RuntimeError
+    );
+}
+
+TEST_CASE("BufferLog: Concurrent Log", "[bufferlog]") {
+    constexpr const int NThreads = 8;
+    constexpr const int NMessages = 5000;
+
+    // The buffer is too small to hold all messages, so the callback has to write out
+    // and reset the buffer concurrently to the other producers
+    std::vector<char> memory(16 * 1024);
+    std::vector<ghoul::logging::BufferLog::Entry> entries;
+    ghoul::logging::BufferLog log(
+        memory.data(),
+        memory.size(),
+        [&entries](ghoul::logging::BufferLog& l, unsigned long long&) {
+            std::vector<ghoul::logging::BufferLog::Entry> e =
+                ghoul::logging::BufferLog::entries(l.buffer(), l.usedSize());
+            entries.insert(entries.end(), e.begin(), e.end());
+            l.resetBuffer();
+        }
+    );
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < NThreads; ++i) {
+        threads.emplace_back([&log, i]() {
+            for (int j = 0; j < NMessages; ++j) {
+                log.log(i, std::to_string(i) + ':' + std::to_string(j));
+            }
+        });
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+
+    std::vector<ghoul::logging::BufferLog::Entry> e =
+        ghoul::logging::BufferLog::entries(log.buffer(), log.usedSize());
+    entries.insert(entries.end(), e.begin(), e.end());
+    REQUIRE(entries.size() == NThreads * NMessages);
+
+    // Every message has to appear exactly once and in order for each producer
+    std::vector<int> next(NThreads, 0);
+    for (const ghoul::logging::BufferLog::Entry& entry : entries) {
+        const int thread = static_cast<int>(entry.timestamp);
+        REQUIRE(thread < NThreads);
+        CHECK(entry.message == std::to_string(thread) + ':' +
+                               std::to_string(next[thread]));
+        next[thread]++;
+    }
+    CHECK(std::all_of(next.begin(), next.end(), [](int n) { return n == NMessages; }));
+}
+
+TEST_CASE("BufferLog: Failing Callback", "[bufferlog]") {
+    std::vector<char> memory(128);
+    int nCalls = 0;
+    ghoul::logging::BufferLog log(
+        memory.data(),
+        memory.size(),
+        [&nCalls](ghoul::logging::BufferLog&, unsigned long long&) { ++nCalls; }
+    );
+
+    const std::string message(20, 'a');
+    log.log(0, message);
+    log.log(1, message);
+    CHECK_THROWS_AS(
+        log.log(2, message),
+        ghoul::logging::BufferLog::MemoryExhaustionException
+    );
+    CHECK(nCalls == 1);
+
+    // The exclusive access has to be released, so resetting and logging still works
+    log.resetBuffer();
+    log.log(3, message);
+    const std::vector<ghoul::logging::BufferLog::Entry> entries =
+        ghoul::logging::BufferLog::entries(memory.data(), log.usedSize());
+    REQUIRE(entries.size() == 1);
+    CHECK(entries[0].timestamp == 3);
+}
@@ -0,0 +1,341 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2020                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <ghoul/filesystem/cachemanager.h>
+#include <ghoul/filesystem/file.h>
+#include <ghoul/filesystem/filesystem.h>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#endif // WIN32
+
+namespace {
+    std::string cacheDirectory() {
+        std::string dir = absPath("${TEMPORARY}/ghoul_cachemanager_test");
+        if (FileSys.directoryExists(dir)) {
+            FileSys.deleteDirectory(dir, ghoul::filesystem::FileSystem::Recursive::Yes);
+        }
+        FileSys.createDirectory(dir);
+        return dir;
+    }
+
+    std::string writeFile(const std::string& directory, const std::string& content) {
+        if (!FileSys.directoryExists(directory)) {
+            FileSys.createDirectory(directory);
+        }
+        std::string path = directory + "/file.txt";
+        std::ofstream(path) << content;
+        return path;
+    }
+} // namespace
+
+TEST_CASE("CacheManager: Content Addressed", "[cachemanager]") {
+    using namespace ghoul::filesystem;
+
+    const std::string dir = cacheDirectory();
+    CacheManager cache(dir);
+
+    const std::string tmp = absPath("${TEMPORARY}");
+    File a(writeFile(tmp + "/ghoul_cachemanager_a", "content"));
+    File b(writeFile(tmp + "/ghoul_cachemanager_b", "content"));
+
+    // Identical files in different locations share the same cache entry
+    const std::string cachedA = cache.cachedFilename(a);
+    REQUIRE(cachedA == cache.cachedFilename(b));
+    REQUIRE(cache.hasCachedFile(b));
+
+    // The entries are sharded as <shard>/<shard>/<hash>/<file>
+    const std::string relative = cachedA.substr(Directory(dir).path().size() + 1);
+    REQUIRE(std::count(relative.begin(), relative.end(), FileSystem::PathSeparator) == 3);
+    REQUIRE(relative.substr(relative.size() - 8) == "file.txt");
+
+    // Changing the content produces a different entry
+    writeFile(tmp + "/ghoul_cachemanager_b", "other content");
+    REQUIRE_FALSE(cache.hasCachedFile(b));
+    REQUIRE(cache.cachedFilename(b) != cachedA);
+
+    cache.removeCacheFile(a);
+    REQUIRE_FALSE(cache.hasCachedFile(a));
+
+    // Files that are larger than a chunk are hashed in parallel. A change that keeps the
+    // size of the file is detected through the modification time
+    const std::string largeDir = tmp + "/ghoul_cachemanager_large";
+    const std::string content(9 * 1024 * 1024, 'a');
+    File large(writeFile(largeDir, content));
+    const std::string cachedLarge = cache.cachedFilename(large);
+    REQUIRE(cache.cachedFilename(large) == cachedLarge);
+    const auto time = std::filesystem::last_write_time(large.path());
+    writeFile(largeDir, content.substr(1) + "b");
+    std::filesystem::last_write_time(large.path(), time + std::chrono::seconds(2));
+    REQUIRE_FALSE(cache.hasCachedFile(large));
+    REQUIRE(cache.cachedFilename(large) != cachedLarge);
+}
+
+TEST_CASE("CacheManager: Persistent Entries", "[cachemanager]") {
+    using namespace ghoul::filesystem;
+
+    const std::string dir = cacheDirectory();
+    std::string persistent;
+    std::string temporary;
+    {
+        CacheManager cache(dir);
+        persistent = cache.cachedFilename(
+            "persistent",
+            "1",
+            CacheManager::Persistent::Yes
+        );
+        temporary = cache.cachedFilename("temporary", "1");
+        std::ofstream(persistent) << "persistent";
+        std::ofstream(temporary) << "temporary";
+    }
+
+    CacheManager cache(dir);
+    REQUIRE(cache.hasCachedFile("persistent", "1"));
+    REQUIRE(cache.cachedFilename("persistent", "1") == persistent);
+    REQUIRE(FileSys.fileExists(persistent));
+    REQUIRE_FALSE(cache.hasCachedFile("temporary", "1"));
+    REQUIRE_FALSE(FileSys.fileExists(temporary));
+}
+
+TEST_CASE("CacheManager: Size Limit", "[cachemanager]") {
+    using namespace ghoul::filesystem;
+
+    auto fill = [](const std::string& path) {
+        std::ofstream(path) << std::string(100, 'x');
+    };
+
+    const std::string dir = cacheDirectory();
+    CacheManager cache(dir);
+    REQUIRE(cache.sizeLimit() == 0);
+
+    // 'a' is requested most often, but 'b' and 'c' were requested more recently
+    fill(cache.cachedFilename("a", "", CacheManager::Persistent::Yes));
+    cache.cachedFilename("a", "");
+    cache.cachedFilename("a", "");
+    fill(cache.cachedFilename("b", "", CacheManager::Persistent::Yes));
+    fill(cache.cachedFilename("c", "", CacheManager::Persistent::Yes));
+    const std::string temporary = cache.cachedFilename("d", "");
+    fill(temporary);
+
+    SECTION("Least Recently Used") {
+        cache.setSizeLimit(250, CacheManager::EvictionPolicy::LeastRecentlyUsed);
+        cache.enforceSizeLimit();
+        REQUIRE_FALSE(cache.hasCachedFile("a", ""));
+        REQUIRE(cache.hasCachedFile("b", ""));
+        REQUIRE(cache.hasCachedFile("c", ""));
+    }
+
+    SECTION("Least Frequently Used") {
+        cache.setSizeLimit(250, CacheManager::EvictionPolicy::LeastFrequentlyUsed);
+        cache.enforceSizeLimit();
+        REQUIRE(cache.hasCachedFile("a", ""));
+        REQUIRE_FALSE(cache.hasCachedFile("b", ""));
+        REQUIRE(cache.hasCachedFile("c", ""));
+    }
+
+    // Non-persistent files are never evicted
+    REQUIRE(cache.hasCachedFile("d", ""));
+    REQUIRE(FileSys.fileExists(temporary));
+}
+
+TEST_CASE("CacheManager: Crash Recovery", "[cachemanager]") {
+    using namespace ghoul::filesystem;
+
+    const std::string dir = cacheDirectory();
+    const std::string journal = dir + "/cache";
+    std::string persistent;
+    std::string temporary;
+    std::string crashedJournal;
+    {
+        CacheManager cache(dir);
+        persistent = cache.cachedFilename(
+            "persistent",
+            "",
+            CacheManager::Persistent::Yes
+        );
+        temporary = cache.cachedFilename("temporary", "");
+        std::ofstream(persistent) << "persistent";
+
+        // Capture the journal as it would be left behind by a crash at this point
+        std::ifstream f(journal, std::ifstream::binary);
+        crashedJournal.assign(std::istreambuf_iterator<char>(f), {});
+    }
+
+    // Restore the crashed state, including a record that was only partially written and
+    // a non-persistent file that the crashed application could not remove
+    {
+        std::ofstream f(journal, std::ofstream::binary);
+        f << crashedJournal << std::string("\x20\x00\x00\x00\x12", 5);
+    }
+    FileSys.createDirectory(
+        temporary.substr(0, temporary.rfind(FileSystem::PathSeparator)),
+        FileSystem::Recursive::Yes
+    );
+    std::ofstream(temporary) << "temporary";
+
+    CacheManager cache(dir);
+    REQUIRE(cache.hasCachedFile("persistent", ""));
+    REQUIRE(cache.cachedFilename("persistent", "") == persistent);
+    REQUIRE(FileSys.fileExists(persistent));
+    REQUIRE_FALSE(cache.hasCachedFile("temporary", ""));
+    REQUIRE_FALSE(FileSys.fileExists(temporary));
+}
+
+TEST_CASE("CacheManager: Concurrent Access", "[cachemanager]") {
+    using namespace ghoul::filesystem;
+
+    const std::string dir = cacheDirectory();
+    CacheManager cache(dir);
+
+    constexpr const int NThreads = 8;
+    constexpr const int NEntries = 50;
+    std::vector<std::vector<std::string>> results(NThreads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < NThreads; ++t) {
+        threads.emplace_back([&cache, &results, t]() {
+            for (int i = 0; i < NEntries; ++i) {
+                results[t].push_back(cache.cachedFilename(
+                    "entry",
+                    std::to_string(i),
+                    CacheManager::Persistent::Yes
+                ));
+            }
+        });
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+
+    // Every thread has to receive the same path for the same entry
+    for (int t = 1; t < NThreads; ++t) {
+        REQUIRE(results[t] == results[0]);
+    }
+    for (int i = 0; i < NEntries; ++i) {
+        REQUIRE(cache.hasCachedFile("entry", std::to_string(i)));
+    }
+}
+
+TEST_CASE("CacheManager: Shared Directory", "[cachemanager]") {
+    using namespace ghoul::filesystem;
+
+    // Two CacheManagers on the same directory behave like two processes sharing it
+    const std::string dir = cacheDirectory();
+    std::string persistent;
+    std::string temporary;
+    {
+        CacheManager first(dir);
+        CacheManager second(dir);
+
+        persistent = first.cachedFilename("shared", "", CacheManager::Persistent::Yes);
+        std::ofstream(persistent) << "persistent";
+        temporary = first.cachedFilename("temporary", "");
+
+        // Persistent entries of one are visible to the other, temporary ones are not
+        REQUIRE(second.hasCachedFile("shared", ""));
+        REQUIRE(second.cachedFilename("shared", "") == persistent);
+        REQUIRE_FALSE(second.hasCachedFile("temporary", ""));
+
+        // Removing the entry in one of them also removes it from the other
+        second.removeCacheFile("shared", "");
+        REQUIRE_FALSE(FileSys.fileExists(persistent));
+        persistent = first.cachedFilename("shared", "", CacheManager::Persistent::Yes);
+        std::ofstream(persistent) << "persistent";
+
+        // A CacheManager with a different version cannot use the directory while it is
+        // in use by others
+        REQUIRE_THROWS_AS(
+            CacheManager(dir, 2),
+            CacheManager::ErrorLoadingCacheException
+        );
+    }
+
+    CacheManager cache(dir);
+    REQUIRE(cache.hasCachedFile("shared", ""));
+    REQUIRE(FileSys.fileExists(persistent));
+    REQUIRE_FALSE(FileSys.fileExists(temporary));
+}
+
+TEST_CASE("CacheManager: Shared Access Information", "[cachemanager]") {
+    using namespace ghoul::filesystem;
+
+    const std::string dir = cacheDirectory();
+    CacheManager second(dir);
+    {
+        CacheManager first(dir);
+        for (const char* name : { "a", "b" }) {
+            const std::string path = first.cachedFilename(
+                name,
+                "",
+                CacheManager::Persistent::Yes
+            );
+            std::ofstream(path) << std::string(100, 'x');
+        }
+
+        // The access is only written to the journal when the first one is destroyed
+        first.cachedFilename("a", "");
+    }
+
+    second.setSizeLimit(150, CacheManager::EvictionPolicy::LeastRecentlyUsed);
+    second.enforceSizeLimit();
+    REQUIRE(second.hasCachedFile("a", ""));
+    REQUIRE_FALSE(second.hasCachedFile("b", ""));
+}
+
+#ifndef WIN32
+TEST_CASE("CacheManager: Lookups Without Lock", "[cachemanager]") {
+    using namespace ghoul::filesystem;
+
+    const std::string dir = cacheDirectory();
+    CacheManager cache(dir);
+    const std::string path = cache.cachedFilename("a", "", CacheManager::Persistent::Yes);
+
+    // Another process holding the lock for the journal must not block lookups
+    const int lockFile = open((dir + "/cache.lock").c_str(), O_RDWR | O_CLOEXEC);
+    REQUIRE(lockFile != -1);
+    REQUIRE(flock(lockFile, LOCK_EX) == 0);
+    std::future<bool> lookups = std::async(std::launch::async, [&]() {
+        return cache.hasCachedFile("a", "") && cache.cachedFilename("a", "") == path &&
+               !cache.hasCachedFile("b", "");
+    });
+    const bool isReady =
+        lookups.wait_for(std::chrono::seconds(5)) == std::future_status::ready;
+    flock(lockFile, LOCK_UN);
+    close(lockFile);
+    REQUIRE(isReady);
+    REQUIRE(lookups.get());
+}
+#endif // WIN32
@@ -166,6 +166,57 @@ TEST_CASE("CommandlineParser: Single Command One Argument Bool", "[commandlinepa
     }
 }
 
+TEST_CASE("CommandlineParser: Single Command Bool Values", "[commandlineparser]") {
+    ghoul::cmdparser::CommandlineParser p;
+
+    // Booleans are read as 0 or 1 by the stream, anything else is not a boolean
+    bool v = false;
+    using T = ghoul::cmdparser::SingleCommand<bool>;
+    p.addCommand(std::make_unique<T>(v, "-single"));
+
+    SECTION("1") {
+        p.setCommandLine({ "tests", "-single", "1" });
+        REQUIRE_NOTHROW(p.execute());
+        REQUIRE(v);
+    }
+    SECTION("2") {
+        p.setCommandLine({ "tests", "-single", "2" });
+        REQUIRE_THROWS(p.execute());
+    }
+    SECTION("true") {
+        p.setCommandLine({ "tests", "-single", "true" });
+        REQUIRE_THROWS(p.execute());
+    }
+}
+
+TEST_CASE("CommandlineParser: Single Command Char", "[commandlineparser]") {
+    ghoul::cmdparser::CommandlineParser p;
+
+    // Characters are read as the character itself rather than as a number
+    char c = ' ';
+    unsigned char u = ' ';
+    p.addCommand(std::make_unique<ghoul::cmdparser::SingleCommand<char>>(c, "-char"));
+    p.addCommand(
+        std::make_unique<ghoul::cmdparser::SingleCommand<unsigned char>>(u, "-uchar")
+    );
+
+    p.setCommandLine({ "tests", "-char", "a", "-uchar", "7" });
+    REQUIRE_NOTHROW(p.execute());
+    REQUIRE(c == 'a');
+    REQUIRE(u == '7');
+}
+
+TEST_CASE("CommandlineParser: Multiple Command Char", "[commandlineparser]") {
+    ghoul::cmdparser::CommandlineParser p;
+
+    std::vector<char> v;
+    p.addCommand(std::make_unique<ghoul::cmdparser::MultipleCommand<char>>(v, "-char"));
+
+    p.setCommandLine({ "tests", "-char", "a", "-char", "b" });
+    REQUIRE_NOTHROW(p.execute());
+    REQUIRE(v == std::vector<char>{ 'a', 'b' });
+}
+
 TEST_CASE(
     "CommandlineParser: Single Command Called Multiple Times",
     "[commandlineparser]")
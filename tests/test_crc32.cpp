@@ -26,8 +26,10 @@
 #include "catch2/catch.hpp"
 
 #include <ghoul/misc/crc32.h>
+#include <algorithm>
 #include <cstring>
 #include <random>
+#include <sstream>
 
 namespace {
 struct Data {
@@ -266,3 +268,102 @@ TEST_CASE("CRC32: HashRandomEquality", "[crc32]") {
         }
     }
 }
+
+TEST_CASE("CRC32: Update", "[crc32]") {
+    std::default_random_engine e(1337);
+    std::uniform_int_distribution<int> dist(0, 255);
+    std::vector<char> data(1024 * 1024 + 77);
+    for (char& c : data) {
+        c = static_cast<char>(dist(e));
+    }
+
+    // Different sizes and alignments exercise the vectorized blocks as well as the
+    // bytes before and after them
+    for (size_t offset = 0; offset < 16; ++offset) {
+        for (size_t size = 0; size < 300; ++size) {
+            const char* buffer = data.data() + offset;
+            const unsigned int expected = ghoul::hashCRC32(
+                buffer,
+                static_cast<unsigned int>(size)
+            );
+            REQUIRE(ghoul::updateCRC32(0, buffer, size) == expected);
+        }
+    }
+
+    const unsigned int full = ghoul::hashCRC32(
+        data.data(),
+        static_cast<unsigned int>(data.size())
+    );
+    REQUIRE(ghoul::updateCRC32(0, data.data(), data.size()) == full);
+
+    // Hashing the buffer in parts gives the same result as hashing it at once
+    unsigned int parts = 0;
+    size_t position = 0;
+    for (size_t size = 1; position < data.size(); size = size * 3 + 1) {
+        const size_t s = std::min(size, data.size() - position);
+        parts = ghoul::updateCRC32(parts, data.data() + position, s);
+        position += s;
+    }
+    REQUIRE(parts == full);
+
+    std::istringstream stream(std::string(data.begin(), data.end()));
+    REQUIRE(ghoul::hashCRC32(stream) == full);
+
+    // Strings are hashed including embedded null characters
+    const std::string embedded("a\0b", 3);
+    REQUIRE(ghoul::hashCRC32(embedded) == ghoul::hashCRC32(embedded.data(), 3));
+}
+
+TEST_CASE("CRC32: Implementations", "[crc32]") {
+    using Impl = ghoul::CRC32Implementation;
+    REQUIRE(ghoul::hasCRC32Implementation(Impl::SlicingBy8));
+
+    std::default_random_engine e(1337);
+    std::uniform_int_distribution<int> dist(0, 255);
+    std::vector<char> data(64 * 1024 + 77);
+    for (char& c : data) {
+        c = static_cast<char>(dist(e));
+    }
+    const unsigned int full = ghoul::hashCRC32(
+        data.data(),
+        static_cast<unsigned int>(data.size())
+    );
+
+    for (Impl impl : { Impl::SlicingBy8, Impl::Pclmul, Impl::ArmV8 }) {
+        if (!ghoul::hasCRC32Implementation(impl)) {
+            continue;
+        }
+        INFO("Implementation " << static_cast<int>(impl));
+
+        for (const Data& d : TestStrings) {
+            REQUIRE(ghoul::updateCRC32(0, d.string, strlen(d.string), impl) == d.hash);
+        }
+
+        // Unaligned starts and odd lengths around the sizes at which the implementations
+        // switch between their wide and bytewise loops
+        for (size_t offset = 0; offset < 16; ++offset) {
+            for (size_t size = 0; size < 300; ++size) {
+                const char* buffer = data.data() + offset;
+                const unsigned int expected = ghoul::hashCRC32(
+                    buffer,
+                    static_cast<unsigned int>(size)
+                );
+                REQUIRE(ghoul::updateCRC32(0, buffer, size, impl) == expected);
+            }
+        }
+
+        REQUIRE(ghoul::updateCRC32(0, data.data(), data.size(), impl) == full);
+        REQUIRE(ghoul::updateCRC32(0, data.data() + 1, data.size() - 1, impl) ==
+            ghoul::hashCRC32(data.data() + 1, static_cast<unsigned int>(data.size() - 1))
+        );
+
+        unsigned int parts = 0;
+        size_t position = 0;
+        for (size_t size = 1; position < data.size(); size = size * 3 + 1) {
+            const size_t s = std::min(size, data.size() - position);
+            parts = ghoul::updateCRC32(parts, data.data() + position, s, impl);
+            position += s;
+        }
+        REQUIRE(parts == full);
+    }
+}
@@ -25,8 +25,13 @@
 
 #include "catch2/catch.hpp"
 
+#include <ghoul/filesystem/file.h>
 #include <ghoul/filesystem/filesystem.h>
 #include <ghoul/misc/csvreader.h>
+#include <ghoul/misc/threadpool.h>
+#include <cmath>
+#include <fstream>
+#include <string_view>
 
 TEST_CASE("CSVReader: Initial", "[csvreader]") {
     std::string test0 = absPath("${UNIT_TEST}/csvreader/test0.csv");
@@ -94,3 +99,298 @@ TEST_CASE("CSVReader: Column Name", "[csvreader]") {
     REQUIRE(header[261][1] == "2142");
     REQUIRE(header[84][2] == "peitho");
 }
+
+TEST_CASE("CSVReader: Streaming", "[csvreader]") {
+    const std::string contents = "a,b,c\n1,,3\n\nlast";
+    ghoul::CSVReader reader(contents);
+    std::vector<std::string_view> cells;
+
+    REQUIRE(reader.skipRow());
+    REQUIRE(reader.readRow(cells));
+    REQUIRE(cells == std::vector<std::string_view>{ "1", "", "3" });
+    // The cells point into the contents instead of being copied
+    REQUIRE(cells[0].data() == contents.data() + 6);
+    REQUIRE(reader.lineNumber() == 2);
+    REQUIRE(reader.readRow(cells));
+    REQUIRE(cells == std::vector<std::string_view>{ "" });
+    REQUIRE(reader.readRow(cells));
+    REQUIRE(cells == std::vector<std::string_view>{ "last" });
+    REQUIRE_FALSE(reader.readRow(cells));
+    REQUIRE_FALSE(reader.skipRow());
+    REQUIRE(reader.lineNumber() == 4);
+}
+
+TEST_CASE("CSVReader: Quoted Cells", "[csvreader]") {
+    const std::string contents =
+        "\"a\",\"b, c\",\"d \"\"e\"\"\"\r\n"
+        "\"multi\nline\",\"\",x\"y\"\r\n"
+        "\"after\"trailing,2\n"
+        "\"unterminated,3\n";
+    ghoul::CSVReader reader(contents);
+    std::vector<std::string_view> cells;
+
+    REQUIRE(reader.readRow(cells));
+    REQUIRE(cells == std::vector<std::string_view>{ "a", "b, c", "d \"e\"" });
+    // Quoted cells without escaped quotes still point into the contents
+    REQUIRE(cells[0].data() == contents.data() + 1);
+    REQUIRE(reader.lineNumber() == 1);
+
+    // Quotes are only special at the beginning of a cell
+    REQUIRE(reader.readRow(cells));
+    REQUIRE(cells == std::vector<std::string_view>{ "multi\nline", "", "x\"y\"" });
+    REQUIRE(reader.lineNumber() == 2);
+
+    // The line break in the previous row is counted
+    REQUIRE(reader.readRow(cells));
+    REQUIRE(cells == std::vector<std::string_view>{ "aftertrailing", "2" });
+    REQUIRE(reader.lineNumber() == 4);
+
+    REQUIRE(reader.readRow(cells));
+    REQUIRE(cells == std::vector<std::string_view>{ "unterminated,3\n" });
+    REQUIRE_FALSE(reader.readRow(cells));
+
+    const std::string path = absPath("${TEMPORARY}/ghoul_csvreader_quoted.csv");
+    std::ofstream(path, std::ofstream::binary) <<
+        "name,value\r\n\"Smith, J.\",\"1.5\"\r\n\"O\"\"Brien\",2\r\n";
+    std::vector<std::vector<std::string>> strings = ghoul::loadCSVFile(path);
+    REQUIRE(strings == std::vector<std::vector<std::string>>{
+        { "Smith, J.", "1.5" },
+        { "O\"Brien", "2" }
+    });
+    std::vector<std::vector<double>> values = ghoul::loadCSVColumns<double>(
+        path,
+        std::vector<std::string>{ "value" }
+    );
+    REQUIRE(values[0] == std::vector<double>{ 1.5, 2.0 });
+    FileSys.deleteFile(ghoul::filesystem::File(path));
+}
+
+TEST_CASE("CSVReader: Delimiter", "[csvreader]") {
+    const std::string contents = "a;b,c;\"d;e\"\n1\t2;3";
+    ghoul::CSVReader semicolon(contents, ';');
+    std::vector<std::string_view> cells;
+    REQUIRE(semicolon.readRow(cells));
+    REQUIRE(cells == std::vector<std::string_view>{ "a", "b,c", "d;e" });
+    REQUIRE(semicolon.readRow(cells));
+    REQUIRE(cells == std::vector<std::string_view>{ "1\t2", "3" });
+
+    ghoul::CSVReader tab(contents, '\t');
+    REQUIRE(tab.readRow(cells));
+    REQUIRE(cells == std::vector<std::string_view>{ "a;b,c;\"d;e\"" });
+    REQUIRE(tab.readRow(cells));
+    REQUIRE(cells == std::vector<std::string_view>{ "1", "2;3" });
+
+    // Long rows are scanned in blocks, which must not miss any delimiters
+    std::string row;
+    for (int i = 0; i < 100; ++i) {
+        row += std::to_string(i) + '\t';
+    }
+    ghoul::CSVReader longRow(row, '\t');
+    REQUIRE(longRow.readRow(cells));
+    REQUIRE(cells.size() == 101);
+    for (int i = 0; i < 100; ++i) {
+        REQUIRE(cells[i] == std::to_string(i));
+    }
+
+    const std::string path = absPath("${TEMPORARY}/ghoul_csvreader_delimiter.csv");
+    std::ofstream(path) << "x\ty\n1\t2\n3\t4\n";
+    std::vector<std::vector<int>> values = ghoul::loadCSVColumns<int>(
+        path,
+        std::vector<std::string>{ "y", "x" },
+        nullptr,
+        '\t'
+    );
+    REQUIRE(values == std::vector<std::vector<int>>{ { 2, 4 }, { 1, 3 } });
+    std::vector<std::vector<std::string>> strings = ghoul::loadCSVFile(
+        path,
+        true,
+        '\t'
+    );
+    REQUIRE(strings[0] == std::vector<std::string>{ "x", "y" });
+    FileSys.deleteFile(ghoul::filesystem::File(path));
+}
+
+TEST_CASE("CSVReader: Typed Columns", "[csvreader]") {
+    std::string test0 = absPath("${UNIT_TEST}/csvreader/test0.csv");
+    std::vector<std::string> col = { "mag_h", "ceu_rate" };
+    using Indices = std::vector<int>;
+    std::vector<std::vector<double>> values = ghoul::loadCSVColumns<double>(test0, col);
+    std::vector<std::vector<int>> obs = ghoul::loadCSVColumns<int>(test0, Indices{ 7 });
+    std::vector<std::vector<std::string>> strings = ghoul::loadCSVFile(
+        test0,
+        Indices{ 3, 17 }
+    );
+
+    REQUIRE(values.size() == 2);
+    REQUIRE(obs.size() == 1);
+    REQUIRE(values[0].size() == 351);
+    REQUIRE(values[1].size() == 351);
+    REQUIRE(obs[0].size() == 351);
+    for (size_t i = 0; i < strings.size(); ++i) {
+        REQUIRE(values[0][i] == std::stod(strings[i][0]));
+        REQUIRE(values[1][i] == std::stod(strings[i][1]));
+    }
+    REQUIRE(values[1][0] == -2.3E-4);
+    REQUIRE(obs[0][0] == 2349);
+    REQUIRE(obs[0][260] == 2142);
+
+    const std::string path = absPath("${TEMPORARY}/ghoul_csvreader_typed.csv");
+    std::ofstream(path) << "a,b\n1, +2.5\n,-3\n";
+    std::vector<std::vector<float>> floats = ghoul::loadCSVColumns<float>(
+        path,
+        Indices{ 0, 1 }
+    );
+    REQUIRE(floats[0][0] == 1.f);
+    REQUIRE(std::isnan(floats[0][1]));
+    REQUIRE(floats[1] == std::vector<float>{ 2.5f, -3.f });
+
+    using ghoul::RuntimeError;
+    // Empty cells cannot be converted to integers and the header is not a number
+    REQUIRE_THROWS_AS(ghoul::loadCSVColumns<int>(path, Indices{ 0 }), RuntimeError);
+    REQUIRE_THROWS_AS(
+        ghoul::loadCSVColumns<int>(path, Indices{ 1 }, true),
+        RuntimeError
+    );
+    REQUIRE_THROWS_AS(ghoul::loadCSVColumns<int>(path, Indices{ 2 }), RuntimeError);
+
+    // Only a single sign is allowed
+    std::ofstream(path) << "+-1\n";
+    REQUIRE_THROWS_AS(ghoul::loadCSVColumns<int>(path, Indices{ 0 }, true), RuntimeError);
+    REQUIRE_THROWS_AS(
+        ghoul::loadCSVColumns<double>(path, Indices{ 0 }, true),
+        RuntimeError
+    );
+    FileSys.deleteFile(ghoul::filesystem::File(path));
+}
+
+TEST_CASE("CSVReader: Parallel", "[csvreader]") {
+    using Indices = std::vector<int>;
+
+    // Large enough to be split into multiple chunks
+    const std::string path = absPath("${TEMPORARY}/ghoul_csvreader_parallel.csv");
+    {
+        std::ofstream f(path);
+        f << "index,value,name\n";
+        for (int i = 0; i < 500000; ++i) {
+            f << i << ',' << i << ".5,name" << i << '\n';
+        }
+    }
+
+    ghoul::ThreadPool pool(4);
+    std::vector<std::vector<double>> sequential = ghoul::loadCSVColumns<double>(
+        path,
+        Indices{ 1, 0 }
+    );
+    std::vector<std::vector<double>> parallel = ghoul::loadCSVColumns<double>(
+        path,
+        Indices{ 1, 0 },
+        false,
+        &pool
+    );
+    REQUIRE(parallel.size() == 2);
+    REQUIRE(parallel[0].size() == 500000);
+    REQUIRE(parallel == sequential);
+    for (int i = 0; i < 500000; i += 997) {
+        REQUIRE(parallel[0][i] == i + 0.5);
+        REQUIRE(parallel[1][i] == i);
+    }
+
+    std::vector<std::vector<int>> named = ghoul::loadCSVColumns<int>(
+        path,
+        std::vector<std::string>{ "index" },
+        &pool
+    );
+    REQUIRE(named[0] == std::vector<int>(parallel[1].begin(), parallel[1].end()));
+
+    // Errors report the line in the file, regardless of the chunk they occur in
+    {
+        std::ofstream f(path, std::ofstream::app);
+        f << "1,invalid,name\n";
+    }
+    REQUIRE_THROWS_WITH(
+        ghoul::loadCSVColumns<double>(path, Indices{ 1 }, false, &pool),
+        Catch::Contains("line 500002")
+    );
+    FileSys.deleteFile(ghoul::filesystem::File(path));
+}
+
+TEST_CASE("CSVReader: Parallel Quoted", "[csvreader]") {
+    using Indices = std::vector<int>;
+
+    // Every row spans two lines, so chunks must not be split inside the quoted cells
+    const std::string path = absPath("${TEMPORARY}/ghoul_csvreader_quoted.csv");
+    {
+        std::ofstream f(path, std::ofstream::binary);
+        f << "index,name,value\r\n";
+        for (int i = 0; i < 250000; ++i) {
+            f << i << ",\"name " << i << ",\r\n\"\"quoted\"\"\"," << i << ".5\r\n";
+        }
+    }
+
+    ghoul::ThreadPool pool(4);
+    std::vector<std::vector<double>> sequential = ghoul::loadCSVColumns<double>(
+        path,
+        Indices{ 2, 0 }
+    );
+    std::vector<std::vector<double>> parallel = ghoul::loadCSVColumns<double>(
+        path,
+        Indices{ 2, 0 },
+        false,
+        &pool
+    );
+    REQUIRE(parallel[0].size() == 250000);
+    REQUIRE(parallel == sequential);
+    for (int i = 0; i < 250000; i += 997) {
+        REQUIRE(parallel[0][i] == i + 0.5);
+        REQUIRE(parallel[1][i] == i);
+    }
+
+    {
+        std::ofstream f(path, std::ofstream::app | std::ofstream::binary);
+        f << "1,\"invalid\",\"x\"\r\n";
+    }
+    REQUIRE_THROWS_WITH(
+        ghoul::loadCSVColumns<double>(path, Indices{ 2 }, false, &pool),
+        Catch::Contains("line 500002")
+    );
+
+    // A quote inside an unquoted cell does not start a quoted section, so it must not
+    // change where the following chunks can be split
+    {
+        std::ofstream f(path, std::ofstream::binary);
+        f << "index,text,name,value\n";
+        for (int i = 0; i < 250000; ++i) {
+            f << i << ",\"multi\nline\"," << (i == 0 ? "na\"me," : "name,");
+            f << i << ".5\n";
+        }
+    }
+    parallel = ghoul::loadCSVColumns<double>(path, Indices{ 3, 0 }, false, &pool);
+    REQUIRE(parallel[0].size() == 250000);
+    for (int i = 0; i < 250000; i += 997) {
+        REQUIRE(parallel[0][i] == i + 0.5);
+        REQUIRE(parallel[1][i] == i);
+    }
+
+    // A quoted cell that is larger than a chunk contains the offsets at which the
+    // contents would be split, but none of its line breaks may end a row
+    {
+        std::ofstream f(path, std::ofstream::binary);
+        f << "index,text,value\n";
+        f << "0,\"";
+        for (int i = 0; i < 500000; ++i) {
+            f << "line,\n\"\"" << i << "\"\",";
+        }
+        f << "\",0.5\n";
+        for (int i = 1; i < 250000; ++i) {
+            f << i << ",\"text\n\"," << i << ".5\n";
+        }
+    }
+    parallel = ghoul::loadCSVColumns<double>(path, Indices{ 2, 0 }, false, &pool);
+    REQUIRE(parallel[0].size() == 250000);
+    REQUIRE(parallel == ghoul::loadCSVColumns<double>(path, Indices{ 2, 0 }));
+    for (int i = 0; i < 250000; i += 997) {
+        REQUIRE(parallel[0][i] == i + 0.5);
+        REQUIRE(parallel[1][i] == i);
+    }
+    FileSys.deleteFile(ghoul::filesystem::File(path));
+}
@@ -25,10 +25,19 @@
 
 #include "catch2/catch.hpp"
 
+#include <ghoul/filesystem/directory.h>
 #include <ghoul/filesystem/filesystem.h>
 #include <ghoul/filesystem/file.h>
+#include <ghoul/misc/threadpool.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
 #include <iostream>
 #include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
 
 #ifdef WIN32
 #include <windows.h>
@@ -148,6 +157,121 @@ TEST_CASE("FileSystem: OnChangeCallback", "[filesystem]") {
     REQUIRE(FileSys.deleteFile(path));
 }
 
+TEST_CASE("FileSystem: Watch Directory Spellings", "[filesystem]") {
+    using ghoul::filesystem::File;
+
+    const std::string dir = absPath("${TEMPORARY}/watch");
+    if (!FileSys.directoryExists(dir)) {
+        FileSys.createDirectory(dir);
+    }
+    for (const char* file : { "a.txt", "b.txt", "c.txt", "d.txt" }) {
+        std::ofstream(dir + "/" + file) << "tmp";
+    }
+
+    auto waitFor = [](const std::atomic_bool& flag) {
+        for (int i = 0; i < 4000 && !flag; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            FileSys.triggerFilesystemEvents();
+        }
+    };
+
+    // Both spellings of the directory share one watch, which has to be removed for both
+    // spellings once the last File is gone
+    auto noop = [](const File&) {};
+    File* a = new File(dir + "/a.txt", File::RawPath::Yes, noop);
+    File* b = new File(dir + "/../watch/./b.txt", File::RawPath::Yes, noop);
+    delete a;
+    delete b;
+
+    std::atomic_bool changed = false;
+    File c(dir + "/c.txt", File::RawPath::Yes, [&changed](const File&) { changed = true; });
+    std::ofstream(dir + "/c.txt") << "changed";
+    waitFor(changed);
+    REQUIRE(changed);
+
+    // Destroying a File on another thread has to wait until its callback has returned
+    std::atomic_bool inCallback = false;
+    std::atomic_bool callbackDone = false;
+    std::atomic_bool deletedAfterCallback = false;
+    File* d = new File(dir + "/d.txt", File::RawPath::Yes, [&](const File&) {
+        inCallback = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        callbackDone = true;
+    });
+    std::thread deleter([&]() {
+        for (int i = 0; i < 4000 && !inCallback; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        delete d;
+        deletedAfterCallback = callbackDone.load();
+    });
+    std::ofstream(dir + "/d.txt") << "changed";
+    waitFor(inCallback);
+    deleter.join();
+    REQUIRE(inCallback);
+    REQUIRE(deletedAfterCallback);
+}
+
+#ifdef __linux__
+TEST_CASE("FileSystem: Watch Replaced Directory", "[filesystem]") {
+    using ghoul::filesystem::File;
+    using ghoul::filesystem::FileSystem;
+
+    const std::string dir = absPath("${TEMPORARY}/watchreplace");
+    const std::string replacement = dir + ".new";
+    const std::string old = dir + ".old";
+    for (const std::string& d : { dir, replacement, old }) {
+        if (FileSys.directoryExists(d)) {
+            FileSys.deleteDirectory(d, FileSystem::Recursive::Yes);
+        }
+    }
+    FileSys.createDirectory(dir);
+    std::ofstream(dir + "/a.txt") << "tmp";
+
+    std::atomic_int nChanges = 0;
+    File file(dir + "/a.txt", File::RawPath::Yes, [&nChanges](const File&) {
+        ++nChanges;
+    });
+    auto waitForChange = [&nChanges]() {
+        for (int i = 0; i < 4000 && nChanges == 0; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            FileSys.triggerFilesystemEvents();
+        }
+        // Let the remaining events of the same change settle before the next one
+        for (int i = 0; i < 200; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            FileSys.triggerFilesystemEvents();
+        }
+        return nChanges.exchange(0) > 0;
+    };
+
+    // Replacing the directory by moving it away and renaming another one into its place
+    FileSys.createDirectory(replacement);
+    std::ofstream(replacement + "/a.txt") << "replaced";
+    REQUIRE(std::rename(dir.c_str(), old.c_str()) == 0);
+    REQUIRE(std::rename(replacement.c_str(), dir.c_str()) == 0);
+    REQUIRE(waitForChange());
+
+    // Only the directory that is now at the path of the file is watched
+    std::ofstream(old + "/a.txt") << "changed";
+    REQUIRE_FALSE(waitForChange());
+    std::ofstream(dir + "/a.txt") << "changed";
+    REQUIRE(waitForChange());
+
+    // Removing the directory and creating it again
+    FileSys.deleteDirectory(dir, FileSystem::Recursive::Yes);
+    REQUIRE_FALSE(waitForChange());
+    FileSys.createDirectory(dir);
+    std::ofstream(dir + "/a.txt") << "created";
+    REQUIRE(waitForChange());
+    std::ofstream(dir + "/a.txt") << "changed";
+    REQUIRE(waitForChange());
+
+    FileSys.deleteDirectory(dir, FileSystem::Recursive::Yes);
+    FileSys.deleteDirectory(old, FileSystem::Recursive::Yes);
+}
+#endif // __linux__
+
 TEST_CASE("FileSystem: TokenDefaultState", "[filesystem]") {
     REQUIRE(FileSys.tokens().size() == 3);
     REQUIRE(FileSys.tokens()[0] == "${TEMPORARY}");
@@ -343,3 +467,113 @@ TEST_CASE("FileSystem: Expanding Tokens Ignored Unregistered", "[filesystem]") {
         REQUIRE(p == "foobar/${X}/foobar/fob/${Y}/foobar/fob/foo");
     }
 }
+
+TEST_CASE("FileSystem: Directory Walk", "[filesystem]") {
+    using ghoul::filesystem::Directory;
+    using ghoul::filesystem::FileSystem;
+
+    // Build a fixture whose contents do not depend on the rest of the tree
+    const std::string root = absPath("${TEMPORARY}/walk");
+    if (FileSys.directoryExists(root)) {
+        FileSys.deleteDirectory(root, FileSystem::Recursive::Yes);
+    }
+    FileSys.createDirectory(root + "/sub/deeper", FileSystem::Recursive::Yes);
+    FileSys.createDirectory(root + "/empty");
+    for (const char* file : { "a.cfg", "b.txt", "test1.cpp", "sub/c.cfg",
+                              "sub/test2.cfg", "sub/deeper/test3.h", "sub/deeper/d.cfg" })
+    {
+        std::ofstream(root + "/" + file) << file;
+    }
+
+    const Directory dir(root);
+    const std::vector<std::string> files = dir.readFiles(Directory::Recursive::Yes);
+    const std::vector<std::string> directories =
+        dir.readDirectories(Directory::Recursive::Yes);
+    const std::vector<std::string> all = dir.read(Directory::Recursive::Yes);
+    REQUIRE(files.size() == 7);
+    REQUIRE(directories.size() == 3);
+    REQUIRE(all.size() == files.size() + directories.size());
+
+    ghoul::ThreadPool pool(4);
+    std::mutex mutex;
+    std::vector<std::string> walked;
+    Directory::WalkOptions options;
+    dir.walk(
+        [&](const std::string& path, bool) {
+            std::lock_guard lock(mutex);
+            walked.push_back(path);
+        },
+        options,
+        &pool
+    );
+    std::vector<std::string> sorted = all;
+    std::sort(sorted.begin(), sorted.end());
+    std::sort(walked.begin(), walked.end());
+    REQUIRE(walked == sorted);
+
+    options.includeDirectories = false;
+    options.extensions = { "cfg" };
+    int nConfigs = 0;
+    dir.walk([&nConfigs](const std::string&, bool) { ++nConfigs; }, options);
+    REQUIRE(nConfigs == 4);
+
+    options.extensions.clear();
+    options.pattern = "test?.c*";
+    int nMatches = 0;
+    dir.walk([&nMatches](const std::string&, bool) { ++nMatches; }, options);
+    REQUIRE(nMatches == 2);
+
+    // An exception from the callback aborts the walk and is passed on to the caller
+    options.pattern.clear();
+    auto throwing = [](const std::string& path, bool) {
+        if (path.find("test3.h") != std::string::npos) {
+            throw std::runtime_error("callback");
+        }
+    };
+    REQUIRE_THROWS_AS(dir.walk(throwing, options), std::runtime_error);
+    REQUIRE_THROWS_AS(dir.walk(throwing, options, &pool), std::runtime_error);
+#ifdef __linux__
+    // The directories that were being listed when the callback threw are closed again
+    const size_t nOpenFiles = Directory("/proc/self/fd").read().size();
+    REQUIRE_THROWS_AS(dir.walk(throwing, options), std::runtime_error);
+    REQUIRE(Directory("/proc/self/fd").read().size() == nOpenFiles);
+#endif // __linux__
+
+    // The ThreadPool must still be usable after the failed walk
+    int nFiles = 0;
+    dir.walk([&](const std::string&, bool) {
+        std::lock_guard lock(mutex);
+        ++nFiles;
+    }, options, &pool);
+    REQUIRE(nFiles == 7);
+
+    FileSys.deleteDirectory(root, FileSystem::Recursive::Yes);
+}
+
+TEST_CASE("FileSystem: Absolute Path Cache", "[filesystem]") {
+    using ghoul::filesystem::Directory;
+
+    const std::string path = absPath("${UNIT_TEST}/main.cpp");
+    REQUIRE(absPath("${UNIT_TEST}/main.cpp") == path);
+    REQUIRE(FileSys.fileExists(path));
+
+    // Changing the current directory has to invalidate cached relative paths
+    const Directory current = FileSys.currentDirectory();
+    FileSys.setCurrentDirectory(Directory(absPath("${UNIT_TEST}")));
+    const std::string inTests = absPath("main.cpp");
+    REQUIRE(inTests == path);
+    FileSys.setCurrentDirectory(Directory(absPath("${UNIT_TEST}/csvreader")));
+    const std::string inCsv = absPath("main.cpp");
+    REQUIRE(inCsv != inTests);
+    FileSys.setCurrentDirectory(current);
+
+    std::vector<std::string> ignored = { "${UNIT_TEST}" };
+    REQUIRE(
+        FileSys.absolutePath("${UNIT_TEST}/main.cpp", ignored).find("${UNIT_TEST}") !=
+        std::string::npos
+    );
+    REQUIRE_THROWS_AS(
+        absPath("${NOT_A_REGISTERED_TOKEN}/main.cpp"),
+        ghoul::filesystem::FileSystem::ResolveTokenException
+    );
+}
@@ -0,0 +1,83 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2020                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <ghoul/misc/hash.h>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+TEST_CASE("Hash64: Known Values", "[hash]") {
+    using ghoul::operator""_hash64;
+
+    // Reference values of the xxHash64 implementation
+    static_assert(ghoul::hash64("") == 0xEF46DB3751D8E999ULL, "");
+    static_assert("a"_hash64 == 0xD24EC4F1A98C6E5BULL, "a");
+    static_assert(ghoul::hash64("abc") == 0x44BC2CF5AD770999ULL, "abc");
+
+    REQUIRE(ghoul::hash64(std::string("abc")) == 0x44BC2CF5AD770999ULL);
+    REQUIRE(ghoul::hash64("abc", 3, 1) != ghoul::hash64("abc", 3, 0));
+}
+
+TEST_CASE("Hash64: Streaming", "[hash]") {
+    std::default_random_engine e(1337);
+    std::uniform_int_distribution<int> dist(0, 255);
+    std::vector<char> data(4096);
+    for (char& c : data) {
+        c = static_cast<char>(dist(e));
+    }
+
+    for (size_t size = 0; size < data.size(); size += (size < 100 ? 1 : 61)) {
+        const uint64_t expected = ghoul::hash64(data.data(), size, 42);
+
+        // Parts of increasing sizes cover partial as well as complete stripes
+        ghoul::StreamingHash64 hash(42);
+        size_t position = 0;
+        for (size_t part = 1; position < size; part = part * 2 + 1) {
+            const size_t s = std::min(part, size - position);
+            hash.update(data.data() + position, s);
+            position += s;
+        }
+        REQUIRE(hash.value() == expected);
+    }
+
+    // The value can be retrieved in between without affecting the result
+    ghoul::StreamingHash64 hash;
+    hash.update("Hello, ");
+    REQUIRE(hash.value() == ghoul::hash64("Hello, "));
+    hash.update("World");
+    REQUIRE(hash.value() == ghoul::hash64("Hello, World"));
+}
+
+TEST_CASE("Hash64: Collisions", "[hash]") {
+    std::unordered_set<uint64_t> hashes;
+    for (int i = 0; i < 100000; ++i) {
+        hashes.insert(ghoul::hash64("name" + std::to_string(i)));
+    }
+    REQUIRE(hashes.size() == 100000);
+}
@@ -0,0 +1,239 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2020                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <ghoul/logging/consolelog.h>
+#include <ghoul/logging/log.h>
+#include <ghoul/logging/logmanager.h>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+    struct Message {
+        ghoul::logging::LogLevel level;
+        std::string category;
+        std::string message;
+    };
+
+    class CaptureLog : public ghoul::logging::Log {
+    public:
+        explicit CaptureLog(std::vector<Message>& messages) : _messages(messages) {}
+
+        void log(ghoul::logging::LogLevel level, const std::string& category,
+                 const std::string& message) override
+        {
+            _messages.push_back({ level, category, message });
+        }
+
+    private:
+        std::vector<Message>& _messages;
+    };
+
+    /**
+     * Replaces the global LogManager with one that has the provided level and captures
+     * all messages while this object is alive and restores the one from main afterwards
+     */
+    struct ScopedLogManager {
+        explicit ScopedLogManager(ghoul::logging::LogLevel level) {
+            ghoul::logging::LogManager::deinitialize();
+            ghoul::logging::LogManager::initialize(level);
+            LogMgr.addLog(std::make_unique<CaptureLog>(messages));
+        }
+
+        ~ScopedLogManager() {
+            ghoul::logging::LogManager::deinitialize();
+            ghoul::logging::LogManager::initialize(ghoul::logging::LogLevel::Fatal);
+            LogMgr.addLog(std::make_unique<ghoul::logging::ConsoleLog>());
+        }
+
+        std::vector<Message> messages;
+    };
+
+    std::string countEvaluation(int& counter, std::string message) {
+        counter++;
+        return message;
+    }
+
+    // All calls of this function share the same call site
+    void logFromSharedSite(const std::string& category, const std::string& message) {
+        LINFOC(category, message);
+    }
+} // namespace
+
+TEST_CASE("LogManager: Category Levels", "[logmanager]") {
+    using ghoul::logging::LogLevel;
+    ghoul::logging::LogManager manager(LogLevel::Warning);
+
+    CHECK(manager.isEnabled(LogLevel::Warning, "A"));
+    CHECK_FALSE(manager.isEnabled(LogLevel::Info, "A"));
+    CHECK(manager.categoryLogLevel("A") == LogLevel::Warning);
+
+    manager.setCategoryLogLevel("A", LogLevel::Trace);
+    CHECK(manager.categoryLogLevel("A") == LogLevel::Trace);
+    CHECK(manager.isEnabled(LogLevel::Trace, "A"));
+    CHECK_FALSE(manager.isEnabled(LogLevel::Info, "B"));
+
+    manager.setCategoryLogLevel("B", LogLevel::Fatal);
+    CHECK_FALSE(manager.isEnabled(LogLevel::Error, "B"));
+    CHECK(manager.isEnabled(LogLevel::Error, "C"));
+
+    ghoul::logging::LogCallSite site;
+    CHECK(manager.isEnabled(LogLevel::Trace, "A", site));
+    // The cached index of the call site must not be used for a different category
+    CHECK_FALSE(manager.isEnabled(LogLevel::Trace, "C", site));
+    CHECK_FALSE(manager.isEnabled(LogLevel::Error, "B", site));
+
+    // Category strings at different addresses or passed as strings refer to the same
+    // category if their names are equal
+    const std::string a = "A";
+    CHECK(manager.isEnabled(LogLevel::Trace, a.c_str(), site));
+    CHECK(manager.isEnabled(LogLevel::Trace, a, site));
+    ghoul::logging::LogCallSite stringSite;
+    CHECK(manager.isEnabled(LogLevel::Trace, a, stringSite));
+    CHECK_FALSE(manager.isEnabled(LogLevel::Trace, std::string("C"), stringSite));
+
+    manager.removeCategoryLogLevel("A");
+    CHECK(manager.categoryLogLevel("A") == LogLevel::Warning);
+    CHECK_FALSE(manager.isEnabled(LogLevel::Trace, "A"));
+    CHECK_FALSE(manager.isEnabled(LogLevel::Trace, "A", site));
+}
+
+TEST_CASE("LogManager: Macros", "[logmanager]") {
+    using ghoul::logging::LogLevel;
+    ScopedLogManager scope(LogLevel::Info);
+    LogMgr.setCategoryLogLevel("Verbose", LogLevel::Trace);
+
+    int nEvaluations = 0;
+    LDEBUGC("Quiet", countEvaluation(nEvaluations, "filtered"));
+    CHECK(nEvaluations == 0);
+
+    for (int i = 0; i < 2; ++i) {
+        LTRACEC("Verbose", countEvaluation(nEvaluations, "trace"));
+        LINFOC("Quiet", countEvaluation(nEvaluations, "info"));
+    }
+    CHECK(nEvaluations == 4);
+
+    constexpr const char* _loggerCat = "Default";
+    LWARNING("warning");
+
+    REQUIRE(scope.messages.size() == 5);
+    CHECK(scope.messages[0].level == LogLevel::Trace);
+    CHECK(scope.messages[0].category == "Verbose");
+    CHECK(scope.messages[0].message == "trace");
+    CHECK(scope.messages[1].level == LogLevel::Info);
+    CHECK(scope.messages[1].category == "Quiet");
+    CHECK(scope.messages[4].level == LogLevel::Warning);
+    CHECK(scope.messages[4].category == "Default");
+    CHECK(LogMgr.messageCounter(LogLevel::Trace) == 2);
+    CHECK(LogMgr.messageCounter(LogLevel::Debug) == 0);
+
+    // The function forms can be used where an expression or a function is needed
+    void (*function)(const std::string&, const std::string&) = &LERRORC;
+    function("Function", "pointer");
+    const bool condition = true;
+    condition ? (LERRORC)("Function", "expression") : (LINFOC)("Function", "other");
+    LDEBUGC("Quiet", "still filtered");
+
+    REQUIRE(scope.messages.size() == 7);
+    CHECK(scope.messages[5].message == "pointer");
+    CHECK(scope.messages[6].message == "expression");
+}
+
+TEST_CASE("LogManager: Rate Limits", "[logmanager]") {
+    using ghoul::logging::LogLevel;
+    ScopedLogManager scope(LogLevel::Info);
+
+    // The limits are low enough that no token becomes available again during the test
+    LogMgr.setCallSiteRateLimit(0.001);
+    LogMgr.setCategoryRateLimit("Limited", 0.001);
+
+    int nEvaluations = 0;
+    LINFOC("Limited", countEvaluation(nEvaluations, "first"));
+    CHECK(nEvaluations == 1);
+
+    // The category rejects this message, which must not use up the call site's token
+    logFromSharedSite("Limited", "rejected by category");
+    logFromSharedSite("Free", "allowed");
+    // Now the call site's token is used up
+    logFromSharedSite("Free", "rejected by call site");
+    logFromSharedSite("Free", "rejected by call site");
+
+    for (int i = 0; i < 3; ++i) {
+        LWARNINGC("Limited", countEvaluation(nEvaluations, "suppressed"));
+    }
+    CHECK(nEvaluations == 1);
+
+    REQUIRE(scope.messages.size() == 2);
+    CHECK(scope.messages[0].message == "first");
+    CHECK(scope.messages[1].category == "Free");
+    CHECK(scope.messages[1].message == "allowed (repeated 1 times)");
+
+    // The suppressed messages are reported even though no message followed them
+    LogMgr.flushLogs();
+    REQUIRE(scope.messages.size() == 4);
+    CHECK(scope.messages[2].level == LogLevel::Info);
+    CHECK(scope.messages[2].category == "Free");
+    CHECK(scope.messages[2].message.find("(suppressed 2 times at ") == 0);
+    CHECK(scope.messages[3].level == LogLevel::Warning);
+    CHECK(scope.messages[3].category == "Limited");
+    CHECK(scope.messages[3].message.find("(suppressed 3 times at ") == 0);
+
+    LogMgr.flushLogs();
+    CHECK(scope.messages.size() == 4);
+
+    LogMgr.removeCallSiteRateLimit();
+    LogMgr.removeCategoryRateLimit("Limited");
+    logFromSharedSite("Limited", "unlimited");
+    REQUIRE(scope.messages.size() == 5);
+    CHECK(scope.messages[4].message == "unlimited");
+}
+
+TEST_CASE("LogManager: Rate Limit Window Expires", "[logmanager]") {
+    using ghoul::logging::LogLevel;
+    ScopedLogManager scope(LogLevel::Info);
+    LogMgr.setCallSiteRateLimit(20.0);
+
+    for (int i = 0; i < 3; ++i) {
+        LWARNINGC("Limited", "message");
+    }
+    REQUIRE(scope.messages.size() == 1);
+
+    // Once the call site could log again, its suppressed messages are reported with the
+    // next message from any other call site rather than only when the logs are flushed
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    LINFOC("Other", "other");
+    REQUIRE(scope.messages.size() == 3);
+    CHECK(scope.messages[1].level == LogLevel::Warning);
+    CHECK(scope.messages[1].category == "Limited");
+    CHECK(scope.messages[1].message.find("(suppressed 2 times at ") == 0);
+    CHECK(scope.messages[2].message == "other");
+
+    LogMgr.flushLogs();
+    CHECK(scope.messages.size() == 3);
+}
@@ -0,0 +1,160 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2020                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <ghoul/lua/ghoul_lua.h>
+#include <ghoul/lua/luastatepool.h>
+#include <ghoul/misc/dictionary.h>
+#include <ghoul/misc/threadpool.h>
+#include <future>
+#include <string>
+#include <vector>
+
+namespace {
+    // Refuses all allocations while 'fail' is set, but still frees memory
+    struct FailingAllocator {
+        lua_Alloc allocator = nullptr;
+        void* userData = nullptr;
+        bool fail = false;
+    };
+
+    void* failingAllocate(void* userData, void* ptr, size_t oldSize, size_t newSize) {
+        FailingAllocator* a = reinterpret_cast<FailingAllocator*>(userData);
+        // For new objects, 'oldSize' is the type of the object rather than a size
+        if (a->fail && newSize > 0 && (!ptr || newSize > oldSize)) {
+            return nullptr;
+        }
+        return a->allocator(a->userData, ptr, oldSize, newSize);
+    }
+} // namespace
+
+TEST_CASE("LuaStatePool: Acquire", "[luastatepool]") {
+    ghoul::lua::LuaStatePool pool(2);
+    REQUIRE(pool.nIdleStates() == 2);
+
+    {
+        ghoul::lua::LuaStatePool::Handle first = pool.acquire();
+        ghoul::lua::LuaStatePool::Handle second = pool.acquire();
+        REQUIRE(pool.nIdleStates() == 0);
+        REQUIRE(static_cast<lua_State*>(first) != static_cast<lua_State*>(second));
+
+        // The pool grows if all states are in use
+        ghoul::lua::LuaStatePool::Handle third = pool.acquire();
+        REQUIRE(static_cast<lua_State*>(third) != nullptr);
+        REQUIRE(pool.nIdleStates() == 0);
+    }
+    REQUIRE(pool.nIdleStates() == 3);
+
+    {
+        ghoul::lua::LuaStatePool::Handle handle = pool.acquire();
+        ghoul::lua::LuaStatePool::Handle moved = std::move(handle);
+        REQUIRE(pool.nIdleStates() == 2);
+    }
+    REQUIRE(pool.nIdleStates() == 3);
+}
+
+TEST_CASE("LuaStatePool: Reset Globals", "[luastatepool]") {
+    ghoul::lua::LuaStatePool pool(
+        1,
+        ghoul::lua::LuaState::IncludeStandardLibrary::Yes,
+        [](lua_State* state) { ghoul::lua::runScript(state, "Preloaded = 42"); }
+    );
+
+    {
+        ghoul::lua::LuaStatePool::Handle state = pool.acquire();
+        REQUIRE(ghoul::lua::value<int>(state, "Preloaded") == 42);
+        ghoul::lua::runScript(state, "Preloaded = 1; Added = 2; print = nil");
+        REQUIRE(ghoul::lua::value<int>(state, "Added", ghoul::lua::PopValue::Yes) == 2);
+
+        // Leave something on the stack that has to be cleaned up
+        lua_pushinteger(state, 1);
+    }
+
+    ghoul::lua::LuaStatePool::Handle state = pool.acquire();
+    REQUIRE(lua_gettop(state) == 0);
+    REQUIRE(ghoul::lua::value<int>(state, "Preloaded") == 42);
+
+    lua_getglobal(state, "Added");
+    REQUIRE(lua_isnil(state, -1));
+    lua_getglobal(state, "print");
+    REQUIRE(lua_isfunction(state, -1));
+    lua_settop(state, 0);
+}
+
+TEST_CASE("LuaStatePool: Failed Reset", "[luastatepool]") {
+    ghoul::lua::LuaStatePool pool(
+        1,
+        ghoul::lua::LuaState::IncludeStandardLibrary::Yes,
+        [](lua_State* state) {
+            ghoul::lua::runScript(state, "for i = 1, 1000 do _G['g' .. i] = i end");
+        }
+    );
+
+    FailingAllocator allocator;
+    {
+        ghoul::lua::LuaStatePool::Handle state = pool.acquire();
+        // After replacing the globals, the global table has to grow to restore them
+        ghoul::lua::runScript(
+            state,
+            "for i = 1, 1000 do _G['g' .. i] = nil end "
+            "for i = 1, 2000 do _G['h' .. i] = i end"
+        );
+        allocator.allocator = lua_getallocf(state, &allocator.userData);
+        lua_setallocf(state, failingAllocate, &allocator);
+        allocator.fail = true;
+    }
+    // The state could not be reset, so it is not reused
+    REQUIRE(pool.nIdleStates() == 0);
+
+    ghoul::lua::LuaStatePool::Handle state = pool.acquire();
+    REQUIRE(ghoul::lua::value<int>(state, "g1000") == 1000);
+    lua_settop(state, 0);
+}
+
+TEST_CASE("LuaStatePool: Parallel", "[luastatepool]") {
+    constexpr const int NScripts = 500;
+
+    ghoul::lua::LuaStatePool pool;
+    ghoul::ThreadPool threadPool(4);
+
+    std::vector<std::future<ghoul::Dictionary>> results;
+    for (int i = 0; i < NScripts; ++i) {
+        results.push_back(threadPool.queue([&pool, i]() {
+            const std::string script = "Value = " + std::to_string(i) +
+                "; return { a = Value, b = 'foo' }";
+            return ghoul::lua::loadDictionaryFromString(script, pool.acquire());
+        }));
+    }
+
+    for (int i = 0; i < NScripts; ++i) {
+        const ghoul::Dictionary d = results[i].get();
+        REQUIRE(d.value<double>("a") == static_cast<double>(i));
+        REQUIRE(d.value<std::string>("b") == "foo");
+    }
+
+    // No more states than threads that used them at the same time
+    REQUIRE(pool.nIdleStates() <= 4);
+}
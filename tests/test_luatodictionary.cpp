@@ -25,12 +25,15 @@
 
 #include "catch2/catch.hpp"
 
+#include <ghoul/filesystem/directory.h>
 #include <ghoul/filesystem/filesystem.h>
 #include <ghoul/lua/lua_helper.h>
 #include <ghoul/misc/dictionary.h>
 #include <ghoul/glm.h>
+#include <algorithm>
 #include <fstream>
 #include <sstream>
+#include <vector>
 
 // @TODO (abock, 2020-01-06) None of these tests really work anymore and there is an open
 // issue to rewrite the Dictionary class, so there is no much reason to make these work
@@ -1895,3 +1898,116 @@ TEST_CASE("LuaToDictionary: MatrixClass SetValue", "[luatodictionary]") {
 }
 
 #endif
+
+TEST_CASE("LuaToDictionary: Bytecode Cache", "[luatodictionary]") {
+    using namespace ghoul::filesystem;
+
+    const std::string tmp = absPath("${TEMPORARY}");
+    const std::string cacheDirectory = tmp + "/ghoul_luabytecode_cache";
+    if (FileSys.directoryExists(cacheDirectory)) {
+        FileSys.deleteDirectory(cacheDirectory, FileSystem::Recursive::Yes);
+    }
+    FileSys.createDirectory(cacheDirectory);
+    FileSys.createCacheManager(cacheDirectory);
+
+    auto cachedFiles = [&cacheDirectory]() {
+        std::vector<std::string> files = Directory(cacheDirectory).readFiles(
+            Directory::Recursive::Yes
+        );
+        return std::count_if(
+            files.begin(),
+            files.end(),
+            [](const std::string& f) {
+                return f.find("ghoul_luabytecode.lua") != std::string::npos;
+            }
+        );
+    };
+
+    // The first line is skipped just like luaL_loadfile does
+    const std::string script = tmp + "/ghoul_luabytecode.lua";
+    std::ofstream(script) << "#!/usr/bin/env lua\nreturn { a = 1 }";
+    REQUIRE(ghoul::lua::loadDictionaryFromFile(script).value<double>("a") == 1.0);
+    REQUIRE(cachedFiles() == 1);
+
+    // The second load uses the bytecode
+    REQUIRE(ghoul::lua::loadDictionaryFromFile(script).value<double>("a") == 1.0);
+    REQUIRE(cachedFiles() == 1);
+
+    // Changing the script invalidates the bytecode and replaces it in the same entry
+    std::ofstream(script) << "return { a = 2 }";
+    REQUIRE(ghoul::lua::loadDictionaryFromFile(script).value<double>("a") == 2.0);
+    REQUIRE(cachedFiles() == 1);
+    std::ofstream(script) << "return { a = 3 }";
+    REQUIRE(ghoul::lua::loadDictionaryFromFile(script).value<double>("a") == 3.0);
+    REQUIRE(cachedFiles() == 1);
+
+    Directory directory(cacheDirectory);
+    std::string cachedFile;
+    for (const std::string& f : directory.readFiles(Directory::Recursive::Yes)) {
+        if (f.find("ghoul_luabytecode.lua") != std::string::npos) {
+            cachedFile = f;
+        }
+    }
+    REQUIRE_FALSE(cachedFile.empty());
+
+    // Damaged bytecode fails the checksum and is recompiled from the script
+    {
+        std::fstream f(cachedFile, std::ios::binary | std::ios::in | std::ios::out);
+        f.seekg(-1, std::ios::end);
+        const char last = static_cast<char>(f.get());
+        f.seekp(-1, std::ios::end);
+        f.put(static_cast<char>(last ^ 0x5A));
+    }
+    REQUIRE(ghoul::lua::loadDictionaryFromFile(script).value<double>("a") == 3.0);
+    REQUIRE(ghoul::lua::loadDictionaryFromFile(script).value<double>("a") == 3.0);
+
+    // Broken bytecode is recompiled from the script
+    std::ofstream(cachedFile, std::ios::binary) << "\x1bLua broken";
+    REQUIRE(ghoul::lua::loadDictionaryFromFile(script).value<double>("a") == 3.0);
+    REQUIRE(cachedFiles() == 1);
+
+    FileSys.destroyCacheManager();
+}
+
+TEST_CASE("LuaToDictionary: Conversion", "[luatodictionary]") {
+    ghoul::Dictionary d = ghoul::lua::loadDictionaryFromString(
+        "return {"
+        "  Name = 'Earth', Enabled = true, Radius = 6371.0,"
+        "  Position = { 1, 2, 3 },"
+        "  Nested = { A = { B = { C = 'deep' } } },"
+        "  Samples = { 0.5, 1.5, 2.5, 3.5, 4.5, 5.5, 6.5, 7.5, 8.5, 9.5, 10.5, 11.5 }"
+        "}"
+    );
+
+    REQUIRE(d.size() == 6);
+    CHECK(d.value<std::string>("Name") == "Earth");
+    CHECK(d.value<bool>("Enabled"));
+    CHECK(d.value<double>("Radius") == 6371.0);
+    CHECK(d.value<std::string>("Nested.A.B.C") == "deep");
+
+    // Arrays are stored with the 1-based indices as keys
+    const ghoul::Dictionary position = d.value<ghoul::Dictionary>("Position");
+    REQUIRE(position.size() == 3);
+    CHECK(position.value<double>("1") == 1.0);
+    CHECK(position.value<double>("3") == 3.0);
+
+    const ghoul::Dictionary samples = d.value<ghoul::Dictionary>("Samples");
+    REQUIRE(samples.size() == 12);
+    CHECK(samples.value<double>("10") == 9.5);
+    CHECK(samples.value<double>("12") == 11.5);
+
+    // Keys containing a '.' still address nested dictionaries, which have to exist
+    CHECK_THROWS_AS(
+        ghoul::lua::loadDictionaryFromString("return { ['A.B'] = 1 }"),
+        ghoul::Dictionary::KeyError
+    );
+
+    CHECK_THROWS_AS(
+        ghoul::lua::loadDictionaryFromString("return { 1, 2, A = 3 }"),
+        ghoul::lua::LuaFormatException
+    );
+    CHECK_THROWS_AS(
+        ghoul::lua::loadDictionaryFromString("return { A = function() end }"),
+        ghoul::lua::LuaFormatException
+    );
+}
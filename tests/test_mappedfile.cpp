@@ -0,0 +1,83 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2020                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <ghoul/filesystem/file.h>
+#include <ghoul/filesystem/filesystem.h>
+#include <ghoul/filesystem/mappedfile.h>
+#include <ghoul/misc/crc32.h>
+#include <fstream>
+#include <string>
+#include <utility>
+
+TEST_CASE("MappedFile: Contents", "[mappedfile]") {
+    using ghoul::filesystem::MappedFile;
+
+    std::string content;
+    for (int i = 0; i < 100000; ++i) {
+        content += std::to_string(i) + ',';
+    }
+    const std::string path = absPath("${TEMPORARY}/ghoul_mappedfile_contents");
+    std::ofstream(path, std::ofstream::binary) << content;
+
+    MappedFile file(path, MappedFile::Advice::Sequential, MappedFile::UseHugePages::Yes);
+    REQUIRE(file.path() == path);
+    REQUIRE(file.size() == content.size());
+    REQUIRE_FALSE(file.empty());
+    REQUIRE(file.view() == content);
+
+    // Hints for parts of the file do not change the contents
+    file.advise(MappedFile::Advice::Random, 12345, 100);
+    file.advise(MappedFile::Advice::WillNeed, content.size() - 1, 4096);
+    REQUIRE(file.view() == content);
+
+    REQUIRE(ghoul::hashCRC32File(path) == ghoul::hashCRC32(content));
+
+    // Moving transfers the ownership of the mapping
+    MappedFile moved = std::move(file);
+    REQUIRE(moved.view() == content);
+    REQUIRE(file.data() == nullptr);
+    REQUIRE(file.size() == 0);
+
+    FileSys.deleteFile(ghoul::filesystem::File(path));
+}
+
+TEST_CASE("MappedFile: Empty And Missing", "[mappedfile]") {
+    using ghoul::filesystem::MappedFile;
+
+    const std::string path = absPath("${TEMPORARY}/ghoul_mappedfile_empty");
+    std::ofstream(path).close();
+    MappedFile file(path);
+    REQUIRE(file.empty());
+    REQUIRE(file.data() == nullptr);
+    REQUIRE(file.view().empty());
+    FileSys.deleteFile(ghoul::filesystem::File(path));
+
+    REQUIRE_THROWS_AS(
+        MappedFile(absPath("${TEMPORARY}/ghoul_mappedfile_missing")),
+        MappedFile::MappedFileException
+    );
+}
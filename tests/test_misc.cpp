@@ -0,0 +1,86 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2020                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <ghoul/misc/misc.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+TEST_CASE("Misc: Split String", "[misc]") {
+    auto split = [](std::string_view input, char separator) {
+        std::vector<std::string> result;
+        for (std::string_view part : ghoul::splitString(input, separator)) {
+            result.emplace_back(part);
+        }
+        return result;
+    };
+
+    const std::vector<std::string> inputs = {
+        "", ".", "a", "a.b.c.d 1.e", ".a", "a.", "a..b", "..", "a.b.c.d.e.f.g"
+    };
+    for (const std::string& input : inputs) {
+        REQUIRE(split(input, '.') == ghoul::tokenizeString(input, '.'));
+    }
+    REQUIRE(split("a.b..c", '.') == std::vector<std::string>{ "a", "b", "", "c" });
+    REQUIRE(split("1\n2\n", '\n') == std::vector<std::string>{ "1", "2", "" });
+
+    // The parts point into the input instead of being copied
+    const std::string input = "first,second";
+    ghoul::StringSplitRange range = ghoul::splitString(input, ',');
+    ghoul::StringSplitRange::Iterator it = range.begin();
+    REQUIRE(it->data() == input.data());
+    REQUIRE(*it++ == "first");
+    REQUIRE(it != range.end());
+    REQUIRE(it->data() == input.data() + 6);
+    REQUIRE(*it == "second");
+    REQUIRE(++it == range.end());
+    REQUIRE(std::distance(range.begin(), range.end()) == 2);
+}
+
+TEST_CASE("Misc: Join", "[misc]") {
+    REQUIRE(ghoul::join({}) == "");
+    REQUIRE(ghoul::join({ "a" }) == "a");
+    REQUIRE(ghoul::join({ "a", "b", "c" }) == "a.b.c");
+    REQUIRE(ghoul::join({ "a", "", "c" }, ", ") == "a, , c");
+    REQUIRE(ghoul::join(ghoul::tokenizeString("a.b..c")) == "a.b..c");
+}
+
+TEST_CASE("Misc: Trim Whitespace", "[misc]") {
+    std::string s = " \t value with spaces \r\n";
+    ghoul::trimWhitespace(s);
+    REQUIRE(s == "value with spaces");
+
+    const std::string input = "  value ";
+    std::string_view view = input;
+    ghoul::trimWhitespace(view);
+    REQUIRE(view == "value");
+    REQUIRE(view.data() == input.data() + 2);
+
+    std::string_view empty = " \t\n ";
+    ghoul::trimWhitespace(empty);
+    REQUIRE(empty.empty());
+}
@@ -0,0 +1,244 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2020                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <ghoul/filesystem/file.h>
+#include <ghoul/filesystem/filesystem.h>
+#include <ghoul/filesystem/packarchive.h>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+    // Creates a directory with a couple of files and returns their contents
+    std::map<std::string, std::string> createDirectory(const std::string& dir) {
+        using namespace ghoul::filesystem;
+
+        if (FileSys.directoryExists(dir)) {
+            FileSys.deleteDirectory(dir, FileSystem::Recursive::Yes);
+        }
+        FileSys.createDirectory(dir + "/shaders/include", FileSystem::Recursive::Yes);
+
+        std::map<std::string, std::string> files;
+        for (int i = 0; i < 1000; ++i) {
+            files["config.txt"] += "key" + std::to_string(i % 10) + " = value;\n";
+        }
+        files["empty"] = "";
+        files["shaders/a.glsl"] = "#include \"include/b.glsl\"\nvoid main() {}\n";
+        files["shaders/include/b.glsl"] = "uniform float a;\n";
+        // Data without any repetitions that cannot be compressed
+        unsigned int state = 1;
+        for (int i = 0; i < 4096; ++i) {
+            state = state * 1103515245 + 12345;
+            files["random.bin"] += static_cast<char>(state >> 24);
+        }
+
+        for (const std::pair<const std::string, std::string>& f : files) {
+            std::ofstream(dir + "/" + f.first, std::ofstream::binary) << f.second;
+        }
+        return files;
+    }
+} // namespace
+
+TEST_CASE("PackArchive: Round Trip", "[packarchive]") {
+    using namespace ghoul::filesystem;
+
+    const std::string dir = absPath("${TEMPORARY}/ghoul_packarchive_files");
+    const std::map<std::string, std::string> files = createDirectory(dir);
+    const std::string stored = absPath("${TEMPORARY}/ghoul_packarchive_stored.pack");
+    const std::string compressed = absPath("${TEMPORARY}/ghoul_packarchive_lz4.pack");
+    PackArchive::create(stored, dir, PackArchive::Compress::No);
+    PackArchive::create(compressed, dir, PackArchive::Compress::Yes);
+
+    for (const std::string& path : { stored, compressed }) {
+        PackArchive archive(path);
+        REQUIRE(archive.path() == path);
+
+        std::vector<std::string> names;
+        for (const std::pair<const std::string, std::string>& f : files) {
+            names.push_back(f.first);
+            REQUIRE(archive.hasFile(f.first));
+            REQUIRE(archive.read(f.first).view() == f.second);
+        }
+        REQUIRE(archive.files() == names);
+
+        REQUIRE(archive.hasDirectory(""));
+        REQUIRE(archive.hasDirectory("shaders"));
+        REQUIRE(archive.hasDirectory("shaders/include"));
+        REQUIRE_FALSE(archive.hasDirectory("shader"));
+        REQUIRE_FALSE(archive.hasFile("shaders"));
+        REQUIRE_FALSE(archive.hasFile("missing"));
+        REQUIRE_THROWS_AS(archive.read("missing"), FileSource::FileSourceException);
+    }
+
+    // The contents are still valid after the archive is closed
+    FileContents contents = PackArchive(stored).read("config.txt");
+    REQUIRE(contents.view() == files.at("config.txt"));
+
+    std::ifstream s(stored, std::ifstream::binary | std::ifstream::ate);
+    std::ifstream c(compressed, std::ifstream::binary | std::ifstream::ate);
+    REQUIRE(c.tellg() < s.tellg());
+}
+
+TEST_CASE("PackArchive: Invalid Archive", "[packarchive]") {
+    using namespace ghoul::filesystem;
+
+    const std::string dir = absPath("${TEMPORARY}/ghoul_packarchive_files");
+    createDirectory(dir);
+    const std::string path = absPath("${TEMPORARY}/ghoul_packarchive_invalid.pack");
+
+    std::ofstream(path, std::ofstream::binary) << "not an archive";
+    REQUIRE_THROWS_AS(PackArchive(path), PackArchive::PackArchiveException);
+
+    // An archive that is missing the end of its index
+    PackArchive::create(path, dir);
+    std::string archive;
+    {
+        std::ifstream f(path, std::ifstream::binary);
+        archive.assign(std::istreambuf_iterator<char>(f), {});
+    }
+    std::ofstream(path, std::ofstream::binary) << archive.substr(0, archive.size() - 4);
+    REQUIRE_THROWS_AS(PackArchive(path), PackArchive::PackArchiveException);
+
+    REQUIRE_THROWS_AS(
+        PackArchive(absPath("${TEMPORARY}/ghoul_packarchive_missing.pack")),
+        PackArchive::PackArchiveException
+    );
+
+    auto writeLE = [](std::string& data, size_t offset, uint64_t value, size_t size) {
+        for (size_t i = 0; i < size; ++i) {
+            data[offset + i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+        }
+    };
+    auto readLE = [](const std::string& data, size_t offset) {
+        uint64_t value = 0;
+        for (size_t i = 0; i < sizeof(uint64_t); ++i) {
+            value |= static_cast<uint64_t>(static_cast<unsigned char>(data[offset + i]))
+                     << (8 * i);
+        }
+        return value;
+    };
+
+    // An archive that claims to contain more entries than its index can hold
+    std::string corrupted = archive;
+    writeLE(corrupted, 12, 0xFFFFFFFF, sizeof(uint32_t));
+    std::ofstream(path, std::ofstream::binary) << corrupted;
+    REQUIRE_THROWS_AS(PackArchive(path), PackArchive::PackArchiveException);
+
+    // A compressed entry whose size exceeds what LZ4 can produce from its stored size.
+    // The first entry is 'config.txt', which is compressed
+    const uint64_t indexOffset = readLE(archive, 16);
+    corrupted = archive;
+    writeLE(corrupted, indexOffset + 16, uint64_t(1) << 40, sizeof(uint64_t));
+    std::ofstream(path, std::ofstream::binary) << corrupted;
+    REQUIRE_THROWS_AS(PackArchive(path), PackArchive::PackArchiveException);
+
+    // Contents that run past the end of the file
+    corrupted = archive;
+    writeLE(corrupted, indexOffset + 8, archive.size(), sizeof(uint64_t));
+    std::ofstream(path, std::ofstream::binary) << corrupted;
+    REQUIRE_THROWS_AS(PackArchive(path), PackArchive::PackArchiveException);
+}
+
+TEST_CASE("PackArchive: Mount", "[packarchive]") {
+    using namespace ghoul::filesystem;
+
+    const std::string dir = absPath("${TEMPORARY}/ghoul_packarchive_files");
+    const std::map<std::string, std::string> files = createDirectory(dir);
+    const std::string path = absPath("${TEMPORARY}/ghoul_packarchive_mount.pack");
+    PackArchive::create(path, dir);
+
+    // The mount point does not exist on disk and is accessed through a path token
+    const std::string tokenPath = "${TEMPORARY}/ghoul_packarchive_mount";
+    const std::string mountPoint = absPath(tokenPath);
+    FileSys.mount(mountPoint, std::make_unique<PackArchive>(path));
+
+    const std::string shader = absPath(tokenPath + "/shaders/a.glsl");
+    REQUIRE(FileSys.fileExists(shader));
+    REQUIRE(FileSys.directoryExists(absPath(tokenPath + "/shaders/include")));
+    REQUIRE(FileSys.directoryExists(mountPoint));
+    REQUIRE_FALSE(FileSys.fileExists(absPath(tokenPath + "/shaders/missing")));
+    REQUIRE(
+        FileSys.readFile(tokenPath + "/shaders/a.glsl").view() ==
+        files.at("shaders/a.glsl")
+    );
+
+    // A nested mount point takes precedence over the outer one
+    std::ofstream(dir + "/shaders/override.glsl") << "override";
+    FileSys.mount(
+        tokenPath + "/shaders",
+        std::make_unique<DirectorySource>(dir + "/shaders")
+    );
+    const std::string overridden = tokenPath + "/shaders/override.glsl";
+    REQUIRE(FileSys.readFile(overridden).view() == "override");
+    FileSys.unmount(tokenPath + "/shaders");
+    REQUIRE_FALSE(FileSys.fileExists(absPath(overridden)));
+
+    // Files on disk are still read normally
+    REQUIRE(FileSys.readFile(dir + "/config.txt").view() == files.at("config.txt"));
+    REQUIRE(FileSys.isMountedFile(shader));
+    REQUIRE_FALSE(FileSys.isMountedFile(dir + "/config.txt"));
+
+    // '..' components are resolved before the mount point is determined
+    REQUIRE(absPath(mountPoint + "/shaders/../config.txt") == mountPoint + "/config.txt");
+    const std::string outside = mountPoint + "/../ghoul_packarchive_files/config.txt";
+    REQUIRE(absPath(outside) == dir + "/config.txt");
+    REQUIRE(FileSys.readFile(outside).view() == files.at("config.txt"));
+
+    FileSys.unmount(mountPoint);
+    REQUIRE_FALSE(FileSys.fileExists(shader));
+    REQUIRE_THROWS_AS(FileSys.readFile(shader), FileSystem::FileSystemException);
+}
+
+TEST_CASE("PackArchive: Directory Source", "[packarchive]") {
+    using namespace ghoul::filesystem;
+
+    const std::string dir = absPath("${TEMPORARY}/ghoul_packarchive_files");
+    const std::map<std::string, std::string> files = createDirectory(dir);
+
+    // The directory is passed with a path token and is resolved by the source
+    DirectorySource source("${TEMPORARY}/ghoul_packarchive_files/");
+    std::vector<std::string> names;
+    for (const std::pair<const std::string, std::string>& f : files) {
+        names.push_back(f.first);
+    }
+    REQUIRE(source.files() == names);
+    REQUIRE(source.hasFile("shaders/a.glsl"));
+    REQUIRE(source.hasDirectory("shaders/include"));
+    REQUIRE_FALSE(source.hasFile("shaders"));
+    REQUIRE(source.read("config.txt").view() == files.at("config.txt"));
+
+    // A directory mounted onto itself must not consult its own mount point
+    FileSys.mount(dir, std::make_unique<DirectorySource>(dir));
+    REQUIRE(FileSys.fileExists(dir + "/config.txt"));
+    REQUIRE(FileSys.directoryExists(dir + "/shaders"));
+    REQUIRE_FALSE(FileSys.fileExists(dir + "/missing"));
+    const FileContents shader = FileSys.readFile(dir + "/shaders/a.glsl");
+    REQUIRE(shader.view() == files.at("shaders/a.glsl"));
+    FileSys.unmount(dir);
+}
@@ -0,0 +1,131 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2020                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <ghoul/misc/ringbuffer.h>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("RingBuffer: Capacity", "[ringbuffer]") {
+    ghoul::RingBuffer buffer(1000);
+    CHECK(buffer.capacity() == 1024);
+    CHECK(buffer.empty());
+    CHECK(buffer.size() == 0);
+    CHECK(buffer.freeSpace() == 1024);
+
+    std::vector<char> data(2000, 'a');
+    CHECK(buffer.write(data.data(), data.size()) == 1024);
+    CHECK(buffer.size() == 1024);
+    CHECK(buffer.freeSpace() == 0);
+    CHECK(buffer.writeRegion().second == 0);
+    CHECK(buffer.write(data.data(), 1) == 0);
+}
+
+TEST_CASE("RingBuffer: Wrap Around", "[ringbuffer]") {
+    ghoul::RingBuffer buffer(16);
+
+    // Move the indices close to the end of the storage
+    char tmp[16];
+    REQUIRE(buffer.write("0123456789", 10) == 10);
+    REQUIRE(buffer.read(tmp, 10) == 10);
+    CHECK(std::string(tmp, 10) == "0123456789");
+    CHECK(buffer.empty());
+
+    REQUIRE(buffer.write("abcdefgh;ijk", 12) == 12);
+    CHECK(buffer.size() == 12);
+
+    // The first six bytes are before the end of the storage, the rest after it
+    const std::pair<const char*, size_t> region = buffer.readRegion();
+    CHECK(region.second == 6);
+    CHECK(std::string(region.first, region.second) == "abcdef");
+    CHECK(buffer.contiguousData(6) != nullptr);
+    CHECK(buffer.contiguousData(7) == nullptr);
+
+    CHECK(buffer.find('a') == 0);
+    CHECK(buffer.find(';') == 8);
+    CHECK(buffer.find('k') == 11);
+    CHECK(buffer.find(';', 9) == ghoul::RingBuffer::npos);
+    CHECK(buffer.find('z') == ghoul::RingBuffer::npos);
+    CHECK(buffer.find(';', 0, 8) == ghoul::RingBuffer::npos);
+    CHECK(buffer.find(';', 0, 9) == 8);
+    CHECK(buffer.find('k', 9, 64) == 11);
+
+    REQUIRE(buffer.peek(tmp, 16) == 12);
+    CHECK(std::string(tmp, 12) == "abcdefgh;ijk");
+    CHECK(buffer.size() == 12);
+
+    buffer.consume(9);
+    CHECK(buffer.find('i') == 0);
+    CHECK(buffer.contiguousData(3) != nullptr);
+    CHECK(std::string(buffer.contiguousData(3), 3) == "ijk");
+
+    // The writable region ends at the end of the storage
+    const std::pair<char*, size_t> writeRegion = buffer.writeRegion();
+    CHECK(writeRegion.second == 10);
+    CHECK(buffer.freeSpace() == 13);
+    std::memcpy(writeRegion.first, "lmn", 3);
+    buffer.commit(3);
+    REQUIRE(buffer.read(tmp, 16) == 6);
+    CHECK(std::string(tmp, 6) == "ijklmn");
+}
+
+TEST_CASE("RingBuffer: Concurrent", "[ringbuffer]") {
+    constexpr const size_t NBytes = 16 * 1024 * 1024;
+    ghoul::RingBuffer buffer(4096);
+
+    std::thread producer([&buffer]() {
+        std::vector<char> data(1000);
+        size_t nWritten = 0;
+        while (nWritten < NBytes) {
+            const size_t n = std::min(data.size(), NBytes - nWritten);
+            for (size_t i = 0; i < n; ++i) {
+                data[i] = static_cast<char>((nWritten + i) % 251);
+            }
+            size_t offset = 0;
+            while (offset < n) {
+                offset += buffer.write(data.data() + offset, n - offset);
+            }
+            nWritten += n;
+        }
+    });
+
+    size_t nRead = 0;
+    bool isCorrect = true;
+    std::vector<char> data(1500);
+    while (nRead < NBytes) {
+        const size_t n = buffer.read(data.data(), data.size());
+        for (size_t i = 0; i < n; ++i) {
+            isCorrect &= (data[i] == static_cast<char>((nRead + i) % 251));
+        }
+        nRead += n;
+    }
+    producer.join();
+
+    CHECK(isCorrect);
+    CHECK(buffer.empty());
+}
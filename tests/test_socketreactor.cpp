@@ -0,0 +1,183 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2020                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifdef __linux__
+
+#include "catch2/catch.hpp"
+
+#include <ghoul/io/socket/socketreactor.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <unistd.h>
+#include <sys/socket.h>
+
+namespace {
+    // Waits until the predicate is fulfilled or a few seconds have passed
+    template <typename Predicate>
+    bool waitFor(Predicate predicate) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (!predicate()) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                return false;
+            }
+            std::this_thread::yield();
+        }
+        return true;
+    }
+
+    struct SocketPair {
+        SocketPair() {
+            socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, sockets.data());
+            // The first socket becomes readable immediately
+            [[maybe_unused]] ssize_t res = write(sockets[1], "x", 1);
+        }
+
+        ~SocketPair() {
+            close(sockets[0]);
+            close(sockets[1]);
+        }
+
+        std::array<int, 2> sockets;
+    };
+} // namespace
+
+TEST_CASE("SocketReactor: Unregister Waits", "[socketreactor]") {
+    using ghoul::io::SocketReactor;
+    SocketReactor reactor(1);
+    SocketPair pair;
+
+    std::atomic_bool isRunning = false;
+    std::atomic_bool isFinished = false;
+    const uint64_t id = reactor.registerSocket(
+        pair.sockets[0],
+        SocketReactor::Readable,
+        [&](int) {
+            isRunning = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            isFinished = true;
+        }
+    );
+    REQUIRE(waitFor([&]() { return isRunning.load(); }));
+
+    // Unregistering from another thread waits for the running callback
+    reactor.unregisterSocket(id);
+    REQUIRE(isFinished);
+}
+
+TEST_CASE("SocketReactor: Unregister From Other Loop Waits", "[socketreactor]") {
+    using ghoul::io::SocketReactor;
+    SocketReactor reactor(2);
+    std::array<SocketPair, 2> pairs;
+
+    // The first callback is slow, the second one unregisters the first socket while it
+    // is running on the other loop
+    std::atomic_bool isRunning = false;
+    std::atomic_bool isFinished = false;
+    std::atomic_bool wasFinished = false;
+    std::atomic_bool hasUnregistered = false;
+    const uint64_t slowId = reactor.registerSocket(
+        pairs[0].sockets[0],
+        SocketReactor::Readable,
+        [&](int) {
+            if (isRunning.exchange(true)) {
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            isFinished = true;
+        }
+    );
+    REQUIRE(waitFor([&]() { return isRunning.load(); }));
+
+    const uint64_t id = reactor.registerSocket(
+        pairs[1].sockets[0],
+        SocketReactor::Readable,
+        [&](int) {
+            if (hasUnregistered.exchange(true)) {
+                return;
+            }
+            reactor.unregisterSocket(slowId);
+            wasFinished = isFinished.load();
+        }
+    );
+    REQUIRE(waitFor([&]() { return hasUnregistered.load(); }));
+    reactor.unregisterSocket(id);
+    REQUIRE(wasFinished);
+}
+
+TEST_CASE("SocketReactor: Unregister Across Loops", "[socketreactor]") {
+    using ghoul::io::SocketReactor;
+    SocketReactor reactor(2);
+    std::array<SocketPair, 2> pairs;
+
+    // Each callback unregisters the other socket while both callbacks are running on
+    // different loops, so neither of them can wait for the other
+    std::array<std::atomic<uint64_t>, 2> ids = { 0, 0 };
+    std::array<std::atomic_bool, 2> hasRun = { false, false };
+    std::atomic_int nRunning = 0;
+    std::atomic_int nFinished = 0;
+    std::atomic_int nCalls = 0;
+    auto callback = [&](int self) {
+        return [&, self](int) {
+            ++nCalls;
+            // The sockets stay readable, so the callbacks are called until they have
+            // been unregistered
+            if (hasRun[self].exchange(true)) {
+                return;
+            }
+            ++nRunning;
+            waitFor([&]() { return nRunning == 2; });
+            reactor.unregisterSocket(ids[1 - self]);
+            ++nFinished;
+        };
+    };
+
+    // Consecutive registrations are served by different loops. The sockets are
+    // registered without events first so that the callbacks know both identifiers
+    for (int i = 0; i < 2; ++i) {
+        ids[i] = reactor.registerSocket(
+            pairs[i].sockets[0],
+            SocketReactor::None,
+            callback(i)
+        );
+    }
+    for (int i = 0; i < 2; ++i) {
+        reactor.setEvents(ids[i], SocketReactor::Readable);
+    }
+
+    REQUIRE(waitFor([&]() { return nFinished == 2; }));
+    REQUIRE(nRunning == 2);
+
+    // Both registrations are removed once the callbacks have returned
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    const int nCallsBefore = nCalls;
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    REQUIRE(nCalls == nCallsBefore);
+    reactor.unregisterSocket(ids[0]);
+    reactor.unregisterSocket(ids[1]);
+}
+
+#endif // __linux__
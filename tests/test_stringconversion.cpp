@@ -0,0 +1,237 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2020                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <ghoul/glm.h>
+#include <ghoul/misc/stringconversion.h>
+#include <clocale>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+TEST_CASE("StringConversion: Integral", "[stringconversion]") {
+    REQUIRE(ghoul::to_string(0) == "0");
+    REQUIRE(ghoul::to_string(-12345) == "-12345");
+    constexpr int64_t Min = std::numeric_limits<int64_t>::min();
+    constexpr uint64_t Max = std::numeric_limits<uint64_t>::max();
+    REQUIRE(ghoul::to_string(Min) == "-9223372036854775808");
+    REQUIRE(ghoul::to_string(Max) == "18446744073709551615");
+    REQUIRE(ghoul::to_string(true) == "1");
+    REQUIRE(ghoul::to_string(false) == "0");
+
+    REQUIRE(ghoul::from_string<int>("-12345") == -12345);
+    REQUIRE(ghoul::from_string<int>("+42") == 42);
+    REQUIRE(ghoul::from_string<uint8_t>("255") == 255);
+    REQUIRE(ghoul::from_string<bool>("1"));
+    REQUIRE(ghoul::from_string<bool>("true"));
+    REQUIRE_FALSE(ghoul::from_string<bool>("0"));
+    REQUIRE_FALSE(ghoul::from_string<bool>("false"));
+
+    REQUIRE_THROWS_AS(ghoul::from_string<int>(""), std::invalid_argument);
+    REQUIRE_THROWS_AS(ghoul::from_string<int>("12a"), std::invalid_argument);
+    REQUIRE_THROWS_AS(ghoul::from_string<int>(" 12"), std::invalid_argument);
+    REQUIRE_THROWS_AS(ghoul::from_string<int>("+-12"), std::invalid_argument);
+    REQUIRE_THROWS_AS(ghoul::from_string<bool>("yes"), std::invalid_argument);
+    REQUIRE_THROWS_AS(ghoul::from_string<uint8_t>("256"), std::out_of_range);
+    REQUIRE_THROWS_AS(ghoul::from_string<unsigned int>("-1"), std::invalid_argument);
+}
+
+TEST_CASE("StringConversion: Floating Point", "[stringconversion]") {
+    // The shortest representation that reads back to the same value is used
+    REQUIRE(ghoul::to_string(0.1) == "0.1");
+    REQUIRE(ghoul::to_string(0.1f) == "0.1");
+    REQUIRE(ghoul::to_string(2.0) == "2");
+    REQUIRE(ghoul::to_string(-1.5e300) == "-1.5e+300");
+
+    REQUIRE(ghoul::from_string<double>("0.1") == 0.1);
+    REQUIRE(ghoul::from_string<float>("+2.5") == 2.5f);
+    REQUIRE(ghoul::from_string<double>("1e-3") == 1e-3);
+    REQUIRE_THROWS_AS(ghoul::from_string<double>("1.0.0"), std::invalid_argument);
+    REQUIRE_THROWS_AS(ghoul::from_string<float>("1e100"), std::out_of_range);
+
+    std::mt19937_64 generator(1337);
+    for (int i = 0; i < 10000; ++i) {
+        const uint64_t bits = generator();
+        double d;
+        std::memcpy(&d, &bits, sizeof(double));
+        if (!std::isfinite(d)) {
+            continue;
+        }
+        const std::string s = ghoul::to_string(d);
+        REQUIRE(s.size() <= ghoul::MaxCharsLength<double>);
+        REQUIRE(ghoul::from_string<double>(s) == d);
+
+        const float f = static_cast<float>(bits & 0xFFFFFFFF) / 3.f;
+        REQUIRE(ghoul::from_string<float>(ghoul::to_string(f)) == f);
+    }
+}
+
+TEST_CASE("StringConversion: Buffer", "[stringconversion]") {
+    char buffer[8];
+
+    std::to_chars_result res = ghoul::to_chars(buffer, buffer + sizeof(buffer), -1234);
+    REQUIRE(res.ec == std::errc());
+    REQUIRE(std::string(buffer, res.ptr) == "-1234");
+
+    res = ghoul::to_chars(buffer, buffer + sizeof(buffer), 123456789);
+    REQUIRE(res.ec == std::errc::value_too_large);
+
+    res = ghoul::to_chars(buffer, buffer, true);
+    REQUIRE(res.ec == std::errc::value_too_large);
+
+    // Parsing stops at the first character that does not belong to the number
+    const std::string s = "3.25,rest";
+    double value = 0.0;
+    std::from_chars_result r = ghoul::from_chars(s.data(), s.data() + s.size(), value);
+    REQUIRE(r.ec == std::errc());
+    REQUIRE(r.ptr == s.data() + 4);
+    REQUIRE(value == 3.25);
+}
+
+TEST_CASE("StringConversion: Fixed", "[stringconversion]") {
+    char buffer[16];
+    std::to_chars_result res = ghoul::to_chars(buffer, buffer + sizeof(buffer), 1.5, 6);
+    REQUIRE(res.ec == std::errc());
+    REQUIRE(std::string(buffer, res.ptr) == "1.500000");
+
+    res = ghoul::to_chars(buffer, buffer + sizeof(buffer), -2.25f, 1);
+    REQUIRE(std::string(buffer, res.ptr) == "-2.2");
+
+    res = ghoul::to_chars(buffer, buffer + sizeof(buffer), 1e20, 6);
+    REQUIRE(res.ec == std::errc::value_too_large);
+}
+
+TEST_CASE("StringConversion: Fallback", "[stringconversion]") {
+    // The fallback for standard libraries without floating point support in
+    // std::to_chars and std::from_chars has to behave the same way
+    auto toString = [](auto value) {
+        char buffer[ghoul::MaxCharsLength<decltype(value)>];
+        const std::to_chars_result res = ghoul::internal::floatToChars(
+            buffer,
+            buffer + sizeof(buffer),
+            value
+        );
+        REQUIRE(res.ec == std::errc());
+        return std::string(buffer, res.ptr);
+    };
+    auto fromString = [](const std::string& s, auto& value) {
+        const char* last = s.data() + s.size();
+        const std::from_chars_result res = ghoul::internal::floatFromChars(
+            s.data(),
+            last,
+            value
+        );
+        return res.ec == std::errc() ? res.ptr - s.data() : -1;
+    };
+
+    auto check = [&]() {
+        REQUIRE(toString(0.1) == "0.1");
+        REQUIRE(toString(0.1f) == "0.1");
+        REQUIRE(toString(2.0) == "2");
+        REQUIRE(toString(-1.5e300) == "-1.5e+300");
+
+        double d = 0.0;
+        REQUIRE(fromString("0.25", d) == 4);
+        REQUIRE(d == 0.25);
+        REQUIRE(fromString("3.25,rest", d) == 4);
+        REQUIRE(d == 3.25);
+        // std::from_chars does not parse hexadecimal numbers without being asked to
+        REQUIRE(fromString("0x10", d) == 1);
+        REQUIRE(d == 0.0);
+        REQUIRE(fromString(" 1", d) == -1);
+        REQUIRE(fromString("+1", d) == -1);
+        REQUIRE(fromString("", d) == -1);
+        float f = 0.f;
+        REQUIRE(fromString("1e100", f) == -1);
+
+        char buffer[16];
+        std::to_chars_result res = ghoul::internal::fixedToChars(
+            buffer,
+            buffer + sizeof(buffer),
+            1.5,
+            6
+        );
+        REQUIRE(std::string(buffer, res.ptr) == "1.500000");
+
+        std::mt19937_64 generator(1337);
+        for (int i = 0; i < 1000; ++i) {
+            const uint64_t bits = generator();
+            double value;
+            std::memcpy(&value, &bits, sizeof(double));
+            if (!std::isfinite(value)) {
+                continue;
+            }
+            const std::string s = toString(value);
+            REQUIRE(s.size() <= ghoul::MaxCharsLength<double>);
+            double result = 0.0;
+            REQUIRE(fromString(s, result) == static_cast<int>(s.size()));
+            REQUIRE(result == value);
+        }
+    };
+
+    check();
+
+    // The C functions use the decimal point of the current locale, which must not leak
+    // into the results
+    if (std::setlocale(LC_NUMERIC, "de_DE.UTF-8")) {
+        check();
+        std::setlocale(LC_NUMERIC, "C");
+    }
+}
+
+TEST_CASE("StringConversion: Vector", "[stringconversion]") {
+    REQUIRE(ghoul::to_string(glm::vec3(1.5f, -2.f, 0.1f)) == "{1.5,-2,0.1}");
+    REQUIRE(ghoul::to_string(glm::ivec2(-1, 7)) == "{-1,7}");
+    REQUIRE(ghoul::to_string(glm::bvec4(true, false, false, true)) == "{1,0,0,1}");
+
+    REQUIRE(ghoul::from_string<glm::dvec3>("{1,-0.25,3}") == glm::dvec3(1.0, -0.25, 3.0));
+    REQUIRE(ghoul::from_string<glm::uvec2>("{ 4 , 5 }") == glm::uvec2(4, 5));
+    REQUIRE(ghoul::from_string<glm::bvec2>("{true,0}") == glm::bvec2(true, false));
+
+    const glm::dvec4 v = glm::dvec4(0.1, 1e-300, -7.0, 123456.789);
+    REQUIRE(ghoul::from_string<glm::dvec4>(ghoul::to_string(v)) == v);
+
+    REQUIRE_THROWS_AS(ghoul::from_string<glm::ivec2>("{1,2,3}"), std::invalid_argument);
+    REQUIRE_THROWS_AS(ghoul::from_string<glm::ivec3>("{1,2}"), std::invalid_argument);
+    REQUIRE_THROWS_AS(ghoul::from_string<glm::ivec2>("1,2"), std::invalid_argument);
+    REQUIRE_THROWS_AS(ghoul::from_string<glm::ivec2>("{1,2}x"), std::invalid_argument);
+    REQUIRE_THROWS_AS(
+        ghoul::from_string<glm::ivec2>("{1,99999999999}"),
+        std::out_of_range
+    );
+
+    char buffer[6];
+    std::to_chars_result res = ghoul::to_chars(
+        buffer,
+        buffer + sizeof(buffer),
+        glm::ivec2(10, 20)
+    );
+    REQUIRE(res.ec == std::errc::value_too_large);
+}
@@ -0,0 +1,232 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * GHOUL                                                                                 *
+ * General Helpful Open Utility Library                                                  *
+ *                                                                                       *
+ * Copyright (c) 2012-2020                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <ghoul/filesystem/directory.h>
+#include <ghoul/io/socket/tcpsocket.h>
+#include <ghoul/io/socket/tcpsocketserver.h>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+    struct Connection {
+        std::unique_ptr<ghoul::io::TcpSocket> client;
+        std::unique_ptr<ghoul::io::TcpSocket> server;
+    };
+
+    Connection connect(ghoul::io::TcpSocketServer& server) {
+        Connection c;
+        c.client = std::make_unique<ghoul::io::TcpSocket>("127.0.0.1", server.port());
+        c.client->connect();
+        c.server = server.awaitPendingTcpSocket();
+        if (c.server) {
+            c.server->startStreams();
+        }
+        return c;
+    }
+} // namespace
+
+TEST_CASE("TcpSocket: Loopback", "[tcpsocket]") {
+    ghoul::io::TcpSocketServer server;
+    server.listen(0);
+    REQUIRE(server.isListening());
+    REQUIRE(server.port() != 0);
+
+    Connection c = connect(server);
+    REQUIRE(c.server);
+
+    // Messages written while the client is still connecting are sent afterwards
+    REQUIRE(c.client->putMessage("ping"));
+    std::string message;
+    REQUIRE(c.server->getMessage(message));
+    CHECK(message == "ping");
+    CHECK(c.client->isConnected());
+
+    REQUIRE(c.server->putMessage("pong"));
+    REQUIRE(c.client->getMessage(message));
+    CHECK(message == "pong");
+
+    // Binary data that is larger than the socket buffers arrives in one piece
+    std::vector<int> data(1 << 20);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<int>(i);
+    }
+    REQUIRE(c.client->put(data.data(), data.size()));
+    std::vector<int> received(data.size());
+    REQUIRE(c.server->peek(received.data(), 1));
+    CHECK(received[0] == 0);
+    REQUIRE(c.server->get(received.data(), received.size()));
+    CHECK(received == data);
+
+    // Closing one side is noticed by the other side
+    c.client->disconnect();
+    CHECK_FALSE(c.client->isConnected());
+    CHECK_FALSE(c.server->getMessage(message));
+    CHECK_FALSE(c.server->isConnected());
+
+    server.close();
+    CHECK_FALSE(server.isListening());
+}
+
+TEST_CASE("TcpSocket: Connection Refused", "[tcpsocket]") {
+    // Find a port that nobody is listening on
+    ghoul::io::TcpSocketServer server;
+    server.listen(0);
+    const int port = server.port();
+    server.close();
+
+    ghoul::io::TcpSocket socket("127.0.0.1", port);
+    socket.connect();
+    std::string message;
+    CHECK_FALSE(socket.getMessage(message));
+    CHECK_FALSE(socket.isConnected());
+    CHECK_FALSE(socket.isConnecting());
+}
+
+TEST_CASE("TcpSocket: Many Connections", "[tcpsocket]") {
+    constexpr const int NConnections = 200;
+
+    ghoul::io::TcpSocketServer server;
+    server.listen(0);
+
+#ifdef __linux__
+    // All sockets are served by the shared reactor, so the number of threads does not
+    // depend on the number of connections
+    auto nThreads = []() {
+        return ghoul::filesystem::Directory("/proc/self/task").readDirectories().size();
+    };
+    Connection first = connect(server);
+    const size_t nThreadsBefore = nThreads();
+#endif // __linux__
+
+    std::vector<Connection> connections;
+    for (int i = 0; i < NConnections; ++i) {
+        connections.push_back(connect(server));
+        REQUIRE(connections.back().server);
+    }
+
+#ifdef __linux__
+    CHECK(nThreads() == nThreadsBefore);
+#endif // __linux__
+
+    for (int i = 0; i < NConnections; ++i) {
+        REQUIRE(connections[i].client->putMessage("request " + std::to_string(i)));
+    }
+    for (int i = 0; i < NConnections; ++i) {
+        std::string message;
+        REQUIRE(connections[i].server->getMessage(message));
+        CHECK(message == "request " + std::to_string(i));
+        REQUIRE(connections[i].server->putMessage("response " + std::to_string(i)));
+    }
+    for (int i = 0; i < NConnections; ++i) {
+        std::string message;
+        REQUIRE(connections[i].client->getMessage(message));
+        CHECK(message == "response " + std::to_string(i));
+    }
+
+    connections.clear();
+    server.close();
+}
+
+TEST_CASE("TcpSocket: Message Views", "[tcpsocket]") {
+    ghoul::io::TcpSocketServer server;
+    server.listen(0);
+    Connection c = connect(server);
+    REQUIRE(c.server);
+
+    // Enough messages of different lengths that some wrap around the end of the input
+    // queue, and one message that is longer than the input queue
+    std::vector<std::string> messages;
+    for (int i = 0; i < 5000; ++i) {
+        messages.push_back(std::string(static_cast<size_t>(i % 1000), 'a' + i % 26));
+    }
+    messages.push_back(std::string(3 * 1024 * 1024, 'z'));
+    messages.push_back("last");
+
+    std::thread writer([&c, &messages]() {
+        for (const std::string& message : messages) {
+            c.client->putMessage(message);
+        }
+    });
+
+    for (const std::string& message : messages) {
+        std::string_view view;
+        REQUIRE(c.server->getMessage(view));
+        REQUIRE(view == message);
+    }
+    writer.join();
+
+    // Reading binary data releases the last message
+    REQUIRE(c.client->put("abc", 3));
+    char buffer[3];
+    REQUIRE(c.server->get(buffer, 3));
+    CHECK(std::string(buffer, 3) == "abc");
+}
+
+TEST_CASE("TcpSocket: Small Queues", "[tcpsocket]") {
+    ghoul::io::TcpSocketServer server;
+    server.listen(0);
+    ghoul::io::TcpSocket client(
+        "127.0.0.1",
+        server.port(),
+        ghoul::io::TcpSocket::QueueCapacity{ 64 }
+    );
+    client.connect();
+    std::unique_ptr<ghoul::io::TcpSocket> s = server.awaitPendingTcpSocket();
+    REQUIRE(s);
+    s->startStreams();
+
+    // Messages that are shorter than, as long as, and longer than the queues of the
+    // client, which are filled while the client is still searching for the delimiter
+    std::vector<std::string> messages;
+    for (int i = 0; i < 500; ++i) {
+        messages.push_back(std::string(static_cast<size_t>(i % 200), 'a' + i % 26));
+    }
+    messages.push_back("last");
+
+    std::thread writer([&s, &messages]() {
+        for (const std::string& message : messages) {
+            s->putMessage(message);
+        }
+    });
+
+    for (const std::string& message : messages) {
+        std::string received;
+        REQUIRE(client.getMessage(received));
+        REQUIRE(received == message);
+    }
+    writer.join();
+
+    // The output queue of the client is smaller than the message as well
+    const std::string reply(1000, 'r');
+    REQUIRE(client.putMessage(reply));
+    std::string received;
+    REQUIRE(s->getMessage(received));
+    CHECK(received == reply);
+}
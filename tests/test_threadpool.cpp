@@ -434,3 +434,20 @@ TEST_CASE("ThreadPool: Detaching Stop", "[threadpool]") {
     // As it is not blocking, the operation shouldn't take any time at all
     REQUIRE(ms < Epsilon);
 }
+
+TEST_CASE("ThreadPool: Tasks After Resize", "[threadpool]") {
+    // The workers keep signalling that they have been initialized while they run tasks,
+    // long after the function that started them has returned, so the signal must not
+    // live on the stack of the thread that started them
+    ghoul::ThreadPool pool(1);
+    [&pool]() { pool.resize(4); }();
+
+    std::atomic_int counter(0);
+    for (int i = 0; i < 100; ++i) {
+        pushWait(pool, 1, counter);
+    }
+    for (int i = 0; i < 1000 && counter < 100; ++i) {
+        threadSleep(std::chrono::milliseconds(5));
+    }
+    REQUIRE(counter == 100);
+}